@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Decode matchmaker binary logs (.mmblog) to text lines.
+
+The layout is documented in services/matchmaker/include/matchmaker/binary_log.hpp.
+Event names and format strings are read from the file header, so logs from
+older builds decode without this script knowing their events.
+
+Usage:
+    python scripts/decode_binary_log.py matchmaker.mmblog [--json]
+"""
+
+import datetime
+import json
+import re
+import struct
+import sys
+
+FILE_MAGIC = b"MMBLOG01"
+RECORD_SIZE = 128
+RECORD_HEADER = struct.Struct("<qHBBI")
+LEVELS = ["trace", "debug", "info", "warning", "error", "critical", "off"]
+PLACEHOLDER = re.compile(r"\{[^}]*\}")
+
+ARG_INT, ARG_DOUBLE, ARG_STRING = 1, 2, 3
+
+
+def read_header(blob):
+    """Return (events by id, offset of the first record)."""
+    if blob[:8] != FILE_MAGIC:
+        raise ValueError("not a matchmaker binary log")
+    (count,) = struct.unpack_from("<H", blob, 8)
+    pos = 10
+    events = {}
+    for _ in range(count):
+        event_id, level = struct.unpack_from("<HB", blob, pos)
+        pos += 3
+        (name_len,) = struct.unpack_from("<H", blob, pos)
+        name = blob[pos + 2 : pos + 2 + name_len].decode("utf-8")
+        pos += 2 + name_len
+        (fmt_len,) = struct.unpack_from("<H", blob, pos)
+        fmt = blob[pos + 2 : pos + 2 + fmt_len].decode("utf-8")
+        pos += 2 + fmt_len
+        events[event_id] = (name, LEVELS[level] if level < len(LEVELS) else str(level), fmt)
+    return events, pos
+
+
+def decode_args(payload, arg_count):
+    args = []
+    pos = 0
+    for _ in range(arg_count):
+        arg_type = payload[pos]
+        pos += 1
+        if arg_type == ARG_INT:
+            args.append(struct.unpack_from("<q", payload, pos)[0])
+            pos += 8
+        elif arg_type == ARG_DOUBLE:
+            args.append(struct.unpack_from("<d", payload, pos)[0])
+            pos += 8
+        elif arg_type == ARG_STRING:
+            length = payload[pos]
+            args.append(payload[pos + 1 : pos + 1 + length].decode("utf-8", "replace"))
+            pos += 1 + length
+        else:
+            raise ValueError(f"unknown arg type {arg_type}")
+    return args
+
+
+def render(fmt, args):
+    values = iter(args)
+
+    def substitute(match):
+        value = next(values, "?")
+        if match.group(0) == "{:.2f}" and isinstance(value, float):
+            return f"{value:.2f}"
+        return str(value)
+
+    return PLACEHOLDER.sub(substitute, fmt)
+
+
+def iter_records(blob):
+    events, pos = read_header(blob)
+    while pos + RECORD_SIZE <= len(blob):
+        timestamp_ns, event_id, arg_count, payload_size, _ = RECORD_HEADER.unpack_from(blob, pos)
+        payload = blob[pos + RECORD_HEADER.size : pos + RECORD_HEADER.size + payload_size]
+        pos += RECORD_SIZE
+        name, level, fmt = events.get(event_id, (f"event_{event_id}", "info", ""))
+        yield timestamp_ns, name, level, fmt, decode_args(payload, arg_count)
+
+
+def main():
+    paths = [arg for arg in sys.argv[1:] if not arg.startswith("--")]
+    as_json = "--json" in sys.argv
+    if not paths:
+        print(__doc__)
+        return 1
+
+    for path in paths:
+        with open(path, "rb") as f:
+            blob = f.read()
+        for timestamp_ns, name, level, fmt, args in iter_records(blob):
+            if as_json:
+                print(json.dumps({"ts_ns": timestamp_ns, "event": name, "level": level, "args": args}))
+            else:
+                ts = datetime.datetime.fromtimestamp(timestamp_ns / 1e9, datetime.timezone.utc)
+                print(f"[{ts.isoformat(timespec='milliseconds')}] [{level}] {render(fmt, args)}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Decode matchmaker .mmcol match export files to CSV.
+
+The layout is documented in services/matchmaker/include/matchmaker/match_exporter.hpp.
+Uses only the standard library; column buffers follow the Arrow layout, so
+pyarrow users can wrap them with pa.Array.from_buffers instead.
+
+Usage:
+    python scripts/decode_match_export.py matches-*.mmcol > matches.csv
+"""
+
+import array
+import csv
+import struct
+import sys
+
+FILE_MAGIC = b"MMCOL001"
+FOOTER_MAGIC = b"MMCOLEND"
+ROW_GROUP_MAGIC = 0x50524752
+FOOTER_SIZE = 4 + 8 + 8
+
+FIXED_TYPES = {0: "i", 1: "q", 2: "d"}  # int32, int64, float64
+UTF8 = 3
+
+
+def read_column(payload, row_count, col_type):
+    """Decode one column payload into a list of Python values."""
+    if col_type in FIXED_TYPES:
+        values = array.array(FIXED_TYPES[col_type])
+        values.frombytes(payload)
+        return values.tolist()
+    if col_type == UTF8:
+        offsets = array.array("i")
+        offsets.frombytes(payload[: (row_count + 1) * 4])
+        data = payload[(row_count + 1) * 4 :]
+        return [data[offsets[i] : offsets[i + 1]].decode("utf-8") for i in range(row_count)]
+    raise ValueError(f"unknown column type {col_type}")
+
+
+def iter_row_groups(path):
+    """Yield (column_names, rows) for each row group in a file."""
+    with open(path, "rb") as f:
+        blob = f.read()
+
+    if blob[:8] != FILE_MAGIC or blob[-8:] != FOOTER_MAGIC:
+        raise ValueError(f"{path}: not a complete .mmcol file")
+
+    pos = 8
+    end = len(blob) - FOOTER_SIZE
+    while pos < end:
+        magic, row_count, column_count = struct.unpack_from("<III", blob, pos)
+        if magic != ROW_GROUP_MAGIC:
+            raise ValueError(f"{path}: bad row group at offset {pos}")
+        pos += 12
+
+        names, columns = [], []
+        for _ in range(column_count):
+            (name_len,) = struct.unpack_from("<H", blob, pos)
+            pos += 2
+            names.append(blob[pos : pos + name_len].decode("ascii"))
+            pos += name_len
+            col_type, byte_len = struct.unpack_from("<BQ", blob, pos)
+            pos += 9
+            columns.append(read_column(blob[pos : pos + byte_len], row_count, col_type))
+            pos += byte_len
+
+        yield names, list(zip(*columns))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+
+    writer = csv.writer(sys.stdout)
+    header_written = False
+    for path in sys.argv[1:]:
+        for names, rows in iter_row_groups(path):
+            if not header_written:
+                writer.writerow(names)
+                header_written = True
+            writer.writerows(rows)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -4,7 +4,9 @@ WebSocket endpoints for real-time party updates.
 
 import logging
 import json
-from typing import Dict, Set
+import time
+from collections import OrderedDict, deque
+from typing import Deque, Dict, Optional, Set
 from datetime import datetime, timezone
 from fastapi import APIRouter, WebSocket, WebSocketDisconnect, Query
 from fastapi.websockets import WebSocketState
@@ -14,6 +16,13 @@ from utils.auth import verify_access_token
 logger = logging.getLogger(__name__)
 router = APIRouter()
 
+# Recent broadcasts kept per party so a reconnecting client can resume
+REPLAY_BUFFER_SIZE = 256
+# Drop the buffer of a party this long after its last connection leaves
+REPLAY_TTL_SECONDS = 300
+# Most parties without connections whose buffers are kept at once
+REPLAY_MAX_IDLE_PARTIES = 10000
+
 
 class ConnectionManager:
     """Manages WebSocket connections for party updates."""
@@ -23,10 +32,47 @@ class ConnectionManager:
         self.party_connections: Dict[str, Set[WebSocket]] = {}
         # Map of WebSocket -> player_id for authentication tracking
         self.connection_players: Dict[WebSocket, str] = {}
+        # Per-party broadcast sequence numbers and replay buffers
+        self.party_seq: Dict[str, int] = {}
+        self.party_history: Dict[str, Deque[dict]] = {}
+        # Parties with replay state but no connections -> when they went
+        # idle, oldest first, so pruning only looks at the front
+        self.idle_parties: "OrderedDict[str, float]" = OrderedDict()
+
+    def current_seq(self, party_id: str) -> int:
+        """Sequence number of the latest broadcast to a party (0 if none)."""
+        return self.party_seq.get(party_id, 0)
+
+    def resumable(self, party_id: str, last_seq: int) -> bool:
+        """True if every broadcast after last_seq is still in the replay buffer."""
+        if last_seq > self.current_seq(party_id):
+            return False  # Sequence restarted (e.g. server restart)
+        history = self.party_history.get(party_id)
+        return not history or history[0]["seq"] <= last_seq + 1
+
+    def open_replay(self, party_id: str):
+        """Start keeping replay state for a party a connection is about to join."""
+        # Broadcasts between "connected" and register() must reach resume()
+        if party_id not in self.party_connections:
+            self._mark_idle(party_id)
 
-    async def connect(self, websocket: WebSocket, party_id: str, player_id: str):
-        """Register a new WebSocket connection for a party."""
-        await websocket.accept()
+    async def resume(self, websocket: WebSocket, party_id: str, last_seq: int):
+        """Send buffered broadcasts newer than last_seq to an unregistered connection."""
+        # Broadcasts made while we await sends are picked up by the next pass;
+        # the caller registers the connection right after the last empty pass
+        sent = last_seq
+        while True:
+            history = self.party_history.get(party_id, ())
+            pending = [message for message in history if message["seq"] > sent]
+            if not pending:
+                return
+            for message in pending:
+                await websocket.send_json(message)
+                sent = message["seq"]
+
+    def register(self, websocket: WebSocket, party_id: str, player_id: str):
+        """Subscribe an accepted connection to party broadcasts."""
+        self.idle_parties.pop(party_id, None)
 
         if party_id not in self.party_connections:
             self.party_connections[party_id] = set()
@@ -36,13 +82,32 @@ class ConnectionManager:
 
         logger.info(f"Player {player_id} connected to party {party_id} WebSocket")
 
+    def _mark_idle(self, party_id: str):
+        """Keep a party's replay state for REPLAY_TTL_SECONDS from now."""
+        self.idle_parties.pop(party_id, None)
+        self.idle_parties[party_id] = time.monotonic()
+        self._prune_history()
+
+    def _prune_history(self):
+        """Forget replay buffers of parties nobody has listened to for a while."""
+        cutoff = time.monotonic() - REPLAY_TTL_SECONDS
+        while self.idle_parties:
+            party_id, idle_since = next(iter(self.idle_parties.items()))
+            if idle_since >= cutoff and len(self.idle_parties) <= REPLAY_MAX_IDLE_PARTIES:
+                break
+            del self.idle_parties[party_id]
+            self.party_seq.pop(party_id, None)
+            self.party_history.pop(party_id, None)
+
     def disconnect(self, websocket: WebSocket, party_id: str):
         """Remove a WebSocket connection."""
         if party_id in self.party_connections:
             self.party_connections[party_id].discard(websocket)
             if not self.party_connections[party_id]:
-                # Clean up empty party subscriptions
+                # Clean up empty party subscriptions; the replay buffer
+                # outlives them for clients that reconnect within the TTL
                 del self.party_connections[party_id]
+                self._mark_idle(party_id)
 
         player_id = self.connection_players.pop(websocket, "unknown")
         logger.info(f"Player {player_id} disconnected from party {party_id} WebSocket")
@@ -51,14 +116,26 @@ class ConnectionManager:
         self, party_id: str, event: str, data: dict, exclude: WebSocket = None
     ):
         """Broadcast a message to all connections subscribed to a party."""
-        if party_id not in self.party_connections:
+        # Numbered and buffered while a client may still resume: the party
+        # has connections, or lost its last one less than the TTL ago
+        self._prune_history()
+        if party_id not in self.party_connections and party_id not in self.idle_parties:
             return
 
+        seq = self.party_seq.get(party_id, 0) + 1
+        self.party_seq[party_id] = seq
         message = {
             "event": event,
             "data": data,
+            "seq": seq,
             "timestamp": datetime.now(timezone.utc).isoformat(),
         }
+        self.party_history.setdefault(
+            party_id, deque(maxlen=REPLAY_BUFFER_SIZE)
+        ).append(message)
+
+        if party_id not in self.party_connections:
+            return
 
         # Remove dead connections
         dead_connections = set()
@@ -86,12 +163,21 @@ manager = ConnectionManager()
 
 
 @router.websocket("/party/{party_id}")
-async def party_websocket(websocket: WebSocket, party_id: str, token: str = Query(...)):
+async def party_websocket(
+    websocket: WebSocket,
+    party_id: str,
+    token: str = Query(...),
+    last_seq: Optional[int] = Query(None),
+):
     """
     WebSocket endpoint for real-time party updates.
 
     Query parameters:
         token: JWT access token for authentication
+        last_seq: Sequence number of the last event received on a previous
+            connection; newer events are replayed before live ones. The
+            "connected" message reports "seq" (latest broadcast) and
+            "missed": true if events were lost and state must be refetched.
 
     Events sent to client:
         - member_joined: When a player joins the party
@@ -134,17 +220,32 @@ async def party_websocket(websocket: WebSocket, party_id: str, token: str = Quer
             return
 
     try:
-        await manager.connect(websocket, party_id, player_id)
+        await websocket.accept()
+
+        manager.open_replay(party_id)
+        seq = manager.current_seq(party_id)
+        missed = last_seq is not None and not manager.resumable(party_id, last_seq)
 
         # Send initial connection success message
         await websocket.send_json(
             {
                 "event": "connected",
-                "data": {"party_id": party_id, "player_id": player_id},
+                "data": {
+                    "party_id": party_id,
+                    "player_id": player_id,
+                    "seq": seq,
+                    "missed": missed,
+                },
                 "timestamp": datetime.now(timezone.utc).isoformat(),
             }
         )
 
+        # Replay what was missed (or broadcast since "connected" was built),
+        # then go live with no await in between
+        resume_from = last_seq if last_seq is not None and not missed else seq
+        await manager.resume(websocket, party_id, resume_from)
+        manager.register(websocket, party_id, player_id)
+
         # Keep connection alive and handle incoming messages
         while True:
             try:
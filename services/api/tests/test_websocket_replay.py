@@ -0,0 +1,173 @@
+"""
+Tests for party WebSocket replay buffers (resume, gaps and idle pruning).
+"""
+
+import types
+
+import pytest
+from fastapi.websockets import WebSocketState
+
+import routes.websocket as ws_routes
+from routes.websocket import ConnectionManager, REPLAY_BUFFER_SIZE
+
+
+class FakeWebSocket:
+    """Records what the manager sends instead of writing to a socket."""
+
+    def __init__(self):
+        self.client_state = WebSocketState.CONNECTED
+        self.sent = []
+
+    async def send_json(self, message):
+        self.sent.append(message)
+
+
+class FakeClock:
+    """Stands in for the time module so idle ages can be stepped."""
+
+    def __init__(self):
+        self.now = 1000.0
+
+    def monotonic(self):
+        return self.now
+
+
+@pytest.fixture
+def clock(monkeypatch):
+    fake = FakeClock()
+    monkeypatch.setattr(ws_routes, "time", types.SimpleNamespace(monotonic=fake.monotonic))
+    return fake
+
+
+async def broadcast(manager, party_id, count):
+    for i in range(count):
+        await manager.broadcast_to_party(party_id, "party_updated", {"n": i})
+
+
+@pytest.mark.asyncio
+class TestReplayResume:
+    """Test resuming a party stream from a sequence number."""
+
+    async def test_resume_sends_broadcasts_after_last_seq(self, clock):
+        manager = ConnectionManager()
+        live = FakeWebSocket()
+        manager.register(live, "party-1", "player-1")
+        await broadcast(manager, "party-1", 5)
+
+        assert manager.current_seq("party-1") == 5
+        assert [m["seq"] for m in live.sent] == [1, 2, 3, 4, 5]
+
+        # A second member drops after seq 2 and reconnects
+        manager.open_replay("party-1")
+        assert manager.resumable("party-1", 2)
+
+        rejoined = FakeWebSocket()
+        await manager.resume(rejoined, "party-1", 2)
+        manager.register(rejoined, "party-1", "player-2")
+        assert [m["seq"] for m in rejoined.sent] == [3, 4, 5]
+
+        await broadcast(manager, "party-1", 1)
+        assert rejoined.sent[-1]["seq"] == 6
+
+    async def test_resume_after_last_connection_left(self, clock):
+        manager = ConnectionManager()
+        first = FakeWebSocket()
+        manager.register(first, "party-1", "player-1")
+        await broadcast(manager, "party-1", 2)
+        manager.disconnect(first, "party-1")
+
+        # Still buffered while idle within the TTL
+        await broadcast(manager, "party-1", 2)
+        clock.now += ws_routes.REPLAY_TTL_SECONDS - 1
+
+        manager.open_replay("party-1")
+        assert manager.resumable("party-1", 2)
+        rejoined = FakeWebSocket()
+        await manager.resume(rejoined, "party-1", 2)
+        assert [m["seq"] for m in rejoined.sent] == [3, 4]
+
+    async def test_sequence_ahead_of_server_is_not_resumable(self, clock):
+        manager = ConnectionManager()
+        manager.register(FakeWebSocket(), "party-1", "player-1")
+        await broadcast(manager, "party-1", 3)
+
+        assert not manager.resumable("party-1", 7)
+
+    async def test_broadcasts_to_unwatched_party_are_not_buffered(self, clock):
+        manager = ConnectionManager()
+        await broadcast(manager, "party-1", 3)
+
+        assert manager.current_seq("party-1") == 0
+        assert "party-1" not in manager.party_history
+
+
+@pytest.mark.asyncio
+class TestReplayGap:
+    """Test resuming once the replay buffer has rotated past the client."""
+
+    async def test_gap_beyond_buffer_is_reported(self, clock):
+        manager = ConnectionManager()
+        manager.register(FakeWebSocket(), "party-1", "player-1")
+        await broadcast(manager, "party-1", REPLAY_BUFFER_SIZE + 10)
+
+        history = manager.party_history["party-1"]
+        assert len(history) == REPLAY_BUFFER_SIZE
+        assert history[0]["seq"] == 11
+
+        # Seq 11 onwards is buffered, so a client at 10 can resume; one at 9 missed seq 10
+        assert manager.resumable("party-1", 10)
+        assert not manager.resumable("party-1", 9)
+        assert not manager.resumable("party-1", 0)
+
+
+class TestReplayPruning:
+    """Test the idle-ordered index that bounds replay state."""
+
+    @pytest.mark.asyncio
+    async def test_idle_party_is_pruned_after_ttl(self, clock):
+        manager = ConnectionManager()
+        connection = FakeWebSocket()
+        manager.register(connection, "party-1", "player-1")
+        await broadcast(manager, "party-1", 3)
+        manager.disconnect(connection, "party-1")
+        assert list(manager.idle_parties) == ["party-1"]
+
+        clock.now += ws_routes.REPLAY_TTL_SECONDS + 1
+        await broadcast(manager, "party-1", 1)
+
+        assert "party-1" not in manager.idle_parties
+        assert "party-1" not in manager.party_history
+        assert manager.current_seq("party-1") == 0
+
+    def test_only_expired_parties_are_pruned_in_idle_order(self, clock):
+        manager = ConnectionManager()
+        manager.open_replay("party-1")
+        clock.now += 100
+        manager.open_replay("party-2")
+        clock.now += 100
+        manager.open_replay("party-3")
+
+        clock.now += ws_routes.REPLAY_TTL_SECONDS - 150
+        manager._prune_history()
+
+        assert list(manager.idle_parties) == ["party-2", "party-3"]
+
+    def test_reconnect_removes_party_from_idle_index(self, clock):
+        manager = ConnectionManager()
+        manager.open_replay("party-1")
+        manager.register(FakeWebSocket(), "party-1", "player-1")
+
+        clock.now += ws_routes.REPLAY_TTL_SECONDS + 1
+        manager._prune_history()
+
+        assert "party-1" not in manager.idle_parties
+        assert "party-1" in manager.party_connections
+
+    def test_idle_party_cap_drops_oldest(self, clock, monkeypatch):
+        monkeypatch.setattr(ws_routes, "REPLAY_MAX_IDLE_PARTIES", 2)
+        manager = ConnectionManager()
+        for party_id in ("party-1", "party-2", "party-3"):
+            manager.open_replay(party_id)
+            clock.now += 1
+
+        assert list(manager.idle_parties) == ["party-2", "party-3"]
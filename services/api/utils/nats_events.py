@@ -3,6 +3,7 @@ NATS event publishing for matchmaking queue.
 """
 
 import logging
+import secrets
 from typing import Optional
 from datetime import datetime, timezone
 
@@ -26,6 +27,11 @@ def get_nats():
     return _nats
 
 
+def new_traceparent() -> str:
+    """Start a sampled W3C trace context for a queue entry."""
+    return f"00-{secrets.token_hex(16)}-{secrets.token_hex(8)}-01"
+
+
 # ============================================================================
 # Queue Event Publishers
 # ============================================================================
@@ -38,6 +44,7 @@ async def publish_queue_enter(
     avg_mmr: int,
     region: str,
     party_size: int,
+    traceparent: Optional[str] = None,
 ):
     """
     Publish party enter queue event to matchmaker.
@@ -49,6 +56,8 @@ async def publish_queue_enter(
         avg_mmr: Average MMR of party
         region: Party region
         party_size: Number of players in party
+        traceparent: W3C trace context to continue in the matchmaker; a new
+            sampled trace is started when omitted
     """
     try:
         nats = get_nats()
@@ -61,6 +70,7 @@ async def publish_queue_enter(
             "region": region,
             "party_size": party_size,
             "timestamp": datetime.now(timezone.utc).isoformat(),
+            "traceparent": traceparent or new_traceparent(),
         }
 
         # Publish to matchmaker queue subject
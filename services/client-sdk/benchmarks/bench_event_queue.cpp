@@ -0,0 +1,182 @@
+#include "matchmaker/event_queue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace matchmaker;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Previous design: one mutex around the queue, callbacks dispatched under it
+class LockedQueue {
+public:
+    void push(Event event) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push(std::move(event));
+        }
+        cv_.notify_one();
+    }
+
+    std::optional<Event> wait_for(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, timeout, [this] { return !queue_.empty(); })) {
+            return std::nullopt;
+        }
+        Event event = std::move(queue_.front());
+        queue_.pop();
+        if (callback_) {
+            callback_(event);
+        }
+        return event;
+    }
+
+    void on(EventCallback callback) { callback_ = std::move(callback); }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::queue<Event> queue_;
+    EventCallback callback_;
+};
+
+struct Run {
+    double events_per_sec = 0;
+    double push_p99_us = 0;
+    double push_max_us = 0;
+};
+
+// One producer pushes events; consume() delivers them on this thread
+template <typename Push, typename Consume>
+Run measure(int events, Push&& push, Consume&& consume) {
+    std::vector<double> push_us;
+    push_us.reserve(events);
+    auto start = Clock::now();
+    std::thread producer([&] {
+        for (int i = 0; i < events; ++i) {
+            Event event{EventType::PARTY_UPDATED, nullptr, std::chrono::system_clock::now()};
+            auto begin = Clock::now();
+            push(std::move(event));
+            push_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+        }
+    });
+    consume(events);
+    producer.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(push_us.begin(), push_us.end());
+    Run run;
+    run.events_per_sec = events / elapsed;
+    run.push_p99_us = push_us[push_us.size() * 99 / 100];
+    run.push_max_us = push_us.back();
+    return run;
+}
+
+void report(const char* name, const Run& run) {
+    std::printf("%-36s %11.0f events/s  push p99=%7.2fus  max=%9.1fus\n",
+        name, run.events_per_sec, run.push_p99_us, run.push_max_us);
+}
+
+void spin_for(std::chrono::microseconds duration) {
+    auto until = Clock::now() + duration;
+    while (Clock::now() < until) {
+    }
+}
+
+} // namespace
+
+int main() {
+    constexpr int kEvents = 200000;
+    constexpr int kSlowEvents = 5000;
+
+    for (auto callback_cost : {std::chrono::microseconds(0), std::chrono::microseconds(20)}) {
+        int events = callback_cost.count() == 0 ? kEvents : kSlowEvents;
+        std::printf("callback cost %lldus\n", static_cast<long long>(callback_cost.count()));
+
+        LockedQueue locked;
+        locked.on([callback_cost](const Event&) { spin_for(callback_cost); });
+        report("  mutex queue, one event per wait", measure(events,
+            [&locked](Event event) { locked.push(std::move(event)); },
+            [&locked](int count) {
+                for (int i = 0; i < count; ++i) {
+                    locked.wait_for(std::chrono::milliseconds(1000));
+                }
+            }));
+
+        // BLOCK keeps the comparison lossless when the producer runs ahead
+        EventQueueConfig config;
+        config.overflow = OverflowPolicy::BLOCK;
+        EventQueue ring(config);
+        int delivered = 0;
+        ring.on(EventType::PARTY_UPDATED, [&delivered, callback_cost](const Event&) {
+            spin_for(callback_cost);
+            delivered++;
+        });
+        report("  SPSC ring, drain(256)", measure(events,
+            [&ring](Event event) { ring.push(std::move(event)); },
+            [&ring, &delivered](int count) {
+                while (delivered < count) {
+                    if (ring.wait_for(std::chrono::milliseconds(1000))) {
+                        ring.drain(256);
+                    }
+                }
+            }));
+    }
+
+    // Game minimized: a burst of party-state events arrives while nobody
+    // polls, then the backlog is processed in one go
+    constexpr int kBacklog = 200000;
+    constexpr int kParties = 8;
+    auto backlog_event = [](int i) {
+        bool ready = i % 2 == 0;
+        std::string party_id = "party-" + std::to_string(i % kParties);
+        if (i % 3 == 0) {
+            return Event{EventType::PARTY_UPDATED,
+                {{"party_id", party_id}, {"party", {{"version", i}}}},
+                std::chrono::system_clock::now()};
+        }
+        return Event{EventType::MEMBER_READY,
+            {{"party_id", party_id}, {"player_id", "player-" + std::to_string(i % 5)}, {"ready", ready}},
+            std::chrono::system_clock::now()};
+    };
+
+    std::printf("backlog of %d party-state events while not polling\n", kBacklog);
+    {
+        std::queue<Event> unbounded;
+        for (int i = 0; i < kBacklog; ++i) {
+            unbounded.push(backlog_event(i));
+        }
+        size_t pending = unbounded.size();
+        auto start = Clock::now();
+        while (!unbounded.empty()) {
+            unbounded.pop();
+        }
+        std::printf("  %-34s pending=%-7zu processed in %8.2fms\n", "unbounded queue", pending,
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    for (auto policy : {OverflowPolicy::DROP_OLDEST, OverflowPolicy::COALESCE}) {
+        EventQueueConfig config;
+        config.overflow = policy;
+        EventQueue queue(config);
+        for (int i = 0; i < kBacklog; ++i) {
+            queue.push(backlog_event(i));
+        }
+        size_t pending = queue.size();
+        auto start = Clock::now();
+        queue.drain();
+        auto stats = queue.stats();
+        std::printf("  %-34s pending=%-7zu processed in %8.2fms  dropped=%llu coalesced=%llu\n",
+            policy == OverflowPolicy::COALESCE ? "bounded, coalesce" : "bounded, drop-oldest", pending,
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count(),
+            static_cast<unsigned long long>(stats.dropped),
+            static_cast<unsigned long long>(stats.coalesced));
+    }
+    return 0;
+}
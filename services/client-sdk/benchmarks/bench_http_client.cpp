@@ -0,0 +1,103 @@
+#include "matchmaker/http_client.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace matchmaker;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Run {
+    double requests_per_sec = 0;
+    double p50_us = 0;
+    double p99_us = 0;
+    size_t failures = 0;
+};
+
+// threads x requests calls of fn; latency percentiles over all calls
+template <typename Fn>
+Run measure(int threads, int requests, Fn&& fn) {
+    std::vector<std::vector<double>> samples(threads);
+    std::vector<size_t> failures(threads, 0);
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            samples[t].reserve(requests);
+            for (int i = 0; i < requests; ++i) {
+                auto begin = Clock::now();
+                if (!fn()) {
+                    failures[t]++;
+                }
+                samples[t].push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> all;
+    for (const auto& s : samples) {
+        all.insert(all.end(), s.begin(), s.end());
+    }
+    std::sort(all.begin(), all.end());
+    Run run;
+    run.requests_per_sec = static_cast<double>(all.size()) / elapsed;
+    run.p50_us = all[all.size() / 2];
+    run.p99_us = all[all.size() * 99 / 100];
+    for (size_t f : failures) {
+        run.failures += f;
+    }
+    return run;
+}
+
+void report(const char* name, int threads, const Run& run) {
+    std::printf("%-34s threads=%-2d %9.0f req/s  p50=%8.1fus  p99=%8.1fus  failures=%zu\n",
+        name, threads, run.requests_per_sec, run.p50_us, run.p99_us, run.failures);
+}
+
+} // namespace
+
+int main() {
+    // Local API stand-in
+    httplib::Server server;
+    server.Get("/v1/ping", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content(R"({"ok":true})", "application/json");
+    });
+    int port = server.bind_to_any_port("127.0.0.1");
+    std::thread server_thread([&server] { server.listen_after_bind(); });
+    server.wait_until_ready();
+    std::string url = "http://127.0.0.1:" + std::to_string(port);
+
+    constexpr int kRequests = 2000;
+    for (int threads : {1, 4}) {
+        // Previous behaviour: a fresh connection per call
+        report("fresh connection per request", threads, measure(threads, kRequests, [&url] {
+            httplib::Client client(url);
+            auto res = client.Get("/v1/ping");
+            return res && res->status == 200;
+        }));
+
+        HTTPPoolConfig pool;
+        pool.max_connections = static_cast<size_t>(threads);
+        HTTPClient http(url, pool);
+        report("pooled keep-alive", threads, measure(threads, kRequests, [&http] {
+            return http.get("/v1/ping").success;
+        }));
+        auto stats = http.pool_stats();
+        std::printf("  connections opened=%llu reused=%llu\n",
+            static_cast<unsigned long long>(stats.connections_opened),
+            static_cast<unsigned long long>(stats.connections_reused));
+    }
+
+    server.stop();
+    server_thread.join();
+    return 0;
+}
@@ -2,6 +2,8 @@
 
 #include "types.hpp"
 #include "http_client.hpp"
+#include "io_pool.hpp"
+#include <future>
 #include <memory>
 
 namespace matchmaker {
@@ -12,7 +14,12 @@ namespace matchmaker {
  */
 class AuthAPI {
 public:
-    explicit AuthAPI(std::shared_ptr<HTTPClient> http_client);
+    /**
+     * @param http_client Shared HTTP client
+     * @param io_pool Pool running the *_async calls (nullptr = a private pool)
+     */
+    explicit AuthAPI(std::shared_ptr<HTTPClient> http_client,
+                     std::shared_ptr<IOPool> io_pool = nullptr);
     ~AuthAPI() = default;
 
     /**
@@ -39,8 +46,22 @@ public:
      */
     Result<AuthTokens> refresh_token(const std::string& refresh_token);
 
+    // ========================================================================
+    // Asynchronous variants
+    // Each runs the blocking call of the same name on the I/O pool and returns
+    // immediately. The optional callback receives the same Result as the future.
+    // ========================================================================
+
+    std::future<Result<AuthTokens>> register_user_async(const RegisterRequest& request,
+                                                        ResultCallback<AuthTokens> on_complete = nullptr);
+    std::future<Result<AuthTokens>> login_async(const LoginRequest& request,
+                                                ResultCallback<AuthTokens> on_complete = nullptr);
+    std::future<Result<AuthTokens>> refresh_token_async(const std::string& token,
+                                                        ResultCallback<AuthTokens> on_complete = nullptr);
+
 private:
     std::shared_ptr<HTTPClient> http_;
+    std::shared_ptr<IOPool> io_;
 };
 
 } // namespace matchmaker
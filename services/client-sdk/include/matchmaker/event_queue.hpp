@@ -1,26 +1,93 @@
 #pragma once
 
 #include "types.hpp"
-#include <queue>
-#include <mutex>
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace matchmaker {
 
+/**
+ * What push() does once the ring is full.
+ */
+enum class OverflowPolicy {
+    DROP_OLDEST,    // Hold up to overflow_capacity more events, discarding the oldest of them
+    BLOCK,          // Wait until the consumer frees a slot
+    COALESCE        // As DROP_OLDEST, but newer party state replaces superseded events first
+};
+
+struct EventQueueConfig {
+    size_t capacity = 1024;                 // Ring slots (rounded up to a power of two)
+    size_t overflow_capacity = 1024;        // Events held behind a full ring
+    OverflowPolicy overflow = OverflowPolicy::COALESCE;
+};
+
+/**
+ * Overflow counters (cumulative).
+ */
+struct EventQueueStats {
+    uint64_t dropped = 0;                   // Discarded to stay within overflow_capacity
+    uint64_t coalesced = 0;                 // Replaced by a newer snapshot of the same state
+    uint64_t producer_waits = 0;            // push() calls that blocked (BLOCK policy)
+};
+
 /**
  * Thread-safe event queue for delivering WebSocket events to the main thread.
  * Supports both polling and callback-based event handling.
+ *
+ * Events travel through a ring buffer with one consumer and mutex-serialized
+ * producers; it is not lock-free on the producer side.
+ *
+ * Consumer: poll/wait/wait_for/drain/clear must all be called from one
+ * thread (the game loop), and never concurrently. Earlier versions locked
+ * every call and allowed any thread to consume; code that polls from several
+ * threads must now funnel those calls through one of them. The consumer
+ * takes no lock in steady state.
+ *
+ * Producers: push() may be called from any thread, and every push() takes
+ * producer_mutex_. The WebSocket run-loop is the usual producer, but
+ * stopping the socket from the game or reconnect thread can deliver
+ * Close/Error callbacks there, so producers take turns on that mutex. It is
+ * uncontended with one producer; a producer only locks beyond its own turn
+ * to wake a consumer blocked in wait()/wait_for().
+ *
+ * Callbacks run on the consumer thread with no lock held, so they may call
+ * on(), size() or post() freely. The callback registry is copy-on-write:
+ * on() publishes a new table and the consumer picks it up before its next
+ * event, while the table it is iterating stays alive.
+ *
+ * The queue is bounded. Once the ring fills (e.g. the game is minimized and
+ * not polling), further events wait in a mutex-guarded overflow list of at
+ * most overflow_capacity events, behind the ones already in the ring. Under
+ * COALESCE, a PARTY_UPDATED replaces the older PARTY_UPDATED for the same
+ * party_id, and a MEMBER_READY the older one for the same player, so a
+ * backlog collapses to the latest state. Pushing into the overflow list
+ * replaces the superseded entry there at once; superseded events already in
+ * the ring are skipped when drained, so size() counts them until then.
+ * Order is otherwise preserved; a replacing event takes the position of the
+ * newest.
  */
 class EventQueue {
 public:
-    EventQueue() = default;
+    explicit EventQueue(const EventQueueConfig& config = EventQueueConfig{});
     ~EventQueue() = default;
 
-    // Add event to queue (called from WebSocket thread)
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    // Add event to queue (any thread; takes the producer mutex)
     void push(Event event);
 
-    // Poll for events (non-blocking)
+    // Poll for events (non-blocking; consumer thread only, as below)
     std::optional<Event> poll();
 
     // Wait for next event (blocking)
@@ -29,6 +96,10 @@ public:
     // Wait for next event with timeout (blocking)
     std::optional<Event> wait_for(std::chrono::milliseconds timeout);
 
+    // Pop up to budget pending events and dispatch their callbacks.
+    // Returns the number of events delivered.
+    size_t drain(size_t budget = std::numeric_limits<size_t>::max());
+
     // Register callback for specific event type
     void on(EventType type, EventCallback callback);
 
@@ -38,13 +109,83 @@ public:
     // Get number of pending events
     size_t size() const;
 
+    EventQueueStats stats() const;
+
+    // Run task on the thread that next drains the queue (poll/wait/wait_for/drain),
+    // outside any lock. Used to deliver async API completions.
+    void post(std::function<void()> task);
+
 private:
-    mutable std::mutex mutex_;
+    using CallbackMap = std::unordered_map<EventType, std::vector<EventCallback>>;
+
+    // Producer and consumer cursors on separate cache lines
+    struct alignas(64) Cursor {
+        std::atomic<size_t> value{0};
+    };
+
+    EventQueueConfig config_;
+    std::unique_ptr<Event[]> ring_;
+    size_t mask_;
+    Cursor head_;                           // Next slot to read (consumer)
+    Cursor tail_;                           // Next slot to write (producer)
+    size_t cached_head_ = 0;                // Producer's last view of head_
+    std::mutex producer_mutex_;             // Held by push(): guards tail_ and cached_head_
+
+    // Slow path once the ring is full; the consumer moves the whole
+    // overflow list into spilled_ with one lock
+    std::mutex overflow_mutex_;
+    std::list<Event> overflow_;
+    std::unordered_map<std::string, std::list<Event>::iterator> overflow_keys_;
+    std::atomic<size_t> overflow_size_{0};
+    std::list<Event> spilled_;              // Consumer-owned, older than the ring
+    std::atomic<size_t> spilled_size_{0};
+
+    // Consumer-owned: latest ring position of each coalesce key, for
+    // slots up to indexed_
+    std::unordered_map<std::string, size_t> ring_keys_;
+    size_t indexed_ = 0;
+
+    // Producer blocked on a full ring (BLOCK policy)
+    std::mutex space_mutex_;
+    std::condition_variable space_cv_;
+    std::atomic<bool> producer_waiting_{false};
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> producer_waits_{0};
+
+    // Blocking consumer
+    std::mutex wait_mutex_;
     std::condition_variable cv_;
-    std::queue<Event> queue_;
-    std::unordered_map<EventType, std::vector<EventCallback>> callbacks_;
+    std::atomic<bool> waiting_{false};
+
+    // Callback registry (copy-on-write)
+    std::mutex callbacks_mutex_;
+    std::shared_ptr<const CallbackMap> callbacks_;
+    std::atomic<uint64_t> callbacks_version_{0};
+    std::shared_ptr<const CallbackMap> reader_callbacks_;   // Consumer's snapshot
+    uint64_t reader_version_ = 0;
+
+    // Tasks queued by post()
+    std::mutex posted_mutex_;
+    std::vector<std::function<void()>> posted_;
+    std::atomic<size_t> posted_size_{0};
+
+    bool ring_has_space();
+    void wait_for_space();
+    void push_overflow(Event event);
+    void erase_overflow_key(const std::string& key);
+    static std::string coalesce_key(const Event& event);
+
+    std::optional<Event> take();
+    std::optional<Event> take_next(std::optional<size_t>& position);
+    bool superseded(const Event& event, std::optional<size_t> position);
+    bool ready() const;
+    void wake();
+    void block_until(std::optional<std::chrono::steady_clock::time_point> deadline);
 
     void dispatch_callbacks(const Event& event);
+    void run_posted();
 };
 
 } // namespace matchmaker
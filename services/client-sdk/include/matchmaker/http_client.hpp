@@ -2,19 +2,63 @@
 
 #include "types.hpp"
 #include <httplib.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 namespace matchmaker {
 
+/**
+ * Keep-alive connection pool settings (one pool per HTTPClient, i.e. per host).
+ */
+struct HTTPPoolConfig {
+    size_t max_connections = 8;             // Open connections; callers beyond this wait
+    int idle_timeout_seconds = 60;          // Close connections unused for this long
+    int acquire_timeout_ms = 5000;          // Wait for a free connection before failing
+    std::string health_check_path;          // GET before reusing a long-idle connection (empty = off)
+    int health_check_after_seconds = 30;    // Idle time that triggers the health check
+};
+
+/**
+ * Connection pool counters (cumulative except open/idle).
+ */
+struct HTTPPoolStats {
+    uint64_t requests = 0;
+    uint64_t connections_opened = 0;
+    uint64_t connections_reused = 0;
+    uint64_t idle_evictions = 0;
+    uint64_t failed_health_checks = 0;
+    uint64_t retries = 0;                   // Requests resent after a stale connection failed
+    uint64_t acquire_timeouts = 0;
+    size_t open = 0;
+    size_t idle = 0;
+};
+
 /**
  * HTTP client wrapper for REST API calls.
  * Thread-safe for concurrent requests.
+ *
+ * Requests run on a pool of keep-alive connections to base_url, so a
+ * sequence of calls pays the TCP (and TLS) handshake once. Each in-flight
+ * request holds one connection; idle connections are closed after
+ * idle_timeout_seconds. A request that fails on a reused connection
+ * (e.g. closed by the server while idle) is retried once on a fresh one
+ * if it is idempotent or never reached the server.
  */
 class HTTPClient {
 public:
-    explicit HTTPClient(const std::string& base_url);
+    explicit HTTPClient(const std::string& base_url, const HTTPPoolConfig& pool = HTTPPoolConfig{});
     ~HTTPClient() = default;
 
+    HTTPClient(const HTTPClient&) = delete;
+    HTTPClient& operator=(const HTTPClient&) = delete;
+
     // Authentication
     void set_auth_token(const std::string& token);
     void clear_auth_token();
@@ -30,13 +74,40 @@ public:
     // Timeout configuration
     void set_timeout(int seconds);
 
+    // Connection pool
+    HTTPPoolStats pool_stats() const;
+    void close_idle_connections();
+
 private:
+    using Request = std::function<httplib::Result(httplib::Client&, const httplib::Headers&)>;
+
+    struct IdleConnection {
+        std::unique_ptr<httplib::Client> client;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
     std::string base_url_;
+    HTTPPoolConfig pool_config_;
+    std::atomic<int> timeout_seconds_{30};
+
+    mutable std::mutex auth_mutex_;
     std::string auth_token_;
-    int timeout_seconds_ = 30;
+
+    mutable std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;
+    std::vector<IdleConnection> idle_;      // Oldest first; reuse takes the newest
+    size_t open_ = 0;
+    HTTPPoolStats stats_;
 
     httplib::Headers get_headers() const;
     Result<json> handle_response(const httplib::Result& res);
+    Result<json> send(const Request& request, bool idempotent);
+
+    std::unique_ptr<httplib::Client> acquire(bool& reused);
+    void release(std::unique_ptr<httplib::Client> client, bool healthy);
+    std::unique_ptr<httplib::Client> open_connection() const;
+    bool health_check(httplib::Client& client);
+    void evict_idle_locked(std::chrono::steady_clock::time_point now);
 };
 
 } // namespace matchmaker
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "types.hpp"
+#include "event_queue.hpp"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace matchmaker {
+
+/**
+ * Small worker pool that runs blocking API calls off the caller's thread.
+ *
+ * Workers are started on demand, up to max_threads, so an idle pool costs
+ * nothing. Each submitted call resolves a future and, optionally, invokes a
+ * completion callback. When the pool was given an EventQueue, callbacks are
+ * posted to it and run on whichever thread drains that queue (e.g. the game
+ * loop calling process_events()); otherwise they run on the worker thread.
+ *
+ * Destroying the pool finishes every queued call before joining the workers.
+ */
+class IOPool {
+public:
+    explicit IOPool(size_t max_threads = 4, EventQueue* completions = nullptr);
+    ~IOPool();
+
+    IOPool(const IOPool&) = delete;
+    IOPool& operator=(const IOPool&) = delete;
+
+    /**
+     * Run call on a worker thread.
+     *
+     * @param call Blocking call producing a Result
+     * @param on_complete Optional callback receiving the same Result
+     * @return Future resolved with the Result; an exception thrown by call
+     *         becomes a Failure with status_code 0
+     */
+    template<typename T>
+    std::future<Result<T>> submit(std::function<Result<T>()> call,
+                                  ResultCallback<T> on_complete = nullptr) {
+        auto promise = std::make_shared<std::promise<Result<T>>>();
+        auto future = promise->get_future();
+
+        post([this, call = std::move(call), on_complete = std::move(on_complete), promise]() mutable {
+            auto result = invoke(call);
+            if (on_complete) {
+                deliver([on_complete = std::move(on_complete), result] { on_complete(result); });
+            }
+            promise->set_value(std::move(result));
+        });
+
+        return future;
+    }
+
+    /**
+     * Finish queued calls and stop the workers. Later submissions run inline.
+     */
+    void shutdown();
+
+    size_t max_threads() const { return max_threads_; }
+    size_t pending() const;
+
+private:
+    const size_t max_threads_;
+    EventQueue* completions_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    size_t idle_ = 0;
+    bool stopping_ = false;
+
+    void post(std::function<void()> task);
+    void deliver(std::function<void()> callback);
+    void worker();
+
+    template<typename T>
+    static Result<T> invoke(const std::function<Result<T>()>& call) {
+        try {
+            return call();
+        } catch (const std::exception& e) {
+            return Result<T>::Failure({0, "Request failed", e.what()});
+        } catch (...) {
+            return Result<T>::Failure({0, "Request failed", "Unknown exception"});
+        }
+    }
+};
+
+} // namespace matchmaker
@@ -4,11 +4,13 @@
 #include "http_client.hpp"
 #include "websocket_client.hpp"
 #include "event_queue.hpp"
+#include "io_pool.hpp"
 #include "auth_api.hpp"
 #include "profile_api.hpp"
 #include "party_api.hpp"
 #include "session_api.hpp"
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace matchmaker {
@@ -28,6 +30,14 @@ namespace matchmaker {
  *           // Handle match found
  *       });
  *   }
+ *
+ * Every API call also has an *_async variant that returns a std::future
+ * immediately and accepts an optional completion callback. Callbacks are
+ * delivered through the event queue, so they run on the thread calling
+ * process_events() / poll_event() / wait_event():
+ *   client.party().get_party_async(party_id, [](const Result<PartyInfo>& r) {
+ *       // Runs inside process_events() on the game thread
+ *   });
  */
 class MatchmakerClient {
 public:
@@ -37,10 +47,14 @@ public:
      * @param api_base_url Base URL of the API server (e.g., "http://localhost:8080")
      * @param ws_base_url Base URL for WebSocket connections (e.g., "ws://localhost:8080")
      *                    If empty, derives from api_base_url by replacing http with ws
+     * @param io_threads Maximum worker threads running *_async calls
+     * @param events Event queue bounds and overflow policy
      */
     explicit MatchmakerClient(
         const std::string& api_base_url,
-        const std::string& ws_base_url = ""
+        const std::string& ws_base_url = "",
+        size_t io_threads = 4,
+        const EventQueueConfig& events = EventQueueConfig{}
     );
 
     ~MatchmakerClient();
@@ -91,9 +105,12 @@ public:
 
     /**
      * Connect to party WebSocket for real-time updates.
+     * Uses the token from set_auth_token(). Dropped connections are
+     * re-established automatically and missed events replayed; see
+     * WebSocketClient for the DISCONNECTED/CONNECTED event fields.
      *
      * @param party_id Party ID to connect to
-     * @return True on success, false on failure
+     * @return True on success, false on failure or if no token is set
      */
     bool connect_websocket(const std::string& party_id);
 
@@ -107,6 +124,11 @@ public:
      */
     bool is_websocket_connected() const;
 
+    /**
+     * Reconnect counters and the last event sequence number seen.
+     */
+    WebSocketStats websocket_stats() const;
+
     // ========================================================================
     // Event Handling
     // ========================================================================
@@ -156,9 +178,13 @@ private:
     std::string api_base_url_;
     std::string ws_base_url_;
 
+    mutable std::mutex auth_mutex_;
+    std::string auth_token_;               // Reused by connect_websocket()
+
     // Core components
     std::shared_ptr<HTTPClient> http_client_;
     EventQueue event_queue_;
+    std::shared_ptr<IOPool> io_pool_;       // Completions are posted to event_queue_
     std::unique_ptr<WebSocketClient> ws_client_;
 
     // API wrappers
@@ -2,6 +2,8 @@
 
 #include "types.hpp"
 #include "http_client.hpp"
+#include "io_pool.hpp"
+#include <future>
 #include <memory>
 
 namespace matchmaker {
@@ -12,7 +14,12 @@ namespace matchmaker {
  */
 class PartyAPI {
 public:
-    explicit PartyAPI(std::shared_ptr<HTTPClient> http_client);
+    /**
+     * @param http_client Shared HTTP client
+     * @param io_pool Pool running the *_async calls (nullptr = a private pool)
+     */
+    explicit PartyAPI(std::shared_ptr<HTTPClient> http_client,
+                      std::shared_ptr<IOPool> io_pool = nullptr);
     ~PartyAPI() = default;
 
     /**
@@ -71,8 +78,32 @@ public:
      */
     Result<PartyInfo> leave_queue(const std::string& party_id);
 
+    // ========================================================================
+    // Asynchronous variants
+    // Each runs the blocking call of the same name on the I/O pool and returns
+    // immediately. The optional callback receives the same Result as the future.
+    // ========================================================================
+
+    std::future<Result<PartyInfo>> create_party_async(int max_size = 5,
+                                                      ResultCallback<PartyInfo> on_complete = nullptr);
+    std::future<Result<PartyInfo>> join_party_async(const std::string& party_id,
+                                                    ResultCallback<PartyInfo> on_complete = nullptr);
+    std::future<Result<void>> leave_party_async(const std::string& party_id,
+                                                ResultCallback<void> on_complete = nullptr);
+    std::future<Result<PartyInfo>> set_ready_async(const std::string& party_id,
+                                                   bool ready,
+                                                   ResultCallback<PartyInfo> on_complete = nullptr);
+    std::future<Result<PartyInfo>> get_party_async(const std::string& party_id,
+                                                   ResultCallback<PartyInfo> on_complete = nullptr);
+    std::future<Result<PartyInfo>> enter_queue_async(const std::string& party_id,
+                                                     const QueueRequest& request,
+                                                     ResultCallback<PartyInfo> on_complete = nullptr);
+    std::future<Result<PartyInfo>> leave_queue_async(const std::string& party_id,
+                                                     ResultCallback<PartyInfo> on_complete = nullptr);
+
 private:
     std::shared_ptr<HTTPClient> http_;
+    std::shared_ptr<IOPool> io_;
 };
 
 } // namespace matchmaker
@@ -2,6 +2,8 @@
 
 #include "types.hpp"
 #include "http_client.hpp"
+#include "io_pool.hpp"
+#include <future>
 #include <memory>
 
 namespace matchmaker {
@@ -12,7 +14,12 @@ namespace matchmaker {
  */
 class ProfileAPI {
 public:
-    explicit ProfileAPI(std::shared_ptr<HTTPClient> http_client);
+    /**
+     * @param http_client Shared HTTP client
+     * @param io_pool Pool running the *_async calls (nullptr = a private pool)
+     */
+    explicit ProfileAPI(std::shared_ptr<HTTPClient> http_client,
+                        std::shared_ptr<IOPool> io_pool = nullptr);
     ~ProfileAPI() = default;
 
     /**
@@ -30,8 +37,19 @@ public:
      */
     Result<ProfileInfo> update_profile(const ProfileUpdateRequest& request);
 
+    // ========================================================================
+    // Asynchronous variants
+    // Each runs the blocking call of the same name on the I/O pool and returns
+    // immediately. The optional callback receives the same Result as the future.
+    // ========================================================================
+
+    std::future<Result<ProfileInfo>> get_profile_async(ResultCallback<ProfileInfo> on_complete = nullptr);
+    std::future<Result<ProfileInfo>> update_profile_async(const ProfileUpdateRequest& request,
+                                                          ResultCallback<ProfileInfo> on_complete = nullptr);
+
 private:
     std::shared_ptr<HTTPClient> http_;
+    std::shared_ptr<IOPool> io_;
 };
 
 } // namespace matchmaker
@@ -2,6 +2,8 @@
 
 #include "types.hpp"
 #include "http_client.hpp"
+#include "io_pool.hpp"
+#include <future>
 #include <memory>
 
 namespace matchmaker {
@@ -12,7 +14,12 @@ namespace matchmaker {
  */
 class SessionAPI {
 public:
-    explicit SessionAPI(std::shared_ptr<HTTPClient> http_client);
+    /**
+     * @param http_client Shared HTTP client
+     * @param io_pool Pool running the *_async calls (nullptr = a private pool)
+     */
+    explicit SessionAPI(std::shared_ptr<HTTPClient> http_client,
+                        std::shared_ptr<IOPool> io_pool = nullptr);
     ~SessionAPI() = default;
 
     /**
@@ -39,8 +46,22 @@ public:
      */
     Result<void> submit_result(const MatchResult& result);
 
+    // ========================================================================
+    // Asynchronous variants
+    // Each runs the blocking call of the same name on the I/O pool and returns
+    // immediately. The optional callback receives the same Result as the future.
+    // ========================================================================
+
+    std::future<Result<SessionInfo>> get_session_async(const std::string& match_id,
+                                                       ResultCallback<SessionInfo> on_complete = nullptr);
+    std::future<Result<void>> send_heartbeat_async(const std::string& match_id,
+                                                   ResultCallback<void> on_complete = nullptr);
+    std::future<Result<void>> submit_result_async(const MatchResult& result,
+                                                  ResultCallback<void> on_complete = nullptr);
+
 private:
     std::shared_ptr<HTTPClient> http_;
+    std::shared_ptr<IOPool> io_;
 };
 
 } // namespace matchmaker
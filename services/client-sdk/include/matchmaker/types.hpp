@@ -4,6 +4,7 @@
 #include <vector>
 #include <functional>
 #include <chrono>
+#include <optional>
 #include <nlohmann/json.hpp>
 
 namespace matchmaker {
@@ -211,4 +212,8 @@ struct Result<void> {
     explicit operator bool() const { return success; }
 };
 
+// Completion callback for asynchronous API calls
+template<typename T>
+using ResultCallback = std::function<void(const Result<T>&)>;
+
 } // namespace matchmaker
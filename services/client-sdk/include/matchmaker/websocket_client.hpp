@@ -5,20 +5,66 @@
 #include <ixwebsocket/IXWebSocket.h>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <random>
+#include <thread>
 
 namespace matchmaker {
 
+/**
+ * Automatic reconnect settings.
+ */
+struct ReconnectConfig {
+    bool enabled = true;
+    int initial_delay_ms = 250;             // Backoff before the first retry
+    int max_delay_ms = 30000;               // Backoff ceiling
+    double multiplier = 2.0;                // Backoff growth per failed attempt
+    double jitter = 0.5;                    // Each delay is drawn from [d * (1 - jitter), d]
+    int max_attempts = 0;                   // Consecutive failures before giving up (0 = never)
+    int connect_timeout_ms = 5000;          // How long connect() waits for the socket to open
+};
+
+/**
+ * Connection counters (cumulative except last_*).
+ */
+struct WebSocketStats {
+    uint64_t reconnects = 0;                // Outages recovered from
+    uint64_t failed_attempts = 0;           // Reconnect attempts that did not open
+    int64_t last_reconnect_ms = -1;         // Outage duration of the latest reconnect
+    uint64_t last_seq = 0;                  // Latest server event sequence number seen
+    uint64_t duplicates_skipped = 0;        // Replayed events already delivered
+};
+
 /**
  * WebSocket client for real-time party updates.
  * Thread-safe event delivery via EventQueue.
+ *
+ * After an unexpected close or error the client reconnects on its own,
+ * waiting a jittered exponential backoff between attempts. Party broadcasts
+ * carry a sequence number; a reconnect passes the last one seen so the
+ * server replays what was missed, and replays already delivered are
+ * skipped. The outage is reported by a DISCONNECTED event with
+ * "will_reconnect": true, then a CONNECTED event with "reconnected": true,
+ * "attempts" and "reconnect_ms". If the server could not replay everything,
+ * its "connected" event carries "missed": true and party state should be
+ * refetched. Closes with an application code (4000-4999, e.g. invalid token)
+ * are not retried.
  */
 class WebSocketClient {
 public:
-    WebSocketClient(const std::string& base_url, EventQueue& event_queue);
+    WebSocketClient(const std::string& base_url, EventQueue& event_queue,
+                    const ReconnectConfig& reconnect = ReconnectConfig{});
     ~WebSocketClient();
 
-    // Connection management
+    WebSocketClient(const WebSocketClient&) = delete;
+    WebSocketClient& operator=(const WebSocketClient&) = delete;
+
+    // Connection management. connect() waits up to connect_timeout_ms for
+    // the socket to open; on timeout it returns false and, if reconnect is
+    // enabled, keeps retrying in the background until disconnect().
     bool connect(const std::string& party_id, const std::string& auth_token);
     void disconnect();
     bool is_connected() const;
@@ -26,15 +72,44 @@ public:
     // Send ping to keep connection alive
     void send_ping();
 
+    WebSocketStats stats() const;
+
+    // Delay before reconnect attempt n (1-based); random01 in [0, 1)
+    static std::chrono::milliseconds backoff_delay(const ReconnectConfig& config,
+                                                   int attempt, double random01);
+
 private:
     std::string base_url_;
     EventQueue& event_queue_;
+    ReconnectConfig reconnect_;
     std::unique_ptr<ix::WebSocket> ws_;
     std::atomic<bool> connected_{false};
-    mutable std::mutex mutex_;
+    mutable std::mutex mutex_;              // Serializes operations on ws_
+
+    // Connection state shared with the socket and reconnect threads
+    mutable std::mutex state_mutex_;
+    std::condition_variable state_cv_;
+    std::string party_id_;
+    std::string auth_token_;
+    bool want_connected_ = false;           // Between connect() and disconnect()
+    bool stopping_ = false;                 // Destructor: reconnect thread exits
+    bool reconnecting_ = false;             // In an outage
+    bool attempt_in_flight_ = false;        // A (re)connect attempt awaits Open or failure
+    bool reconnect_pending_ = false;        // Reconnect thread should schedule the next attempt
+    int attempts_ = 0;                      // Failures in the current outage
+    std::chrono::steady_clock::time_point outage_start_;
+    bool have_seq_ = false;
+    WebSocketStats stats_;
+
+    std::thread reconnect_thread_;
+    std::mt19937 rng_{std::random_device{}()};
 
     void setup_callbacks();
     void handle_message(const std::string& message);
+    void handle_open();
+    void handle_failure(Event event, bool permanent);
+    void reconnect_loop();
+    std::string build_url() const;
     EventType parse_event_type(const std::string& event);
 };
 
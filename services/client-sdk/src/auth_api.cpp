@@ -2,8 +2,9 @@
 
 namespace matchmaker {
 
-AuthAPI::AuthAPI(std::shared_ptr<HTTPClient> http_client)
-    : http_(std::move(http_client)) {
+AuthAPI::AuthAPI(std::shared_ptr<HTTPClient> http_client, std::shared_ptr<IOPool> io_pool)
+    : http_(std::move(http_client)),
+      io_(io_pool ? std::move(io_pool) : std::make_shared<IOPool>()) {
 }
 
 Result<AuthTokens> AuthAPI::register_user(const RegisterRequest& request) {
@@ -67,4 +68,25 @@ Result<AuthTokens> AuthAPI::refresh_token(const std::string& refresh_token) {
     return Result<AuthTokens>::Success(tokens);
 }
 
+std::future<Result<AuthTokens>> AuthAPI::register_user_async(const RegisterRequest& request,
+                                                             ResultCallback<AuthTokens> on_complete) {
+    return io_->submit<AuthTokens>(
+        [this, request] { return register_user(request); },
+        std::move(on_complete));
+}
+
+std::future<Result<AuthTokens>> AuthAPI::login_async(const LoginRequest& request,
+                                                     ResultCallback<AuthTokens> on_complete) {
+    return io_->submit<AuthTokens>(
+        [this, request] { return login(request); },
+        std::move(on_complete));
+}
+
+std::future<Result<AuthTokens>> AuthAPI::refresh_token_async(const std::string& token,
+                                                             ResultCallback<AuthTokens> on_complete) {
+    return io_->submit<AuthTokens>(
+        [this, token] { return refresh_token(token); },
+        std::move(on_complete));
+}
+
 } // namespace matchmaker
@@ -1,85 +1,391 @@
 #include "matchmaker/event_queue.hpp"
+#include <algorithm>
+#include <thread>
 
 namespace matchmaker {
 
-void EventQueue::push(Event event) {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        queue_.push(std::move(event));
+static size_t round_up_pow2(size_t value) {
+    size_t pow2 = 1;
+    while (pow2 < value) {
+        pow2 <<= 1;
     }
-    cv_.notify_one();
+    return pow2;
 }
 
-std::optional<Event> EventQueue::poll() {
-    std::lock_guard<std::mutex> lock(mutex_);
+EventQueue::EventQueue(const EventQueueConfig& config)
+    : config_(config),
+      ring_(std::make_unique<Event[]>(round_up_pow2(std::max<size_t>(config.capacity, 2)))),
+      mask_(round_up_pow2(std::max<size_t>(config.capacity, 2)) - 1),
+      callbacks_(std::make_shared<const CallbackMap>()),
+      reader_callbacks_(callbacks_) {
+}
 
-    if (queue_.empty()) {
-        return std::nullopt;
+void EventQueue::push(Event event) {
+    // One producer at a time owns the tail; a blocked BLOCK-policy producer
+    // holds the turn, so later producers queue behind it in order
+    std::lock_guard<std::mutex> producer(producer_mutex_);
+
+    // Once events have spilled, keep spilling until the consumer empties the
+    // overflow list so that ring and overflow never interleave
+    if (overflow_size_.load(std::memory_order_acquire) == 0) {
+        if (config_.overflow == OverflowPolicy::BLOCK && !ring_has_space()) {
+            wait_for_space();
+        }
+        if (ring_has_space()) {
+            size_t tail = tail_.value.load(std::memory_order_relaxed);
+            ring_[tail & mask_] = std::move(event);
+            tail_.value.store(tail + 1, std::memory_order_release);
+            wake();
+            return;
+        }
     }
 
-    Event event = std::move(queue_.front());
-    queue_.pop();
+    push_overflow(std::move(event));
+    wake();
+}
 
-    // Dispatch to callbacks
-    dispatch_callbacks(event);
+std::optional<Event> EventQueue::poll() {
+    run_posted();
 
+    auto event = take();
+    if (event) {
+        dispatch_callbacks(*event);
+    }
     return event;
 }
 
 Event EventQueue::wait() {
-    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        run_posted();
+        if (auto event = take()) {
+            dispatch_callbacks(*event);
+            return std::move(*event);
+        }
+        block_until(std::nullopt);
+    }
+}
 
-    cv_.wait(lock, [this] { return !queue_.empty(); });
+std::optional<Event> EventQueue::wait_for(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
 
-    Event event = std::move(queue_.front());
-    queue_.pop();
+    while (true) {
+        run_posted();
+        if (auto event = take()) {
+            dispatch_callbacks(*event);
+            return event;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return std::nullopt;  // Timeout
+        }
+        block_until(deadline);
+    }
+}
 
-    // Dispatch to callbacks
-    dispatch_callbacks(event);
+size_t EventQueue::drain(size_t budget) {
+    run_posted();
 
-    return event;
+    size_t delivered = 0;
+    while (delivered < budget) {
+        auto event = take();
+        if (!event) {
+            break;
+        }
+        dispatch_callbacks(*event);
+        ++delivered;
+    }
+    return delivered;
 }
 
-std::optional<Event> EventQueue::wait_for(std::chrono::milliseconds timeout) {
-    std::unique_lock<std::mutex> lock(mutex_);
+void EventQueue::on(EventType type, EventCallback callback) {
+    std::lock_guard<std::mutex> lock(callbacks_mutex_);
+    auto updated = std::make_shared<CallbackMap>(*callbacks_);
+    (*updated)[type].push_back(std::move(callback));
+    callbacks_ = std::move(updated);
+    callbacks_version_.fetch_add(1, std::memory_order_release);
+}
+
+void EventQueue::clear() {
+    while (take()) {
+    }
+}
+
+size_t EventQueue::size() const {
+    size_t head = head_.value.load(std::memory_order_acquire);
+    size_t tail = tail_.value.load(std::memory_order_acquire);
+    return (tail - head) + overflow_size_.load(std::memory_order_acquire)
+        + spilled_size_.load(std::memory_order_acquire);
+}
+
+void EventQueue::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        posted_.push_back(std::move(task));
+        posted_size_.fetch_add(1, std::memory_order_release);
+    }
+    wake();
+}
+
+EventQueueStats EventQueue::stats() const {
+    EventQueueStats stats;
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+    stats.producer_waits = producer_waits_.load(std::memory_order_relaxed);
+    return stats;
+}
 
-    if (!cv_.wait_for(lock, timeout, [this] { return !queue_.empty(); })) {
-        return std::nullopt;  // Timeout
+bool EventQueue::ring_has_space() {
+    size_t tail = tail_.value.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_) {
+        cached_head_ = head_.value.load(std::memory_order_acquire);
     }
+    return tail - cached_head_ <= mask_;
+}
 
-    Event event = std::move(queue_.front());
-    queue_.pop();
+void EventQueue::wait_for_space() {
+    producer_waits_.fetch_add(1, std::memory_order_relaxed);
 
-    // Dispatch to callbacks
-    dispatch_callbacks(event);
+    for (int spin = 0; spin < 64; ++spin) {
+        if (ring_has_space()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
 
+    // Same handshake as block_until, with the roles swapped
+    std::unique_lock<std::mutex> lock(space_mutex_);
+    producer_waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    space_cv_.wait(lock, [this] { return ring_has_space(); });
+    producer_waiting_.store(false, std::memory_order_relaxed);
+}
+
+void EventQueue::push_overflow(Event event) {
+    std::lock_guard<std::mutex> lock(overflow_mutex_);
+
+    std::string key = config_.overflow == OverflowPolicy::COALESCE ? coalesce_key(event) : std::string();
+    if (!key.empty()) {
+        auto it = overflow_keys_.find(key);
+        if (it != overflow_keys_.end()) {
+            overflow_.erase(it->second);
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    overflow_.push_back(std::move(event));
+    if (!key.empty()) {
+        overflow_keys_[key] = std::prev(overflow_.end());
+    }
+
+    while (overflow_.size() > config_.overflow_capacity) {
+        erase_overflow_key(coalesce_key(overflow_.front()));
+        overflow_.pop_front();
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    overflow_size_.store(overflow_.size(), std::memory_order_release);
+}
+
+void EventQueue::erase_overflow_key(const std::string& key) {
+    // Only if the index still points at the front entry
+    auto it = overflow_keys_.find(key);
+    if (it != overflow_keys_.end() && it->second == overflow_.begin()) {
+        overflow_keys_.erase(it);
+    }
+}
+
+std::string EventQueue::coalesce_key(const Event& event) {
+    if ((event.type != EventType::PARTY_UPDATED && event.type != EventType::MEMBER_READY)
+        || !event.data.is_object()) {
+        return {};
+    }
+
+    auto field = [&event](const char* name) -> std::string {
+        auto it = event.data.find(name);
+        return it != event.data.end() && it->is_string() ? it->get<std::string>() : std::string();
+    };
+
+    std::string party_id = field("party_id");
+    if (party_id.empty()) {
+        return {};
+    }
+
+    switch (event.type) {
+        case EventType::PARTY_UPDATED:
+            return "party:" + party_id;
+        case EventType::MEMBER_READY: {
+            std::string player_id = field("player_id");
+            return player_id.empty() ? std::string() : "ready:" + party_id + ":" + player_id;
+        }
+        default:
+            return {};
+    }
+}
+
+std::optional<Event> EventQueue::take() {
+    std::optional<size_t> position;
+    while (auto event = take_next(position)) {
+        if (!superseded(*event, position)) {
+            return event;
+        }
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return std::nullopt;
+}
+
+std::optional<Event> EventQueue::take_next(std::optional<size_t>& position) {
+    position.reset();
+
+    // Spilled events were taken while the ring was empty, so anything in
+    // the ring now was pushed after them
+    if (!spilled_.empty()) {
+        Event event = std::move(spilled_.front());
+        spilled_.pop_front();
+        spilled_size_.fetch_sub(1, std::memory_order_release);
+        return event;
+    }
+
+    size_t head = head_.value.load(std::memory_order_relaxed);
+    if (head == tail_.value.load(std::memory_order_acquire)) {
+        if (overflow_size_.load(std::memory_order_acquire) == 0) {
+            return std::nullopt;
+        }
+        // The producer filled the ring before spilling: re-check it so
+        // earlier ring events are delivered before the overflow
+        if (head == tail_.value.load(std::memory_order_acquire)) {
+            {
+                std::lock_guard<std::mutex> lock(overflow_mutex_);
+                spilled_.swap(overflow_);
+                overflow_keys_.clear();
+                spilled_size_.store(spilled_.size(), std::memory_order_relaxed);
+                overflow_size_.store(0, std::memory_order_release);
+            }
+            return take_next(position);
+        }
+    }
+
+    Event event = std::move(ring_[head & mask_]);
+    head_.value.store(head + 1, std::memory_order_release);
+    position = head;
+
+    if (config_.overflow == OverflowPolicy::BLOCK) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producer_waiting_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(space_mutex_);
+            space_cv_.notify_one();
+        }
+    }
     return event;
 }
 
-void EventQueue::on(EventType type, EventCallback callback) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    callbacks_[type].push_back(std::move(callback));
+bool EventQueue::superseded(const Event& event, std::optional<size_t> position) {
+    if (config_.overflow != OverflowPolicy::COALESCE) {
+        return false;
+    }
+    std::string key = coalesce_key(event);
+    if (key.empty()) {
+        return false;
+    }
+
+    // Index the keys of ring slots published since the last look. Slots in
+    // [head, tail) belong to the consumer until head passes them, so reading
+    // ahead is safe
+    size_t tail = tail_.value.load(std::memory_order_acquire);
+    size_t slot = std::max(indexed_, head_.value.load(std::memory_order_relaxed));
+    for (; slot != tail; ++slot) {
+        std::string slot_key = coalesce_key(ring_[slot & mask_]);
+        if (!slot_key.empty()) {
+            ring_keys_[std::move(slot_key)] = slot;
+        }
+    }
+    indexed_ = tail;
+
+    // The ring is newer than spilled events and older than the overflow list
+    auto it = ring_keys_.find(key);
+    if (it != ring_keys_.end()) {
+        if (it->second != position) {
+            return true;
+        }
+        ring_keys_.erase(it);
+    }
+    if (overflow_size_.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        return overflow_keys_.count(key) > 0;
+    }
+    return false;
 }
 
-void EventQueue::clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    while (!queue_.empty()) {
-        queue_.pop();
+bool EventQueue::ready() const {
+    return head_.value.load(std::memory_order_relaxed) != tail_.value.load(std::memory_order_acquire)
+        || overflow_size_.load(std::memory_order_acquire) > 0
+        || spilled_size_.load(std::memory_order_relaxed) > 0
+        || posted_size_.load(std::memory_order_acquire) > 0;
+}
+
+void EventQueue::wake() {
+    // Pairs with the fence in block_until: either the consumer sees the new
+    // item before sleeping, or we see it waiting and notify
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        cv_.notify_one();
     }
 }
 
-size_t EventQueue::size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+void EventQueue::block_until(std::optional<std::chrono::steady_clock::time_point> deadline) {
+    // A burst usually continues within microseconds; yield briefly before
+    // paying for a sleep and a producer-side notify
+    for (int spin = 0; spin < 64; ++spin) {
+        if (ready()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (deadline) {
+        cv_.wait_until(lock, *deadline, [this] { return ready(); });
+    } else {
+        cv_.wait(lock, [this] { return ready(); });
+    }
+
+    waiting_.store(false, std::memory_order_relaxed);
 }
 
 void EventQueue::dispatch_callbacks(const Event& event) {
-    auto it = callbacks_.find(event.type);
-    if (it != callbacks_.end()) {
+    // Pick up registrations made since the last event; the snapshot keeps
+    // the table alive even if a callback registers another one
+    uint64_t version = callbacks_version_.load(std::memory_order_acquire);
+    if (version != reader_version_) {
+        std::lock_guard<std::mutex> lock(callbacks_mutex_);
+        reader_callbacks_ = callbacks_;
+        reader_version_ = callbacks_version_.load(std::memory_order_relaxed);
+    }
+    auto snapshot = reader_callbacks_;
+
+    auto it = snapshot->find(event.type);
+    if (it != snapshot->end()) {
         for (const auto& callback : it->second) {
             callback(event);
         }
     }
 }
 
+void EventQueue::run_posted() {
+    while (posted_size_.load(std::memory_order_acquire) > 0) {
+        std::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(posted_mutex_);
+            tasks.swap(posted_);
+            posted_size_.store(0, std::memory_order_relaxed);
+        }
+
+        for (auto& task : tasks) {
+            task();
+        }
+    }
+}
+
 } // namespace matchmaker
@@ -1,17 +1,21 @@
 #include "matchmaker/http_client.hpp"
+#include <algorithm>
 #include <sstream>
 
 namespace matchmaker {
 
-HTTPClient::HTTPClient(const std::string& base_url)
-    : base_url_(base_url) {
+HTTPClient::HTTPClient(const std::string& base_url, const HTTPPoolConfig& pool)
+    : base_url_(base_url), pool_config_(pool) {
+    pool_config_.max_connections = std::max<size_t>(pool_config_.max_connections, 1);
 }
 
 void HTTPClient::set_auth_token(const std::string& token) {
+    std::lock_guard<std::mutex> lock(auth_mutex_);
     auth_token_ = token;
 }
 
 void HTTPClient::clear_auth_token() {
+    std::lock_guard<std::mutex> lock(auth_mutex_);
     auth_token_.clear();
 }
 
@@ -25,6 +29,7 @@ httplib::Headers HTTPClient::get_headers() const {
         {"Accept", "application/json"}
     };
 
+    std::lock_guard<std::mutex> lock(auth_mutex_);
     if (!auth_token_.empty()) {
         headers.emplace("Authorization", "Bearer " + auth_token_);
     }
@@ -75,9 +80,6 @@ Result<json> HTTPClient::handle_response(const httplib::Result& res) {
 }
 
 Result<json> HTTPClient::get(const std::string& path, const httplib::Params& params) {
-    httplib::Client client(base_url_);
-    client.set_read_timeout(timeout_seconds_, 0);
-
     std::string query_string;
     if (!params.empty()) {
         std::ostringstream oss;
@@ -90,66 +92,179 @@ Result<json> HTTPClient::get(const std::string& path, const httplib::Params& par
         query_string = "?" + oss.str();
     }
 
-    auto res = client.Get((path + query_string).c_str(), get_headers());
-    return handle_response(res);
+    std::string target = path + query_string;
+    return send([&target](httplib::Client& client, const httplib::Headers& headers) {
+        return client.Get(target.c_str(), headers);
+    }, true);
 }
 
 Result<json> HTTPClient::post(const std::string& path, const json& body) {
-    httplib::Client client(base_url_);
-    client.set_read_timeout(timeout_seconds_, 0);
+    std::string payload = body.dump();
+    return send([&](httplib::Client& client, const httplib::Headers& headers) {
+        return client.Post(path.c_str(), headers, payload, "application/json");
+    }, false);
+}
 
-    auto res = client.Post(
-        path.c_str(),
-        get_headers(),
-        body.dump(),
-        "application/json"
-    );
+Result<json> HTTPClient::patch(const std::string& path, const json& body) {
+    std::string payload = body.dump();
+    return send([&](httplib::Client& client, const httplib::Headers& headers) {
+        return client.Patch(path.c_str(), headers, payload, "application/json");
+    }, false);
+}
 
-    return handle_response(res);
+Result<json> HTTPClient::del(const std::string& path) {
+    return send([&path](httplib::Client& client, const httplib::Headers& headers) {
+        return client.Delete(path.c_str(), headers);
+    }, true);
 }
 
-Result<json> HTTPClient::patch(const std::string& path, const json& body) {
-    httplib::Client client(base_url_);
-    client.set_read_timeout(timeout_seconds_, 0);
+Result<json> HTTPClient::post(const std::string &path) {
+    return send([&path](httplib::Client& client, const httplib::Headers& headers) {
+        return client.Post(path.c_str(), headers, "", "application/json");
+    }, false);
+}
 
-    auto res = client.Patch(
-        path.c_str(),
-        get_headers(),
-        body.dump(),
-        "application/json"
-    );
+Result<json> HTTPClient::put(const std::string &path, const json &body) {
+    std::string payload = body.dump();
+    return send([&](httplib::Client& client, const httplib::Headers& headers) {
+        return client.Put(path.c_str(), headers, payload, "application/json");
+    }, true);
+}
 
-    return handle_response(res);
+Result<json> HTTPClient::send(const Request& request, bool idempotent) {
+    httplib::Headers headers = get_headers();
+
+    for (int attempt = 0;; ++attempt) {
+        bool reused = false;
+        auto client = acquire(reused);
+        if (!client) {
+            return Result<json>::Failure({
+                0,
+                "Connection pool exhausted",
+                "No connection became free within the acquire timeout"
+            });
+        }
+        client->set_read_timeout(timeout_seconds_.load(), 0);
+
+        auto res = request(*client, headers);
+        bool delivered = static_cast<bool>(res);
+        release(std::move(client), delivered);
+
+        // A kept-alive connection the server closed while it sat idle fails
+        // on first use; the rest of the idle pool is likely just as stale
+        bool not_sent = !delivered && (res.error() == httplib::Error::Connection
+                                       || res.error() == httplib::Error::Write);
+        if (!delivered && reused && attempt == 0 && (idempotent || not_sent)) {
+            close_idle_connections();
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            stats_.retries++;
+            continue;
+        }
+        return handle_response(res);
+    }
 }
 
-Result<json> HTTPClient::del(const std::string& path) {
-    httplib::Client client(base_url_);
-    client.set_read_timeout(timeout_seconds_, 0);
+std::unique_ptr<httplib::Client> HTTPClient::open_connection() const {
+    auto client = std::make_unique<httplib::Client>(base_url_);
+    client->set_keep_alive(true);
+    return client;
+}
 
-    auto res = client.Delete(path.c_str(), get_headers());
-    return handle_response(res);
+bool HTTPClient::health_check(httplib::Client& client) {
+    auto res = client.Get(pool_config_.health_check_path.c_str());
+    return res && res->status >= 200 && res->status < 300;
 }
 
-Result<json> HTTPClient::post(const std::string &path) {
-    httplib::Client client(base_url_);
-    client.set_read_timeout(timeout_seconds_, 0);
+std::unique_ptr<httplib::Client> HTTPClient::acquire(bool& reused) {
+    auto deadline = std::chrono::steady_clock::now()
+        + std::chrono::milliseconds(pool_config_.acquire_timeout_ms);
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    stats_.requests++;
+
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+        evict_idle_locked(now);
+
+        if (!idle_.empty()) {
+            IdleConnection connection = std::move(idle_.back());
+            idle_.pop_back();
+            bool check = !pool_config_.health_check_path.empty()
+                && now - connection.last_used >= std::chrono::seconds(pool_config_.health_check_after_seconds);
+            if (check) {
+                lock.unlock();
+                bool healthy = health_check(*connection.client);
+                lock.lock();
+                if (!healthy) {
+                    stats_.failed_health_checks++;
+                    open_--;
+                    lock.unlock();
+                    connection.client.reset();
+                    lock.lock();
+                    continue;
+                }
+            }
+            stats_.connections_reused++;
+            reused = true;
+            return std::move(connection.client);
+        }
+
+        if (open_ < pool_config_.max_connections) {
+            open_++;
+            stats_.connections_opened++;
+            lock.unlock();
+            return open_connection();
+        }
 
-    auto res = client.Post(path.c_str(), get_headers(), "", "application/json");
-    return handle_response(res);
+        if (pool_cv_.wait_until(lock, deadline) == std::cv_status::timeout
+            && idle_.empty() && open_ >= pool_config_.max_connections) {
+            stats_.acquire_timeouts++;
+            return nullptr;
+        }
+    }
 }
 
-Result<json> HTTPClient::put(const std::string &path, const json &body) {
-    httplib::Client client(base_url_);
-    client.set_read_timeout(timeout_seconds_, 0);
+void HTTPClient::release(std::unique_ptr<httplib::Client> client, bool healthy) {
+    std::unique_ptr<httplib::Client> closed;    // Destroyed after the lock is released
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (healthy) {
+            idle_.push_back({std::move(client), std::chrono::steady_clock::now()});
+        } else {
+            closed = std::move(client);
+            open_--;
+        }
+    }
+    pool_cv_.notify_one();
+}
 
-    auto res = client.Put(
-        path.c_str(),
-        get_headers(),
-        body.dump(),
-        "application/json"
-    );
+void HTTPClient::evict_idle_locked(std::chrono::steady_clock::time_point now) {
+    auto limit = std::chrono::seconds(pool_config_.idle_timeout_seconds);
+    auto stale = std::find_if(idle_.begin(), idle_.end(),
+        [&](const IdleConnection& c) { return now - c.last_used < limit; });
+    size_t evicted = static_cast<size_t>(stale - idle_.begin());
+    if (evicted > 0) {
+        idle_.erase(idle_.begin(), stale);
+        open_ -= evicted;
+        stats_.idle_evictions += evicted;
+    }
+}
+
+void HTTPClient::close_idle_connections() {
+    std::vector<IdleConnection> closed;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        closed.swap(idle_);
+        open_ -= closed.size();
+    }
+    pool_cv_.notify_all();
+}
 
-    return handle_response(res);
+HTTPPoolStats HTTPClient::pool_stats() const {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    HTTPPoolStats stats = stats_;
+    stats.open = open_;
+    stats.idle = idle_.size();
+    return stats;
 }
 
 } // namespace matchmaker
@@ -0,0 +1,81 @@
+#include "matchmaker/io_pool.hpp"
+#include <algorithm>
+
+namespace matchmaker {
+
+IOPool::IOPool(size_t max_threads, EventQueue* completions)
+    : max_threads_(std::max<size_t>(max_threads, 1)),
+      completions_(completions) {
+}
+
+IOPool::~IOPool() {
+    shutdown();
+}
+
+void IOPool::shutdown() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        workers.swap(workers_);
+    }
+    cv_.notify_all();
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+size_t IOPool::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+void IOPool::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {
+            tasks_.push_back(std::move(task));
+            // Grow only when every running worker is busy
+            if (idle_ == 0 && workers_.size() < max_threads_) {
+                workers_.emplace_back([this] { worker(); });
+            }
+            cv_.notify_one();
+            return;
+        }
+    }
+
+    // Pool is shutting down: resolve the future rather than dropping it
+    task();
+}
+
+void IOPool::deliver(std::function<void()> callback) {
+    if (completions_) {
+        completions_->post(std::move(callback));
+    } else {
+        callback();
+    }
+}
+
+void IOPool::worker() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        ++idle_;
+        cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        --idle_;
+
+        if (tasks_.empty()) {
+            return;  // Stopping with nothing left to run
+        }
+
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+} // namespace matchmaker
@@ -5,41 +5,62 @@ namespace matchmaker {
 
 MatchmakerClient::MatchmakerClient(
     const std::string& api_base_url,
-    const std::string& ws_base_url
+    const std::string& ws_base_url,
+    size_t io_threads,
+    const EventQueueConfig& events
 )
     : api_base_url_(api_base_url),
-      ws_base_url_(ws_base_url.empty() ? derive_ws_url(api_base_url) : ws_base_url)
+      ws_base_url_(ws_base_url.empty() ? derive_ws_url(api_base_url) : ws_base_url),
+      event_queue_(events)
 {
     // Create HTTP client
     http_client_ = std::make_shared<HTTPClient>(api_base_url_);
 
+    // Worker pool for *_async calls, one keep-alive connection per in-flight request
+    io_pool_ = std::make_shared<IOPool>(io_threads, &event_queue_);
+
     // Create WebSocket client
     ws_client_ = std::make_unique<WebSocketClient>(ws_base_url_, event_queue_);
 
     // Create API wrappers
-    auth_api_ = std::make_unique<AuthAPI>(http_client_);
-    profile_api_ = std::make_unique<ProfileAPI>(http_client_);
-    party_api_ = std::make_unique<PartyAPI>(http_client_);
-    session_api_ = std::make_unique<SessionAPI>(http_client_);
+    auth_api_ = std::make_unique<AuthAPI>(http_client_, io_pool_);
+    profile_api_ = std::make_unique<ProfileAPI>(http_client_, io_pool_);
+    party_api_ = std::make_unique<PartyAPI>(http_client_, io_pool_);
+    session_api_ = std::make_unique<SessionAPI>(http_client_, io_pool_);
 }
 
 MatchmakerClient::~MatchmakerClient() {
     disconnect_websocket();
+
+    // Finish in-flight async calls while the API wrappers are still alive
+    io_pool_->shutdown();
 }
 
 void MatchmakerClient::set_auth_token(const std::string& token) {
     http_client_->set_auth_token(token);
+
+    std::lock_guard<std::mutex> lock(auth_mutex_);
+    auth_token_ = token;
 }
 
 void MatchmakerClient::clear_auth_token() {
     http_client_->clear_auth_token();
+
+    std::lock_guard<std::mutex> lock(auth_mutex_);
+    auth_token_.clear();
 }
 
 bool MatchmakerClient::connect_websocket(const std::string& party_id) {
-    // Need to get current auth token from HTTP client
-    // For now, we'll require the user to pass it separately
-    // TODO: Store auth token in MatchmakerClient for reuse
-    return false;  // Placeholder - needs auth token
+    std::string token;
+    {
+        std::lock_guard<std::mutex> lock(auth_mutex_);
+        token = auth_token_;
+    }
+
+    if (token.empty()) {
+        return false;  // set_auth_token() first
+    }
+    return ws_client_->connect(party_id, token);
 }
 
 void MatchmakerClient::disconnect_websocket() {
@@ -52,6 +73,10 @@ bool MatchmakerClient::is_websocket_connected() const {
     return ws_client_ && ws_client_->is_connected();
 }
 
+WebSocketStats MatchmakerClient::websocket_stats() const {
+    return ws_client_->stats();
+}
+
 void MatchmakerClient::on_event(EventType type, EventCallback callback) {
     event_queue_.on(type, std::move(callback));
 }
@@ -65,30 +90,26 @@ Event MatchmakerClient::wait_event() {
 }
 
 void MatchmakerClient::process_events(int duration_ms) {
-    auto start = std::chrono::steady_clock::now();
-
-    while (true) {
-        auto timeout = duration_ms > 0 ?
-            std::chrono::milliseconds(duration_ms) :
-            std::chrono::milliseconds(0);
-
-        auto event_opt = event_queue_.wait_for(timeout);
+    // Everything already queued is delivered as one batch
+    event_queue_.drain();
 
-        if (!event_opt) {
-            break;  // No more events or timeout
-        }
+    if (duration_ms <= 0) {
+        return;
+    }
 
-        // Event callbacks are already dispatched in wait_for
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(duration_ms);
 
-        if (duration_ms > 0) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - start
-            ).count();
+    for (auto now = std::chrono::steady_clock::now(); now < deadline;
+         now = std::chrono::steady_clock::now()) {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
 
-            if (elapsed >= duration_ms) {
-                break;
-            }
+        if (!event_queue_.wait_for(remaining)) {
+            break;  // Timeout
         }
+
+        // Event callbacks are already dispatched in wait_for; deliver
+        // anything that arrived alongside it
+        event_queue_.drain();
     }
 }
 
@@ -2,8 +2,9 @@
 
 namespace matchmaker {
 
-PartyAPI::PartyAPI(std::shared_ptr<HTTPClient> http_client)
-    : http_(std::move(http_client)) {
+PartyAPI::PartyAPI(std::shared_ptr<HTTPClient> http_client, std::shared_ptr<IOPool> io_pool)
+    : http_(std::move(http_client)),
+      io_(io_pool ? std::move(io_pool) : std::make_shared<IOPool>()) {
 }
 
 static PartyInfo parse_party(const json& data) {
@@ -121,4 +122,55 @@ Result<PartyInfo> PartyAPI::leave_queue(const std::string& party_id) {
     return Result<PartyInfo>::Success(parse_party(result.value));
 }
 
+std::future<Result<PartyInfo>> PartyAPI::create_party_async(int max_size,
+                                                            ResultCallback<PartyInfo> on_complete) {
+    return io_->submit<PartyInfo>(
+        [this, max_size] { return create_party(max_size); },
+        std::move(on_complete));
+}
+
+std::future<Result<PartyInfo>> PartyAPI::join_party_async(const std::string& party_id,
+                                                          ResultCallback<PartyInfo> on_complete) {
+    return io_->submit<PartyInfo>(
+        [this, party_id] { return join_party(party_id); },
+        std::move(on_complete));
+}
+
+std::future<Result<void>> PartyAPI::leave_party_async(const std::string& party_id,
+                                                      ResultCallback<void> on_complete) {
+    return io_->submit<void>(
+        [this, party_id] { return leave_party(party_id); },
+        std::move(on_complete));
+}
+
+std::future<Result<PartyInfo>> PartyAPI::set_ready_async(const std::string& party_id,
+                                                         bool ready,
+                                                         ResultCallback<PartyInfo> on_complete) {
+    return io_->submit<PartyInfo>(
+        [this, party_id, ready] { return set_ready(party_id, ready); },
+        std::move(on_complete));
+}
+
+std::future<Result<PartyInfo>> PartyAPI::get_party_async(const std::string& party_id,
+                                                         ResultCallback<PartyInfo> on_complete) {
+    return io_->submit<PartyInfo>(
+        [this, party_id] { return get_party(party_id); },
+        std::move(on_complete));
+}
+
+std::future<Result<PartyInfo>> PartyAPI::enter_queue_async(const std::string& party_id,
+                                                           const QueueRequest& request,
+                                                           ResultCallback<PartyInfo> on_complete) {
+    return io_->submit<PartyInfo>(
+        [this, party_id, request] { return enter_queue(party_id, request); },
+        std::move(on_complete));
+}
+
+std::future<Result<PartyInfo>> PartyAPI::leave_queue_async(const std::string& party_id,
+                                                           ResultCallback<PartyInfo> on_complete) {
+    return io_->submit<PartyInfo>(
+        [this, party_id] { return leave_queue(party_id); },
+        std::move(on_complete));
+}
+
 } // namespace matchmaker
@@ -2,8 +2,9 @@
 
 namespace matchmaker {
 
-ProfileAPI::ProfileAPI(std::shared_ptr<HTTPClient> http_client)
-    : http_(std::move(http_client)) {
+ProfileAPI::ProfileAPI(std::shared_ptr<HTTPClient> http_client, std::shared_ptr<IOPool> io_pool)
+    : http_(std::move(http_client)),
+      io_(io_pool ? std::move(io_pool) : std::make_shared<IOPool>()) {
 }
 
 Result<ProfileInfo> ProfileAPI::get_profile() {
@@ -48,4 +49,15 @@ Result<ProfileInfo> ProfileAPI::update_profile(const ProfileUpdateRequest& reque
     return Result<ProfileInfo>::Success(profile);
 }
 
+std::future<Result<ProfileInfo>> ProfileAPI::get_profile_async(ResultCallback<ProfileInfo> on_complete) {
+    return io_->submit<ProfileInfo>([this] { return get_profile(); }, std::move(on_complete));
+}
+
+std::future<Result<ProfileInfo>> ProfileAPI::update_profile_async(const ProfileUpdateRequest& request,
+                                                                  ResultCallback<ProfileInfo> on_complete) {
+    return io_->submit<ProfileInfo>(
+        [this, request] { return update_profile(request); },
+        std::move(on_complete));
+}
+
 } // namespace matchmaker
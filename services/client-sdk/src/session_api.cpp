@@ -2,8 +2,9 @@
 
 namespace matchmaker {
 
-SessionAPI::SessionAPI(std::shared_ptr<HTTPClient> http_client)
-    : http_(std::move(http_client)) {
+SessionAPI::SessionAPI(std::shared_ptr<HTTPClient> http_client, std::shared_ptr<IOPool> io_pool)
+    : http_(std::move(http_client)),
+      io_(io_pool ? std::move(io_pool) : std::make_shared<IOPool>()) {
 }
 
 Result<SessionInfo> SessionAPI::get_session(const std::string& match_id) {
@@ -62,4 +63,25 @@ Result<void> SessionAPI::submit_result(const MatchResult& result_data) {
     return Result<void>::Success();
 }
 
+std::future<Result<SessionInfo>> SessionAPI::get_session_async(const std::string& match_id,
+                                                               ResultCallback<SessionInfo> on_complete) {
+    return io_->submit<SessionInfo>(
+        [this, match_id] { return get_session(match_id); },
+        std::move(on_complete));
+}
+
+std::future<Result<void>> SessionAPI::send_heartbeat_async(const std::string& match_id,
+                                                           ResultCallback<void> on_complete) {
+    return io_->submit<void>(
+        [this, match_id] { return send_heartbeat(match_id); },
+        std::move(on_complete));
+}
+
+std::future<Result<void>> SessionAPI::submit_result_async(const MatchResult& result,
+                                                          ResultCallback<void> on_complete) {
+    return io_->submit<void>(
+        [this, result] { return submit_result(result); },
+        std::move(on_complete));
+}
+
 } // namespace matchmaker
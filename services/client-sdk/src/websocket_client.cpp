@@ -1,41 +1,90 @@
 #include "matchmaker/websocket_client.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace matchmaker {
 
-WebSocketClient::WebSocketClient(const std::string& base_url, EventQueue& event_queue)
-    : base_url_(base_url), event_queue_(event_queue) {
+WebSocketClient::WebSocketClient(const std::string& base_url, EventQueue& event_queue,
+                                 const ReconnectConfig& reconnect)
+    : base_url_(base_url), event_queue_(event_queue), reconnect_(reconnect) {
     ws_ = std::make_unique<ix::WebSocket>();
+
+    // Reconnects are driven by reconnect_loop so they can resume by sequence number
+    ws_->disableAutomaticReconnection();
+    setup_callbacks();
 }
 
 WebSocketClient::~WebSocketClient() {
+    {
+        std::lock_guard<std::mutex> state(state_mutex_);
+        stopping_ = true;
+    }
+    state_cv_.notify_all();
+
+    if (reconnect_thread_.joinable()) {
+        reconnect_thread_.join();
+    }
     disconnect();
 }
 
 bool WebSocketClient::connect(const std::string& party_id, const std::string& auth_token) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
 
-    if (connected_) {
-        return true;  // Already connected
-    }
+        if (connected_) {
+            return true;  // Already connected
+        }
 
-    // Construct WebSocket URL with auth token as query parameter
-    std::string url = base_url_ + "/v1/ws/party/" + party_id + "?token=" + auth_token;
+        // Stop a previous session (or its pending retry) before starting over
+        ws_->stop();
 
-    ws_->setUrl(url);
-    setup_callbacks();
+        std::string url;
+        {
+            std::lock_guard<std::mutex> state(state_mutex_);
+            if (party_id != party_id_) {
+                // Sequence numbers are per party
+                have_seq_ = false;
+                stats_.last_seq = 0;
+            }
+            party_id_ = party_id;
+            auth_token_ = auth_token;
+            want_connected_ = true;
+            reconnecting_ = false;
+            reconnect_pending_ = false;
+            attempts_ = 0;
+            attempt_in_flight_ = true;
+            url = build_url();
+        }
 
-    ws_->start();
+        if (reconnect_.enabled && !reconnect_thread_.joinable()) {
+            reconnect_thread_ = std::thread([this] { reconnect_loop(); });
+        }
 
-    // Wait briefly for connection
-    for (int i = 0; i < 50 && !connected_; ++i) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ws_->setUrl(url);
+        ws_->start();
     }
 
+    // Wait for the Open callback; with reconnect enabled, retries after a
+    // failed first attempt still count towards the same timeout
+    std::unique_lock<std::mutex> state(state_mutex_);
+    state_cv_.wait_for(state, std::chrono::milliseconds(reconnect_.connect_timeout_ms), [this] {
+        return connected_.load() || !want_connected_ || (!reconnect_.enabled && !attempt_in_flight_);
+    });
+
     return connected_.load();
 }
 
 void WebSocketClient::disconnect() {
+    {
+        std::lock_guard<std::mutex> state(state_mutex_);
+        want_connected_ = false;
+        reconnecting_ = false;
+        reconnect_pending_ = false;
+        attempt_in_flight_ = false;
+    }
+    state_cv_.notify_all();
+
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (ws_) {
@@ -59,61 +108,220 @@ void WebSocketClient::send_ping() {
     }
 }
 
+WebSocketStats WebSocketClient::stats() const {
+    std::lock_guard<std::mutex> state(state_mutex_);
+    return stats_;
+}
+
+std::chrono::milliseconds WebSocketClient::backoff_delay(const ReconnectConfig& config,
+                                                         int attempt, double random01) {
+    double delay = std::max(config.initial_delay_ms, 0);
+    for (int i = 1; i < attempt && delay < config.max_delay_ms; ++i) {
+        delay *= config.multiplier;
+    }
+    delay = std::min(delay, static_cast<double>(config.max_delay_ms));
+
+    // Full-range jitter spreads out clients that lost the connection together
+    double jitter = std::clamp(config.jitter, 0.0, 1.0);
+    delay *= 1.0 - jitter * std::clamp(random01, 0.0, 1.0);
+
+    return std::chrono::milliseconds(std::llround(delay));
+}
+
 void WebSocketClient::setup_callbacks() {
+    // Runs on the ix::WebSocket thread, the only producer for event_queue_
     ws_->setOnMessageCallback([this](const ix::WebSocketMessagePtr& msg) {
         if (msg->type == ix::WebSocketMessageType::Message) {
             handle_message(msg->str);
         }
         else if (msg->type == ix::WebSocketMessageType::Open) {
-            connected_ = true;
-
-            // Emit connected event
-            Event event{
-                EventType::CONNECTED,
-                {{"message", "Connected to WebSocket"}},
-                std::chrono::system_clock::now()
-            };
-            event_queue_.push(event);
+            handle_open();
         }
         else if (msg->type == ix::WebSocketMessageType::Close) {
-            connected_ = false;
+            // Application close codes (e.g. 4001 invalid token) will not heal on retry
+            bool permanent = msg->closeInfo.code >= 4000 && msg->closeInfo.code < 5000;
 
             // Emit disconnected event
-            Event event{
+            handle_failure(Event{
                 EventType::DISCONNECTED,
                 {{"reason", msg->closeInfo.reason}, {"code", msg->closeInfo.code}},
                 std::chrono::system_clock::now()
-            };
-            event_queue_.push(event);
+            }, permanent);
         }
         else if (msg->type == ix::WebSocketMessageType::Error) {
             // Emit error event
-            Event event{
+            handle_failure(Event{
                 EventType::ERROR,
                 {{"error", msg->errorInfo.reason}},
                 std::chrono::system_clock::now()
-            };
-            event_queue_.push(event);
+            }, false);
         }
     });
 }
 
+void WebSocketClient::handle_open() {
+    Event event{
+        EventType::CONNECTED,
+        {{"message", "Connected to WebSocket"}},
+        std::chrono::system_clock::now()
+    };
+
+    {
+        std::lock_guard<std::mutex> state(state_mutex_);
+        connected_ = true;
+        attempt_in_flight_ = false;
+
+        if (reconnecting_) {
+            auto outage = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - outage_start_
+            ).count();
+            event.data["reconnected"] = true;
+            event.data["attempts"] = attempts_ + 1;
+            event.data["reconnect_ms"] = outage;
+            stats_.reconnects++;
+            stats_.last_reconnect_ms = outage;
+            reconnecting_ = false;
+            attempts_ = 0;
+        }
+    }
+    state_cv_.notify_all();
+
+    event_queue_.push(std::move(event));
+}
+
+void WebSocketClient::handle_failure(Event event, bool permanent) {
+    {
+        std::lock_guard<std::mutex> state(state_mutex_);
+
+        // Error and Close can both report one failure; only the first ends the attempt
+        bool attempt_ended = connected_.exchange(false) || attempt_in_flight_;
+        attempt_in_flight_ = false;
+
+        if (permanent) {
+            want_connected_ = false;
+            reconnecting_ = false;
+        }
+        else if (attempt_ended && want_connected_ && reconnect_.enabled && !stopping_) {
+            if (!reconnecting_) {
+                reconnecting_ = true;
+                outage_start_ = std::chrono::steady_clock::now();
+                attempts_ = 0;
+            } else {
+                attempts_++;
+                stats_.failed_attempts++;
+            }
+
+            if (reconnect_.max_attempts > 0 && attempts_ >= reconnect_.max_attempts) {
+                want_connected_ = false;
+                reconnecting_ = false;
+                event.data["gave_up"] = true;
+            } else {
+                reconnect_pending_ = true;
+            }
+        }
+
+        event.data["will_reconnect"] = want_connected_ && reconnect_.enabled && reconnecting_;
+    }
+    state_cv_.notify_all();
+
+    event_queue_.push(std::move(event));
+}
+
+void WebSocketClient::reconnect_loop() {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::unique_lock<std::mutex> state(state_mutex_);
+
+    while (true) {
+        state_cv_.wait(state, [this] { return stopping_ || reconnect_pending_; });
+        if (stopping_) {
+            return;
+        }
+        reconnect_pending_ = false;
+
+        // Backoff is interrupted by disconnect() or destruction
+        auto delay = backoff_delay(reconnect_, attempts_ + 1, unit(rng_));
+        if (state_cv_.wait_for(state, delay, [this] { return stopping_ || !want_connected_; })) {
+            continue;
+        }
+
+        // connect() may have started its own attempt during the backoff
+        if (attempt_in_flight_ || connected_) {
+            continue;
+        }
+
+        state.unlock();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // Join the failed run loop before restarting
+            ws_->stop();
+
+            std::string url;
+            {
+                std::lock_guard<std::mutex> relock(state_mutex_);
+                if (!stopping_ && want_connected_ && !attempt_in_flight_ && !connected_) {
+                    attempt_in_flight_ = true;
+                    url = build_url();
+                }
+            }
+
+            if (!url.empty()) {
+                ws_->setUrl(url);
+                ws_->start();
+            }
+        }
+        state.lock();
+    }
+}
+
+std::string WebSocketClient::build_url() const {
+    // Caller holds state_mutex_
+    std::string url = base_url_ + "/v1/ws/party/" + party_id_ + "?token=" + auth_token_;
+    if (have_seq_) {
+        url += "&last_seq=" + std::to_string(stats_.last_seq);
+    }
+    return url;
+}
+
 void WebSocketClient::handle_message(const std::string& message) {
     try {
         json msg = json::parse(message);
 
         std::string event_name = msg.value("event", "unknown");
         EventType type = parse_event_type(event_name);
+        json data = msg.contains("data") ? msg["data"] : json::object();
+
+        {
+            std::lock_guard<std::mutex> state(state_mutex_);
+
+            if (msg.contains("seq") && msg["seq"].is_number_unsigned()) {
+                // Party broadcast: skip replays of events already delivered
+                uint64_t seq = msg["seq"].get<uint64_t>();
+                if (have_seq_ && seq <= stats_.last_seq) {
+                    stats_.duplicates_skipped++;
+                    return;
+                }
+                stats_.last_seq = seq;
+                have_seq_ = true;
+            }
+            else if (event_name == "connected" && data.is_object() && data.contains("seq")) {
+                // Fresh session, or the server could not replay: resume from its position
+                if (!have_seq_ || data.value("missed", false)) {
+                    stats_.last_seq = data.value("seq", uint64_t{0});
+                    have_seq_ = true;
+                }
+            }
+        }
 
         Event event{
             type,
-            msg.contains("data") ? msg["data"] : json::object(),
+            std::move(data),
             std::chrono::system_clock::now()
         };
 
         event_queue_.push(event);
 
-    } catch (const json::parse_error& e) {
+    } catch (const json::exception& e) {
         // Emit error event for invalid JSON
         Event event{
             EventType::ERROR,
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "matchmaker/party_api.hpp"
+#include <atomic>
+#include <thread>
+
+using namespace matchmaker;
+
+namespace {
+
+// Local API stand-in whose party lookups take delay_ms to answer
+class SlowPartyServer {
+public:
+    explicit SlowPartyServer(int delay_ms) : delay_ms_(delay_ms) {
+        server_.Get(R"(/v1/party/([\w-]+))", [this](const httplib::Request& req, httplib::Response& res) {
+            int now = ++in_flight_;
+            int seen = max_in_flight_.load();
+            while (now > seen && !max_in_flight_.compare_exchange_weak(seen, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms_));
+            --in_flight_;
+            json body = {{"party_id", req.matches[1].str()}, {"max_size", 5}};
+            res.set_content(body.dump(), "application/json");
+        });
+        port_ = server_.bind_to_any_port("127.0.0.1");
+        thread_ = std::thread([this] { server_.listen_after_bind(); });
+        server_.wait_until_ready();
+    }
+
+    ~SlowPartyServer() {
+        server_.stop();
+        thread_.join();
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+    int max_in_flight() const { return max_in_flight_.load(); }
+
+private:
+    httplib::Server server_;
+    std::thread thread_;
+    int port_ = 0;
+    int delay_ms_;
+    std::atomic<int> in_flight_{0};
+    std::atomic<int> max_in_flight_{0};
+};
+
+} // namespace
+
+TEST(AsyncAPITest, CallsReturnImmediatelyAndRunConcurrently) {
+    SlowPartyServer server(100);
+    auto http = std::make_shared<HTTPClient>(server.url());
+    PartyAPI party(http, std::make_shared<IOPool>(4));
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<Result<PartyInfo>>> futures;
+    for (int i = 0; i < 4; ++i) {
+        futures.push_back(party.get_party_async("party-" + std::to_string(i)));
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+
+    for (int i = 0; i < 4; ++i) {
+        auto result = futures[i].get();
+        ASSERT_TRUE(result.success);
+        EXPECT_EQ(result.value.party_id, "party-" + std::to_string(i));
+    }
+
+    // Four 100ms requests overlapped rather than running back to back
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(350));
+    EXPECT_GT(server.max_in_flight(), 1);
+}
+
+TEST(AsyncAPITest, CallbacksRunOnTheThreadDrainingTheEventQueue) {
+    SlowPartyServer server(0);
+    EventQueue events;
+    auto http = std::make_shared<HTTPClient>(server.url());
+    PartyAPI party(http, std::make_shared<IOPool>(2, &events));
+
+    std::thread::id callback_thread;
+    std::string party_id;
+    auto future = party.get_party_async("party-7", [&](const Result<PartyInfo>& result) {
+        callback_thread = std::this_thread::get_id();
+        party_id = result.value.party_id;
+    });
+
+    // The future resolves on the I/O pool; the callback waits for a drain
+    ASSERT_TRUE(future.get().success);
+    EXPECT_TRUE(party_id.empty());
+
+    EXPECT_FALSE(events.wait_for(std::chrono::milliseconds(10)).has_value());
+    EXPECT_EQ(party_id, "party-7");
+    EXPECT_EQ(callback_thread, std::this_thread::get_id());
+}
+
+TEST(AsyncAPITest, ConnectionFailureResolvesWithError) {
+    auto http = std::make_shared<HTTPClient>("http://127.0.0.1:1");
+    PartyAPI party(http);
+
+    bool called = false;
+    auto result = party.leave_party_async("party-1", [&](const Result<void>& r) {
+        called = !r.success;
+    }).get();
+
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.error.status_code, 0);
+    EXPECT_TRUE(called);  // No event queue: callback ran on the worker before the future resolved
+}
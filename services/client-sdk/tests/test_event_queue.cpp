@@ -118,3 +118,254 @@ TEST(EventQueueTest, MultipleCallbacks) {
     EXPECT_EQ(callback1_count, 1);
     EXPECT_EQ(callback2_count, 1);
 }
+
+TEST(EventQueueTest, DrainRespectsBudget) {
+    EventQueue queue;
+
+    int delivered = 0;
+    queue.on(EventType::PARTY_UPDATED, [&](const Event&) { delivered++; });
+
+    for (int i = 0; i < 5; ++i) {
+        queue.push({EventType::PARTY_UPDATED, {}, std::chrono::system_clock::now()});
+    }
+
+    EXPECT_EQ(queue.drain(3), 3u);
+    EXPECT_EQ(delivered, 3);
+    EXPECT_EQ(queue.size(), 2u);
+
+    EXPECT_EQ(queue.drain(), 2u);
+    EXPECT_EQ(delivered, 5);
+}
+
+TEST(EventQueueTest, CallbacksRunWithoutLockHeld) {
+    EventQueue queue;
+
+    int late_calls = 0;
+    size_t seen_size = 0;
+    queue.on(EventType::MEMBER_JOINED, [&](const Event&) {
+        // Both would deadlock if callbacks ran under the queue lock
+        seen_size = queue.size();
+        queue.on(EventType::MEMBER_LEFT, [&](const Event&) { late_calls++; });
+    });
+
+    queue.push({EventType::MEMBER_JOINED, {}, std::chrono::system_clock::now()});
+    queue.push({EventType::MEMBER_LEFT, {}, std::chrono::system_clock::now()});
+
+    EXPECT_EQ(queue.drain(), 2u);
+    EXPECT_EQ(seen_size, 1u);
+    EXPECT_EQ(late_calls, 1);  // Registered mid-batch, applies to the next event
+}
+
+TEST(EventQueueTest, OverflowPreservesOrder) {
+    EventQueueConfig config;
+    config.capacity = 4;
+    EventQueue queue(config);
+
+    std::vector<int> order;
+    queue.on(EventType::PARTY_UPDATED, [&](const Event& e) { order.push_back(e.data["seq"]); });
+
+    int seq = 0;
+    for (; seq < 6; ++seq) {
+        queue.push({EventType::PARTY_UPDATED, {{"seq", seq}}, std::chrono::system_clock::now()});
+    }
+    EXPECT_EQ(queue.size(), 6u);
+
+    queue.drain(2);
+    for (; seq < 10; ++seq) {
+        queue.push({EventType::PARTY_UPDATED, {{"seq", seq}}, std::chrono::system_clock::now()});
+    }
+    queue.drain();
+
+    ASSERT_EQ(order.size(), 10u);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(EventQueueTest, ProducerConsumerThreads) {
+    EventQueueConfig config;
+    config.capacity = 64;
+    config.overflow = OverflowPolicy::BLOCK;   // Lossless even if the producer runs ahead
+    EventQueue queue(config);
+    constexpr int kEvents = 20000;
+
+    int expected = 0;
+    bool in_order = true;
+    queue.on(EventType::PARTY_UPDATED, [&](const Event& e) {
+        in_order = in_order && e.data["seq"] == expected;
+        expected++;
+    });
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < kEvents; ++i) {
+            queue.push({EventType::PARTY_UPDATED, {{"seq", i}}, std::chrono::system_clock::now()});
+        }
+    });
+
+    while (expected < kEvents) {
+        if (queue.wait_for(std::chrono::milliseconds(1000))) {
+            queue.drain(256);
+        } else {
+            break;
+        }
+    }
+    producer.join();
+
+    EXPECT_EQ(expected, kEvents);
+    EXPECT_TRUE(in_order);
+}
+
+TEST(EventQueueTest, ConcurrentProducers) {
+    EventQueueConfig config;
+    config.capacity = 64;
+    config.overflow = OverflowPolicy::BLOCK;
+    EventQueue queue(config);
+    constexpr int kProducers = 3;
+    constexpr int kEvents = 5000;
+
+    // e.g. the run-loop thread plus Close/Error from a thread calling stop()
+    int received = 0;
+    std::vector<int> next(kProducers, 0);
+    bool in_order = true;
+    queue.on(EventType::PARTY_UPDATED, [&](const Event& e) {
+        int producer = e.data["producer"];
+        in_order = in_order && e.data["seq"] == next[producer];
+        next[producer]++;
+        received++;
+    });
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < kEvents; ++i) {
+                queue.push({EventType::PARTY_UPDATED, {{"producer", p}, {"seq", i}},
+                    std::chrono::system_clock::now()});
+            }
+        });
+    }
+
+    while (received < kProducers * kEvents) {
+        if (queue.wait_for(std::chrono::milliseconds(1000))) {
+            queue.drain(256);
+        } else {
+            break;
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_EQ(received, kProducers * kEvents);
+    EXPECT_TRUE(in_order);
+}
+
+TEST(EventQueueTest, DropOldestBoundsOverflow) {
+    EventQueueConfig config;
+    config.capacity = 2;
+    config.overflow_capacity = 3;
+    config.overflow = OverflowPolicy::DROP_OLDEST;
+    EventQueue queue(config);
+
+    for (int seq = 0; seq < 10; ++seq) {
+        queue.push({EventType::MEMBER_JOINED, {{"seq", seq}}, std::chrono::system_clock::now()});
+    }
+
+    // Ring keeps the first two; overflow keeps the newest three
+    EXPECT_EQ(queue.size(), 5u);
+    EXPECT_EQ(queue.stats().dropped, 5u);
+
+    std::vector<int> order;
+    while (auto event = queue.poll()) {
+        order.push_back(event->data["seq"]);
+    }
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 7, 8, 9}));
+}
+
+TEST(EventQueueTest, CoalescesSupersededPartyState) {
+    EventQueueConfig config;
+    config.capacity = 2;
+    config.overflow_capacity = 8;
+    EventQueue queue(config);
+
+    auto push = [&queue](EventType type, json data) {
+        queue.push({type, std::move(data), std::chrono::system_clock::now()});
+    };
+
+    // Fill the ring so the rest overflows
+    push(EventType::CONNECTED, json::object());
+    push(EventType::CONNECTED, json::object());
+
+    for (int version = 0; version < 50; ++version) {
+        push(EventType::PARTY_UPDATED, {{"party_id", "p1"}, {"party", {{"version", version}}}});
+        push(EventType::MEMBER_READY, {{"party_id", "p1"}, {"player_id", "alice"}, {"ready", version % 2 == 0}});
+    }
+    push(EventType::MEMBER_JOINED, {{"party_id", "p1"}, {"player_id", "bob"}});
+    push(EventType::PARTY_UPDATED, {{"party_id", "p2"}, {"party", {{"version", 0}}}});
+
+    EXPECT_EQ(queue.size(), 6u);
+    EXPECT_EQ(queue.stats().coalesced, 98u);
+    EXPECT_EQ(queue.stats().dropped, 0u);
+
+    std::vector<Event> events;
+    while (auto event = queue.poll()) {
+        events.push_back(*event);
+    }
+    ASSERT_EQ(events.size(), 6u);
+    EXPECT_EQ(events[2].type, EventType::PARTY_UPDATED);
+    EXPECT_EQ(events[2].data["party"]["version"], 49);
+    EXPECT_EQ(events[3].type, EventType::MEMBER_READY);
+    EXPECT_EQ(events[3].data["ready"], false);
+    EXPECT_EQ(events[4].type, EventType::MEMBER_JOINED);
+    EXPECT_EQ(events[5].data["party_id"], "p2");
+}
+
+TEST(EventQueueTest, CoalescesSupersededStateAcrossRingAndOverflow) {
+    EventQueueConfig config;
+    config.capacity = 4;
+    config.overflow_capacity = 8;
+    EventQueue queue(config);
+
+    auto push = [&queue](EventType type, json data) {
+        queue.push({type, std::move(data), std::chrono::system_clock::now()});
+    };
+    auto next = [&queue]() {
+        auto event = queue.poll();
+        return event ? *event : Event{EventType::ERROR, json::object(), {}};
+    };
+
+    // Superseded within the ring
+    push(EventType::PARTY_UPDATED, {{"party_id", "p1"}, {"party", {{"version", 0}}}});
+    push(EventType::MEMBER_JOINED, {{"party_id", "p1"}, {"player_id", "bob"}});
+    push(EventType::PARTY_UPDATED, {{"party_id", "p1"}, {"party", {{"version", 1}}}});
+    push(EventType::CONNECTED, json::object());
+
+    // Supersedes the ring's version 1 from the overflow list
+    push(EventType::MEMBER_LEFT, {{"party_id", "p1"}, {"player_id", "bob"}});
+    push(EventType::PARTY_UPDATED, {{"party_id", "p1"}, {"party", {{"version", 2}}}});
+
+    EXPECT_EQ(next().type, EventType::MEMBER_JOINED);
+    EXPECT_EQ(next().type, EventType::CONNECTED);
+    EXPECT_EQ(next().type, EventType::MEMBER_LEFT);
+
+    // Version 2 is now spilled; version 3 goes to the ring behind it
+    push(EventType::PARTY_UPDATED, {{"party_id", "p1"}, {"party", {{"version", 3}}}});
+
+    Event latest = next();
+    EXPECT_EQ(latest.type, EventType::PARTY_UPDATED);
+    EXPECT_EQ(latest.data["party"]["version"], 3);
+    EXPECT_FALSE(queue.poll().has_value());
+    EXPECT_EQ(queue.stats().coalesced, 3u);
+}
+
+TEST(EventQueueTest, DropOldestKeepsSupersededRingEvents) {
+    EventQueueConfig config;
+    config.overflow = OverflowPolicy::DROP_OLDEST;
+    EventQueue queue(config);
+
+    for (int version = 0; version < 3; ++version) {
+        queue.push({EventType::PARTY_UPDATED, {{"party_id", "p1"}, {"party", {{"version", version}}}},
+                    std::chrono::system_clock::now()});
+    }
+    EXPECT_EQ(queue.drain(), 3u);
+    EXPECT_EQ(queue.stats().coalesced, 0u);
+}
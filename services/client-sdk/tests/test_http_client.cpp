@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "matchmaker/http_client.hpp"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace matchmaker;
+
+namespace {
+
+// Local API stand-in that records which client connections it served
+class TestServer {
+public:
+    TestServer() {
+        server_.Get("/ping", [this](const httplib::Request& req, httplib::Response& res) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ports_.insert(req.remote_port);
+                last_auth_ = req.get_header_value("Authorization");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms_));
+            res.set_content(R"({"ok":true})", "application/json");
+        });
+        port_ = server_.bind_to_any_port("127.0.0.1");
+        thread_ = std::thread([this] { server_.listen_after_bind(); });
+        server_.wait_until_ready();
+    }
+
+    ~TestServer() {
+        server_.stop();
+        thread_.join();
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+    size_t connections() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ports_.size();
+    }
+    std::string last_auth() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_auth_;
+    }
+    void set_delay_ms(int delay_ms) { delay_ms_ = delay_ms; }
+
+private:
+    httplib::Server server_;
+    std::thread thread_;
+    int port_ = 0;
+    std::atomic<int> delay_ms_{0};
+    std::mutex mutex_;
+    std::set<int> ports_;
+    std::string last_auth_;
+};
+
+} // namespace
+
+TEST(HTTPClientTest, SequentialRequestsReuseOneConnection) {
+    TestServer server;
+    HTTPClient http(server.url());
+    http.set_auth_token("token-1");
+
+    for (int i = 0; i < 10; ++i) {
+        auto result = http.get("/ping");
+        ASSERT_TRUE(result.success);
+        EXPECT_EQ(result.value["ok"], true);
+    }
+
+    EXPECT_EQ(server.connections(), 1u);
+    EXPECT_EQ(server.last_auth(), "Bearer token-1");
+    auto stats = http.pool_stats();
+    EXPECT_EQ(stats.connections_opened, 1u);
+    EXPECT_EQ(stats.connections_reused, 9u);
+    EXPECT_EQ(stats.idle, 1u);
+}
+
+TEST(HTTPClientTest, ConcurrentRequestsStayWithinMaxConnections) {
+    TestServer server;
+    server.set_delay_ms(5);
+    HTTPPoolConfig pool;
+    pool.max_connections = 2;
+    HTTPClient http(server.url(), pool);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> ok{0};
+    for (int t = 0; t < 6; ++t) {
+        threads.emplace_back([&http, &ok, t] {
+            for (int i = 0; i < 5; ++i) {
+                http.set_auth_token("token-" + std::to_string(t));
+                if (http.get("/ping").success) {
+                    ok++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(ok.load(), 30);
+    EXPECT_LE(server.connections(), 2u);
+    EXPECT_LE(http.pool_stats().open, 2u);
+}
+
+TEST(HTTPClientTest, IdleConnectionsAreEvicted) {
+    TestServer server;
+    HTTPPoolConfig pool;
+    pool.idle_timeout_seconds = 0;
+    HTTPClient http(server.url(), pool);
+
+    ASSERT_TRUE(http.get("/ping").success);
+    ASSERT_TRUE(http.get("/ping").success);
+
+    auto stats = http.pool_stats();
+    EXPECT_EQ(stats.connections_opened, 2u);
+    EXPECT_EQ(stats.idle_evictions, 1u);
+    http.close_idle_connections();
+    EXPECT_EQ(http.pool_stats().open, 0u);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "matchmaker/websocket_client.hpp"
+#include <thread>
+
+using namespace matchmaker;
+
+TEST(WebSocketClientTest, BackoffGrowsToCeiling) {
+    ReconnectConfig config;
+    config.initial_delay_ms = 100;
+    config.max_delay_ms = 1000;
+    config.multiplier = 2.0;
+
+    // random01 = 0 is the un-jittered delay
+    EXPECT_EQ(WebSocketClient::backoff_delay(config, 1, 0.0).count(), 100);
+    EXPECT_EQ(WebSocketClient::backoff_delay(config, 2, 0.0).count(), 200);
+    EXPECT_EQ(WebSocketClient::backoff_delay(config, 4, 0.0).count(), 800);
+    EXPECT_EQ(WebSocketClient::backoff_delay(config, 5, 0.0).count(), 1000);
+    EXPECT_EQ(WebSocketClient::backoff_delay(config, 1000, 0.0).count(), 1000);
+}
+
+TEST(WebSocketClientTest, BackoffJitterStaysInRange) {
+    ReconnectConfig config;
+    config.initial_delay_ms = 1000;
+    config.jitter = 0.5;
+
+    EXPECT_EQ(WebSocketClient::backoff_delay(config, 1, 0.5).count(), 750);
+    EXPECT_EQ(WebSocketClient::backoff_delay(config, 1, 0.998).count(), 501);
+
+    config.jitter = 0.0;
+    EXPECT_EQ(WebSocketClient::backoff_delay(config, 1, 0.999).count(), 1000);
+}
+
+TEST(WebSocketClientTest, FailedConnectReturnsWithoutWaitingForTimeout) {
+    EventQueue events;
+    ReconnectConfig config;
+    config.enabled = false;
+    config.connect_timeout_ms = 5000;
+    WebSocketClient ws("ws://127.0.0.1:1", events, config);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(ws.connect("party-1", "token"));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(4));
+
+    auto event = events.wait_for(std::chrono::milliseconds(1000));
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->data["will_reconnect"], false);
+}
+
+TEST(WebSocketClientTest, RetriesInBackgroundUntilDisconnect) {
+    EventQueue events;
+    ReconnectConfig config;
+    config.initial_delay_ms = 10;
+    config.max_delay_ms = 20;
+    config.connect_timeout_ms = 300;
+    WebSocketClient ws("ws://127.0.0.1:1", events, config);
+
+    EXPECT_FALSE(ws.connect("party-1", "token"));
+    EXPECT_GT(ws.stats().failed_attempts, 0u);
+
+    auto event = events.poll();
+    ASSERT_TRUE(event.has_value());
+    EXPECT_EQ(event->data["will_reconnect"], true);
+
+    ws.disconnect();
+    events.clear();
+    auto attempts = ws.stats().failed_attempts;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(ws.stats().failed_attempts, attempts);
+}
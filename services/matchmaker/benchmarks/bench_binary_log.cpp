@@ -0,0 +1,47 @@
+#include "bench_util.hpp"
+#include "matchmaker/binary_log.hpp"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+#include <cstdio>
+#include <string>
+
+using namespace matchmaker;
+
+int main() {
+    constexpr int kCalls = 100'000;
+
+    std::string party_id = "7c1e4b2a-90d3-4f6e-8a5b-1d2c3e100000";
+    std::string region = "us-east";
+    std::string mode = "ranked";
+
+    // Ring sized so nothing is dropped; the worker drains between samples
+    BinaryLogger::Config config;
+    config.path = "/tmp/bench_binary_log.mmblog";
+    config.ring_capacity = 1 << 18;
+    config.mirror_to_spdlog = false;
+    BinaryLogger logger(config);
+
+    bench::run("BinaryLogger::log x100k (binary sink)", 20,
+        [&] { logger.flush(); },
+        [&] {
+            for (int i = 0; i < kCalls; ++i) {
+                logger.log(LogEvent::QueueEvent, party_id, region, mode, 1500 + i);
+            }
+        });
+
+    // Reference: synchronous formatting on the calling thread
+    auto null_logger = spdlog::create<spdlog::sinks::null_sink_st>("bench_null");
+    bench::run("spdlog format x100k (null sink)", 20, [&] {
+        for (int i = 0; i < kCalls; ++i) {
+            null_logger->info("Queue event: party={}, region={}, mode={}, mmr={}",
+                party_id, region, mode, 1500 + i);
+        }
+    });
+
+    logger.flush();
+    std::printf("dropped=%llu (per-call ns = median us / 100)\n",
+        static_cast<unsigned long long>(logger.dropped()));
+    std::remove(config.path.c_str());
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "bench_util.hpp"
+#include "matchmaker/bulk_assignment.hpp"
+
+#include <random>
+#include <string>
+
+using namespace matchmaker;
+
+namespace {
+
+constexpr int kPlayers = 50000;
+
+// Tournament check-in: 5v5, mostly solos with some premade stacks
+std::vector<QueueEntry> make_pool(bool stacks) {
+    std::mt19937 rng(42);
+    std::normal_distribution<double> mmr(1500.0, 300.0);
+    std::discrete_distribution<int> size_dist({60, 20, 10, 6, 4});
+    std::vector<QueueEntry> pool;
+    int players = 0;
+    while (players < kPlayers) {
+        QueueEntry e;
+        e.party_id = "party-" + std::to_string(pool.size());
+        e.region = "eu-west";
+        e.mode = "tournament";
+        e.team_size = 5;
+        e.party_size = stacks ? std::min(size_dist(rng) + 1, kPlayers - players) : 1;
+        e.avg_mmr = static_cast<int>(mmr(rng));
+        for (int p = 0; p < e.party_size; ++p) {
+            e.player_ids.push_back(e.party_id + "-p" + std::to_string(p));
+        }
+        players += e.party_size;
+        pool.push_back(std::move(e));
+    }
+    return pool;
+}
+
+void report(const char* name, const std::vector<QueueEntry>& pool, size_t threads) {
+    BulkAssignmentConfig config;
+    config.threads = threads;
+    auto result = assign_lobbies(pool, config);
+    std::printf("%-48s lobbies=%zu placed=%zu/%d unassigned_parties=%zu\n",
+        name, result.lobbies.size(), result.players_assigned, kPlayers, result.unassigned.size());
+    bench::run(name, 5, [&] { assign_lobbies(pool, config); });
+}
+
+} // namespace
+
+int main() {
+    auto solos = make_pool(false);
+    auto stacks = make_pool(true);
+    report("50k solos, 1 thread", solos, 1);
+    report("50k solos, all threads", solos, 0);
+    report("50k mixed stacks, 1 thread", stacks, 1);
+    report("50k mixed stacks, all threads", stacks, 0);
+    return 0;
+}
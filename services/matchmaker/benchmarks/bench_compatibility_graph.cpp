@@ -0,0 +1,85 @@
+#include "bench_util.hpp"
+#include "matchmaker/compatibility_graph.hpp"
+#include "matchmaker/queue_manager.hpp"
+
+#include <random>
+#include <string>
+
+using namespace matchmaker;
+
+int main() {
+    constexpr int kParties = 100'000;
+
+    // Sparse 5v5 bucket: parties spread far apart so nothing is ever viable.
+    // Before the graph, each tick re-ran try_form_match over the whole bucket.
+    QueueConfig config;
+    config.max_wait_time_sec = 3600;
+    config.mmr_band_initial = 2;
+    config.mmr_band_growth_per_sec = 0;
+    QueueManager sparse(config);
+    auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < kParties; ++i) {
+        QueueEntry e;
+        e.party_id = "party-" + std::to_string(i);
+        e.region = "us-east";
+        e.mode = "ranked";
+        e.team_size = 5;
+        e.party_size = 1;
+        e.avg_mmr = i * 10;
+        e.enqueued_at = now;
+        e.player_ids.push_back("player-" + std::to_string(i));
+        sparse.enqueue(e);
+    }
+    sparse.tick();
+    bench::run("QueueManager::tick (100k 5v5, nothing viable)", 20, [&] { sparse.tick(); });
+
+    // One small cluster becomes viable per tick in the same large bucket:
+    // members are found and removed through their slots, not a bucket scan
+    int cluster = 0;
+    bench::run("QueueManager::tick (100k 5v5, one new match)", 20,
+        [&] {
+            ++cluster;
+            for (int i = 0; i < 10; ++i) {
+                QueueEntry e;
+                e.party_id = "cluster-" + std::to_string(cluster) + "-" + std::to_string(i);
+                e.region = "us-east";
+                e.mode = "ranked";
+                e.team_size = 5;
+                e.party_size = 1;
+                e.avg_mmr = kParties * 10 + cluster * 1000;
+                e.enqueued_at = now;
+                e.player_ids.push_back(e.party_id + "-p0");
+                sparse.enqueue(e);
+            }
+        },
+        [&] { sparse.tick(); });
+
+    // Incremental maintenance cost
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> mmr(0, 3000);
+    std::vector<QueueEntry> entries(kParties);
+    for (int i = 0; i < kParties; ++i) {
+        entries[i].party_id = "party-" + std::to_string(i);
+        entries[i].party_size = 1;
+        entries[i].avg_mmr = mmr(rng);
+        entries[i].enqueued_at = now;
+    }
+    std::unique_ptr<CompatibilityGraph> graph;
+    bench::run("CompatibilityGraph::add (100k parties)", 5,
+        [&] { graph = std::make_unique<CompatibilityGraph>(QueueConfig{}); },
+        [&] {
+            for (const auto& e : entries) {
+                graph->add(e, now);
+            }
+        });
+    bench::run("CompatibilityGraph::advance (100k parties, +1s)", 5,
+        [&] {
+            graph = std::make_unique<CompatibilityGraph>(QueueConfig{});
+            for (const auto& e : entries) {
+                graph->add(e, now);
+            }
+        },
+        [&] { graph->advance(now + std::chrono::seconds(1)); });
+
+    return 0;
+}
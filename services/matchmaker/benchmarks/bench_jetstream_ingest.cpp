@@ -0,0 +1,84 @@
+#include "bench_util.hpp"
+#include "matchmaker/jetstream.hpp"
+#include "matchmaker/queue_events.hpp"
+#include "matchmaker/queue_manager.hpp"
+#include "matchmaker/queue_store.hpp"
+
+#include <random>
+#include <string>
+
+using namespace matchmaker;
+
+namespace {
+
+constexpr size_t kEvents = 100000;
+
+QueueEntry make_solo(size_t i, int mmr) {
+    QueueEntry e;
+    e.party_id = "party-" + std::to_string(i);
+    e.region = "us-east";
+    e.mode = "ranked";
+    e.team_size = 1;
+    e.party_size = 1;
+    e.avg_mmr = mmr;
+    e.enqueued_at = std::chrono::system_clock::now();
+    e.player_ids.push_back("player-" + std::to_string(i));
+    return e;
+}
+
+} // namespace
+
+int main() {
+    // Pre-encode once so the runs measure ingest, not payload construction
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> mmr(1000, 2000);
+    std::vector<std::string> payloads;
+    payloads.reserve(kEvents);
+    for (size_t i = 0; i < kEvents; ++i) {
+        payloads.push_back(encode_queue_enter(make_solo(i, mmr(rng))));
+    }
+
+    // poll -> tick (store write) -> commit, until the stream is drained
+    for (size_t batch_size : {1u, 16u, 128u, 1024u}) {
+        JetStreamStandIn stream;
+        for (const auto& payload : payloads) {
+            stream.publish("matchmaker.queue.ranked.us-east", payload);
+        }
+        auto consumer = stream.pull_consumer({});
+        InMemoryQueueStore store;
+        QueueManager qm;
+        qm.set_store(&store);
+        DurableQueueIngest ingest(*consumer, qm,
+            [&qm](const QueueEvent& event) { qm.enqueue(event.entry); }, batch_size);
+
+        size_t ticks = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (ingest.poll() > 0) {
+            qm.tick();
+            ingest.commit();
+            ticks++;
+        }
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("batch %5zu: %8.0f events/s, %6zu ticks, %6llu acks (%.4f per event), %llu requests\n",
+            batch_size, kEvents / sec, ticks,
+            static_cast<unsigned long long>(ingest.stats().acks),
+            static_cast<double>(ingest.stats().acks) / kEvents,
+            static_cast<unsigned long long>(consumer->round_trips()));
+    }
+
+    // Fetch + ack cost alone, without the queue
+    JetStreamStandIn stream;
+    auto consumer = stream.pull_consumer({});
+    bench::run("publish 256 + fetch 256 + ack_all", 2000,
+        [&] {
+            for (size_t i = 0; i < 256; ++i) {
+                stream.publish("matchmaker.queue.ranked.us-east", payloads[i]);
+            }
+        },
+        [&] {
+            auto batch = consumer->fetch(256, std::chrono::milliseconds(0));
+            consumer->ack_all(batch.back().stream_sequence);
+        });
+    return 0;
+}
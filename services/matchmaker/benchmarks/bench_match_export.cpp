@@ -0,0 +1,50 @@
+#include "bench_util.hpp"
+#include "matchmaker/match_exporter.hpp"
+#include "matchmaker/team_builder.hpp"
+
+#include <filesystem>
+#include <string>
+
+using namespace matchmaker;
+
+int main() {
+    constexpr int kMatches = 200'000;
+
+    auto dir = std::filesystem::temp_directory_path() / "matchmaker_export_bench";
+    std::filesystem::create_directories(dir);
+
+    // A 5v5 match of solo parties
+    MatchResult match;
+    match.match_id = "3f2b8c1e-7d4a-4e9b-a1c6-0d5e8f7a9b21";
+    match.region = "us-east";
+    match.mode = "ranked";
+    match.team_size = 5;
+    match.avg_mmr = 1500;
+    match.mmr_variance = 40;
+    match.quality_score = 0.91;
+    match.mmr_band = 180;
+    match.formed_at = std::chrono::system_clock::now();
+    for (int i = 0; i < 10; ++i) {
+        match.party_ids.push_back("7c1e4b2a-90d3-4f6e-8a5b-1d2c3e4f5a" + std::to_string(10 + i));
+        match.party_mmrs.push_back(1450 + i * 10);
+        match.party_enqueued_at.push_back(match.formed_at - std::chrono::seconds(i * 3));
+    }
+
+    MatchExportConfig config;
+    config.directory = dir.string();
+    std::unique_ptr<MatchExporter> exporter;
+    bench::run("MatchExporter::append (200k 5v5 matches)", 5,
+        [&] { exporter = std::make_unique<MatchExporter>(config); },
+        [&] {
+            for (int i = 0; i < kMatches; ++i) {
+                exporter->append(match);
+            }
+            exporter->rotate();
+        });
+    std::printf("  rows per file: %llu\n",
+        static_cast<unsigned long long>(exporter->rows_written()));
+
+    exporter.reset();
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "bench_util.hpp"
+#include "matchmaker/match_serializer.hpp"
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+using namespace matchmaker;
+
+int main() {
+    constexpr int kMatches = 100'000;
+
+    // 5v5 of solo parties with UUID-sized IDs
+    MatchResult match;
+    match.match_id = "3f2b8c1e-7d4a-4e9b-a1c6-0d5e8f7a9b21";
+    match.region = "us-east";
+    match.mode = "ranked";
+    match.team_size = 5;
+    match.teams.resize(2);
+    for (int i = 0; i < 10; ++i) {
+        std::string suffix = std::to_string(100000 + i);
+        match.teams[i % 2].push_back("5e9d1c7a-2b4f-4a8e-9c3d-7f6a5b" + suffix);
+        match.party_ids.push_back("7c1e4b2a-90d3-4f6e-8a5b-1d2c3e" + suffix);
+    }
+    match.avg_mmr = 1512;
+    match.mmr_variance = 38;
+    match.quality_score = 0.9134;
+
+    size_t bytes = 0;
+    bench::run("serialize_match_found x100k", 10, [&] {
+        for (int i = 0; i < kMatches; ++i) {
+            bytes += serialize_match_found(match).size();
+        }
+    });
+
+    bench::run("nlohmann::json DOM + dump x100k", 10, [&] {
+        for (int i = 0; i < kMatches; ++i) {
+            nlohmann::json j = {
+                {"match_id", match.match_id},
+                {"region", match.region},
+                {"mode", match.mode},
+                {"team_size", match.team_size},
+                {"teams", match.teams},
+                {"party_ids", match.party_ids},
+                {"avg_mmr", match.avg_mmr},
+                {"mmr_variance", match.mmr_variance},
+                {"quality_score", match.quality_score},
+            };
+            bytes += j.dump().size();
+        }
+    });
+
+    std::printf("  payload bytes: %zu (divide medians by 100k for ns/match)\n",
+        serialize_match_found(match).size());
+    return bytes == 0;
+}
@@ -0,0 +1,105 @@
+#include "bench_util.hpp"
+#include "matchmaker/queue_manager.hpp"
+#include "matchmaker/team_builder.hpp"
+
+#include <random>
+#include <string>
+
+using namespace matchmaker;
+
+namespace {
+
+std::vector<QueueEntry> make_solo_bucket(size_t count, int mmr_spread) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> mmr(1500 - mmr_spread, 1500 + mmr_spread);
+    auto now = std::chrono::system_clock::now();
+
+    std::vector<QueueEntry> entries(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto& e = entries[i];
+        e.party_id = "party-" + std::to_string(i);
+        e.region = "us-east";
+        e.mode = "ranked";
+        e.team_size = 1;
+        e.party_size = 1;
+        e.avg_mmr = mmr(rng);
+        e.enqueued_at = now - std::chrono::seconds(i % 60);
+        e.player_ids.push_back("player-" + std::to_string(i));
+    }
+    return entries;
+}
+
+}  // namespace
+
+int main() {
+    constexpr size_t kPlayers = 1'000'000;
+
+    // Pairing sweep alone over an MMR-ordered bucket
+    auto sorted = make_solo_bucket(kPlayers, 1000);
+    std::sort(sorted.begin(), sorted.end(),
+        [](const QueueEntry& a, const QueueEntry& b) { return a.avg_mmr < b.avg_mmr; });
+    std::vector<TeamBuilder::SoloCandidate> candidates;
+    for (const auto& e : sorted) {
+        candidates.push_back({e.avg_mmr, 100, e.enqueued_at.time_since_epoch().count()});
+    }
+    size_t pairs = 0;
+    bench::run("pair_adjacent_1v1 (1M solo, all pairable)", 10, [&] {
+        pairs = TeamBuilder::pair_adjacent_1v1(candidates, 0.6).size();
+    });
+    std::printf("  pairs formed: %zu\n", pairs);
+
+    // Steady-state tick: bucket already MMR-ordered, nobody within band
+    QueueConfig sparse_config;
+    sparse_config.mmr_band_initial = 0;
+    sparse_config.mmr_band_growth_per_sec = 0;
+    sparse_config.max_wait_time_sec = 3600;
+    QueueManager sparse(sparse_config);
+    for (size_t i = 0; i < kPlayers; ++i) {
+        QueueEntry e = sorted[i];
+        e.avg_mmr = static_cast<int>(i);  // Distinct MMRs, zero band: no pairs
+        sparse.enqueue(e);
+    }
+    sparse.tick();  // First tick sorts the bucket once
+    bench::run("QueueManager::tick (1M solo, no matches)", 10, [&] { sparse.tick(); });
+
+    // The idle loop asks for the next deadline after every tick
+    auto wake = std::chrono::system_clock::time_point::max();
+    bench::run("QueueManager::next_wakeup (1M solo)", 10,
+        [&] { wake = sparse.next_wakeup(std::chrono::system_clock::now()); });
+    std::printf("  next wakeup in %llds\n", static_cast<long long>(
+        std::chrono::duration_cast<std::chrono::seconds>(wake - std::chrono::system_clock::now()).count()));
+
+    // Same tick serving a one-slot backfill through the MMR index
+    int next_match = 0;
+    bench::run("QueueManager::tick (1M solo, no matches, 1-slot backfill)", 10,
+        [&] {
+            BackfillRequest request;
+            request.match_id = "bf-" + std::to_string(next_match);
+            request.region = "us-east";
+            request.mode = "ranked";
+            request.target_mmr = 1000 * next_match++;
+            request.deadline = std::chrono::system_clock::now() + std::chrono::seconds(10);
+            sparse.request_backfill(request);
+        },
+        [&] { sparse.tick(); });
+    std::printf("  backfills filled: %llu, avg fill %.1fus\n",
+        static_cast<unsigned long long>(sparse.get_backfill_stats().filled),
+        1e6 * sparse.get_backfill_stats().fill_latency.sum
+            / static_cast<double>(std::max<uint64_t>(sparse.get_backfill_stats().fill_latency.count, 1)));
+
+    // Full tick that drains the bucket into ~500k matches
+    QueueConfig config;
+    config.max_wait_time_sec = 3600;
+    std::unique_ptr<QueueManager> full;
+    bench::run("QueueManager::tick (1M solo, ~500k matches)", 5,
+        [&] {
+            full = std::make_unique<QueueManager>(config);
+            for (const auto& e : sorted) {
+                full->enqueue(e);
+            }
+        },
+        [&] { pairs = full->tick().size(); });
+    std::printf("  matches formed: %zu\n", pairs);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "bench_util.hpp"
+#include "matchmaker/party_index.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace matchmaker;
+
+namespace {
+
+// Same shape as QueueManager's per-party location
+struct Location {
+    const void* bucket = nullptr;
+    int64_t entry_bytes = 0;
+    int64_t id_bytes = 0;
+    const void* mmr_slot = nullptr;
+};
+
+using StdIndex = std::unordered_map<std::string, Location, std::hash<std::string>, std::equal_to<std::string>,
+                                    AccountingAllocator<std::pair<const std::string, Location>>>;
+
+} // namespace
+
+int main() {
+    constexpr size_t kParties = 1'000'000;
+
+    // UUID-sized party ids, with precomputed hashes as QueueEntry carries them
+    std::vector<std::string> ids;
+    std::vector<uint64_t> hashes;
+    ids.reserve(kParties);
+    hashes.reserve(kParties);
+    for (size_t i = 0; i < kParties; ++i) {
+        ids.push_back("7c1e4b2a-90d3-4f6e-8a5b-" + std::to_string(100000000000 + i * 7919));
+        hashes.push_back(hash_party_id(ids.back()));
+    }
+    std::vector<uint32_t> order(kParties);
+    for (size_t i = 0; i < kParties; ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+    // Lookups arrive as views into message bytes (copied here so the
+    // std::string keys are not reused)
+    std::string wire;
+    std::vector<std::string_view> views;
+    for (const auto& id : ids) {
+        wire += id;
+    }
+    size_t offset = 0;
+    for (const auto& id : ids) {
+        views.emplace_back(wire.data() + offset, id.size());
+        offset += id.size();
+    }
+
+    size_t hits = 0;
+    MemoryAccount std_account;
+    MemoryAccount flat_account;
+    std::unique_ptr<StdIndex> std_index;
+    std::unique_ptr<FlatPartyIndex<Location>> flat_index;
+
+    auto fill_std = [&] {
+        std_index = std::make_unique<StdIndex>(0, std::hash<std::string>{}, std::equal_to<std::string>{},
+                                               StdIndex::allocator_type(&std_account));
+        for (const auto& id : ids) {
+            std_index->try_emplace(id).first->second.entry_bytes = 1;
+        }
+    };
+    auto fill_flat = [&] {
+        flat_index = std::make_unique<FlatPartyIndex<Location>>(&flat_account);
+        for (size_t i = 0; i < kParties; ++i) {
+            flat_index->try_emplace(ids[i], hashes[i]).first->value.entry_bytes = 1;
+        }
+    };
+
+    bench::run("unordered_map insert x1M", 5, [&] { std_index.reset(); }, fill_std);
+    std::printf("  unordered_map bytes: %lld\n", static_cast<long long>(std_account.bytes));
+    bench::run("FlatPartyIndex insert x1M", 5, [&] { flat_index.reset(); }, fill_flat);
+    std::printf("  FlatPartyIndex bytes: %lld (%zu slots)\n",
+        static_cast<long long>(flat_account.bytes), flat_index->slot_count());
+
+    bench::run("unordered_map lookup x1M (string_view -> string)", 5, [&] {
+        for (uint32_t i : order) {
+            hits += std_index->find(std::string(views[i])) != std_index->end();
+        }
+    });
+    bench::run("FlatPartyIndex lookup x1M (string_view)", 5, [&] {
+        for (uint32_t i : order) {
+            hits += flat_index->find(views[i]) != nullptr;
+        }
+    });
+    bench::run("FlatPartyIndex lookup x1M (precomputed hash)", 5, [&] {
+        for (uint32_t i : order) {
+            hits += flat_index->find(views[i], hashes[i]) != nullptr;
+        }
+    });
+
+    bench::run("unordered_map erase x1M", 5, fill_std, [&] {
+        for (uint32_t i : order) {
+            std_index->erase(ids[i]);
+        }
+    });
+    bench::run("FlatPartyIndex erase x1M", 5, fill_flat, [&] {
+        for (uint32_t i : order) {
+            flat_index->erase(flat_index->find(ids[i], hashes[i]));
+        }
+    });
+
+    // Steady-state churn: erase and re-insert half the parties
+    bench::run("unordered_map churn x1M", 5, fill_std, [&] {
+        for (size_t n = 0; n < kParties / 2; ++n) {
+            std_index->erase(ids[order[n]]);
+        }
+        for (size_t n = 0; n < kParties / 2; ++n) {
+            std_index->try_emplace(ids[order[n]]);
+        }
+    });
+    bench::run("FlatPartyIndex churn x1M", 5, fill_flat, [&] {
+        for (size_t n = 0; n < kParties / 2; ++n) {
+            flat_index->erase(flat_index->find(ids[order[n]], hashes[order[n]]));
+        }
+        for (size_t n = 0; n < kParties / 2; ++n) {
+            flat_index->try_emplace(ids[order[n]], hashes[order[n]]);
+        }
+    });
+
+    return hits == 0;
+}
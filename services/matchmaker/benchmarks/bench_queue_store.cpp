@@ -0,0 +1,86 @@
+#include "bench_util.hpp"
+#include "matchmaker/queue_manager.hpp"
+#include "matchmaker/queue_store.hpp"
+#include "matchmaker/redis_client.hpp"
+
+#include <random>
+#include <string>
+
+using namespace matchmaker;
+
+namespace {
+
+QueueEntry make_solo(size_t i, int mmr) {
+    QueueEntry e;
+    e.party_id = "party-" + std::to_string(i);
+    e.region = "us-east";
+    e.mode = "ranked";
+    e.team_size = 1;
+    e.party_size = 1;
+    e.avg_mmr = mmr;
+    e.enqueued_at = std::chrono::system_clock::now();
+    e.player_ids.push_back("player-" + std::to_string(i));
+    return e;
+}
+
+}  // namespace
+
+int main() {
+    // Round trips per tick stay fixed as the number of matches grows
+    RespStandIn server;
+    if (!server.listening()) {
+        std::printf("cannot start RESP stand-in\n");
+        return 1;
+    }
+
+    for (size_t parties : {0u, 100u, 1000u, 10000u}) {
+        RedisQueueStoreConfig store_config;
+        store_config.port = server.port();
+        store_config.key_prefix = "bench" + std::to_string(parties) + ":";
+        RedisQueueStore store(store_config);
+        store.apply({});    // Nothing to write: no round trip
+
+        QueueManager qm;
+        qm.set_store(&store);
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> mmr(1400, 1600);
+        for (size_t i = 0; i < parties; ++i) {
+            qm.enqueue(make_solo(i, mmr(rng)));
+        }
+
+        uint64_t before = store.round_trips();
+        size_t matches = 0;
+        auto start = std::chrono::steady_clock::now();
+        matches = qm.tick().size();
+        double tick_us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+        uint64_t trips = store.round_trips() - before;
+
+        std::printf("%6zu enqueues + %5zu matches in one tick: %llu round trip(s), %10.1fus\n",
+            parties, matches, static_cast<unsigned long long>(trips), tick_us);
+    }
+
+    // Steady-state ticks with a trickle of joins and matches
+    RedisQueueStoreConfig store_config;
+    store_config.port = server.port();
+    store_config.key_prefix = "steady:";
+    RedisQueueStore store(store_config);
+    QueueManager qm;
+    qm.set_store(&store);
+    size_t next_id = 0;
+    bench::run("tick + batch write (20 joins, ~10 matches)", 200,
+        [&] {
+            for (int i = 0; i < 20; ++i, ++next_id) {
+                qm.enqueue(make_solo(next_id, 1500));
+            }
+        },
+        [&] { qm.tick(); });
+
+    uint64_t before = store.round_trips();
+    for (int i = 0; i < 100; ++i) {
+        qm.tick();
+    }
+    std::printf("  idle ticks: %llu round trips over 100 ticks\n",
+        static_cast<unsigned long long>(store.round_trips() - before));
+    return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace matchmaker::bench {
+
+/**
+ * Run fn `iterations` times (after one warm-up) and print min/median
+ * wall time in microseconds.
+ */
+template <typename Setup, typename Fn>
+void run(const char* name, int iterations, Setup&& setup, Fn&& fn) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    for (int i = 0; i <= iterations; ++i) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (i > 0) {
+            samples.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    std::printf("%-48s min=%10.1fus  median=%10.1fus\n",
+        name, samples.front(), samples[samples.size() / 2]);
+}
+
+template <typename Fn>
+void run(const char* name, int iterations, Fn&& fn) {
+    run(name, iterations, [] {}, fn);
+}
+
+} // namespace matchmaker::bench
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace matchmaker {
+
+// Hot-path log events. The format strings live in binary_log.cpp and are
+// written into every log file header, so the decoder needs no copy of them.
+enum class LogEvent : uint16_t {
+    QueueEvent = 1,     // party_id, region, mode, mmr
+    MatchFormed = 2,    // match_id, region, mode, mmr, quality
+    TickOverrun = 3,    // interval_ms, took_ms
+};
+
+/**
+ * Fixed-size binary log record
+ *
+ * Arguments are packed into payload as [type][value]: integers and doubles
+ * take 8 bytes, strings a length byte plus their bytes (truncated to fit).
+ */
+struct BinaryLogRecord {
+    static constexpr size_t kSize = 128;
+    static constexpr size_t kPayloadSize = kSize - 16;
+
+    enum ArgType : uint8_t { kInt = 1, kDouble = 2, kString = 3 };
+
+    int64_t timestamp_ns;   // Wall clock since epoch, coarse (tick) resolution on Linux
+    uint16_t event;
+    uint8_t arg_count;
+    uint8_t payload_size;
+    uint32_t reserved;
+    uint8_t payload[kPayloadSize];
+};
+static_assert(sizeof(BinaryLogRecord) == BinaryLogRecord::kSize, "record must stay fixed-size");
+
+/**
+ * BinaryLogger - Low-latency structured logging for the tick and ingest paths
+ *
+ * log() encodes its arguments into a fixed-size record and pushes it onto a
+ * bounded lock-free ring (multi-producer, single consumer); it never blocks
+ * or allocates and drops the record if the ring is full. A background thread
+ * drains the ring, appends raw records to an optional binary file and mirrors
+ * them as formatted lines to spdlog. Binary files are decoded offline with
+ * scripts/decode_binary_log.py.
+ *
+ * File layout: "MMBLOG01", u16 event_count, per event {u16 id, u8 level,
+ * u16 name_len, name, u16 format_len, format}, then 128-byte records.
+ */
+class BinaryLogger {
+public:
+    struct Config {
+        std::string path;                    // Binary sink; empty = none
+        size_t ring_capacity = 1 << 14;      // Records, rounded up to a power of two
+        bool mirror_to_spdlog = true;        // Format records to spdlog off-thread
+    };
+
+    explicit BinaryLogger(const Config& config);
+    ~BinaryLogger();
+
+    BinaryLogger(const BinaryLogger&) = delete;
+    BinaryLogger& operator=(const BinaryLogger&) = delete;
+
+    template <typename... Args>
+    bool log(LogEvent event, const Args&... args) {
+        BinaryLogRecord record;
+        record.timestamp_ns = now_ns();
+        record.event = static_cast<uint16_t>(event);
+        record.arg_count = 0;
+        record.payload_size = 0;
+        record.reserved = 0;
+        (encode(record, args), ...);
+        return push(record);
+    }
+
+    // Block until every record logged so far has been written
+    void flush();
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Render a record with its event's format string
+    static std::string format(const BinaryLogRecord& record);
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<size_t> sequence;
+        BinaryLogRecord record;
+    };
+
+    Config config_;
+    std::unique_ptr<Cell[]> ring_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+    std::atomic<size_t> written_{0};
+    std::atomic<bool> stopping_{false};
+    std::FILE* file_ = nullptr;
+    std::thread worker_;
+
+    bool push(const BinaryLogRecord& record);
+    static int64_t now_ns();
+    void run();
+    size_t drain();
+    void write_header();
+
+    template <typename T>
+    static void encode(BinaryLogRecord& record, const T& value) {
+        if constexpr (std::is_integral_v<T>) {
+            put_number(record, BinaryLogRecord::kInt, static_cast<int64_t>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            put_number(record, BinaryLogRecord::kDouble, static_cast<double>(value));
+        } else {
+            put_string(record, std::string_view(value));
+        }
+    }
+
+    template <typename T>
+    static void put_number(BinaryLogRecord& record, uint8_t type, T value) {
+        if (record.payload_size + 1 + sizeof(T) > BinaryLogRecord::kPayloadSize) {
+            return;
+        }
+        record.payload[record.payload_size++] = type;
+        std::memcpy(record.payload + record.payload_size, &value, sizeof(T));
+        record.payload_size += sizeof(T);
+        record.arg_count++;
+    }
+
+    static void put_string(BinaryLogRecord& record, std::string_view value) {
+        size_t room = BinaryLogRecord::kPayloadSize - record.payload_size;
+        if (room < 2) {
+            return;
+        }
+        size_t len = std::min({value.size(), room - 2, size_t{255}});
+        record.payload[record.payload_size++] = BinaryLogRecord::kString;
+        record.payload[record.payload_size++] = static_cast<uint8_t>(len);
+        std::memcpy(record.payload + record.payload_size, value.data(), len);
+        record.payload_size += len;
+        record.arg_count++;
+    }
+};
+
+} // namespace matchmaker
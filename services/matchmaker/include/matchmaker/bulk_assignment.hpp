@@ -0,0 +1,42 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace matchmaker {
+
+// Settings for a one-shot lobby assignment
+struct BulkAssignmentConfig {
+    int num_teams = 2;
+    int mmr_tolerance = 500;              // Widest MMR spread within a lobby
+    double min_match_quality = 0.6;
+    size_t threads = 0;                   // 0 = hardware concurrency
+    std::string lobby_id_prefix = "lobby";
+};
+
+struct BulkAssignmentResult {
+    std::vector<MatchResult> lobbies;       // Grouped by bucket
+    std::vector<std::string> unassigned;    // Party ids no lobby could take
+    size_t players_assigned = 0;
+};
+
+/**
+ * Place a whole pool (e.g. a tournament check-in) into lobbies in one pass.
+ *
+ * Parties are grouped by (region, mode, team_size) and each group is sorted
+ * by MMR, in chunks on all threads followed by a merge. The sorted order is
+ * cut into one contiguous slice per thread. Within a slice the lowest
+ * unplaced party anchors the next lobby and is joined by the following
+ * parties that fit the remaining slots. TeamBuilder::try_form_match
+ * balances the lobby under the same band and quality rules as the live
+ * queue, and every team must come out exactly team_size players. If the
+ * anchor's lobby fails, the anchor is set aside. Set-aside parties from
+ * all slices get one more serial pass, so slice edges do not strand
+ * anyone. Lobby ids are <lobby_id_prefix>-<n>, numbered in output order.
+ */
+BulkAssignmentResult assign_lobbies(const std::vector<QueueEntry>& pool,
+                                    const BulkAssignmentConfig& config = {});
+
+} // namespace matchmaker
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace matchmaker {
+
+/**
+ * CompatibilityGraph - Incremental "mutually within band" clustering for one bucket
+ *
+ * Two parties are compatible once their MMR gap fits both of their current
+ * bands. Edges only appear when a party joins or its band widens (at whole
+ * second steps, as in QueueManager::calculate_mmr_band), so the graph is
+ * updated from a time-ordered event queue instead of rescanning the bucket.
+ * Connectivity is tracked with union-find; removals mark the affected
+ * cluster stale and it is re-split lazily the next time it is examined.
+ *
+ * Parties with the same MMR are always mutually compatible, so they share
+ * an MMR slot that is merged on insert. Range queries then visit at most
+ * one slot per MMR point in the band rather than every party in it.
+ */
+class CompatibilityGraph {
+public:
+    explicit CompatibilityGraph(const QueueConfig& config = QueueConfig{});
+
+    // Membership
+    void add(const QueueEntry& entry, std::chrono::system_clock::time_point now);
+    void remove(const std::string& party_id);
+    bool contains(const std::string& party_id) const;
+
+    // Apply every band widening step due by `now`
+    void advance(std::chrono::system_clock::time_point now);
+
+    // Earliest pending widening step (may belong to a party that has since
+    // left); time_point::max() when no band can widen further
+    std::chrono::system_clock::time_point next_widening() const {
+        return events_.empty() ? std::chrono::system_clock::time_point::max() : events_.top().at;
+    }
+
+    /**
+     * Clusters that changed since they were last taken and hold at least
+     * min_players players. Each cluster is a list of party IDs.
+     */
+    std::vector<std::vector<std::string>> take_viable_clusters(int min_players);
+
+    // Stats
+    size_t size() const { return index_.size(); }
+    size_t cluster_count() const;
+
+    // Approximate heap footprint: node/slot/event storage plus ID copies
+    int64_t memory_bytes() const;
+
+    // Storage the next add() may reallocate on top of memory_bytes()
+    int64_t add_growth_bytes() const;
+
+private:
+    struct Node {
+        std::string party_id;
+        int mmr = 0;
+        int party_size = 0;
+        int band = 0;
+        std::chrono::system_clock::time_point enqueued_at;
+        bool alive = false;
+        uint32_t generation = 0;
+
+        // Union-find state (valid on roots unless noted)
+        uint32_t parent = 0;        // Every node
+        uint32_t rank = 0;
+        int players = 0;            // Live players in the cluster
+        bool dirty = false;         // Changed since last taken
+        bool stale = false;         // A member left; connectivity may have split
+        std::vector<uint32_t> members;
+    };
+
+    struct MmrSlot {
+        std::vector<uint32_t> nodes;    // Live parties at this MMR
+        int max_band = -1;
+        uint32_t widest = 0;            // Node holding max_band
+    };
+
+    struct WidenEvent {
+        std::chrono::system_clock::time_point at;
+        uint32_t node;
+        uint32_t generation;
+
+        bool operator>(const WidenEvent& other) const { return at > other.at; }
+    };
+
+    QueueConfig config_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+    std::unordered_map<std::string, uint32_t> index_;
+    std::map<int, MmrSlot> slots_;
+    std::priority_queue<WidenEvent, std::vector<WidenEvent>, std::greater<>> events_;
+    std::vector<uint32_t> dirty_;
+    int64_t id_bytes_ = 0;      // Heap held by party_id copies (nodes and index)
+
+    int band_at(const Node& node, std::chrono::system_clock::time_point now) const;
+    void schedule_next_step(uint32_t id);
+    void connect_range(uint32_t id, int old_band);
+    void refresh_slot_band(MmrSlot& slot);
+    void reset_singleton(uint32_t id);
+    uint32_t find(uint32_t id);
+    void unite(uint32_t a, uint32_t b);
+    void mark_dirty(uint32_t root);
+    std::vector<uint32_t> resplit(uint32_t root);
+};
+
+} // namespace matchmaker
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "nats_client.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace matchmaker {
+
+// One message delivered by a pull consumer
+struct JetStreamMessage {
+    uint64_t stream_sequence = 0;
+    uint32_t deliveries = 1;      // 1 on first delivery, >1 when redelivered
+    std::string subject;
+    std::string data;
+};
+
+// Durable pull consumer settings (ack policy is always "all")
+struct PullConsumerConfig {
+    std::string durable_name = "matchmaker";
+    std::string filter_subject = "matchmaker.queue.>";   // NATS wildcards; empty = all
+    std::chrono::milliseconds ack_wait{30000};           // Redeliver if not acked within
+    uint32_t max_deliver = 0;                            // 0 = unlimited
+};
+
+/**
+ * PullConsumer - Durable pull consumer on a JetStream stream
+ *
+ * fetch() returns up to max_messages, redeliveries (unacked past ack_wait)
+ * first and then new messages in stream order. The consumer's position
+ * lives on the server under its durable name, so a restarted process
+ * resumes where the last one stopped acking.
+ *
+ * Acks use the AckAll policy: ack_all(seq) acknowledges every delivered
+ * message up to seq, so a whole batch costs one round trip.
+ */
+class PullConsumer {
+public:
+    virtual ~PullConsumer() = default;
+
+    virtual std::vector<JetStreamMessage> fetch(size_t max_messages, std::chrono::milliseconds wait) = 0;
+    virtual bool ack_all(uint64_t stream_sequence) = 0;
+
+    // Requests issued so far (each fetch and each ack is one)
+    virtual uint64_t round_trips() const = 0;
+};
+
+/**
+ * JetStreamStandIn - In-process stream with durable pull consumers
+ *
+ * Enough JetStream for tests and throughput runs: subject-filtered durable
+ * consumers, AckAll, ack_wait redelivery and max_deliver. Retention is
+ * work-queue style: a message is dropped once every consumer has acked it.
+ * Thread-safe; fetch() blocks up to its wait for new messages.
+ */
+class JetStreamStandIn {
+public:
+    struct ConsumerInfo {
+        uint64_t delivered = 0;          // Highest stream sequence delivered
+        uint64_t ack_floor = 0;          // Every message up to here is acked
+        size_t ack_pending = 0;          // Delivered, not yet acked
+        uint64_t redelivered = 0;        // Redeliveries so far
+        uint64_t terminated = 0;         // Dropped after max_deliver
+    };
+
+    uint64_t publish(const std::string& subject, std::string data);
+
+    // Creates the durable on first use, binds to it afterwards
+    std::unique_ptr<PullConsumer> pull_consumer(const PullConsumerConfig& config);
+
+    uint64_t last_sequence() const;
+    size_t stored_messages() const;
+    ConsumerInfo consumer_info(const std::string& durable_name) const;
+
+    // Same as the free subject_matches (nats_client.hpp)
+    static bool subject_matches(const std::string& filter, const std::string& subject);
+
+private:
+    struct Pending {
+        std::chrono::steady_clock::time_point deadline;
+        uint32_t deliveries = 1;
+    };
+
+    struct Consumer {
+        PullConsumerConfig config;
+        ConsumerInfo info;
+        std::map<uint64_t, Pending> pending;   // stream sequence -> delivery state
+    };
+
+    class Handle;
+
+    mutable std::mutex mutex_;
+    std::condition_variable published_;
+    std::deque<JetStreamMessage> messages_;    // Ordered by stream sequence
+    uint64_t last_sequence_ = 0;
+    std::unordered_map<std::string, Consumer> consumers_;
+
+    std::vector<JetStreamMessage> fetch(const std::string& durable, size_t max_messages,
+                                        std::chrono::milliseconds wait);
+    bool ack_all(const std::string& durable, uint64_t stream_sequence);
+    void collect(Consumer& consumer, size_t max_messages, std::vector<JetStreamMessage>& out);
+    const JetStreamMessage* find(uint64_t stream_sequence) const;
+    void trim();
+};
+
+/**
+ * DurableQueueIngest - Feeds queue events from a pull consumer into QueueManager
+ *
+ * poll() fetches a batch and hands each event, decoded from the API's
+ * queue_enter/queue_leave JSON (decode_queue_event), to the handler
+ * (normally QueueManager::enqueue or dequeue plus logging), then records the batch's
+ * last sequence with QueueManager::checkpoint_ingest. The checkpoint rides
+ * in the same store batch as the enqueues, which the tick writes. commit(),
+ * called after the tick, acks the batch with one AckAll once nothing is
+ * left unwritten (immediately when there is no store).
+ *
+ * A crash between the store write and the ack leads to redelivery; events
+ * at or below the restored checkpoint are acked without being applied
+ * again, so a party is never re-queued after it was matched.
+ *
+ * An undecodable message is only acked once the dead-letter handler has
+ * taken it. Without a handler, or while it fails, ingest stops at that
+ * message: it and the rest of its batch are held and retried by the next
+ * poll(), which fetches nothing new, so the stream stalls visibly (ack lag,
+ * the malformed count) instead of losing events.
+ */
+class DurableQueueIngest {
+public:
+    struct Stats {
+        uint64_t fetched = 0;
+        uint64_t applied = 0;
+        uint64_t redelivered = 0;       // Fetched with deliveries > 1
+        uint64_t skipped = 0;           // Redelivered but already applied
+        uint64_t malformed = 0;         // Undecodable payloads seen (each delivery)
+        uint64_t dead_lettered = 0;     // Undecodable payloads handed to the dead-letter handler
+        uint64_t acks = 0;              // AckAll requests sent
+        uint64_t ack_failures = 0;
+    };
+
+    // Takes an undecodable message; true once it is stored elsewhere
+    using DeadLetterCallback = std::function<bool(const JetStreamMessage&)>;
+
+    DurableQueueIngest(PullConsumer& consumer, QueueManager& queue_manager,
+                       NatsClient::QueueEventCallback handler, size_t batch_size = 256);
+
+    void set_dead_letter(DeadLetterCallback dead_letter) { dead_letter_ = std::move(dead_letter); }
+
+    // Fetch (or retry held messages) and apply one batch; returns its size
+    size_t poll(std::chrono::milliseconds wait = std::chrono::milliseconds(0));
+
+    // Ack everything applied so far if the queue state holding it is durable
+    bool commit();
+
+    uint64_t applied_sequence() const { return applied_sequence_; }
+    uint64_t acked_sequence() const { return acked_sequence_; }
+    bool ack_pending() const { return handled_sequence_ > acked_sequence_; }
+    bool stalled() const { return !held_.empty(); }
+    const Stats& stats() const { return stats_; }
+
+private:
+    PullConsumer& consumer_;
+    QueueManager& queue_manager_;
+    NatsClient::QueueEventCallback handler_;
+    DeadLetterCallback dead_letter_;
+    size_t batch_size_;
+    uint64_t applied_sequence_;       // Highest sequence applied (the checkpoint)
+    uint64_t handled_sequence_ = 0;   // Highest sequence fetched and applied or skipped
+    uint64_t acked_sequence_ = 0;
+    std::vector<JetStreamMessage> held_;  // From an undecodable message not yet dead-lettered
+    Stats stats_;
+};
+
+} // namespace matchmaker
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace matchmaker {
+
+// Configuration for the columnar match export sink
+struct MatchExportConfig {
+    std::string directory = ".";
+    std::string file_prefix = "matches";
+    size_t rows_per_group = 65536;               // Party rows buffered per row group
+    size_t max_file_bytes = 256u * 1024 * 1024;  // Rotate once a file exceeds this
+    size_t io_buffer_bytes = 4u * 1024 * 1024;   // stdio buffer for sequential writes
+};
+
+/**
+ * MatchExporter - Appends formed matches to rotating columnar files
+ *
+ * One row is written per matched party. Rows are buffered column by column
+ * and flushed as a row group once rows_per_group is reached, so the tick
+ * path only appends to vectors. Column buffers use the Arrow layout
+ * (little-endian fixed width values; utf8 as int32 offsets + bytes) and can
+ * be wrapped by pyarrow without copying; see scripts/decode_match_export.py.
+ *
+ * File layout (.mmcol):
+ *   "MMCOL001"                                     8-byte magic
+ *   row group*:
+ *     u32 'RGRP', u32 row_count, u32 column_count
+ *     per column: u16 name_len, name, u8 type, u64 byte_len, payload
+ *       type 0 = int32, 1 = int64, 2 = float64, 3 = utf8
+ *   footer: u32 row_group_count, u64 row_count, "MMCOLEND"
+ *
+ * Files are written as <name>.mmcol.tmp and renamed when complete, so
+ * offline readers only ever see finished files.
+ */
+class MatchExporter {
+public:
+    explicit MatchExporter(const MatchExportConfig& config);
+    ~MatchExporter();
+
+    MatchExporter(const MatchExporter&) = delete;
+    MatchExporter& operator=(const MatchExporter&) = delete;
+
+    void append(const MatchResult& match);
+
+    // Write buffered rows as a row group (no-op when empty)
+    void flush();
+
+    // Flush, finish the current file and start a new one on next append
+    void rotate();
+
+    // Stats
+    uint64_t rows_written() const { return rows_written_; }
+    uint64_t rows_dropped() const { return rows_dropped_; }
+    size_t files_completed() const { return files_completed_; }
+
+private:
+    struct StringColumn {
+        std::vector<int32_t> offsets{0};
+        std::string data;
+
+        void push(const std::string& value) {
+            data += value;
+            offsets.push_back(static_cast<int32_t>(data.size()));
+        }
+        void clear() {
+            offsets.assign(1, 0);
+            data.clear();
+        }
+    };
+
+    MatchExportConfig config_;
+    std::FILE* file_ = nullptr;
+    std::vector<char> io_buffer_;
+    std::string file_path_;
+    size_t file_bytes_ = 0;
+    uint32_t file_row_groups_ = 0;
+    uint64_t file_rows_ = 0;
+    uint64_t rows_written_ = 0;
+    uint64_t rows_dropped_ = 0;
+    size_t files_completed_ = 0;
+    uint64_t file_sequence_ = 0;
+
+    // Column buffers for the pending row group
+    size_t pending_rows_ = 0;
+    std::vector<int64_t> formed_at_ms_;
+    StringColumn match_id_;
+    StringColumn region_;
+    StringColumn mode_;
+    std::vector<int32_t> team_size_;
+    StringColumn party_id_;
+    std::vector<int32_t> party_mmr_;
+    std::vector<int64_t> wait_ms_;
+    std::vector<int32_t> mmr_band_;
+    std::vector<int32_t> match_avg_mmr_;
+    std::vector<int32_t> mmr_variance_;
+    std::vector<double> quality_score_;
+
+    void clear_pending();
+    bool open_file();
+    void close_file();
+    void write_bytes(const void* data, size_t size);
+    template <typename T>
+    void write_column(const char* name, uint8_t type, const std::vector<T>& values);
+    void write_column(const char* name, const StringColumn& values);
+};
+
+} // namespace matchmaker
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include <string>
+#include <string_view>
+
+namespace matchmaker {
+
+/**
+ * Schema-specific JSON writer for match.found payloads
+ *
+ * Emits the fields consumed by the API's handle_match_found (match_id,
+ * region, mode, team_size, teams, party_ids, avg_mmr, mmr_variance,
+ * quality_score) straight into a byte buffer, without building a DOM.
+ * Strings are escaped per RFC 8259 (control characters, '"' and '\\');
+ * UTF-8 is passed through. The scan for characters needing escapes runs
+ * 16 bytes at a time with SSE2 where available.
+ */
+
+// Append the payload to out (out is not cleared)
+void write_match_found(std::string& out, const MatchResult& match);
+
+/**
+ * Serialize into a reusable per-thread buffer. The returned view stays
+ * valid until the next call on the same thread.
+ */
+std::string_view serialize_match_found(const MatchResult& match);
+
+// backfill.result payload: match_id, region, mode, team_size, party_ids,
+// players (parallel to party_ids), open_slots, expired, latency_ms
+void write_backfill_result(std::string& out, const BackfillResult& result);
+std::string_view serialize_backfill_result(const BackfillResult& result);
+
+// queue.positions payload: bucket, queued, positions as [party_id, position]
+// pairs (only parties whose position changed)
+void write_queue_positions(std::string& out, const QueuePositionUpdate& update);
+std::string_view serialize_queue_positions(const QueuePositionUpdate& update);
+
+// Append s as a quoted, escaped JSON string
+void append_json_string(std::string& out, std::string_view s);
+
+} // namespace matchmaker
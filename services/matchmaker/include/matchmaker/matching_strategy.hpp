@@ -0,0 +1,154 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace matchmaker {
+
+/**
+ * MatchingStrategy - Pluggable match formation for a single bucket
+ *
+ * Strategies are stateless and may be shared between buckets and threads.
+ * form_matches may reorder entries but must not add or remove any; the
+ * caller removes matched parties and assigns match_id/region/mode/team_size.
+ */
+class MatchingStrategy {
+public:
+    virtual ~MatchingStrategy() = default;
+
+    virtual std::string name() const = 0;
+
+    virtual std::vector<MatchResult> form_matches(
+        const QueueBucket& bucket,
+        std::vector<QueueEntry>& entries,
+        const QueueConfig& config,
+        std::chrono::system_clock::time_point now
+    ) const = 0;
+};
+
+/**
+ * WaitOrderStrategy - The original whole-bucket greedy algorithm
+ *
+ * Sorts the bucket by wait time and repeatedly calls TeamBuilder::try_form_match
+ * with the longest-waiting party's band until it fails or quality drops
+ * below the threshold. Kept as a baseline for shadow comparisons.
+ */
+class WaitOrderStrategy : public MatchingStrategy {
+public:
+    std::string name() const override { return "wait_order"; }
+
+    std::vector<MatchResult> form_matches(
+        const QueueBucket& bucket,
+        std::vector<QueueEntry>& entries,
+        const QueueConfig& config,
+        std::chrono::system_clock::time_point now
+    ) const override;
+};
+
+// Cumulative outcome of one strategy on one bucket
+struct StrategyStats {
+    uint64_t ticks = 0;
+    uint64_t total_tick_ns = 0;
+    uint64_t matches = 0;
+    uint64_t parties_matched = 0;
+    double quality_sum = 0.0;
+    double wait_sec_sum = 0.0;      // Summed over matched parties
+
+    double avg_tick_us() const { return ticks ? total_tick_ns / 1000.0 / ticks : 0.0; }
+    double avg_quality() const { return matches ? quality_sum / matches : 0.0; }
+    double avg_wait_sec() const { return parties_matched ? wait_sec_sum / parties_matched : 0.0; }
+};
+
+// Live strategy vs. shadow candidate on the same tick inputs
+struct ShadowComparison {
+    std::string live_strategy;
+    std::string shadow_strategy;
+    StrategyStats live;
+    StrategyStats shadow;
+    uint64_t dropped_ticks = 0;     // Skipped because the evaluator was behind
+};
+
+/**
+ * ShadowEvaluator - Runs candidate strategies off the tick thread
+ *
+ * Each submitted job carries a snapshot of a bucket's tick input and the
+ * live outcome. A single background worker runs the candidate on the
+ * snapshot, discards its matches and accumulates both sides' stats. The
+ * tick claims a job slot with reserve() before copying anything; when the
+ * worker is behind the tick is dropped without a copy, so the live tick
+ * never waits on it. Snapshot buffers are recycled between jobs.
+ *
+ * The live path only re-tries what changed, but the candidate sees the
+ * whole queue every tick. Parties the candidate has matched are therefore
+ * withheld from its later snapshots, as if its matches had been published,
+ * so it is not credited again for the same parties (with an ever longer
+ * wait). Parties the live strategy matched still leave both sides'
+ * queues, so on a busy bucket the candidate's queue is shaped by the live
+ * strategy's choices.
+ */
+class ShadowEvaluator {
+public:
+    struct Job {
+        QueueBucket bucket;
+        std::shared_ptr<const MatchingStrategy> strategy;
+        std::string live_strategy;
+        QueueConfig config;
+        std::chrono::system_clock::time_point now;
+        std::vector<QueueEntry> snapshot;
+        std::vector<MatchResult> live_matches;
+        uint64_t live_tick_ns = 0;
+    };
+
+    explicit ShadowEvaluator(size_t max_pending = 4);
+    ~ShadowEvaluator();
+
+    ShadowEvaluator(const ShadowEvaluator&) = delete;
+    ShadowEvaluator& operator=(const ShadowEvaluator&) = delete;
+
+    /**
+     * Claims a slot for a job on bucket. Returns false, counting a dropped
+     * tick, when the worker is behind; otherwise hands out a recycled
+     * snapshot buffer and the caller must submit() the job.
+     */
+    bool reserve(const QueueBucket& bucket, std::vector<QueueEntry>& snapshot);
+    void submit(Job job);
+
+    // Block until every accepted job has been evaluated
+    void flush();
+
+    std::unordered_map<std::string, ShadowComparison> get_comparisons() const;
+
+private:
+    size_t max_pending_;
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Job> jobs_;
+    size_t reserved_ = 0;                   // Slots claimed but not yet submitted
+    std::vector<std::vector<QueueEntry>> spare_snapshots_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    std::unordered_map<std::string, ShadowComparison> comparisons_;
+
+    // Parties the candidate matched and that are still queued, per bucket
+    // (worker thread only)
+    std::unordered_map<std::string, std::unordered_set<std::string>> withheld_;
+    std::thread worker_;
+
+    void run();
+    static void accumulate(StrategyStats& stats, const std::vector<MatchResult>& matches,
+                           const std::unordered_map<std::string, std::chrono::system_clock::time_point>& enqueued_at,
+                           std::chrono::system_clock::time_point now, uint64_t tick_ns);
+};
+
+} // namespace matchmaker
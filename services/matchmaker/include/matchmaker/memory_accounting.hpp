@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace matchmaker {
+
+/**
+ * MemoryAccount - Running byte/allocation count for one owner
+ *
+ * Not synchronized; each account belongs to the thread driving its owner.
+ */
+struct MemoryAccount {
+    int64_t bytes = 0;
+    int64_t allocations = 0;
+
+    void charge(size_t n) { bytes += static_cast<int64_t>(n); allocations++; }
+    void release(size_t n) { bytes -= static_cast<int64_t>(n); allocations--; }
+};
+
+/**
+ * AccountingAllocator - std::allocator that charges a MemoryAccount
+ *
+ * Rebinds (node and bucket-array allocations of node containers) charge
+ * the same account, so a container's whole footprint is visible.
+ */
+template <typename T>
+class AccountingAllocator {
+public:
+    using value_type = T;
+
+    explicit AccountingAllocator(MemoryAccount* account) noexcept : account_(account) {}
+
+    template <typename U>
+    AccountingAllocator(const AccountingAllocator<U>& other) noexcept : account_(other.account()) {}
+
+    T* allocate(size_t n) {
+        T* p = std::allocator<T>{}.allocate(n);
+        account_->charge(n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        account_->release(n * sizeof(T));
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    MemoryAccount* account() const noexcept { return account_; }
+
+    template <typename U>
+    bool operator==(const AccountingAllocator<U>& other) const noexcept { return account_ == other.account(); }
+    template <typename U>
+    bool operator!=(const AccountingAllocator<U>& other) const noexcept { return account_ != other.account(); }
+
+private:
+    MemoryAccount* account_;
+};
+
+// Heap bytes owned by a string (0 while it fits the small-string buffer)
+inline size_t string_heap_bytes(const std::string& s) {
+    static const size_t kInlineCapacity = std::string().capacity();
+    return s.capacity() > kInlineCapacity ? s.capacity() + 1 : 0;
+}
+
+// Memory held by one queue bucket
+struct BucketMemory {
+    size_t parties = 0;
+    int64_t entry_bytes = 0;        // Entry vector capacity + non-ID strings
+    int64_t id_bytes = 0;           // Party and player ID string data
+    int64_t graph_bytes = 0;        // CompatibilityGraph estimate (team buckets)
+
+    int64_t total() const { return entry_bytes + id_bytes + graph_bytes; }
+};
+
+// QueueManager memory snapshot
+struct MemoryStats {
+    int64_t party_index_bytes = 0;      // party_id -> bucket map and MMR index (allocator-counted)
+    int64_t party_index_allocations = 0;
+    int64_t id_arena_bytes = 0;         // All party/player ID string data
+    int64_t bucket_bytes = 0;           // Sum of bucket entry_bytes
+    int64_t graph_bytes = 0;            // Sum of bucket graph_bytes
+    int64_t freelist_bytes = 0;         // Entry storage of evicted buckets kept for reuse
+    int64_t budget_bytes = 0;           // 0 = unlimited
+    uint64_t admission_rejections = 0;
+    std::map<std::string, BucketMemory> buckets;
+
+    int64_t total() const { return party_index_bytes + id_arena_bytes + bucket_bytes + graph_bytes + freelist_bytes; }
+};
+
+} // namespace matchmaker
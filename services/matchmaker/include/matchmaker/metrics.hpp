@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace matchmaker {
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+// Fixed-bound histogram, observed by its owner and published with set_histogram
+struct Histogram {
+    std::vector<double> bounds;       // Upper bounds, ascending (+Inf implied)
+    std::vector<uint64_t> counts;     // Per bound plus an overflow slot (not cumulative)
+    double sum = 0;
+    uint64_t count = 0;
+
+    explicit Histogram(std::vector<double> upper_bounds = {})
+        : bounds(std::move(upper_bounds)), counts(bounds.size() + 1, 0) {}
+
+    void observe(double value) {
+        size_t slot = 0;
+        while (slot < bounds.size() && value > bounds[slot]) {
+            slot++;
+        }
+        counts[slot]++;
+        sum += value;
+        count++;
+    }
+};
+
+/**
+ * MetricsRegistry - Gauges and counters in Prometheus text format
+ *
+ * The tick thread sets values (typically once per stats interval); the
+ * metrics server renders them on scrape. Counters are set to their
+ * cumulative value rather than incremented, so the owner stays the
+ * source of truth.
+ */
+class MetricsRegistry {
+public:
+    enum class Type { Gauge, Counter, Histogram };
+
+    void describe(const std::string& name, Type type, const std::string& help);
+    void set(const std::string& name, double value, const MetricLabels& labels = {});
+    void set_histogram(const std::string& name, const Histogram& histogram, const MetricLabels& labels = {});
+
+    // Drop every series of a family, e.g. before re-publishing per-bucket values
+    void clear(const std::string& name);
+
+    // Text exposition format 0.0.4
+    std::string render() const;
+
+private:
+    struct Family {
+        Type type = Type::Gauge;
+        std::string help;
+        std::map<std::string, double> series;   // Rendered label set -> value
+        std::map<std::string, std::pair<MetricLabels, Histogram>> histograms;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Family> families_;
+};
+
+/**
+ * MetricsServer - Minimal HTTP endpoint serving GET /metrics
+ *
+ * One background thread, one connection at a time; enough for a
+ * Prometheus scraper. Port 0 binds an ephemeral port (see port()).
+ */
+class MetricsServer {
+public:
+    MetricsServer(const MetricsRegistry& registry, int port);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    bool listening() const { return listen_fd_ >= 0; }
+    int port() const { return port_; }
+
+private:
+    const MetricsRegistry& registry_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread worker_;
+
+    void run();
+    void serve(int client_fd);
+};
+
+} // namespace matchmaker
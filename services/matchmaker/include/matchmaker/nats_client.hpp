@@ -1,12 +1,46 @@
 #pragma once
 
 #include "queue_manager.hpp"
+#include "queue_events.hpp"
+#include "match_serializer.hpp"
 #include <string>
+#include <string_view>
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace matchmaker {
 
+// NATS subject match: '*' is one token, '>' the remaining tokens
+inline bool subject_matches(std::string_view filter, std::string_view subject) {
+    if (filter.empty()) {
+        return true;
+    }
+    size_t f = 0;
+    size_t s = 0;
+    while (f < filter.size() && s < subject.size()) {
+        size_t f_end = filter.find('.', f);
+        size_t s_end = subject.find('.', s);
+        if (f_end == std::string_view::npos) {
+            f_end = filter.size();
+        }
+        if (s_end == std::string_view::npos) {
+            s_end = subject.size();
+        }
+        std::string_view token = filter.substr(f, f_end - f);
+        if (token == ">") {
+            return true;
+        }
+        if (token != "*" && token != subject.substr(s, s_end - s)) {
+            return false;
+        }
+        f = f_end + 1;
+        s = s_end + 1;
+    }
+    return f >= filter.size() && s >= subject.size();
+}
+
 /**
  * NATS Client - Simplified wrapper for pub/sub messaging
  *
@@ -15,12 +49,15 @@ namespace matchmaker {
  */
 class NatsClient {
 public:
-    using QueueEventCallback = std::function<void(const QueueEntry&)>;
+    using QueueEventCallback = std::function<void(const QueueEvent&)>;
     using DequeueEventCallback = std::function<void(const std::string& party_id)>;
+    using BackfillRequestCallback = std::function<void(const BackfillRequest&)>;
 
     virtual ~NatsClient() = default;
 
-    // Subscribe to queue events
+    // Subscribe to queue events (enter and leave, decoded from the API's JSON).
+    // Each subscription gets every message on a matching subject, so
+    // tenants can subscribe to their own subjects on one client.
     virtual bool subscribe_queue_events(
         const std::string& subject,
         QueueEventCallback callback
@@ -29,6 +66,16 @@ public:
     // Publish match found event
     virtual bool publish_match_found(const MatchResult& match) = 0;
 
+    // Backfill requests from game servers, and the parties assigned to them
+    virtual bool subscribe_backfill_requests(
+        const std::string& subject,
+        BackfillRequestCallback callback
+    ) = 0;
+    virtual bool publish_backfill_result(const BackfillResult& result) = 0;
+
+    // Changed queue positions, so the API can push them to waiting clients
+    virtual bool publish_queue_positions(const QueuePositionUpdate& update) = 0;
+
     // Connection management
     virtual bool connect(const std::string& url) = 0;
     virtual void disconnect() = 0;
@@ -37,23 +84,53 @@ public:
 
 /**
  * Mock NATS client for testing (no actual network connection)
+ *
+ * Queue subscriptions are kept per subject filter, and simulated messages
+ * go to every subscription whose filter matches, as on a NATS server.
  */
 class MockNatsClient : public NatsClient {
 public:
     bool subscribe_queue_events(
-        const std::string& /*subject*/,
+        const std::string& subject,
         QueueEventCallback callback
     ) override {
-        queue_callback_ = callback;
+        for (auto& [filter, existing] : queue_subscriptions_) {
+            if (filter == subject) {
+                existing = std::move(callback);
+                return true;
+            }
+        }
+        queue_subscriptions_.emplace_back(subject, std::move(callback));
         return true;
     }
 
     bool publish_match_found(const MatchResult& match) override {
         last_match_ = match;
+        last_payload_ = serialize_match_found(match);
         match_count_++;
         return true;
     }
 
+    bool subscribe_backfill_requests(
+        const std::string& /*subject*/,
+        BackfillRequestCallback callback
+    ) override {
+        backfill_callback_ = callback;
+        return true;
+    }
+
+    bool publish_backfill_result(const BackfillResult& result) override {
+        last_backfill_payload_ = serialize_backfill_result(result);
+        backfill_result_count_++;
+        return true;
+    }
+
+    bool publish_queue_positions(const QueuePositionUpdate& update) override {
+        last_positions_payload_ = serialize_queue_positions(update);
+        positions_count_++;
+        return true;
+    }
+
     bool connect(const std::string& /*url*/) override {
         connected_ = true;
         return true;
@@ -68,20 +145,50 @@ public:
     }
 
     // Test helpers
-    void simulate_queue_event(const QueueEntry& entry) {
-        if (queue_callback_) {
-            queue_callback_(entry);
+    void simulate_queue_event(std::string_view subject, const QueueEvent& event) {
+        for (const auto& [filter, callback] : queue_subscriptions_) {
+            if (subject_matches(filter, subject)) {
+                callback(event);
+            }
+        }
+    }
+
+    // What a subscription does with each message: decode the API's event
+    // (trace context included) and deliver it. False if undecodable.
+    bool simulate_queue_message(std::string_view subject, std::string_view payload) {
+        auto event = decode_queue_event(payload);
+        if (!event) {
+            return false;
+        }
+        simulate_queue_event(subject, *event);
+        return true;
+    }
+
+    void simulate_backfill_request(const BackfillRequest& request) {
+        if (backfill_callback_) {
+            backfill_callback_(request);
         }
     }
 
     const MatchResult& get_last_match() const { return last_match_; }
+    const std::string& get_last_payload() const { return last_payload_; }
     size_t get_match_count() const { return match_count_; }
+    const std::string& get_last_backfill_payload() const { return last_backfill_payload_; }
+    size_t get_backfill_result_count() const { return backfill_result_count_; }
+    const std::string& get_last_positions_payload() const { return last_positions_payload_; }
+    size_t get_positions_count() const { return positions_count_; }
 
 private:
     bool connected_ = false;
-    QueueEventCallback queue_callback_;
+    std::vector<std::pair<std::string, QueueEventCallback>> queue_subscriptions_;   // filter -> callback
     MatchResult last_match_;
+    std::string last_payload_;
     size_t match_count_ = 0;
+    BackfillRequestCallback backfill_callback_;
+    std::string last_backfill_payload_;
+    size_t backfill_result_count_ = 0;
+    std::string last_positions_payload_;
+    size_t positions_count_ = 0;
 };
 
 /**
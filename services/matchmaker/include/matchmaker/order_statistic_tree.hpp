@@ -0,0 +1,205 @@
+#pragma once
+
+#include "memory_accounting.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace matchmaker {
+
+/**
+ * OrderStatisticTree - Ordered set of (value, tiebreak) keys with
+ * subtree sizes, so rank and range counts are O(log n)
+ *
+ * A treap over an index-addressed node pool: nodes are 32-bit links into
+ * one vector (recycled through a free list), so the tree costs one
+ * allocation per growth step rather than one per key. Keys must be unique;
+ * the tiebreak (e.g. an enqueue sequence number) separates equal values.
+ * Each key carries a Payload returned by for_each in key order.
+ *
+ * Node storage is charged to the given MemoryAccount.
+ */
+template <typename Payload>
+class OrderStatisticTree {
+public:
+    struct Key {
+        int64_t value = 0;
+        uint64_t tiebreak = 0;
+
+        bool operator<(const Key& other) const {
+            return value != other.value ? value < other.value : tiebreak < other.tiebreak;
+        }
+    };
+
+    explicit OrderStatisticTree(MemoryAccount* account)
+        : nodes_(1, Node{}, NodeAllocator(account)),
+          free_(FreeAllocator(account)) {}
+
+    void insert(Key key, Payload payload) {
+        uint32_t node = allocate(key, payload);
+        auto [less, rest] = split(root_, key);
+        root_ = merge(merge(less, node), rest);
+    }
+
+    // False if key is not present
+    bool erase(Key key) {
+        auto [less, rest] = split(root_, key);
+        uint32_t first = rest;
+        while (first != 0 && nodes_[first].left != 0) {
+            first = nodes_[first].left;
+        }
+        bool found = first != 0 && !(key < nodes_[first].key) && !(nodes_[first].key < key);
+        if (found) {
+            rest = erase_min(rest);
+            free_.push_back(first);
+        }
+        root_ = merge(less, rest);
+        return found;
+    }
+
+    // Keys strictly less than key
+    size_t rank(Key key) const {
+        size_t below = 0;
+        for (uint32_t node = root_; node != 0;) {
+            const Node& n = nodes_[node];
+            if (n.key < key) {
+                below += size(n.left) + 1;
+                node = n.right;
+            } else {
+                node = n.left;
+            }
+        }
+        return below;
+    }
+
+    // Keys whose value lies in [lo, hi]
+    size_t count_between(int64_t lo, int64_t hi) const {
+        if (hi < lo) {
+            return 0;
+        }
+        size_t upper = hi == std::numeric_limits<int64_t>::max()
+            ? size() : rank({hi + 1, 0});
+        return upper - rank({lo, 0});
+    }
+
+    size_t size() const { return size(root_); }
+    bool empty() const { return root_ == 0; }
+
+    // Smallest key and its payload; the tree must not be empty
+    std::pair<Key, Payload> front() const {
+        uint32_t node = root_;
+        while (nodes_[node].left != 0) {
+            node = nodes_[node].left;
+        }
+        return {nodes_[node].key, nodes_[node].payload};
+    }
+
+    // fn(rank, payload) for every key, in key order
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        std::vector<uint32_t> stack;
+        size_t position = 0;
+        uint32_t node = root_;
+        while (node != 0 || !stack.empty()) {
+            while (node != 0) {
+                stack.push_back(node);
+                node = nodes_[node].left;
+            }
+            node = stack.back();
+            stack.pop_back();
+            fn(position++, nodes_[node].payload);
+            node = nodes_[node].right;
+        }
+    }
+
+private:
+    struct Node {
+        Key key;
+        Payload payload{};
+        uint32_t priority = 0;
+        uint32_t size = 0;
+        uint32_t left = 0;      // 0 = none (node 0 is a sentinel)
+        uint32_t right = 0;
+    };
+
+    using NodeAllocator = AccountingAllocator<Node>;
+    using FreeAllocator = AccountingAllocator<uint32_t>;
+
+    std::vector<Node, NodeAllocator> nodes_;
+    std::vector<uint32_t, FreeAllocator> free_;
+    uint32_t root_ = 0;
+    uint32_t seed_ = 0x9e3779b9u;
+
+    uint32_t size(uint32_t node) const { return nodes_[node].size; }
+
+    uint32_t next_priority() {
+        // xorshift32: only needs to be independent of key order
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 17;
+        seed_ ^= seed_ << 5;
+        return seed_;
+    }
+
+    uint32_t allocate(Key key, Payload payload) {
+        uint32_t node;
+        if (!free_.empty()) {
+            node = free_.back();
+            free_.pop_back();
+        } else {
+            node = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        nodes_[node] = Node{key, payload, next_priority(), 1, 0, 0};
+        return node;
+    }
+
+    void update(uint32_t node) {
+        Node& n = nodes_[node];
+        n.size = size(n.left) + size(n.right) + 1;
+    }
+
+    // (keys < key, keys >= key)
+    std::pair<uint32_t, uint32_t> split(uint32_t node, Key key) {
+        if (node == 0) {
+            return {0, 0};
+        }
+        if (nodes_[node].key < key) {
+            auto [less, rest] = split(nodes_[node].right, key);
+            nodes_[node].right = less;
+            update(node);
+            return {node, rest};
+        }
+        auto [less, rest] = split(nodes_[node].left, key);
+        nodes_[node].left = rest;
+        update(node);
+        return {less, node};
+    }
+
+    // Every key of a precedes every key of b
+    uint32_t merge(uint32_t a, uint32_t b) {
+        if (a == 0 || b == 0) {
+            return a != 0 ? a : b;
+        }
+        if (nodes_[a].priority > nodes_[b].priority) {
+            nodes_[a].right = merge(nodes_[a].right, b);
+            update(a);
+            return a;
+        }
+        nodes_[b].left = merge(a, nodes_[b].left);
+        update(b);
+        return b;
+    }
+
+    uint32_t erase_min(uint32_t node) {
+        if (nodes_[node].left == 0) {
+            return nodes_[node].right;
+        }
+        nodes_[node].left = erase_min(nodes_[node].left);
+        update(node);
+        return node;
+    }
+};
+
+} // namespace matchmaker
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "memory_accounting.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace matchmaker {
+
+// Party id hash used by the party index (never 0, so 0 can mean "not computed")
+inline uint64_t hash_party_id(std::string_view party_id) {
+    uint64_t hash = std::hash<std::string_view>{}(party_id);
+    return hash != 0 ? hash : 1;
+}
+
+/**
+ * FlatPartyIndex - Open-addressing party_id -> Value table
+ *
+ * Slots are 8 bytes (low 32 hash bits + record number) in one power-of-two
+ * array, probed linearly with Robin Hood ordering, so a miss stops as soon
+ * as it passes a slot closer to its home than the probe. Erase shifts the
+ * following run back by one (no tombstones), keeping probes short under
+ * churn. Growth rehashes from the stored hash bits without touching keys.
+ *
+ * Records (key, full hash, value) live in chunks that double in size (16,
+ * 32, 64, ...) and are recycled through a free list, so a record never
+ * moves while its key is in the table: pointers to it and to its key stay
+ * valid until erase.
+ * Lookups take a string_view plus an optional precomputed hash, so callers
+ * holding raw message bytes do not build a std::string.
+ *
+ * Slot arrays and record chunks are charged to the given MemoryAccount.
+ */
+template <typename Value>
+class FlatPartyIndex {
+public:
+    struct Record {
+        std::string key;
+        uint64_t hash = 0;
+        uint32_t number = 0;
+        Value value{};
+    };
+
+    explicit FlatPartyIndex(MemoryAccount* account)
+        : account_(account),
+          slots_(SlotAllocator(account)),
+          free_(FreeAllocator(account)) {}
+
+    ~FlatPartyIndex() {
+        for (size_t c = 0; c < chunks_.size(); ++c) {
+            for (size_t i = 0; i < chunk_records(c); ++i) {
+                chunks_[c][i].~Record();
+            }
+            RecordAllocator(account_).deallocate(chunks_[c], chunk_records(c));
+        }
+    }
+
+    FlatPartyIndex(const FlatPartyIndex&) = delete;
+    FlatPartyIndex& operator=(const FlatPartyIndex&) = delete;
+
+    Record* find(std::string_view key, uint64_t hash) const {
+        if (slots_.empty()) {
+            return nullptr;
+        }
+        const uint32_t tag = static_cast<uint32_t>(hash);
+        const size_t mask = slots_.size() - 1;
+        size_t pos = tag & mask;
+        for (size_t distance = 0;; ++distance, pos = (pos + 1) & mask) {
+            const Slot& slot = slots_[pos];
+            if (slot.record == 0 || probe_distance(pos, slot) < distance) {
+                return nullptr;
+            }
+            if (slot.tag == tag) {
+                Record& record = record_at(slot.record - 1);
+                if (record.hash == hash && record.key == key) {
+                    return &record;
+                }
+            }
+        }
+    }
+
+    Record* find(std::string_view key) const { return find(key, hash_party_id(key)); }
+
+    // Record for key, created with a default value if absent (second = created)
+    std::pair<Record*, bool> try_emplace(std::string_view key, uint64_t hash) {
+        if (Record* existing = find(key, hash)) {
+            return {existing, false};
+        }
+        if ((size_ + 1) * kMaxLoadDenominator > slots_.size() * kMaxLoadNumerator) {
+            rehash(slots_.empty() ? kMinSlots : slots_.size() * 2);
+        }
+        Record& record = allocate_record();
+        record.key.assign(key.data(), key.size());
+        record.hash = hash;
+        place({static_cast<uint32_t>(hash), record.number + 1});
+        size_++;
+        return {&record, true};
+    }
+
+    void erase(Record* record) {
+        const size_t mask = slots_.size() - 1;
+        size_t pos = static_cast<uint32_t>(record->hash) & mask;
+        while (slots_[pos].record != record->number + 1) {
+            pos = (pos + 1) & mask;
+        }
+        // Backward shift: pull the rest of the run one step towards home
+        for (size_t next = (pos + 1) & mask;
+             slots_[next].record != 0 && probe_distance(next, slots_[next]) > 0;
+             next = (next + 1) & mask) {
+            slots_[pos] = slots_[next];
+            pos = next;
+        }
+        slots_[pos] = Slot{};
+
+        record->key = std::string();
+        record->hash = 0;
+        record->value = Value{};
+        free_.push_back(record->number);
+        size_--;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t slot_count() const { return slots_.size(); }
+
+    // Bytes a new key's insert would allocate (slot array growth, new chunk)
+    size_t insert_growth_bytes() const {
+        size_t bytes = 0;
+        if ((size_ + 1) * kMaxLoadDenominator > slots_.size() * kMaxLoadNumerator) {
+            bytes += (slots_.empty() ? kMinSlots : slots_.size() * 2) * sizeof(Slot);
+        }
+        if (free_.empty() && records_used_ == records_capacity_) {
+            bytes += chunk_records(chunks_.size()) * sizeof(Record);
+        }
+        return bytes;
+    }
+
+private:
+    struct Slot {
+        uint32_t tag = 0;           // Low 32 bits of the hash
+        uint32_t record = 0;        // Record number + 1; 0 = empty
+    };
+
+    using SlotAllocator = AccountingAllocator<Slot>;
+    using FreeAllocator = AccountingAllocator<uint32_t>;
+    using RecordAllocator = AccountingAllocator<Record>;
+
+    static constexpr size_t kFirstChunkShift = 4;
+    static constexpr size_t kFirstChunkRecords = size_t{1} << kFirstChunkShift;
+    static constexpr size_t kMinSlots = 16;
+    static constexpr size_t kMaxLoadNumerator = 7;      // Grow past 7/8 full
+    static constexpr size_t kMaxLoadDenominator = 8;
+
+    MemoryAccount* account_;
+    std::vector<Slot, SlotAllocator> slots_;
+    std::vector<Record*> chunks_;
+    std::vector<uint32_t, FreeAllocator> free_;
+    size_t records_used_ = 0;       // Records ever handed out (free ones included)
+    size_t records_capacity_ = 0;   // Records in all chunks
+    size_t size_ = 0;
+
+    size_t probe_distance(size_t pos, const Slot& slot) const {
+        return (pos - (slot.tag & (slots_.size() - 1))) & (slots_.size() - 1);
+    }
+
+    static size_t chunk_records(size_t chunk) { return kFirstChunkRecords << chunk; }
+
+    // Chunk c holds records [16 * (2^c - 1), 16 * (2^(c+1) - 1))
+    Record& record_at(uint32_t number) const {
+        size_t biased = size_t{number} + kFirstChunkRecords;
+        size_t chunk = static_cast<size_t>(std::bit_width(biased >> kFirstChunkShift)) - 1;
+        return chunks_[chunk][biased - chunk_records(chunk)];
+    }
+
+    Record& allocate_record() {
+        if (!free_.empty()) {
+            uint32_t number = free_.back();
+            free_.pop_back();
+            return record_at(number);
+        }
+        if (records_used_ == records_capacity_) {
+            size_t count = chunk_records(chunks_.size());
+            Record* chunk = RecordAllocator(account_).allocate(count);
+            for (size_t i = 0; i < count; ++i) {
+                new (&chunk[i]) Record();
+                chunk[i].number = static_cast<uint32_t>(records_capacity_ + i);
+            }
+            chunks_.push_back(chunk);
+            records_capacity_ += count;
+        }
+        return record_at(static_cast<uint32_t>(records_used_++));
+    }
+
+    // Robin Hood insert: take the slot of any entry closer to its home
+    void place(Slot incoming) {
+        const size_t mask = slots_.size() - 1;
+        size_t pos = incoming.tag & mask;
+        for (size_t distance = 0;; ++distance, pos = (pos + 1) & mask) {
+            Slot& slot = slots_[pos];
+            if (slot.record == 0) {
+                slot = incoming;
+                return;
+            }
+            size_t resident = probe_distance(pos, slot);
+            if (resident < distance) {
+                std::swap(slot, incoming);
+                distance = resident;
+            }
+        }
+    }
+
+    void rehash(size_t slot_count) {
+        std::vector<Slot, SlotAllocator> old(slot_count, Slot{}, SlotAllocator(account_));
+        old.swap(slots_);
+        for (const Slot& slot : old) {
+            if (slot.record != 0) {
+                place(slot);
+            }
+        }
+    }
+};
+
+} // namespace matchmaker
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace matchmaker {
+
+// Matchmaking parameters for one bucket
+struct BucketPolicy {
+    int mmr_band_initial = 100;
+    int mmr_band_max = 500;
+    int mmr_band_growth_per_sec = 10;
+    int max_wait_time_sec = 120;
+    double min_match_quality = 0.6;
+    int tick_interval_ms = 0;             // Match at most this often (0 = every tick)
+    LaneWeights lane_weights = kDefaultLaneWeights;
+
+    static BucketPolicy from_config(const QueueConfig& config);
+
+    // QueueConfig carrying only these parameters (for graphs and strategies)
+    QueueConfig to_config() const;
+
+    bool operator==(const BucketPolicy& other) const = default;
+};
+
+/**
+ * PolicySet - Immutable per-bucket policy table
+ *
+ * Rules are matched in file order; the first rule whose region, mode and
+ * team_size all match (empty / 0 = any) wins, otherwise the default
+ * applies. Rule fields left out inherit the default's value (lane_weights
+ * per lane).
+ *
+ * File format (JSON):
+ *   {
+ *     "default": {"mmr_band_initial": 100, "mmr_band_max": 500,
+ *                 "mmr_band_growth_per_sec": 10, "max_wait_time_sec": 120,
+ *                 "min_match_quality": 0.6, "tick_interval_ms": 200,
+ *                 "lane_weights": {"normal": 1, "requeue": 2, "backfill": 2, "vip": 4}},
+ *     "buckets": [
+ *       {"region": "eu-west", "mode": "ranked", "mmr_band_growth_per_sec": 25}
+ *     ]
+ *   }
+ */
+class PolicySet {
+public:
+    struct Rule {
+        std::string region;
+        std::string mode;
+        int team_size = 0;
+        BucketPolicy policy;
+
+        bool matches(const QueueBucket& bucket) const;
+    };
+
+    explicit PolicySet(BucketPolicy default_policy = {}, std::vector<Rule> rules = {});
+
+    const BucketPolicy& resolve(const QueueBucket& bucket) const;
+    const BucketPolicy& default_policy() const { return default_policy_; }
+    const std::vector<Rule>& rules() const { return rules_; }
+
+    // Smallest non-zero tick_interval_ms across the table (0 if none)
+    int min_tick_interval_ms() const;
+
+    // Parse/validate; nullptr with *error set on failure
+    static std::unique_ptr<PolicySet> parse(const std::string& text, std::string* error = nullptr);
+    static std::unique_ptr<PolicySet> load(const std::string& path, std::string* error = nullptr);
+
+private:
+    BucketPolicy default_policy_;
+    std::vector<Rule> rules_;
+};
+
+/**
+ * PolicyWatcher - Reloads a policy file when it changes
+ *
+ * Polls the file's modification time and size on a background thread. A
+ * file that fails to parse or validate is logged and skipped, so the
+ * running policy stays in force until a valid version is written.
+ */
+class PolicyWatcher {
+public:
+    using Callback = std::function<void(std::unique_ptr<const PolicySet>)>;
+
+    PolicyWatcher(std::string path, Callback on_reload,
+                  std::chrono::milliseconds poll_interval = std::chrono::milliseconds(1000));
+    ~PolicyWatcher();
+
+    PolicyWatcher(const PolicyWatcher&) = delete;
+    PolicyWatcher& operator=(const PolicyWatcher&) = delete;
+
+    uint64_t reloads() const { return reloads_.load(std::memory_order_relaxed); }
+    uint64_t failures() const { return failures_.load(std::memory_order_relaxed); }
+
+private:
+    std::string path_;
+    Callback on_reload_;
+    std::chrono::milliseconds poll_interval_;
+    std::filesystem::file_time_type last_write_{};
+    std::uintmax_t last_size_ = 0;
+    std::atomic<uint64_t> reloads_{0};
+    std::atomic<uint64_t> failures_{0};
+
+    std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_ = false;
+    std::thread worker_;
+
+    bool changed();
+    void run();
+};
+
+} // namespace matchmaker
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace matchmaker {
+
+// Where a party entered the queue from; decides how often it anchors a match
+enum class PriorityLane : uint8_t {
+    Normal,
+    Requeue,        // Returning from a cancelled match or a disconnect
+    Backfill,       // Declined or outlived a backfill offer
+    Vip,
+};
+
+constexpr size_t kPriorityLaneCount = 4;
+using LaneWeights = std::array<int, kPriorityLaneCount>;
+
+// Anchor share per lane among the lanes that have parties waiting
+constexpr LaneWeights kDefaultLaneWeights = {1, 2, 2, 4};
+constexpr int kMaxLaneWeight = 64;
+
+const char* lane_name(PriorityLane lane);
+bool parse_lane(std::string_view name, PriorityLane& lane);
+
+constexpr uint8_t lane_bit(PriorityLane lane) {
+    return static_cast<uint8_t>(1u << static_cast<uint8_t>(lane));
+}
+
+/**
+ * LaneScheduler - Weighted-fair choice of the lane that supplies the next anchor
+ *
+ * The weights are expanded once into a smooth weighted round-robin cycle
+ * (each lane appears `weight` times, interleaved). pick() walks the cycle
+ * from a cursor that persists across ticks to the next lane with parties
+ * waiting, so a pick costs at most one cycle (bounded by
+ * kPriorityLaneCount * kMaxLaneWeight) whatever the bucket size, and
+ * nothing is sorted. Turns of empty lanes go to the next waiting lane.
+ */
+class LaneScheduler {
+public:
+    explicit LaneScheduler(const LaneWeights& weights = kDefaultLaneWeights);
+
+    // Lane for the next anchor among the lanes set in `waiting` (lane_bit
+    // mask); false if the mask is empty
+    bool pick(uint8_t waiting, PriorityLane& lane);
+
+    const LaneWeights& weights() const { return weights_; }
+
+private:
+    LaneWeights weights_;
+    std::vector<PriorityLane> cycle_;
+    size_t cursor_ = 0;
+};
+
+} // namespace matchmaker
@@ -0,0 +1,152 @@
+#pragma once
+
+/**
+ * USDT static tracepoints (SystemTap SDT v3 notes)
+ *
+ * Each MATCHMAKER_PROBE site compiles to a single nop plus an ELF note in
+ * .note.stapsdt describing where its arguments live, so bpftrace, perf and
+ * SystemTap can attach to a running binary:
+ *
+ *   bpftrace -e 'usdt:./matchmaker:matchmaker:tick_end { @ns = hist(arg1); }'
+ *   bpftrace -l 'usdt:./matchmaker:*'
+ *
+ * Every probe has a semaphore that tracers increment while attached; guard
+ * argument computation that is not free (timings, string building) with
+ * MATCHMAKER_PROBE_ENABLED(name). Arguments must be integers or pointers,
+ * at most six per probe; pass strings as const char*.
+ *
+ * The notes are emitted directly (no <sys/sdt.h> dependency) on ELF
+ * x86-64/aarch64 with GCC or Clang. Elsewhere, or when built with
+ * MATCHMAKER_DISABLE_USDT, probes compile to nothing.
+ *
+ * Adding a probe: add it to MATCHMAKER_PROBE_LIST; probes.cpp defines the
+ * semaphore.
+ */
+
+#include <cstddef>
+#include <type_traits>
+
+#define MATCHMAKER_PROBE_LIST(X) \
+    X(enqueue)                  /* party_id, region, mode, team_size, avg_mmr, bucket_size */ \
+    X(dequeue)                  /* party_id, region, mode, team_size, bucket_size */ \
+    X(tick_start)               /* bucket_count, queued_parties */ \
+    X(tick_end)                 /* match_count, duration_ns, queued_parties */ \
+    X(bucket_processed)         /* region, mode, team_size, size_before, matches, duration_ns */ \
+    X(match_formed)             /* match_id, region, mode, team_size, avg_mmr, quality_permille */ \
+    X(timeout_evict)            /* party_id, region, mode, team_size, wait_ms */ \
+    X(team_formed)              /* candidates, team_size, mmr_tolerance, parties, quality_permille */ \
+    X(team_rejected)            /* candidates, team_size, mmr_tolerance */ \
+    X(pair_sweep)               /* candidates, pairs */
+
+#if !defined(MATCHMAKER_DISABLE_USDT) && defined(__ELF__) && \
+    (defined(__x86_64__) || defined(__aarch64__)) && (defined(__GNUC__) || defined(__clang__))
+#define MATCHMAKER_USDT 1
+#else
+#define MATCHMAKER_USDT 0
+#endif
+
+#if MATCHMAKER_USDT
+
+#define MATCHMAKER_PROBE_SEMAPHORE(name) matchmaker_##name##_semaphore
+
+#define MATCHMAKER_PROBE_DECLARE_SEMAPHORE(name) \
+    extern "C" volatile unsigned short MATCHMAKER_PROBE_SEMAPHORE(name);
+MATCHMAKER_PROBE_LIST(MATCHMAKER_PROBE_DECLARE_SEMAPHORE)
+#undef MATCHMAKER_PROBE_DECLARE_SEMAPHORE
+
+#define MATCHMAKER_PROBE_ENABLED(name) \
+    (__builtin_expect(MATCHMAKER_PROBE_SEMAPHORE(name) != 0, 0))
+
+namespace matchmaker::probes {
+
+// SDT argument size: negative for signed integers
+template <typename T>
+constexpr int arg_size() {
+    using U = std::decay_t<T>;
+    if constexpr (std::is_pointer_v<U>) {
+        return static_cast<int>(sizeof(void*));
+    } else {
+        return std::is_signed_v<U> ? -static_cast<int>(sizeof(U)) : static_cast<int>(sizeof(U));
+    }
+}
+
+} // namespace matchmaker::probes
+
+#define MATCHMAKER_PROBE_STR_(x) #x
+#define MATCHMAKER_PROBE_STR(x) MATCHMAKER_PROBE_STR_(x)
+
+// %n prints the negated constant, so pass the negated size
+#define MATCHMAKER_PROBE_OPERAND(n, x) \
+    [size##n] "n" (-::matchmaker::probes::arg_size<decltype(x)>()), [arg##n] "nor" (x)
+#define MATCHMAKER_PROBE_FMT(n) "%n[size" #n "]@%[arg" #n "]"
+
+#define MATCHMAKER_PROBE_NOTE(name, args)                                           \
+    "990: nop\n"                                                                    \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                                   \
+    ".balign 4\n"                                                                   \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                              \
+    "991: .asciz \"stapsdt\"\n"                                                     \
+    "992: .balign 4\n"                                                              \
+    "993: .8byte 990b\n"                                                            \
+    ".8byte _.stapsdt.base\n"                                                       \
+    ".8byte " MATCHMAKER_PROBE_STR(MATCHMAKER_PROBE_SEMAPHORE(name)) "\n"           \
+    ".asciz \"matchmaker\"\n"                                                       \
+    ".asciz \"" #name "\"\n"                                                        \
+    ".asciz \"" args "\"\n"                                                         \
+    "994: .balign 4\n"                                                              \
+    ".popsection\n"                                                                 \
+    ".ifndef _.stapsdt.base\n"                                                      \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"         \
+    ".weak _.stapsdt.base\n"                                                        \
+    ".hidden _.stapsdt.base\n"                                                      \
+    "_.stapsdt.base: .space 1\n"                                                    \
+    ".size _.stapsdt.base, 1\n"                                                     \
+    ".popsection\n"                                                                 \
+    ".endif\n"
+
+#define MATCHMAKER_PROBE_0(name) \
+    __asm__ __volatile__(MATCHMAKER_PROBE_NOTE(name, "") :: )
+#define MATCHMAKER_PROBE_1(name, a1) \
+    __asm__ __volatile__(MATCHMAKER_PROBE_NOTE(name, MATCHMAKER_PROBE_FMT(1)) \
+        :: MATCHMAKER_PROBE_OPERAND(1, a1))
+#define MATCHMAKER_PROBE_2(name, a1, a2) \
+    __asm__ __volatile__(MATCHMAKER_PROBE_NOTE(name, \
+        MATCHMAKER_PROBE_FMT(1) " " MATCHMAKER_PROBE_FMT(2)) \
+        :: MATCHMAKER_PROBE_OPERAND(1, a1), MATCHMAKER_PROBE_OPERAND(2, a2))
+#define MATCHMAKER_PROBE_3(name, a1, a2, a3) \
+    __asm__ __volatile__(MATCHMAKER_PROBE_NOTE(name, \
+        MATCHMAKER_PROBE_FMT(1) " " MATCHMAKER_PROBE_FMT(2) " " MATCHMAKER_PROBE_FMT(3)) \
+        :: MATCHMAKER_PROBE_OPERAND(1, a1), MATCHMAKER_PROBE_OPERAND(2, a2), \
+           MATCHMAKER_PROBE_OPERAND(3, a3))
+#define MATCHMAKER_PROBE_4(name, a1, a2, a3, a4) \
+    __asm__ __volatile__(MATCHMAKER_PROBE_NOTE(name, \
+        MATCHMAKER_PROBE_FMT(1) " " MATCHMAKER_PROBE_FMT(2) " " MATCHMAKER_PROBE_FMT(3) " " \
+        MATCHMAKER_PROBE_FMT(4)) \
+        :: MATCHMAKER_PROBE_OPERAND(1, a1), MATCHMAKER_PROBE_OPERAND(2, a2), \
+           MATCHMAKER_PROBE_OPERAND(3, a3), MATCHMAKER_PROBE_OPERAND(4, a4))
+#define MATCHMAKER_PROBE_5(name, a1, a2, a3, a4, a5) \
+    __asm__ __volatile__(MATCHMAKER_PROBE_NOTE(name, \
+        MATCHMAKER_PROBE_FMT(1) " " MATCHMAKER_PROBE_FMT(2) " " MATCHMAKER_PROBE_FMT(3) " " \
+        MATCHMAKER_PROBE_FMT(4) " " MATCHMAKER_PROBE_FMT(5)) \
+        :: MATCHMAKER_PROBE_OPERAND(1, a1), MATCHMAKER_PROBE_OPERAND(2, a2), \
+           MATCHMAKER_PROBE_OPERAND(3, a3), MATCHMAKER_PROBE_OPERAND(4, a4), \
+           MATCHMAKER_PROBE_OPERAND(5, a5))
+#define MATCHMAKER_PROBE_6(name, a1, a2, a3, a4, a5, a6) \
+    __asm__ __volatile__(MATCHMAKER_PROBE_NOTE(name, \
+        MATCHMAKER_PROBE_FMT(1) " " MATCHMAKER_PROBE_FMT(2) " " MATCHMAKER_PROBE_FMT(3) " " \
+        MATCHMAKER_PROBE_FMT(4) " " MATCHMAKER_PROBE_FMT(5) " " MATCHMAKER_PROBE_FMT(6)) \
+        :: MATCHMAKER_PROBE_OPERAND(1, a1), MATCHMAKER_PROBE_OPERAND(2, a2), \
+           MATCHMAKER_PROBE_OPERAND(3, a3), MATCHMAKER_PROBE_OPERAND(4, a4), \
+           MATCHMAKER_PROBE_OPERAND(5, a5), MATCHMAKER_PROBE_OPERAND(6, a6))
+
+#define MATCHMAKER_PROBE_PICK(_0, _1, _2, _3, _4, _5, _6, macro, ...) macro
+#define MATCHMAKER_PROBE(...) \
+    MATCHMAKER_PROBE_PICK(__VA_ARGS__, MATCHMAKER_PROBE_6, MATCHMAKER_PROBE_5, MATCHMAKER_PROBE_4, \
+        MATCHMAKER_PROBE_3, MATCHMAKER_PROBE_2, MATCHMAKER_PROBE_1, MATCHMAKER_PROBE_0, )(__VA_ARGS__)
+
+#else
+
+#define MATCHMAKER_PROBE_ENABLED(name) (false)
+#define MATCHMAKER_PROBE(...) do {} while (0)
+
+#endif
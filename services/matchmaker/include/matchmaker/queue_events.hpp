@@ -0,0 +1,43 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace matchmaker {
+
+/**
+ * Queue event as published by the API on matchmaker.queue.{mode}.{region}
+ * (services/api/utils/nats_events.py):
+ *
+ *   queue_enter: party_id, mode, team_size, avg_mmr, region, party_size,
+ *                timestamp, traceparent; player_ids and lane if present
+ *   queue_leave: party_id, mode, region, timestamp
+ *
+ * The enter timestamp (ISO 8601) becomes QueueEntry::enqueued_at and the
+ * traceparent QueueEntry::trace, so the matchmaker's spans are children of
+ * the API's.
+ */
+struct QueueEvent {
+    enum class Type : uint8_t { Enter, Leave };
+
+    Type type = Type::Enter;
+    QueueEntry entry;           // Leave: party_id, region and mode only
+};
+
+// nullopt unless the payload is a well-formed queue_enter or queue_leave
+std::optional<QueueEvent> decode_queue_event(std::string_view payload);
+
+// queue_enter payload for entry, in the API's schema
+std::string encode_queue_enter(const QueueEntry& entry);
+
+// RFC 3339 date-time as written by Python's isoformat(); no offset means UTC
+std::optional<std::chrono::system_clock::time_point> parse_iso8601(std::string_view text);
+
+// Append time as UTC with microseconds and a +00:00 offset, like isoformat()
+void append_iso8601(std::string& out, std::chrono::system_clock::time_point time);
+
+} // namespace matchmaker
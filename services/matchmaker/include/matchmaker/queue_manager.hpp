@@ -1,13 +1,45 @@
 #pragma once
 
+#include "memory_accounting.hpp"
+#include "metrics.hpp"
+#include "order_statistic_tree.hpp"
+#include "party_index.hpp"
+#include "priority_lanes.hpp"
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
+#include <optional>
 #include <chrono>
 
 namespace matchmaker {
 
+class CompatibilityGraph;
+class MatchingStrategy;
+class PolicySet;
+class QueueStore;
+struct StoreOp;
+class ShadowEvaluator;
+struct ShadowComparison;
+class Tracer;
+
+// W3C trace context propagated from the API's queue event (traceparent)
+struct TraceContext {
+    std::string trace_id;          // 32 lowercase hex chars; empty = no upstream trace
+    std::string parent_span_id;    // 16 lowercase hex chars
+    bool sampled = false;
+
+    bool valid() const { return !trace_id.empty(); }
+
+    // Parses "00-<trace_id>-<parent_id>-<flags>"; returns an invalid context on error
+    static TraceContext from_traceparent(std::string_view header);
+};
+
 // Player in matchmaking queue
 struct QueueEntry {
     std::string party_id;
@@ -18,6 +50,9 @@ struct QueueEntry {
     int avg_mmr;
     std::chrono::system_clock::time_point enqueued_at;
     std::vector<std::string> player_ids;
+    TraceContext trace;
+    PriorityLane lane = PriorityLane::Normal;
+    uint64_t party_hash = 0;        // hash_party_id(party_id), filled on decode/enqueue; 0 = not yet
 };
 
 // Match result
@@ -31,6 +66,12 @@ struct MatchResult {
     int avg_mmr;
     int mmr_variance;
     double quality_score;
+
+    // Per-party details, parallel to party_ids (analytics/export)
+    std::vector<int> party_mmrs;
+    std::vector<std::chrono::system_clock::time_point> party_enqueued_at;
+    int mmr_band = 0;                                // Tolerance the match was formed under
+    std::chrono::system_clock::time_point formed_at;
 };
 
 // Queue bucket key (region + mode)
@@ -61,6 +102,134 @@ struct QueueConfig {
     int mmr_band_growth_per_sec = 10;     // MMR range growth rate
     int max_wait_time_sec = 120;          // Max queue time before timeout
     double min_match_quality = 0.6;       // Minimum acceptable match quality (0-1)
+    LaneWeights lane_weights = kDefaultLaneWeights;   // Anchor share per priority lane
+    size_t memory_budget_bytes = 0;       // Reject enqueues beyond this footprint (0 = unlimited)
+
+    // Bucket lifecycle. Region and mode come from client-influenced queue
+    // events, so unknown values are rejected before a bucket is created.
+    std::vector<std::string> allowed_regions;   // Empty = any region
+    std::vector<std::string> allowed_modes;     // Empty = any mode
+    size_t max_buckets = 0;                     // Live bucket cap (0 = unlimited)
+    int bucket_idle_evict_sec = 30;             // Drop buckets empty for this long
+    size_t bucket_freelist_size = 16;           // Evicted bucket storage kept for reuse
+
+    // Publish changed queue positions at most this often (0 = off)
+    int position_update_interval_ms = 0;
+
+    // MMR tolerance after waiting since enqueued_at (grows per whole second)
+    int mmr_band_at(std::chrono::system_clock::time_point enqueued_at,
+                    std::chrono::system_clock::time_point now) const {
+        return mmr_band_after(std::chrono::duration_cast<std::chrono::seconds>(now - enqueued_at));
+    }
+
+    int mmr_band_after(std::chrono::seconds waited) const {
+        int band = mmr_band_initial + (waited.count() * mmr_band_growth_per_sec);
+        return std::min(band, mmr_band_max);
+    }
+
+    // Whether a band reached after some wait still widens with more
+    bool band_can_widen(int band) const {
+        return band < mmr_band_max && mmr_band_growth_per_sec > 0;
+    }
+
+    // When mmr_band_at next widens after now; time_point::max() once it cannot
+    std::chrono::system_clock::time_point next_band_step(std::chrono::system_clock::time_point enqueued_at,
+                                                         std::chrono::system_clock::time_point now) const {
+        auto waited = std::chrono::duration_cast<std::chrono::seconds>(now - enqueued_at);
+        if (!band_can_widen(mmr_band_after(waited))) {
+            return std::chrono::system_clock::time_point::max();
+        }
+        return enqueued_at + waited + std::chrono::seconds(1);
+    }
+};
+
+// Why an enqueue was refused
+enum class EnqueueRejection {
+    Region,         // Not in allowed_regions
+    Mode,           // Not in allowed_modes
+    TeamSize,       // team_size < 1
+    PartySize,      // party_size < 1 or > team_size: the party fits no team
+    BucketLimit,    // Would create a bucket beyond max_buckets
+    MemoryBudget    // Would exceed memory_budget_bytes
+};
+
+// Bucket churn counters (cumulative except live/freelist)
+struct BucketLifecycleStats {
+    size_t live = 0;
+    size_t freelist = 0;
+    uint64_t created = 0;
+    uint64_t evicted = 0;
+    uint64_t recycled = 0;          // Created on storage taken from the freelist
+    uint64_t rejected_region = 0;
+    uint64_t rejected_mode = 0;
+    uint64_t rejected_team_size = 0;
+    uint64_t rejected_party_size = 0;
+    uint64_t rejected_bucket_limit = 0;
+};
+
+// Per-tick CPU budget counters (cumulative except last_tick_cpu)
+struct TickBudgetStats {
+    uint64_t ticks = 0;
+    uint64_t over_budget_ticks = 0;     // Ticks that stopped early and deferred buckets
+    uint64_t deferred_buckets = 0;      // Bucket visits pushed to a later tick
+    std::chrono::nanoseconds cpu_time{0};
+    std::chrono::nanoseconds last_tick_cpu{0};
+};
+
+// CPU time consumed so far by the calling thread
+std::chrono::nanoseconds thread_cpu_time();
+
+// Replacement players wanted for an in-progress match
+struct BackfillRequest {
+    std::string match_id;
+    std::string region;
+    std::string mode;
+    int team_size = 1;                  // Bucket the replacements come from
+    int open_slots = 1;                 // Players needed
+    int target_mmr = 0;
+    std::chrono::system_clock::time_point deadline;
+    std::chrono::system_clock::time_point requested_at = std::chrono::system_clock::now();
+};
+
+// Parties assigned to a backfill request in one tick, or its expiry
+struct BackfillResult {
+    std::string match_id;
+    std::string region;
+    std::string mode;
+    int team_size = 1;
+    std::vector<std::string> party_ids;          // Assigned this tick
+    std::vector<std::vector<std::string>> players;   // Parallel to party_ids
+    std::vector<int> party_mmrs;
+    int open_slots = 0;                 // Still unfilled after this result
+    bool expired = false;               // Deadline passed; the request is dropped
+    std::chrono::microseconds latency{0};   // requested_at to this result
+};
+
+// A party's place in its bucket
+struct QueuePosition {
+    size_t position = 0;        // 1-based, in wait order (earliest enqueued_at first)
+    size_t queued = 0;          // Parties in the bucket
+    int band = 0;               // The party's current MMR band
+    size_t in_band = 0;         // Other parties within ±band of its MMR
+};
+
+// Parties of one bucket whose position changed since the last update
+struct QueuePositionUpdate {
+    std::string bucket;                                         // QueueBucket::key()
+    size_t queued = 0;
+    std::vector<std::pair<std::string, uint32_t>> positions;   // party_id, new position
+};
+
+// Backfill counters (cumulative except pending)
+struct BackfillStats {
+    size_t pending = 0;
+    uint64_t requested = 0;
+    uint64_t rejected = 0;              // Unknown bucket, no slots or duplicate match_id
+    uint64_t filled = 0;                // Every slot filled
+    uint64_t expired = 0;
+    uint64_t cancelled = 0;
+    uint64_t players_assigned = 0;
+    Histogram fill_latency{{0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30}};   // Seconds, request to full
 };
 
 /**
@@ -69,35 +238,307 @@ struct QueueConfig {
 class QueueManager {
 public:
     explicit QueueManager(const QueueConfig& config = QueueConfig{});
-    ~QueueManager() = default;
+    ~QueueManager();
 
-    // Queue operations
-    void enqueue(const QueueEntry& entry);
-    void dequeue(const std::string& party_id);
-    bool is_queued(const std::string& party_id) const;
+    // Queue operations. enqueue returns false if admission control rejected
+    // the entry; the reason is stored in *rejection when given. Enqueuing a
+    // party that is already queued replaces its entry.
+    bool enqueue(const QueueEntry& entry, EnqueueRejection* rejection = nullptr);
+    void dequeue(std::string_view party_id);
+    bool is_queued(std::string_view party_id) const;
 
     // Matchmaking tick
     std::vector<MatchResult> tick();
 
+    /**
+     * Earliest time a tick could change anything, for a loop that sleeps
+     * between ticks instead of polling: a bucket with arrivals not yet
+     * matched (at its cadence), the next whole-second band widening of a
+     * waiting party or backfill, a timeout, a backfill deadline, an idle
+     * bucket eviction or a due position update. Returns now when work is already due (a new policy,
+     * a store retry, buckets deferred by the CPU budget, a new backfill)
+     * and time_point::max() when nothing is queued. Each bucket's timeout
+     * comes from its wait-order tree and its band step from the
+     * compatibility graph's widening queue (team buckets) or the last
+     * sweep (1v1 buckets), so this is O(buckets * log n), not a pass over
+     * the parties. Tick thread only.
+     */
+    std::chrono::system_clock::time_point next_wakeup(std::chrono::system_clock::time_point now) const;
+
+    /**
+     * Strategy selection. Buckets without an explicit strategy use the
+     * built-in path (1v1 adjacent pairing or compatibility clusters).
+     * A shadow strategy runs on a snapshot of the same tick input on a
+     * background thread; its matches are discarded and only compared (see
+     * ShadowEvaluator for how the two sides are kept comparable). No
+     * snapshot is taken on ticks the evaluator is too busy to accept.
+     * Pass nullptr to reset.
+     */
+    void set_strategy(const QueueBucket& bucket, std::shared_ptr<const MatchingStrategy> strategy);
+    void set_shadow_strategy(const QueueBucket& bucket, std::shared_ptr<const MatchingStrategy> strategy);
+    std::unordered_map<std::string, ShadowComparison> get_shadow_comparisons() const;
+    void flush_shadow_evaluations();
+
+    /**
+     * Matchmaking policy (band, quality, timeout and cadence per bucket).
+     * set_policy may be called from any thread: the new table is swapped in
+     * at the start of the next tick, so a tick never mixes two policies.
+     * Buckets keep their queued parties across a swap; only the
+     * compatibility graphs of buckets whose band parameters changed are
+     * rebuilt.
+     */
+    void set_policy(std::unique_ptr<const PolicySet> policy);
+    const PolicySet& policy() const { return *policy_; }   // Tick thread only
+
+    /**
+     * Durable queue storage. Mutations are recorded as they happen and
+     * written as one batch at the end of each tick (or by flush_store());
+     * reads are always served from memory. A failed write is retried with
+     * the next batch. The store must outlive the manager; nullptr disables.
+     */
+    void set_store(QueueStore* store) { store_ = store; }
+    size_t restore_from_store();    // Re-enqueue persisted parties at startup
+    bool flush_store();
+    size_t pending_store_ops() const;
+    uint64_t store_write_failures() const { return store_write_failures_; }
+
+    /**
+     * Ingest checkpoint: the sequence number of the last queue event applied.
+     * It is written in the same store batch as the mutations that event
+     * caused, so after a restart (restore_from_store reloads it) a consumer
+     * can tell redelivered events it has already applied from new ones.
+     */
+    void checkpoint_ingest(uint64_t sequence);
+    uint64_t ingest_checkpoint() const { return ingest_checkpoint_; }
+
+    /**
+     * Backfill. Open requests are served at the start of every tick,
+     * before regular matching, from the bucket's MMR index: the parties
+     * nearest target_mmr within the bucket's band (widening with the
+     * request's age) are taken until the slots are full, so a lookup is
+     * O(log n + k) rather than a bucket scan. Parties past their wait
+     * limit are timed out first, never placed. A partially filled request
+     * stays open until its deadline. Results are collected with
+     * take_backfill_results() after the tick.
+     */
+    bool request_backfill(const BackfillRequest& request);
+    bool cancel_backfill(const std::string& match_id);
+    std::vector<BackfillResult> take_backfill_results();
+    const BackfillStats& get_backfill_stats() const { return backfill_stats_; }
+
+    /**
+     * CPU budget per tick (thread CPU time; 0 = unlimited). Once a tick has
+     * used it up, the remaining buckets are left for the next tick, which
+     * starts with them, so every bucket is still visited in turn. At least
+     * one bucket is processed per tick. Backfills and the store flush are
+     * never deferred.
+     */
+    void set_tick_budget(std::chrono::nanoseconds budget) { tick_budget_ = budget; }
+    std::chrono::nanoseconds tick_budget() const { return tick_budget_; }
+    const TickBudgetStats& get_tick_budget_stats() const { return tick_budget_stats_; }
+
+    // Time-to-match tracing; the tracer must outlive the manager. nullptr disables.
+    void set_tracer(Tracer* tracer) { tracer_ = tracer; }
+
+    /**
+     * Queue position. Each bucket keeps order-statistic trees over wait
+     * order and MMR, so a party's position and the number of parties within
+     * its band are O(log n) without a bucket scan. With
+     * position_update_interval_ms set, the end of a tick (at most that
+     * often) collects, per bucket whose membership changed, only the
+     * parties whose position moved since they were last reported; take
+     * them with take_position_updates() after the tick.
+     */
+    std::optional<QueuePosition> get_queue_position(std::string_view party_id) const;
+    std::vector<QueuePositionUpdate> take_position_updates();
+
     // Stats
     size_t get_queue_size() const;
     size_t get_queue_size(const QueueBucket& bucket) const;
     std::unordered_map<std::string, size_t> get_bucket_sizes() const;
+    BucketLifecycleStats get_bucket_lifecycle_stats() const;
+
+    /**
+     * Priority lanes. In team buckets each matching attempt is anchored on
+     * the longest-waiting party of one lane, chosen by the bucket's
+     * LaneScheduler among the lanes with parties in the cluster, and the
+     * band comes from that anchor. Counts are matches formed per anchor lane.
+     */
+    const std::array<uint64_t, kPriorityLaneCount>& get_lane_anchor_counts() const { return lane_anchors_; }
+
+    /**
+     * Memory accounting. memory_bytes() is the running total admission
+     * control compares against the budget (O(buckets)); get_memory_stats()
+     * adds the per-bucket breakdown.
+     */
+    int64_t memory_bytes() const;
+    MemoryStats get_memory_stats() const;
 
 private:
     QueueConfig config_;
 
+    // Active policy (tick thread) and the next one published by set_policy
+    std::unique_ptr<const PolicySet> policy_;
+    std::atomic<const PolicySet*> pending_policy_{nullptr};
+
+    // Policy resolved for each live bucket, and when it last ran matching
+    struct BucketPolicyState {
+        QueueConfig config;             // Policy parameters only
+        int tick_interval_ms = 0;
+        std::chrono::system_clock::time_point last_matched{};
+        bool unevaluated = true;        // Arrivals or matches since the last matching pass
+        std::chrono::system_clock::time_point next_band_step = std::chrono::system_clock::time_point::max();   // 1v1: as of the last pass
+        LaneScheduler lanes;            // Which lane anchors the next attempt
+    };
+    std::unordered_map<QueueBucket, BucketPolicyState, QueueBucketHash> bucket_policies_;
+
     // Queue storage: bucket -> list of queue entries
     std::unordered_map<QueueBucket, std::vector<QueueEntry>, QueueBucketHash> buckets_;
 
-    // Fast lookup: party_id -> bucket
-    std::unordered_map<std::string, QueueBucket> party_to_bucket_;
+    // Bucket lifecycle: allow-lists, when each empty bucket went idle, and
+    // entry storage of evicted buckets (cleared, capacity kept)
+    std::unordered_set<std::string> allowed_regions_;
+    std::unordered_set<std::string> allowed_modes_;
+    std::unordered_map<QueueBucket, std::chrono::system_clock::time_point, QueueBucketHash> idle_since_;
+    std::vector<std::vector<QueueEntry>> bucket_freelist_;
+    BucketLifecycleStats lifecycle_;
+
+    // Per-bucket MMR order for backfill lookups; values point at the party
+    // index key, which is stable for as long as the party is queued
+    struct IndexedParty {
+        const std::string* party_id = nullptr;
+        int party_size = 1;
+    };
+    using MmrIndex = std::multimap<int, IndexedParty, std::less<int>,
+                                   AccountingAllocator<std::pair<const int, IndexedParty>>>;
+    std::unordered_map<QueueBucket, MmrIndex, QueueBucketHash> mmr_index_;
+
+    // Fast lookup: party_id -> bucket (the buckets_ key, which outlives its
+    // parties), plus the entry's heap footprint so every removal path can
+    // release it, and its MMR index slot
+    struct PartyLocation {
+        const QueueBucket* bucket = nullptr;
+        int64_t entry_bytes = 0;
+        int64_t id_bytes = 0;
+        MmrIndex::iterator mmr_slot;
+
+        // Index of the entry in its bucket's vector. Team buckets only: they
+        // remove by swap-and-pop, while 1v1 buckets stay in MMR order and are
+        // compacted by their sweep.
+        uint32_t slot = 0;
+
+        // Position tree keys, and the position last reported (0 = never)
+        uint64_t sequence = 0;
+        int64_t enqueued_ticks = 0;     // enqueued_at.time_since_epoch()
+        int mmr = 0;
+        int party_size = 0;
+        uint32_t reported_position = 0;
+    };
+    using PartyIndex = FlatPartyIndex<PartyLocation>;
+
+    MemoryAccount party_index_account_;
+    PartyIndex party_to_bucket_;
+
+    // Per-bucket position order: wait order (enqueued_at, then enqueue
+    // sequence) and MMR, both pointing at party index records
+    using PositionTree = OrderStatisticTree<PartyIndex::Record*>;
+    struct BucketPositions {
+        explicit BucketPositions(MemoryAccount* account) : by_wait(account), by_mmr(account) {}
+        PositionTree by_wait;
+        PositionTree by_mmr;
+        int players = 0;                // Sum of queued party sizes
+        bool changed = false;           // Membership changed since the last update
+    };
+    std::unordered_map<QueueBucket, BucketPositions, QueueBucketHash> positions_;
+    uint64_t enqueue_sequence_ = 0;
+    bool positions_changed_ = false;
+    std::chrono::system_clock::time_point last_position_update_{};
+    std::vector<QueuePositionUpdate> position_updates_;
+
+    // Heap held by queued entries outside the entry vectors themselves
+    struct BucketHeap {
+        int64_t entry_bytes = 0;
+        int64_t id_bytes = 0;
+    };
+    std::unordered_map<QueueBucket, BucketHeap, QueueBucketHash> bucket_heap_;
+    int64_t entry_heap_bytes_ = 0;
+    int64_t id_bytes_ = 0;
+    int64_t entry_capacity_bytes_ = 0;
+    uint64_t admission_rejections_ = 0;
+    std::array<uint64_t, kPriorityLaneCount> lane_anchors_{};
+
+    // Incremental compatibility clusters for team buckets (team_size > 1)
+    std::unordered_map<QueueBucket, std::unique_ptr<CompatibilityGraph>, QueueBucketHash> graphs_;
+
+    // Per-bucket strategy overrides and shadow candidates
+    std::unordered_map<QueueBucket, std::shared_ptr<const MatchingStrategy>, QueueBucketHash> strategies_;
+    std::unordered_map<QueueBucket, std::shared_ptr<const MatchingStrategy>, QueueBucketHash> shadow_strategies_;
+    std::unique_ptr<ShadowEvaluator> shadow_evaluator_;
+
+    Tracer* tracer_ = nullptr;
+
+    std::chrono::nanoseconds tick_budget_{0};
+    std::optional<QueueBucket> resume_bucket_;  // Where the next sweep starts after a deferral
+    TickBudgetStats tick_budget_stats_;
+
+    QueueStore* store_ = nullptr;
+    std::vector<StoreOp> store_ops_;
+    uint64_t store_write_failures_ = 0;
+    uint64_t ingest_checkpoint_ = 0;
+
+    // Open backfill requests by bucket (served in arrival order) and by match
+    struct PendingBackfill {
+        BackfillRequest request;
+        int open_slots = 0;
+    };
+    std::unordered_map<QueueBucket, std::vector<PendingBackfill>, QueueBucketHash> backfills_;
+    std::unordered_map<std::string, QueueBucket> backfill_buckets_;
+    std::vector<BackfillResult> backfill_results_;
+    bool backfill_arrived_ = false;     // Requests not yet served by a tick
+    BackfillStats backfill_stats_;
 
     // Helper methods
-    int calculate_mmr_band(const QueueEntry& entry, std::chrono::system_clock::time_point now) const;
-    std::vector<MatchResult> process_bucket(QueueBucket bucket, std::vector<QueueEntry>& entries);
+    BucketPolicyState& bucket_policy(const QueueBucket& bucket);
+    void adopt_pending_policy(std::chrono::system_clock::time_point now);
+    std::vector<MatchResult> process_bucket(QueueBucket bucket, std::vector<QueueEntry>& entries,
+                                            const QueueConfig& config);
+    void trace_bucket_evaluation(const QueueBucket& bucket, const std::vector<QueueEntry>& entries,
+                                 const std::vector<MatchResult>& bucket_matches,
+                                 std::chrono::system_clock::time_point now);
+    std::vector<MatchResult> run_live_strategy(const QueueBucket& bucket, std::vector<QueueEntry>& entries,
+                                               const QueueConfig& config,
+                                               std::chrono::system_clock::time_point now);
+    std::string live_strategy_name(const QueueBucket& bucket) const;
+    std::vector<MatchResult> apply_strategy(const QueueBucket& bucket, const MatchingStrategy& strategy,
+                                            std::vector<QueueEntry>& entries, const QueueConfig& config,
+                                            std::chrono::system_clock::time_point now);
+    std::vector<MatchResult> process_cluster_bucket(const QueueBucket& bucket, std::vector<QueueEntry>& entries,
+                                                    const QueueConfig& config,
+                                                    std::chrono::system_clock::time_point now);
+    std::vector<MatchResult> process_1v1_bucket(const QueueBucket& bucket, std::vector<QueueEntry>& entries,
+                                                const QueueConfig& config,
+                                                std::chrono::system_clock::time_point now);
+    static std::string generate_match_id();
     void remove_matched_parties(std::vector<QueueEntry>& entries, const std::vector<std::string>& party_ids);
-    void remove_timed_out_entries(std::vector<QueueEntry>& entries, std::chrono::system_clock::time_point now);
+    void erase_slot(std::vector<QueueEntry>& entries, uint32_t slot);
+    void restamp_slots(const std::vector<QueueEntry>& entries);
+    std::vector<MatchResult> match_cluster(const QueueBucket& bucket, std::vector<QueueEntry> cluster,
+                                           const QueueConfig& config, LaneScheduler& lanes,
+                                           std::chrono::system_clock::time_point now);
+    void remove_timed_out_entries(const QueueBucket& bucket, std::vector<QueueEntry>& entries,
+                                  const QueueConfig& config,
+                                  std::chrono::system_clock::time_point now);
+    CompatibilityGraph* find_graph(const QueueBucket& bucket);
+    void remove_queued(PartyIndex::Record* record, const char* reason);
+    void forget_party(std::string_view party_id, uint64_t party_hash = 0);
+    void unindex_position(const PartyLocation& location);
+    void collect_position_updates(std::chrono::system_clock::time_point now);
+    std::vector<QueueEntry>& create_bucket(const QueueBucket& bucket);
+    bool evict_if_idle(const QueueBucket& bucket, std::vector<QueueEntry>& entries,
+                       std::chrono::system_clock::time_point now);
+    void serve_backfills(std::chrono::system_clock::time_point now);
+    void fill_backfill(const QueueBucket& bucket, PendingBackfill& pending, int band,
+                       BackfillResult& result);
 };
 
 } // namespace matchmaker
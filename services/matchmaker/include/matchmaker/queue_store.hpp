@@ -0,0 +1,107 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include "redis_client.hpp"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace matchmaker {
+
+// One queue mutation, recorded by QueueManager and written in batches
+struct StoreOp {
+    enum class Type : uint8_t { Add, Remove, Checkpoint };
+
+    Type type = Type::Add;
+    std::string bucket;       // QueueBucket::key()
+    std::string party_id;
+    int mmr = 0;              // Add only
+    std::string payload;      // Add: encode_queue_entry(); Checkpoint: ingest sequence
+};
+
+// Compact JSON form of a QueueEntry (trace context is not persisted)
+std::string encode_queue_entry(const QueueEntry& entry);
+std::optional<QueueEntry> decode_queue_entry(const std::string& payload);
+
+/**
+ * QueueStore - Durable backing storage for QueueManager
+ *
+ * QueueManager stays the read path (its buckets are the local
+ * write-through cache); the store only receives mutations, once per tick
+ * as a single batch, and is read back when a process starts.
+ */
+class QueueStore {
+public:
+    virtual ~QueueStore() = default;
+
+    // Apply ops in order; false leaves the store unchanged or partially
+    // applied, and the caller retries the same batch later
+    virtual bool apply(const std::vector<StoreOp>& ops) = 0;
+
+    // Every persisted entry, or nullopt if the store is unreachable
+    virtual std::optional<std::vector<QueueEntry>> load() = 0;
+
+    // Last ingest sequence written by a Checkpoint op (0 if none)
+    virtual std::optional<uint64_t> load_checkpoint() = 0;
+
+    // Network round trips issued so far (0 for local stores)
+    virtual uint64_t round_trips() const { return 0; }
+};
+
+// In-process store, for tests and as the reference behaviour
+class InMemoryQueueStore : public QueueStore {
+public:
+    bool apply(const std::vector<StoreOp>& ops) override;
+    std::optional<std::vector<QueueEntry>> load() override;
+    std::optional<uint64_t> load_checkpoint() override { return checkpoint_; }
+
+    size_t size() const { return entries_.size(); }
+
+private:
+    std::unordered_map<std::string, std::string> entries_;   // party_id -> payload
+    uint64_t checkpoint_ = 0;
+};
+
+// Configuration for the Redis queue store
+struct RedisQueueStoreConfig {
+    std::string host = "127.0.0.1";
+    int port = 6379;
+    std::string key_prefix = "mm:";
+    std::chrono::milliseconds timeout{1000};
+};
+
+/**
+ * RedisQueueStore - Queue state in Redis
+ *
+ * Layout:
+ *   <prefix>q:<bucket>   sorted set, member party_id, score MMR
+ *   <prefix>entries      hash, party_id -> encoded entry
+ *   <prefix>checkpoint   string, last ingest sequence applied
+ *
+ * apply() sends the whole batch as one atomic server-side script
+ * (RedisConnection::batch), so a tick costs one round trip however many
+ * parties joined, matched or timed out. load() is a single HGETALL.
+ */
+class RedisQueueStore : public QueueStore {
+public:
+    explicit RedisQueueStore(const RedisQueueStoreConfig& config);
+
+    bool apply(const std::vector<StoreOp>& ops) override;
+    std::optional<std::vector<QueueEntry>> load() override;
+    std::optional<uint64_t> load_checkpoint() override;
+    uint64_t round_trips() const override { return connection_.round_trips(); }
+
+    const std::string& last_error() const { return connection_.last_error(); }
+
+    std::string bucket_key(const std::string& bucket) const { return config_.key_prefix + "q:" + bucket; }
+    std::string entries_key() const { return config_.key_prefix + "entries"; }
+    std::string checkpoint_key() const { return config_.key_prefix + "checkpoint"; }
+
+private:
+    RedisQueueStoreConfig config_;
+    RedisConnection connection_;
+};
+
+} // namespace matchmaker
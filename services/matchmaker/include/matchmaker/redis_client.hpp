@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace matchmaker {
+
+// One RESP2 reply (or request: commands are arrays of bulk strings)
+struct RedisReply {
+    enum class Type { Status, Error, Integer, Bulk, Nil, Array };
+
+    Type type = Type::Nil;
+    std::string str;                    // Status, Error and Bulk
+    int64_t integer = 0;
+    std::vector<RedisReply> elements;   // Array
+
+    bool is_error() const { return type == Type::Error; }
+
+    static RedisReply status(std::string s) { return {Type::Status, std::move(s), 0, {}}; }
+    static RedisReply error(std::string s) { return {Type::Error, std::move(s), 0, {}}; }
+    static RedisReply number(int64_t n) { return {Type::Integer, {}, n, {}}; }
+    static RedisReply bulk(std::string s) { return {Type::Bulk, std::move(s), 0, {}}; }
+};
+
+using RedisCommand = std::vector<std::string>;
+
+/**
+ * RedisConnection - Minimal blocking RESP2 client
+ *
+ * pipeline() writes every command before reading any reply, so a batch
+ * costs one network round trip however many commands it holds. batch()
+ * goes further and runs the commands atomically inside one server-side
+ * Lua script (EVALSHA, loaded on first use). The script names its keys
+ * dynamically, so it targets a single Redis node, not a cluster.
+ *
+ * A failed read or write closes the socket; the next call reconnects.
+ * Not thread-safe.
+ */
+class RedisConnection {
+public:
+    RedisConnection(std::string host, int port,
+                    std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+    ~RedisConnection();
+
+    RedisConnection(const RedisConnection&) = delete;
+    RedisConnection& operator=(const RedisConnection&) = delete;
+
+    // "redis://host:port[/db]"; false if the URL is not of that form
+    static bool parse_url(const std::string& url, std::string& host, int& port);
+
+    bool connect();
+    bool connected() const { return fd_ >= 0; }
+
+    // One reply per command, or nullopt on an I/O error (see last_error())
+    std::optional<std::vector<RedisReply>> pipeline(const std::vector<RedisCommand>& commands);
+    std::optional<RedisReply> command(const RedisCommand& command);
+
+    // Run commands atomically in one round trip; returns how many ran
+    std::optional<int64_t> batch(const std::vector<RedisCommand>& commands);
+
+    uint64_t round_trips() const { return round_trips_; }
+    const std::string& last_error() const { return last_error_; }
+
+    // Lua source behind batch(): ARGV holds (argc, arg...) groups
+    static const std::string& batch_script();
+
+private:
+    std::string host_;
+    int port_;
+    std::chrono::milliseconds timeout_;
+    int fd_ = -1;
+    std::string read_buf_;
+    size_t read_pos_ = 0;
+    std::string write_buf_;
+    std::string batch_sha_;
+    uint64_t round_trips_ = 0;
+    std::string last_error_;
+
+    bool send_buffer();
+    bool read_reply(RedisReply& reply);
+    void close_with(std::string error);
+};
+
+/**
+ * RespStandIn - In-process RESP server for tests and benchmarks
+ *
+ * Serves strings, hashes, sets and sorted sets (the commands the queue
+ * store and redis-cli smoke checks use) on an ephemeral loopback port.
+ * Scripts are not interpreted: SCRIPT LOAD / EVALSHA / EVAL accept only
+ * RedisConnection::batch_script(), whose command groups are executed
+ * directly.
+ */
+class RespStandIn {
+public:
+    RespStandIn();
+    ~RespStandIn();
+
+    RespStandIn(const RespStandIn&) = delete;
+    RespStandIn& operator=(const RespStandIn&) = delete;
+
+    bool listening() const { return listen_fd_ >= 0; }
+    int port() const { return port_; }
+
+    // Requests received (a pipelined batch of n commands counts n)
+    uint64_t commands_served() const { return commands_served_.load(std::memory_order_relaxed); }
+
+    // Direct inspection, bypassing the socket
+    RedisReply execute(const RedisCommand& command);
+
+private:
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> commands_served_{0};
+    std::thread worker_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::string> strings_;
+    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> hashes_;
+    std::unordered_map<std::string, std::set<std::string>> sets_;
+    std::unordered_map<std::string, std::map<std::string, double>> zsets_;   // member -> score
+    std::unordered_map<std::string, std::string> scripts_;                    // sha -> body
+
+    void run();
+    RedisReply dispatch(const RedisCommand& command);
+    RedisReply run_batch(const RedisCommand& command, size_t argv_start);
+};
+
+} // namespace matchmaker
@@ -2,7 +2,9 @@
 
 #include "queue_manager.hpp"
 #include <vector>
+#include <cstdint>
 #include <optional>
+#include <utility>
 
 namespace matchmaker {
 
@@ -44,7 +46,50 @@ public:
         const std::vector<QueueEntry>& entries
     );
 
+    /**
+     * Compact per-party view of a 1v1 bucket, so the pairing sweep touches
+     * 16 bytes per party instead of a full QueueEntry.
+     */
+    struct SoloCandidate {
+        int mmr;
+        int mmr_band;           // Current tolerance; negative = not pairable
+        int64_t enqueued_at;    // system_clock ticks, lower = waited longer
+    };
+
+    /**
+     * Pair 1v1 entries in a single sweep over an MMR-ordered bucket.
+     *
+     * Each unpaired entry is offered to its nearest pairable MMR neighbour;
+     * entries with a negative band are passed over. When the middle entry
+     * of three could pair either way and only one side can be served, the
+     * longer-waiting neighbour wins (ties go to the closer MMR). A neighbour
+     * whose own band is too narrow for either side is stepped over, so it
+     * does not keep the entries around it apart. A pair is only formed if
+     * the MMR gap fits both entries' bands and the resulting match meets
+     * min_quality.
+     *
+     * @param candidates Solo parties sorted by mmr ascending
+     * @param min_quality Minimum acceptable match quality
+     * @return Index pairs into candidates, in MMR order
+     */
+    static std::vector<std::pair<size_t, size_t>> pair_adjacent_1v1(
+        const std::vector<SoloCandidate>& candidates,
+        double min_quality
+    );
+
+    /**
+     * Build the MatchResult for a 1v1 pair without rescanning the bucket.
+     * Produces the same teams, averages and quality as try_form_match.
+     */
+    static MatchResult build_1v1_match(const QueueEntry& a, const QueueEntry& b);
+
 private:
+    // Helper: Combine the quality factors into a single weighted score
+    static double score_quality(int team_mmr_diff, int mmr_variance);
+
+    // Helper: 1v1 quality without building a MatchResult
+    static double quality_1v1(int mmr_a, int mmr_b);
+
     // Helper: Calculate average MMR for a list of entries
     static int calculate_avg_mmr(const std::vector<const QueueEntry*>& entries);
 
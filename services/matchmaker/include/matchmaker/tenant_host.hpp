@@ -0,0 +1,100 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include "metrics.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace matchmaker {
+
+// One hosted title
+struct TenantConfig {
+    std::string name;
+    QueueConfig queue;
+    std::chrono::microseconds cpu_budget{0};    // CPU per tick (0 = unlimited)
+};
+
+// Per-tenant counters (cumulative)
+struct TenantStats {
+    uint64_t ticks = 0;
+    uint64_t matches = 0;
+    Histogram tick_cpu_seconds{{0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25}};
+};
+
+/**
+ * TenantHost - Several titles' queues in one process
+ *
+ * Each tenant gets its own QueueManager (buckets, policy, store and budget
+ * are not shared), created with add_tenant(). tick() runs every tenant's
+ * tick once on a shared worker pool; a tenant is ticked by one thread at a
+ * time. The tenant's cpu_budget becomes its QueueManager tick budget, so a
+ * noisy title defers its own buckets to later ticks and cannot hold the
+ * others past the deadline.
+ *
+ * Like QueueManager, the host is not thread-safe: add_tenant, ingest into
+ * tenants' QueueManagers and tick() must not run concurrently.
+ */
+class TenantHost {
+public:
+    struct TenantMatches {
+        std::string tenant;
+        std::vector<MatchResult> matches;
+    };
+
+    explicit TenantHost(size_t threads = 0);    // Pool size including the caller; 0 = hardware
+    ~TenantHost();
+
+    TenantHost(const TenantHost&) = delete;
+    TenantHost& operator=(const TenantHost&) = delete;
+
+    // nullptr if the name is empty or already taken
+    QueueManager* add_tenant(const TenantConfig& config);
+    QueueManager* find(std::string_view name);
+
+    // Tick every tenant; results are in add_tenant order
+    std::vector<TenantMatches> tick();
+
+    size_t tenant_count() const { return tenants_.size(); }
+    size_t threads() const { return workers_.size() + 1; }
+    const TenantConfig& config(size_t index) const { return tenants_[index]->config; }
+    const TenantStats& stats(size_t index) const { return tenants_[index]->stats; }
+    const QueueManager& queue_manager(size_t index) const { return tenants_[index]->queue_manager; }
+
+private:
+    struct Tenant {
+        explicit Tenant(const TenantConfig& tenant_config);
+
+        TenantConfig config;
+        QueueManager queue_manager;
+        TenantStats stats;
+        std::vector<MatchResult> matches;     // From the current tick
+    };
+
+    std::vector<std::unique_ptr<Tenant>> tenants_;
+    std::unordered_map<std::string, size_t> by_name_;
+
+    // Worker pool: tick() bumps generation_ and workers claim tenants via next_
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    size_t busy_ = 0;
+    bool stopping_ = false;
+    std::atomic<size_t> next_{0};
+
+    void worker_loop();
+    void run_tenants();
+    void tick_tenant(Tenant& tenant);
+};
+
+} // namespace matchmaker
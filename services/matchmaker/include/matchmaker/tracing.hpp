@@ -0,0 +1,191 @@
+#pragma once
+
+#include "queue_manager.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace matchmaker {
+
+// Why a queued party was not matched by a tick
+enum class SkipReason : uint8_t {
+    InsufficientPlayers,    // Bucket holds fewer players than one match needs
+    Band,                   // Not enough parties within MMR tolerance
+    Quality,                // A candidate match was rejected by min_match_quality
+};
+
+const char* to_string(SkipReason reason);
+
+// Finished span, timestamps in nanoseconds since the Unix epoch
+struct Span {
+    std::string trace_id;
+    std::string span_id;
+    std::string parent_span_id;
+    std::string name;
+    int64_t start_ns = 0;
+    int64_t end_ns = 0;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    std::vector<std::pair<std::string, int64_t>> int_attributes;
+    bool error = false;
+};
+
+/**
+ * SpanExporter - Destination for finished span batches
+ *
+ * Called on the tracer's export thread, never on the tick thread.
+ */
+class SpanExporter {
+public:
+    virtual ~SpanExporter() = default;
+    virtual void export_spans(const std::vector<Span>& spans) = 0;
+};
+
+/**
+ * OtlpFileExporter - Appends batches as OTLP/JSON lines
+ *
+ * Each line is one ExportTraceServiceRequest, the format read by the
+ * OpenTelemetry Collector's otlpjsonfile receiver, so a local collector
+ * can tail the file and forward spans to any tracing backend.
+ */
+class OtlpFileExporter : public SpanExporter {
+public:
+    explicit OtlpFileExporter(const std::string& path, std::string service_name = "matchmaker");
+    ~OtlpFileExporter() override;
+
+    OtlpFileExporter(const OtlpFileExporter&) = delete;
+    OtlpFileExporter& operator=(const OtlpFileExporter&) = delete;
+
+    void export_spans(const std::vector<Span>& spans) override;
+
+    // One ExportTraceServiceRequest object (no trailing newline)
+    static void write_request(std::string& out, const std::vector<Span>& spans,
+                              const std::string& service_name);
+
+private:
+    std::FILE* file_ = nullptr;
+    std::string service_name_;
+    std::string buffer_;
+};
+
+struct TracerConfig {
+    double max_overhead = 0.02;             // Tracing share of tick time to stay under
+    double initial_sample_rate = 1.0;
+    double min_sample_rate = 1.0 / 1024;
+    int adjust_every_ticks = 16;            // Sampling controller window
+    size_t max_tracked_parties = 10000;     // Hard cap on in-flight traces
+    size_t batch_size = 512;                // Spans per export batch
+    size_t max_pending_batches = 8;         // Batches beyond this are dropped
+};
+
+/**
+ * Tracer - Per-party time-to-match traces
+ *
+ * A sampled party gets a root span "matchmaker.time_to_match" (child of the
+ * API's span when the queue event carried a traceparent) covering enqueue
+ * to publish, timeout or dequeue, with children:
+ *   - matchmaker.ingest: queue event timestamp to insertion in the bucket
+ *   - matchmaker.evaluate: consecutive ticks that skipped the party for the
+ *     same reason, coalesced into one span with an "evaluations" count
+ *   - matchmaker.publish: the match.found publish call
+ *
+ * Sampling is head-based: upstream unsampled traces are ignored and the
+ * rest are kept at the current rate, decided from the trace ID so every
+ * service makes the same call. Time spent in the hooks is measured against
+ * tick time and the rate is halved or doubled to keep it under
+ * max_overhead. Finished spans are batched and exported on a background
+ * thread; if the exporter falls behind, batches are dropped and counted.
+ *
+ * Hooks are not thread-safe; call them from the thread driving the
+ * QueueManager.
+ */
+class Tracer {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    explicit Tracer(std::unique_ptr<SpanExporter> exporter, const TracerConfig& config = TracerConfig{});
+    ~Tracer();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    // QueueManager hooks
+    void on_enqueued(const QueueEntry& entry, const std::string& bucket_key, TimePoint now);
+    bool is_tracking(const std::string& bucket_key) const;
+    void on_matched(const MatchResult& match);
+    void on_quality_rejected(const std::vector<QueueEntry>& candidates);
+    void on_evaluated(const std::string& bucket_key, SkipReason reason, TimePoint now);
+    void on_removed(const std::string& party_id, const char* outcome, TimePoint now);
+    void on_tick_complete(std::chrono::nanoseconds tick_duration);
+
+    // Publisher hook, after match.found has been sent
+    void on_published(const MatchResult& match, TimePoint start, TimePoint end);
+
+    // Hand buffered spans to the exporter and wait until they are written
+    void flush();
+
+    double sample_rate() const { return sample_rate_; }
+    size_t tracked_parties() const { return parties_.size(); }
+    uint64_t spans_exported() const;
+    uint64_t spans_dropped() const;
+
+private:
+    struct PartyTrace {
+        std::string trace_id;
+        std::string root_span_id;
+        std::string parent_span_id;
+        std::string bucket_key;
+        int64_t enqueued_ns = 0;
+
+        // Open run of identical tick outcomes
+        int evaluations = 0;
+        SkipReason run_reason = SkipReason::Band;
+        int64_t run_start_ns = 0;
+        int64_t run_end_ns = 0;
+        bool quality_rejected = false;     // Set during the current tick
+
+        std::string match_id;              // Set once matched, awaiting publish
+    };
+
+    TracerConfig config_;
+    double sample_rate_;
+    std::unordered_map<std::string, PartyTrace> parties_;
+    std::unordered_map<std::string, std::vector<std::string>> bucket_parties_;
+    std::vector<Span> pending_;
+
+    // Sampling controller window
+    int window_ticks_ = 0;
+    int64_t window_tick_ns_ = 0;
+    int64_t window_overhead_ns_ = 0;
+
+    // Export thread
+    std::unique_ptr<SpanExporter> exporter_;
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::vector<Span>> batches_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    uint64_t exported_ = 0;
+    uint64_t dropped_ = 0;
+    std::thread worker_;
+
+    void run();
+    void submit_pending();
+    void close_run(PartyTrace& trace);
+    void finish(const std::string& party_id, PartyTrace& trace, int64_t end_ns,
+                const char* outcome, bool error);
+    void untrack(const std::string& party_id, const std::string& bucket_key);
+    bool should_sample(const std::string& trace_id) const;
+    Span& child_span(const PartyTrace& trace, const char* name, int64_t start_ns, int64_t end_ns);
+};
+
+} // namespace matchmaker
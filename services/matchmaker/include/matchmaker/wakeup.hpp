@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+
+namespace matchmaker {
+
+/**
+ * Wakeup - Lets the tick loop sleep until its next deadline and be woken
+ * early when new work arrives
+ *
+ * Backed by an eventfd on Linux and a self-pipe elsewhere, so notify() is
+ * a single write: callable from any thread and from signal handlers.
+ * Notifications made while nobody waits are kept, and any number of them
+ * are consumed by one wait.
+ */
+class Wakeup {
+public:
+    Wakeup();
+    ~Wakeup();
+
+    Wakeup(const Wakeup&) = delete;
+    Wakeup& operator=(const Wakeup&) = delete;
+
+    void notify();
+
+    // Block for up to timeout; true if woken by notify()
+    bool wait_for(std::chrono::nanoseconds timeout);
+
+private:
+    int read_fd_ = -1;
+    int write_fd_ = -1;     // Same as read_fd_ for an eventfd
+};
+
+} // namespace matchmaker
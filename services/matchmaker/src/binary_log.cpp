@@ -0,0 +1,234 @@
+#include "matchmaker/binary_log.hpp"
+
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+namespace matchmaker {
+
+namespace {
+
+struct EventInfo {
+    LogEvent id;
+    spdlog::level::level_enum level;
+    const char* name;
+    const char* format;
+};
+
+constexpr EventInfo kEvents[] = {
+    {LogEvent::QueueEvent, spdlog::level::info, "queue_event",
+     "Queue event: party={}, region={}, mode={}, mmr={}"},
+    {LogEvent::MatchFormed, spdlog::level::info, "match_formed",
+     "Match formed: id={}, region={}, mode={}, mmr={}, quality={:.2f}"},
+    {LogEvent::TickOverrun, spdlog::level::warn, "tick_overrun",
+     "Tick took longer than {}ms: {}ms"},
+};
+
+const EventInfo* find_event(uint16_t id) {
+    for (const auto& info : kEvents) {
+        if (static_cast<uint16_t>(info.id) == id) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+void write_raw(std::FILE* file, T value) {
+    std::fwrite(&value, sizeof(T), 1, file);
+}
+
+void write_str(std::FILE* file, std::string_view value) {
+    write_raw(file, static_cast<uint16_t>(value.size()));
+    std::fwrite(value.data(), 1, value.size(), file);
+}
+
+size_t round_up_pow2(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+BinaryLogger::BinaryLogger(const Config& config)
+    : config_(config),
+      ring_(new Cell[round_up_pow2(config.ring_capacity)]),
+      mask_(round_up_pow2(config.ring_capacity) - 1) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        ring_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    if (!config_.path.empty()) {
+        file_ = std::fopen(config_.path.c_str(), "wb");
+        if (file_) {
+            std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+            write_header();
+        } else {
+            spdlog::error("Failed to open binary log {}", config_.path);
+        }
+    }
+
+    worker_ = std::thread([this] { run(); });
+}
+
+BinaryLogger::~BinaryLogger() {
+    stopping_.store(true, std::memory_order_release);
+    worker_.join();
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+int64_t BinaryLogger::now_ns() {
+#ifdef __linux__
+    // The coarse clock is read from the vDSO without touching the TSC; it is
+    // several times cheaper than system_clock and records keep log order anyway
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+#endif
+}
+
+bool BinaryLogger::push(const BinaryLogRecord& record) {
+    // Vyukov bounded MPMC queue; only the worker dequeues
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = ring_[pos & mask_];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.record = record;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t BinaryLogger::drain() {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    size_t count = 0;
+    for (;;) {
+        Cell& cell = ring_[pos & mask_];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (seq != pos + 1) {
+            break;
+        }
+
+        const BinaryLogRecord& record = cell.record;
+        if (file_) {
+            std::fwrite(&record, sizeof(record), 1, file_);
+        }
+        if (config_.mirror_to_spdlog) {
+            const EventInfo* info = find_event(record.event);
+            spdlog::log(info ? info->level : spdlog::level::info, "{}", format(record));
+        }
+
+        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        ++pos;
+        ++count;
+    }
+    dequeue_pos_.store(pos, std::memory_order_relaxed);
+    if (count > 0 && file_) {
+        std::fflush(file_);
+    }
+    written_.fetch_add(count, std::memory_order_release);
+    return count;
+}
+
+void BinaryLogger::run() {
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (drain() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    drain();
+}
+
+void BinaryLogger::flush() {
+    // Wait for every slot claimed before this call to reach the sink
+    size_t target = enqueue_pos_.load(std::memory_order_acquire);
+    while (written_.load(std::memory_order_acquire) < target &&
+           !stopping_.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+}
+
+void BinaryLogger::write_header() {
+    std::fwrite("MMBLOG01", 1, 8, file_);
+    write_raw(file_, static_cast<uint16_t>(std::size(kEvents)));
+    for (const auto& info : kEvents) {
+        write_raw(file_, static_cast<uint16_t>(info.id));
+        write_raw(file_, static_cast<uint8_t>(info.level));
+        write_str(file_, info.name);
+        write_str(file_, info.format);
+    }
+}
+
+std::string BinaryLogger::format(const BinaryLogRecord& record) {
+    const EventInfo* info = find_event(record.event);
+    if (!info) {
+        return "event " + std::to_string(record.event);
+    }
+    std::string_view fmt = info->format;
+
+    // Decode args lazily as placeholders are reached
+    size_t offset = 0;
+    uint8_t remaining = record.arg_count;
+    auto next_arg = [&](bool fixed2, std::string& out) {
+        if (remaining == 0 || offset >= record.payload_size) {
+            out += "?";
+            return;
+        }
+        remaining--;
+        uint8_t type = record.payload[offset++];
+        char buf[64];
+        if (type == BinaryLogRecord::kInt) {
+            int64_t value;
+            std::memcpy(&value, record.payload + offset, sizeof(value));
+            offset += sizeof(value);
+            out += std::to_string(value);
+        } else if (type == BinaryLogRecord::kDouble) {
+            double value;
+            std::memcpy(&value, record.payload + offset, sizeof(value));
+            offset += sizeof(value);
+            int n = std::snprintf(buf, sizeof(buf), fixed2 ? "%.2f" : "%g", value);
+            out.append(buf, static_cast<size_t>(n));
+        } else {
+            uint8_t len = record.payload[offset++];
+            out.append(reinterpret_cast<const char*>(record.payload + offset), len);
+            offset += len;
+        }
+    };
+
+    std::string out;
+    out.reserve(fmt.size() + record.payload_size);
+    for (size_t i = 0; i < fmt.size(); ++i) {
+        if (fmt[i] == '{') {
+            size_t close = fmt.find('}', i);
+            if (close != std::string_view::npos) {
+                next_arg(fmt.substr(i, close - i + 1) == "{:.2f}", out);
+                i = close;
+                continue;
+            }
+        }
+        out += fmt[i];
+    }
+    return out;
+}
+
+} // namespace matchmaker
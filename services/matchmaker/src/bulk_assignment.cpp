@@ -0,0 +1,254 @@
+#include "matchmaker/bulk_assignment.hpp"
+#include "matchmaker/team_builder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <tuple>
+
+namespace matchmaker {
+
+namespace {
+
+// Below this many parties per thread the thread start-up outweighs the work
+constexpr size_t kMinPartiesPerThread = 4096;
+
+// How far past the anchor to look for parties that fit, per lobby slot
+constexpr size_t kLookaheadPerSlot = 4;
+
+struct SortKey {
+    int mmr;
+    uint32_t index;
+
+    bool operator<(const SortKey& other) const {
+        return mmr != other.mmr ? mmr < other.mmr : index < other.index;
+    }
+};
+
+struct SliceResult {
+    std::vector<MatchResult> lobbies;
+    std::vector<SortKey> set_aside;     // Anchors whose lobby failed, MMR order
+};
+
+template <typename Fn>
+void run_on_threads(size_t threads, Fn fn) {
+    if (threads <= 1) {
+        fn(0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) {
+        workers.emplace_back(fn, t);
+    }
+    fn(0);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+bool teams_full(const MatchResult& match, int team_size) {
+    return std::all_of(match.teams.begin(), match.teams.end(),
+        [team_size](const std::vector<std::string>& team) {
+            return static_cast<int>(team.size()) == team_size;
+        });
+}
+
+// Rebuild the match's teams from per-team party lists and rescore it
+void regroup(MatchResult& match, const std::vector<std::vector<const QueueEntry*>>& teams,
+             const std::vector<QueueEntry>& window) {
+    match.teams.assign(teams.size(), {});
+    match.party_ids.clear();
+    match.party_mmrs.clear();
+    match.party_enqueued_at.clear();
+    for (size_t t = 0; t < teams.size(); ++t) {
+        for (const QueueEntry* entry : teams[t]) {
+            match.teams[t].insert(match.teams[t].end(), entry->player_ids.begin(), entry->player_ids.end());
+            match.party_ids.push_back(entry->party_id);
+            match.party_mmrs.push_back(entry->avg_mmr);
+            match.party_enqueued_at.push_back(entry->enqueued_at);
+        }
+    }
+    match.quality_score = TeamBuilder::calculate_match_quality(match, window);
+}
+
+// TeamBuilder balances on MMR alone, which can leave premade stacks with
+// uneven head counts. Redo the split with capacity: largest parties first,
+// each to the lowest-MMR team it still fits in.
+bool split_with_capacity(const std::vector<QueueEntry>& window, int team_size, int num_teams,
+                         std::vector<std::vector<const QueueEntry*>>& teams) {
+    std::vector<const QueueEntry*> parties;
+    for (const auto& entry : window) {
+        parties.push_back(&entry);
+    }
+    std::sort(parties.begin(), parties.end(), [](const QueueEntry* a, const QueueEntry* b) {
+        return a->party_size != b->party_size ? a->party_size > b->party_size : a->avg_mmr > b->avg_mmr;
+    });
+    teams.assign(num_teams, {});
+    std::vector<int> open(num_teams, team_size);
+    std::vector<int64_t> mmr_sum(num_teams, 0);
+    for (const QueueEntry* party : parties) {
+        int best = -1;
+        for (int t = 0; t < num_teams; ++t) {
+            if (open[t] >= party->party_size && (best < 0 || mmr_sum[t] < mmr_sum[best])) {
+                best = t;
+            }
+        }
+        if (best < 0) {
+            return false;
+        }
+        teams[best].push_back(party);
+        open[best] -= party->party_size;
+        mmr_sum[best] += static_cast<int64_t>(party->avg_mmr) * party->party_size;
+    }
+    return true;
+}
+
+// Form lobbies from keys[0, count), which are in MMR order
+void form_lobbies(const std::vector<QueueEntry>& pool, const SortKey* keys, size_t count,
+                  int team_size, const BulkAssignmentConfig& config, SliceResult& out) {
+    const size_t lookahead = kLookaheadPerSlot * static_cast<size_t>(team_size * config.num_teams);
+    std::vector<char> taken(count, 0);
+    std::vector<size_t> members;
+    std::vector<int> packed;                 // Team each member was packed into
+    std::vector<int> open(config.num_teams);
+    std::vector<QueueEntry> window;
+    std::vector<std::vector<const QueueEntry*>> teams;
+
+    // Best fit: the team with the fewest open slots that still takes the party
+    auto pack = [&](int party_size) {
+        int best = -1;
+        for (int t = 0; t < config.num_teams; ++t) {
+            if (open[t] >= party_size && (best < 0 || open[t] < open[best])) {
+                best = t;
+            }
+        }
+        if (best >= 0) {
+            open[best] -= party_size;
+        }
+        return best;
+    };
+
+    for (size_t anchor = 0; anchor < count; ++anchor) {
+        if (taken[anchor]) {
+            continue;
+        }
+
+        // The anchor plus the next parties (by MMR) that still pack into the teams
+        const QueueEntry& anchor_entry = pool[keys[anchor].index];
+        std::fill(open.begin(), open.end(), team_size);
+        int open_slots = team_size * config.num_teams - anchor_entry.party_size;
+        members.assign(1, anchor);
+        packed.assign(1, pack(anchor_entry.party_size));
+        for (size_t j = anchor + 1; j < count && open_slots > 0 && j - anchor <= lookahead; ++j) {
+            if (keys[j].mmr - anchor_entry.avg_mmr > config.mmr_tolerance) {
+                break;
+            }
+            int party_size = pool[keys[j].index].party_size;
+            if (taken[j]) {
+                continue;
+            }
+            int team = pack(party_size);
+            if (team >= 0) {
+                members.push_back(j);
+                packed.push_back(team);
+                open_slots -= party_size;
+            }
+        }
+
+        if (open_slots == 0) {
+            window.clear();
+            for (size_t member : members) {
+                window.push_back(pool[keys[member].index]);
+            }
+            auto match = TeamBuilder::try_form_match(window, team_size, config.num_teams, config.mmr_tolerance);
+            if (match.has_value() && !teams_full(*match, team_size)) {
+                if (!split_with_capacity(window, team_size, config.num_teams, teams)) {
+                    // The packing found while picking members always fits
+                    teams.assign(config.num_teams, {});
+                    for (size_t m = 0; m < window.size(); ++m) {
+                        teams[packed[m]].push_back(&window[m]);
+                    }
+                }
+                regroup(*match, teams, window);
+            }
+            if (match.has_value() && match->quality_score >= config.min_match_quality) {
+                for (size_t member : members) {
+                    taken[member] = 1;
+                }
+                out.lobbies.push_back(std::move(*match));
+                continue;
+            }
+        }
+        out.set_aside.push_back(keys[anchor]);
+    }
+}
+
+} // namespace
+
+BulkAssignmentResult assign_lobbies(const std::vector<QueueEntry>& pool, const BulkAssignmentConfig& config) {
+    BulkAssignmentResult result;
+    size_t max_threads = config.threads > 0
+        ? config.threads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    // Group by bucket, in key order so the output is stable run to run.
+    // Parties that can never fill a team exactly are turned away up front.
+    std::map<std::tuple<std::string, std::string, int>, std::vector<SortKey>> buckets;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        const QueueEntry& entry = pool[i];
+        if (entry.team_size <= 0 || entry.party_size <= 0 || entry.party_size > entry.team_size ||
+            entry.player_ids.size() != static_cast<size_t>(entry.party_size)) {
+            result.unassigned.push_back(entry.party_id);
+            continue;
+        }
+        buckets[{entry.region, entry.mode, entry.team_size}].push_back({entry.avg_mmr, static_cast<uint32_t>(i)});
+    }
+
+    auto now = std::chrono::system_clock::now();
+    for (auto& [bucket, keys] : buckets) {
+        const auto& [region, mode, team_size] = bucket;
+        size_t threads = std::clamp<size_t>(keys.size() / kMinPartiesPerThread, 1, max_threads);
+        auto slice_begin = [&keys, threads](size_t t) { return keys.size() * t / threads; };
+
+        // Sort each slice on its own thread, then merge the sorted runs
+        run_on_threads(threads, [&](size_t t) {
+            std::sort(keys.begin() + slice_begin(t), keys.begin() + slice_begin(t + 1));
+        });
+        for (size_t t = 1; t < threads; ++t) {
+            std::inplace_merge(keys.begin(), keys.begin() + slice_begin(t), keys.begin() + slice_begin(t + 1));
+        }
+
+        // Contiguous MMR slices in parallel, then one pass over what they set aside
+        std::vector<SliceResult> slices(threads + 1);
+        run_on_threads(threads, [&](size_t t) {
+            form_lobbies(pool, keys.data() + slice_begin(t), slice_begin(t + 1) - slice_begin(t),
+                         team_size, config, slices[t]);
+        });
+        std::vector<SortKey> set_aside;
+        for (size_t t = 0; t < threads; ++t) {
+            set_aside.insert(set_aside.end(), slices[t].set_aside.begin(), slices[t].set_aside.end());
+        }
+        SliceResult& rest = slices[threads];
+        form_lobbies(pool, set_aside.data(), set_aside.size(), team_size, config, rest);
+        for (const auto& key : rest.set_aside) {
+            result.unassigned.push_back(pool[key.index].party_id);
+        }
+
+        for (auto& slice : slices) {
+            for (auto& lobby : slice.lobbies) {
+                lobby.match_id = config.lobby_id_prefix + "-" + std::to_string(result.lobbies.size() + 1);
+                lobby.region = region;
+                lobby.mode = mode;
+                lobby.team_size = team_size;
+                lobby.mmr_band = config.mmr_tolerance;
+                lobby.formed_at = now;
+                result.players_assigned += static_cast<size_t>(team_size * config.num_teams);
+                result.lobbies.push_back(std::move(lobby));
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace matchmaker
@@ -0,0 +1,386 @@
+#include "matchmaker/compatibility_graph.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace matchmaker {
+
+CompatibilityGraph::CompatibilityGraph(const QueueConfig& config)
+    : config_(config) {}
+
+void CompatibilityGraph::add(const QueueEntry& entry, std::chrono::system_clock::time_point now) {
+    if (contains(entry.party_id)) {
+        remove(entry.party_id);
+    }
+
+    uint32_t id;
+    if (!free_nodes_.empty()) {
+        id = free_nodes_.back();
+        free_nodes_.pop_back();
+    } else {
+        id = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    Node& node = nodes_[id];
+    id_bytes_ -= string_heap_bytes(node.party_id);
+    node.party_id = entry.party_id;
+    id_bytes_ += 2 * string_heap_bytes(node.party_id);  // Node and index key
+    node.mmr = entry.avg_mmr;
+    node.party_size = entry.party_size;
+    node.enqueued_at = entry.enqueued_at;
+    node.alive = true;
+    node.generation++;
+    node.band = band_at(node, now);
+    reset_singleton(id);
+
+    index_[node.party_id] = id;
+
+    MmrSlot& slot = slots_[node.mmr];
+    if (!slot.nodes.empty()) {
+        unite(id, slot.nodes.front());
+    }
+    slot.nodes.push_back(id);
+    if (node.band > slot.max_band) {
+        slot.max_band = node.band;
+        slot.widest = id;
+    }
+
+    connect_range(id, -1);
+    mark_dirty(find(id));
+    schedule_next_step(id);
+}
+
+void CompatibilityGraph::remove(const std::string& party_id) {
+    auto it = index_.find(party_id);
+    if (it == index_.end()) {
+        return;
+    }
+
+    uint32_t id = it->second;
+    Node& node = nodes_[id];
+    node.alive = false;
+    node.generation++;  // Drops any pending widen event
+    id_bytes_ -= string_heap_bytes(it->first);
+    index_.erase(it);
+
+    auto slot_it = slots_.find(node.mmr);
+    auto& slot_nodes = slot_it->second.nodes;
+    slot_nodes.erase(std::find(slot_nodes.begin(), slot_nodes.end(), id));
+    if (slot_nodes.empty()) {
+        slots_.erase(slot_it);
+    } else {
+        refresh_slot_band(slot_it->second);
+    }
+
+    // The node stays in its cluster as a union-find path until the cluster
+    // is re-split; it just stops counting towards the player total.
+    uint32_t root = find(id);
+    Node& root_node = nodes_[root];
+    root_node.players -= node.party_size;
+    root_node.stale = true;
+
+    if (root_node.players <= 0) {
+        for (uint32_t member : root_node.members) {
+            nodes_[member].party_id.clear();
+            free_nodes_.push_back(member);
+        }
+        root_node.members.clear();
+        root_node.dirty = false;
+        return;
+    }
+
+    mark_dirty(root);
+}
+
+bool CompatibilityGraph::contains(const std::string& party_id) const {
+    return index_.find(party_id) != index_.end();
+}
+
+void CompatibilityGraph::advance(std::chrono::system_clock::time_point now) {
+    while (!events_.empty() && events_.top().at <= now) {
+        WidenEvent event = events_.top();
+        events_.pop();
+
+        Node& node = nodes_[event.node];
+        if (!node.alive || node.generation != event.generation) {
+            continue;
+        }
+
+        int new_band = band_at(node, now);
+        if (new_band > node.band) {
+            int old_band = node.band;
+            node.band = new_band;
+            MmrSlot& slot = slots_[node.mmr];
+            if (new_band > slot.max_band) {
+                slot.max_band = new_band;
+                slot.widest = event.node;
+            }
+            connect_range(event.node, old_band);
+
+            // Even without new edges the anchor tolerance grew, so the
+            // cluster deserves another look.
+            mark_dirty(find(event.node));
+        }
+        schedule_next_step(event.node);
+    }
+}
+
+std::vector<std::vector<std::string>> CompatibilityGraph::take_viable_clusters(int min_players) {
+    std::vector<std::vector<std::string>> clusters;
+    std::vector<uint32_t> pending;
+    pending.swap(dirty_);
+
+    auto emit = [&](uint32_t root) {
+        Node& root_node = nodes_[root];
+        root_node.dirty = false;
+        if (root_node.players < min_players) {
+            return;
+        }
+        std::vector<std::string> members;
+        members.reserve(root_node.members.size());
+        for (uint32_t member : root_node.members) {
+            if (nodes_[member].alive) {
+                members.push_back(nodes_[member].party_id);
+            }
+        }
+        clusters.push_back(std::move(members));
+    };
+
+    for (uint32_t id : pending) {
+        if (!nodes_[id].dirty) {
+            continue;
+        }
+        nodes_[id].dirty = false;
+
+        // Only roots carry cluster state; merged-away roots were re-marked
+        // through their new root.
+        if (find(id) != id || nodes_[id].players < min_players) {
+            continue;
+        }
+
+        if (nodes_[id].stale) {
+            for (uint32_t root : resplit(id)) {
+                emit(root);
+            }
+        } else {
+            emit(id);
+        }
+    }
+
+    return clusters;
+}
+
+size_t CompatibilityGraph::cluster_count() const {
+    size_t count = 0;
+    for (uint32_t id = 0; id < nodes_.size(); ++id) {
+        const Node& node = nodes_[id];
+        if (node.parent == id && node.players > 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+int64_t CompatibilityGraph::memory_bytes() const {
+    // Node-based containers are estimated at two pointers per node; member
+    // lists hold each live node once
+    constexpr size_t kNodeOverhead = 2 * sizeof(void*);
+    size_t bytes = nodes_.capacity() * sizeof(Node)
+        + nodes_.size() * sizeof(uint32_t)
+        + free_nodes_.capacity() * sizeof(uint32_t)
+        + index_.size() * (sizeof(std::pair<const std::string, uint32_t>) + kNodeOverhead)
+        + index_.bucket_count() * sizeof(void*)
+        + slots_.size() * (sizeof(std::pair<const int, MmrSlot>) + 2 * kNodeOverhead + sizeof(uint32_t))
+        + events_.size() * sizeof(WidenEvent)
+        + dirty_.capacity() * sizeof(uint32_t);
+    return static_cast<int64_t>(bytes) + id_bytes_;
+}
+
+int64_t CompatibilityGraph::add_growth_bytes() const {
+    size_t bytes = 0;
+    if (free_nodes_.empty() && nodes_.size() == nodes_.capacity()) {
+        bytes += std::max<size_t>(nodes_.capacity(), 1) * sizeof(Node);
+    }
+    if (dirty_.size() == dirty_.capacity()) {
+        bytes += std::max<size_t>(dirty_.capacity(), 1) * sizeof(uint32_t);
+    }
+    if (static_cast<float>(index_.size() + 1) > index_.max_load_factor() * static_cast<float>(index_.bucket_count())) {
+        bytes += index_.bucket_count() * sizeof(void*);
+    }
+    return static_cast<int64_t>(bytes);
+}
+
+int CompatibilityGraph::band_at(const Node& node, std::chrono::system_clock::time_point now) const {
+    return config_.mmr_band_at(node.enqueued_at, now);
+}
+
+void CompatibilityGraph::schedule_next_step(uint32_t id) {
+    const Node& node = nodes_[id];
+    if (node.band >= config_.mmr_band_max || config_.mmr_band_growth_per_sec <= 0) {
+        return;
+    }
+
+    // The band steps once per whole second of waiting
+    int steps_taken = std::max(0, (node.band - config_.mmr_band_initial) / config_.mmr_band_growth_per_sec);
+    auto at = node.enqueued_at + std::chrono::seconds(steps_taken + 1);
+    events_.push({at, id, node.generation});
+}
+
+void CompatibilityGraph::connect_range(uint32_t id, int old_band) {
+    const int mmr = nodes_[id].mmr;
+    const int band = nodes_[id].band;
+
+    // An edge to any party in a slot exists iff the slot's widest band
+    // covers the gap; slot members are already in one cluster.
+    auto connect = [&](int lo, int hi) {
+        if (lo > hi) {
+            return;
+        }
+        auto it = slots_.lower_bound(lo);
+        auto end = slots_.upper_bound(hi);
+        for (; it != end; ++it) {
+            if (it->first != mmr && it->second.max_band >= std::abs(it->first - mmr)) {
+                unite(id, it->second.widest);
+            }
+        }
+    };
+
+    if (old_band < 0) {
+        connect(mmr - band, mmr + band);
+    } else {
+        // Only the newly covered slices can hold new edges
+        connect(mmr - band, mmr - old_band - 1);
+        connect(mmr + old_band + 1, mmr + band);
+    }
+}
+
+void CompatibilityGraph::refresh_slot_band(MmrSlot& slot) {
+    slot.max_band = -1;
+    for (uint32_t id : slot.nodes) {
+        if (nodes_[id].band > slot.max_band) {
+            slot.max_band = nodes_[id].band;
+            slot.widest = id;
+        }
+    }
+}
+
+void CompatibilityGraph::reset_singleton(uint32_t id) {
+    Node& node = nodes_[id];
+    node.parent = id;
+    node.rank = 0;
+    node.players = node.party_size;
+    node.dirty = false;
+    node.stale = false;
+    node.members.assign(1, id);
+}
+
+uint32_t CompatibilityGraph::find(uint32_t id) {
+    while (nodes_[id].parent != id) {
+        nodes_[id].parent = nodes_[nodes_[id].parent].parent;  // Path halving
+        id = nodes_[id].parent;
+    }
+    return id;
+}
+
+void CompatibilityGraph::unite(uint32_t a, uint32_t b) {
+    uint32_t root_a = find(a);
+    uint32_t root_b = find(b);
+    if (root_a == root_b) {
+        return;
+    }
+
+    if (nodes_[root_a].rank < nodes_[root_b].rank) {
+        std::swap(root_a, root_b);
+    }
+    Node& keep = nodes_[root_a];
+    Node& merged = nodes_[root_b];
+
+    merged.parent = root_a;
+    if (keep.rank == merged.rank) {
+        keep.rank++;
+    }
+
+    // Append the smaller member list to the larger one
+    if (keep.members.size() < merged.members.size()) {
+        keep.members.swap(merged.members);
+    }
+    keep.members.insert(keep.members.end(), merged.members.begin(), merged.members.end());
+    merged.members.clear();
+
+    keep.players += merged.players;
+    keep.stale = keep.stale || merged.stale;
+    mark_dirty(root_a);
+}
+
+void CompatibilityGraph::mark_dirty(uint32_t root) {
+    if (!nodes_[root].dirty) {
+        nodes_[root].dirty = true;
+        dirty_.push_back(root);
+    }
+}
+
+std::vector<uint32_t> CompatibilityGraph::resplit(uint32_t root) {
+    std::vector<uint32_t> members;
+    members.swap(nodes_[root].members);
+
+    // Free departed members, restart survivors as singletons
+    std::vector<uint32_t> live;
+    live.reserve(members.size());
+    for (uint32_t member : members) {
+        if (nodes_[member].alive) {
+            live.push_back(member);
+        } else {
+            nodes_[member].party_id.clear();
+            free_nodes_.push_back(member);
+        }
+    }
+    for (uint32_t member : live) {
+        reset_singleton(member);
+    }
+
+    // Rebuild connectivity among survivors in MMR order. Equal MMRs are
+    // merged outright; distinct MMRs connect when both sides have a party
+    // whose band covers the gap.
+    std::sort(live.begin(), live.end(), [this](uint32_t a, uint32_t b) {
+        return nodes_[a].mmr < nodes_[b].mmr;
+    });
+    struct Group {
+        int mmr;
+        int max_band;
+        uint32_t widest;
+    };
+    std::vector<Group> groups;
+    for (uint32_t member : live) {
+        const Node& node = nodes_[member];
+        if (!groups.empty() && groups.back().mmr == node.mmr) {
+            unite(groups.back().widest, member);
+            if (node.band > groups.back().max_band) {
+                groups.back().max_band = node.band;
+                groups.back().widest = member;
+            }
+        } else {
+            groups.push_back({node.mmr, node.band, member});
+        }
+    }
+    for (size_t i = 0; i < groups.size(); ++i) {
+        for (size_t j = i + 1; j < groups.size(); ++j) {
+            int gap = groups[j].mmr - groups[i].mmr;
+            if (gap > groups[i].max_band) {
+                break;
+            }
+            if (groups[j].max_band >= gap) {
+                unite(groups[i].widest, groups[j].widest);
+            }
+        }
+    }
+
+    std::vector<uint32_t> roots;
+    for (uint32_t member : live) {
+        if (find(member) == member) {
+            roots.push_back(member);
+        }
+    }
+    return roots;
+}
+
+} // namespace matchmaker
@@ -0,0 +1,252 @@
+#include "matchmaker/jetstream.hpp"
+#include <algorithm>
+
+namespace matchmaker {
+
+// Client side of a durable: every call is one request to the stand-in
+class JetStreamStandIn::Handle : public PullConsumer {
+public:
+    Handle(JetStreamStandIn& server, std::string durable)
+        : server_(server), durable_(std::move(durable)) {}
+
+    std::vector<JetStreamMessage> fetch(size_t max_messages, std::chrono::milliseconds wait) override {
+        round_trips_++;
+        return server_.fetch(durable_, max_messages, wait);
+    }
+
+    bool ack_all(uint64_t stream_sequence) override {
+        round_trips_++;
+        return server_.ack_all(durable_, stream_sequence);
+    }
+
+    uint64_t round_trips() const override { return round_trips_; }
+
+private:
+    JetStreamStandIn& server_;
+    std::string durable_;
+    uint64_t round_trips_ = 0;
+};
+
+uint64_t JetStreamStandIn::publish(const std::string& subject, std::string data) {
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sequence = ++last_sequence_;
+        messages_.push_back({sequence, 0, subject, std::move(data)});
+    }
+    published_.notify_all();
+    return sequence;
+}
+
+std::unique_ptr<PullConsumer> JetStreamStandIn::pull_consumer(const PullConsumerConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, created] = consumers_.try_emplace(config.durable_name);
+    if (created) {
+        it->second.config = config;
+        // A new durable starts at the first message still stored
+        it->second.info.delivered = messages_.empty()
+            ? last_sequence_ : messages_.front().stream_sequence - 1;
+        it->second.info.ack_floor = it->second.info.delivered;
+    }
+    return std::make_unique<Handle>(*this, config.durable_name);
+}
+
+uint64_t JetStreamStandIn::last_sequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_sequence_;
+}
+
+size_t JetStreamStandIn::stored_messages() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return messages_.size();
+}
+
+JetStreamStandIn::ConsumerInfo JetStreamStandIn::consumer_info(const std::string& durable_name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = consumers_.find(durable_name);
+    if (it == consumers_.end()) {
+        return {};
+    }
+    ConsumerInfo info = it->second.info;
+    info.ack_pending = it->second.pending.size();
+    return info;
+}
+
+bool JetStreamStandIn::subject_matches(const std::string& filter, const std::string& subject) {
+    return matchmaker::subject_matches(filter, subject);
+}
+
+std::vector<JetStreamMessage> JetStreamStandIn::fetch(const std::string& durable, size_t max_messages,
+                                                      std::chrono::milliseconds wait) {
+    std::vector<JetStreamMessage> out;
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = consumers_.find(durable);
+    if (it == consumers_.end() || max_messages == 0) {
+        return out;
+    }
+    Consumer& consumer = it->second;
+
+    auto give_up = std::chrono::steady_clock::now() + wait;
+    while (true) {
+        collect(consumer, max_messages, out);
+        if (!out.empty() || std::chrono::steady_clock::now() >= give_up) {
+            break;
+        }
+        // Wake for a publish, the earliest redelivery or the end of the wait
+        auto until = give_up;
+        for (const auto& [sequence, pending] : consumer.pending) {
+            until = std::min(until, pending.deadline);
+        }
+        published_.wait_until(lock, until);
+    }
+    trim();
+    return out;
+}
+
+void JetStreamStandIn::collect(Consumer& consumer, size_t max_messages, std::vector<JetStreamMessage>& out) {
+    auto now = std::chrono::steady_clock::now();
+
+    // Redeliveries first, oldest sequence first
+    for (auto it = consumer.pending.begin(); it != consumer.pending.end() && out.size() < max_messages;) {
+        Pending& pending = it->second;
+        if (pending.deadline > now) {
+            ++it;
+            continue;
+        }
+        if (consumer.config.max_deliver > 0 && pending.deliveries >= consumer.config.max_deliver) {
+            consumer.info.terminated++;
+            it = consumer.pending.erase(it);
+            continue;
+        }
+        pending.deliveries++;
+        pending.deadline = now + consumer.config.ack_wait;
+        consumer.info.redelivered++;
+        if (const JetStreamMessage* message = find(it->first)) {
+            out.push_back(*message);
+            out.back().deliveries = pending.deliveries;
+        }
+        ++it;
+    }
+
+    // Then new messages in stream order
+    while (out.size() < max_messages && consumer.info.delivered < last_sequence_) {
+        uint64_t sequence = ++consumer.info.delivered;
+        const JetStreamMessage* message = find(sequence);
+        if (message == nullptr || !subject_matches(consumer.config.filter_subject, message->subject)) {
+            continue;
+        }
+        consumer.pending[sequence] = {now + consumer.config.ack_wait, 1};
+        out.push_back(*message);
+        out.back().deliveries = 1;
+    }
+
+    consumer.info.ack_floor = consumer.pending.empty()
+        ? consumer.info.delivered : consumer.pending.begin()->first - 1;
+}
+
+bool JetStreamStandIn::ack_all(const std::string& durable, uint64_t stream_sequence) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = consumers_.find(durable);
+    if (it == consumers_.end()) {
+        return false;
+    }
+    Consumer& consumer = it->second;
+    consumer.pending.erase(consumer.pending.begin(), consumer.pending.upper_bound(stream_sequence));
+    consumer.info.ack_floor = consumer.pending.empty()
+        ? consumer.info.delivered : consumer.pending.begin()->first - 1;
+    trim();
+    return true;
+}
+
+const JetStreamMessage* JetStreamStandIn::find(uint64_t stream_sequence) const {
+    if (messages_.empty() || stream_sequence < messages_.front().stream_sequence) {
+        return nullptr;
+    }
+    size_t index = stream_sequence - messages_.front().stream_sequence;
+    return index < messages_.size() ? &messages_[index] : nullptr;
+}
+
+void JetStreamStandIn::trim() {
+    if (consumers_.empty()) {
+        return;
+    }
+    uint64_t floor = last_sequence_;
+    for (const auto& [name, consumer] : consumers_) {
+        floor = std::min(floor, consumer.info.ack_floor);
+    }
+    while (!messages_.empty() && messages_.front().stream_sequence <= floor) {
+        messages_.pop_front();
+    }
+}
+
+DurableQueueIngest::DurableQueueIngest(PullConsumer& consumer, QueueManager& queue_manager,
+                                       NatsClient::QueueEventCallback handler, size_t batch_size)
+    : consumer_(consumer),
+      queue_manager_(queue_manager),
+      handler_(std::move(handler)),
+      batch_size_(std::max<size_t>(batch_size, 1)),
+      applied_sequence_(queue_manager.ingest_checkpoint()) {}
+
+size_t DurableQueueIngest::poll(std::chrono::milliseconds wait) {
+    // Messages held behind a refused dead letter go first, and nothing new
+    // is fetched until the dead-letter handler takes it
+    bool retrying = !held_.empty();
+    auto batch = retrying ? std::move(held_) : consumer_.fetch(batch_size_, wait);
+    held_.clear();
+    if (batch.empty()) {
+        return 0;
+    }
+
+    uint64_t checkpoint = applied_sequence_;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const auto& message = batch[i];
+        bool seen = retrying && i == 0;     // Counted when it was first held
+        if (!seen) {
+            stats_.fetched++;
+            if (message.deliveries > 1) {
+                stats_.redelivered++;
+            }
+        }
+        if (message.stream_sequence <= applied_sequence_) {
+            handled_sequence_ = std::max(handled_sequence_, message.stream_sequence);
+            stats_.skipped++;
+            continue;
+        }
+        auto event = decode_queue_event(message.data);
+        if (!event) {
+            if (!seen) {
+                stats_.malformed++;
+            }
+            if (!dead_letter_ || !dead_letter_(message)) {
+                // An AckAll past it would drop it: stop here and retry next poll
+                held_.assign(batch.begin() + static_cast<std::ptrdiff_t>(i), batch.end());
+                break;
+            }
+            stats_.dead_lettered++;
+        } else {
+            handler_(*event);
+            stats_.applied++;
+        }
+        applied_sequence_ = message.stream_sequence;
+        handled_sequence_ = std::max(handled_sequence_, message.stream_sequence);
+    }
+    if (applied_sequence_ != checkpoint) {
+        queue_manager_.checkpoint_ingest(applied_sequence_);
+    }
+    return batch.size();
+}
+
+bool DurableQueueIngest::commit() {
+    if (!ack_pending() || queue_manager_.pending_store_ops() > 0) {
+        return false;
+    }
+    stats_.acks++;
+    if (!consumer_.ack_all(handled_sequence_)) {
+        stats_.ack_failures++;
+        return false;
+    }
+    acked_sequence_ = handled_sequence_;
+    return true;
+}
+
+} // namespace matchmaker
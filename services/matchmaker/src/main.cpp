@@ -1,24 +1,266 @@
 #include "matchmaker/queue_manager.hpp"
+#include "matchmaker/bulk_assignment.hpp"
+#include "matchmaker/match_serializer.hpp"
 #include "matchmaker/nats_client.hpp"
+#include "matchmaker/jetstream.hpp"
+#include "matchmaker/matching_strategy.hpp"
+#include "matchmaker/match_exporter.hpp"
+#include "matchmaker/binary_log.hpp"
+#include "matchmaker/tracing.hpp"
+#include "matchmaker/metrics.hpp"
+#include "matchmaker/policy.hpp"
+#include "matchmaker/queue_store.hpp"
+#include "matchmaker/tenant_host.hpp"
+#include "matchmaker/wakeup.hpp"
+#include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <csignal>
+#include <cstdlib>
 #include <atomic>
+#include <memory>
+#include <sstream>
 
 namespace {
 std::atomic<bool> g_running{true};
 
+// Wakes the tick loop early: new queue events, backfills, policy reloads
+// and shutdown
+matchmaker::Wakeup g_wakeup;
+
+// Comma-separated env list ("us-east,eu-west"); unset = empty
+std::vector<std::string> env_list(const char* name) {
+    std::vector<std::string> values;
+    const char* raw = std::getenv(name);
+    if (raw == nullptr) {
+        return values;
+    }
+    std::stringstream stream(raw);
+    std::string value;
+    while (std::getline(stream, value, ',')) {
+        if (!value.empty()) {
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+const char* rejection_reason(matchmaker::EnqueueRejection reason) {
+    switch (reason) {
+        case matchmaker::EnqueueRejection::Region: return "region";
+        case matchmaker::EnqueueRejection::Mode: return "mode";
+        case matchmaker::EnqueueRejection::TeamSize: return "team_size";
+        case matchmaker::EnqueueRejection::PartySize: return "party_size";
+        case matchmaker::EnqueueRejection::BucketLimit: return "bucket_limit";
+        case matchmaker::EnqueueRejection::MemoryBudget: return "memory_budget";
+    }
+    return "unknown";
+}
+
+void describe_metrics(matchmaker::MetricsRegistry& metrics) {
+    using Type = matchmaker::MetricsRegistry::Type;
+    metrics.describe("matchmaker_queued_parties", Type::Gauge, "Parties waiting, by bucket");
+    metrics.describe("matchmaker_matches_total", Type::Counter, "Matches formed and published");
+    metrics.describe("matchmaker_memory_bytes", Type::Gauge, "Queue memory by component");
+    metrics.describe("matchmaker_bucket_memory_bytes", Type::Gauge, "Queue memory by bucket and component");
+    metrics.describe("matchmaker_memory_budget_bytes", Type::Gauge, "Admission control budget (0 = unlimited)");
+    metrics.describe("matchmaker_admission_rejections_total", Type::Counter, "Enqueues rejected by the memory budget");
+    metrics.describe("matchmaker_buckets", Type::Gauge, "Live queue buckets");
+    metrics.describe("matchmaker_bucket_events_total", Type::Counter, "Bucket creations, idle evictions and storage reuse");
+    metrics.describe("matchmaker_enqueue_rejections_total", Type::Counter, "Enqueues rejected by allow-lists and bucket limits");
+    metrics.describe("matchmaker_policy_reloads_total", Type::Counter, "Policy file reloads by result");
+    metrics.describe("matchmaker_store_round_trips_total", Type::Counter, "Queue store network round trips");
+    metrics.describe("matchmaker_store_write_failures_total", Type::Counter, "Queue store batch writes that failed");
+    metrics.describe("matchmaker_store_pending_ops", Type::Gauge, "Queue mutations not yet written to the store");
+    metrics.describe("matchmaker_ingest_events_total", Type::Counter, "Durable consumer events by outcome");
+    metrics.describe("matchmaker_ingest_acks_total", Type::Counter, "Batched AckAll requests sent");
+    metrics.describe("matchmaker_ingest_stalled", Type::Gauge,
+                     "1 while an undecodable queue event could not be dead-lettered");
+    metrics.describe("matchmaker_backfill_requests_total", Type::Counter, "Backfill requests by outcome");
+    metrics.describe("matchmaker_backfill_pending", Type::Gauge, "Open backfill requests");
+    metrics.describe("matchmaker_backfill_players_total", Type::Counter, "Players assigned to backfills");
+    metrics.describe("matchmaker_backfill_fill_latency_seconds", Type::Histogram,
+                     "Time from a backfill request to its last slot being filled");
+    metrics.describe("matchmaker_lane_anchors_total", Type::Counter, "Matches formed per anchor priority lane");
+    metrics.describe("matchmaker_tenant_queued_parties", Type::Gauge, "Parties waiting, by hosted tenant");
+    metrics.describe("matchmaker_tenant_matches_total", Type::Counter, "Matches formed, by hosted tenant");
+    metrics.describe("matchmaker_tenant_tick_cpu_seconds", Type::Histogram, "CPU time per tenant tick");
+    metrics.describe("matchmaker_tenant_over_budget_ticks_total", Type::Counter,
+                     "Tenant ticks that hit the CPU budget and deferred buckets");
+    metrics.describe("matchmaker_tenant_deferred_buckets_total", Type::Counter,
+                     "Bucket visits deferred to a later tick by the tenant CPU budget");
+    metrics.describe("matchmaker_ticks_total", Type::Counter, "Tick loop iterations");
+    metrics.describe("matchmaker_early_wakeups_total", Type::Counter,
+                     "Idle sleeps cut short by a queue event, backfill or policy reload");
+}
+
+void export_queue_metrics(matchmaker::MetricsRegistry& metrics,
+                          const matchmaker::MemoryStats& memory,
+                          const matchmaker::BucketLifecycleStats& lifecycle,
+                          size_t total_matches) {
+    metrics.set("matchmaker_matches_total", static_cast<double>(total_matches));
+
+    metrics.set("matchmaker_memory_bytes", memory.party_index_bytes, {{"component", "party_index"}});
+    metrics.set("matchmaker_memory_bytes", memory.id_arena_bytes, {{"component", "id_arena"}});
+    metrics.set("matchmaker_memory_bytes", memory.bucket_bytes, {{"component", "buckets"}});
+    metrics.set("matchmaker_memory_bytes", memory.graph_bytes, {{"component", "compatibility_graph"}});
+    metrics.set("matchmaker_memory_bytes", memory.freelist_bytes, {{"component", "bucket_freelist"}});
+    metrics.set("matchmaker_memory_budget_bytes", memory.budget_bytes);
+    metrics.set("matchmaker_admission_rejections_total", static_cast<double>(memory.admission_rejections));
+
+    metrics.set("matchmaker_buckets", static_cast<double>(lifecycle.live));
+    metrics.set("matchmaker_bucket_events_total", static_cast<double>(lifecycle.created), {{"event", "created"}});
+    metrics.set("matchmaker_bucket_events_total", static_cast<double>(lifecycle.evicted), {{"event", "evicted"}});
+    metrics.set("matchmaker_bucket_events_total", static_cast<double>(lifecycle.recycled), {{"event", "recycled"}});
+    metrics.set("matchmaker_enqueue_rejections_total", static_cast<double>(lifecycle.rejected_region),
+                {{"reason", "region"}});
+    metrics.set("matchmaker_enqueue_rejections_total", static_cast<double>(lifecycle.rejected_mode),
+                {{"reason", "mode"}});
+    metrics.set("matchmaker_enqueue_rejections_total", static_cast<double>(lifecycle.rejected_team_size),
+                {{"reason", "team_size"}});
+    metrics.set("matchmaker_enqueue_rejections_total", static_cast<double>(lifecycle.rejected_party_size),
+                {{"reason", "party_size"}});
+    metrics.set("matchmaker_enqueue_rejections_total", static_cast<double>(lifecycle.rejected_bucket_limit),
+                {{"reason", "bucket_limit"}});
+
+    metrics.clear("matchmaker_queued_parties");
+    metrics.clear("matchmaker_bucket_memory_bytes");
+    for (const auto& [bucket, usage] : memory.buckets) {
+        metrics.set("matchmaker_queued_parties", static_cast<double>(usage.parties), {{"bucket", bucket}});
+        metrics.set("matchmaker_bucket_memory_bytes", usage.entry_bytes, {{"bucket", bucket}, {"component", "entries"}});
+        metrics.set("matchmaker_bucket_memory_bytes", usage.id_bytes, {{"bucket", bucket}, {"component", "ids"}});
+        metrics.set("matchmaker_bucket_memory_bytes", usage.graph_bytes, {{"bucket", bucket}, {"component", "graph"}});
+    }
+}
+
+/**
+ * matchmaker bulk-assign [options] [pool.jsonl]
+ *
+ * Offline lobby assignment for tournaments and scheduled events. Reads one
+ * party per line (party_id, avg_mmr, player_ids; optional region, mode,
+ * team_size, party_size) from the file or stdin and writes one match.found
+ * payload per lobby to stdout, then {"unassigned": [party ids]}.
+ */
+int run_bulk_assign(int argc, char* argv[]) {
+    matchmaker::BulkAssignmentConfig config;
+    int default_team_size = 5;
+    const char* input_path = nullptr;
+    for (int i = 0; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool takes_value = true;
+        if (std::strcmp(arg, "--team-size") == 0 && value) {
+            default_team_size = std::atoi(value);
+        } else if (std::strcmp(arg, "--teams") == 0 && value) {
+            config.num_teams = std::atoi(value);
+        } else if (std::strcmp(arg, "--band") == 0 && value) {
+            config.mmr_tolerance = std::atoi(value);
+        } else if (std::strcmp(arg, "--min-quality") == 0 && value) {
+            config.min_match_quality = std::atof(value);
+        } else if (std::strcmp(arg, "--threads") == 0 && value) {
+            config.threads = static_cast<size_t>(std::atoll(value));
+        } else if (std::strcmp(arg, "--prefix") == 0 && value) {
+            config.lobby_id_prefix = value;
+        } else if (arg[0] != '-' && input_path == nullptr) {
+            input_path = arg;
+            takes_value = false;
+        } else {
+            std::fprintf(stderr, "usage: matchmaker bulk-assign [--team-size N] [--teams N] [--band MMR] "
+                                 "[--min-quality Q] [--threads N] [--prefix ID] [pool.jsonl]\n");
+            return 2;
+        }
+        if (takes_value) {
+            ++i;
+        }
+    }
+    if (config.num_teams < 2 || default_team_size < 1) {
+        std::fprintf(stderr, "bulk-assign: need --teams >= 2 and --team-size >= 1\n");
+        return 2;
+    }
+
+    std::ifstream file;
+    if (input_path != nullptr) {
+        file.open(input_path);
+        if (!file) {
+            std::fprintf(stderr, "bulk-assign: cannot open %s\n", input_path);
+            return 1;
+        }
+    }
+    std::istream& in = input_path != nullptr ? file : std::cin;
+
+    std::vector<matchmaker::QueueEntry> pool;
+    size_t malformed = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        auto doc = nlohmann::json::parse(line, nullptr, false);
+        if (doc.is_discarded() || !doc.is_object()) {
+            malformed++;
+            continue;
+        }
+        try {
+            matchmaker::QueueEntry entry;
+            entry.party_id = doc.at("party_id").get<std::string>();
+            entry.avg_mmr = doc.at("avg_mmr").get<int>();
+            entry.player_ids = doc.value("player_ids", std::vector<std::string>{});
+            entry.region = doc.value("region", std::string());
+            entry.mode = doc.value("mode", std::string());
+            entry.team_size = doc.value("team_size", default_team_size);
+            entry.party_size = doc.value("party_size", static_cast<int>(entry.player_ids.size()));
+            pool.push_back(std::move(entry));
+        } catch (const nlohmann::json::exception&) {
+            malformed++;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = matchmaker::assign_lobbies(pool, config);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::string out;
+    for (const auto& lobby : result.lobbies) {
+        matchmaker::write_match_found(out, lobby);
+        out += '\n';
+    }
+    out += "{\"unassigned\":[";
+    for (size_t i = 0; i < result.unassigned.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        matchmaker::append_json_string(out, result.unassigned[i]);
+    }
+    out += "]}\n";
+    std::fwrite(out.data(), 1, out.size(), stdout);
+
+    std::fprintf(stderr, "bulk-assign: %zu parties (%zu malformed lines), %zu lobbies, %zu players placed, "
+                         "%zu parties unassigned in %.1f ms\n",
+        pool.size(), malformed, result.lobbies.size(), result.players_assigned,
+        result.unassigned.size(), elapsed_ms);
+    return 0;
+}
+
 void signal_handler(int signal) {
     if (signal == SIGINT || signal == SIGTERM) {
         spdlog::info("Received shutdown signal");
         g_running = false;
+        g_wakeup.notify();
     }
 }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "bulk-assign") == 0) {
+        return run_bulk_assign(argc - 2, argv + 2);
+    }
+
     // Setup logging
     spdlog::set_level(spdlog::level::info);
     spdlog::info("Matchmaker service starting...");
@@ -34,9 +276,111 @@ int main() {
     config.mmr_band_growth_per_sec = 10;
     config.max_wait_time_sec = 120;
     config.min_match_quality = 0.6;
+    if (const char* budget_mb = std::getenv("MATCHMAKER_MEMORY_BUDGET_MB")) {
+        config.memory_budget_bytes = static_cast<size_t>(std::atoll(budget_mb)) << 20;
+    }
+    config.allowed_regions = env_list("MATCHMAKER_REGIONS");
+    config.allowed_modes = env_list("MATCHMAKER_MODES");
+    if (const char* max_buckets = std::getenv("MATCHMAKER_MAX_BUCKETS")) {
+        config.max_buckets = static_cast<size_t>(std::atoll(max_buckets));
+    }
+    if (const char* idle_sec = std::getenv("MATCHMAKER_BUCKET_IDLE_SEC")) {
+        config.bucket_idle_evict_sec = std::atoi(idle_sec);
+    }
+    const char* position_ms = std::getenv("MATCHMAKER_POSITION_UPDATE_MS");
+    config.position_update_interval_ms = position_ms ? std::atoi(position_ms) : 1000;
 
-    // Initialize queue manager
-    matchmaker::QueueManager queue_manager(config);
+    // Every title is a tenant of one host, the primary title first under the
+    // name "default": each has its own queues and CPU budget per tick
+    // (MATCHMAKER_CPU_BUDGET_US for the primary title) and all are ticked on
+    // a shared pool, so a noisy title only defers its own buckets. Further
+    // titles come from MATCHMAKER_TENANTS=name[:cpu_us],...
+    auto tenant_specs = env_list("MATCHMAKER_TENANTS");
+    const char* tenant_threads = std::getenv("MATCHMAKER_TENANT_THREADS");
+    matchmaker::TenantHost tenants(tenant_threads
+        ? static_cast<size_t>(std::atoll(tenant_threads))
+        : std::min<size_t>(tenant_specs.size() + 1, std::max(std::thread::hardware_concurrency(), 1u)));
+    matchmaker::TenantConfig primary_config;
+    primary_config.name = "default";
+    primary_config.queue = config;
+    if (const char* cpu_budget = std::getenv("MATCHMAKER_CPU_BUDGET_US")) {
+        primary_config.cpu_budget = std::chrono::microseconds(std::atoll(cpu_budget));
+    }
+    matchmaker::QueueManager& queue_manager = *tenants.add_tenant(primary_config);
+
+    // Optional per-bucket policy file; edits are picked up without a restart
+    // and swapped in between ticks, so queued parties are kept
+    std::unique_ptr<matchmaker::PolicyWatcher> policy_watcher;
+    if (const char* policy_file = std::getenv("MATCHMAKER_POLICY_FILE")) {
+        std::string error;
+        auto policy = matchmaker::PolicySet::load(policy_file, &error);
+        if (!policy) {
+            spdlog::error("Failed to load policy {}: {}", policy_file, error);
+            return 1;
+        }
+        spdlog::info("Loaded policy from {}: {} bucket rules", policy_file, policy->rules().size());
+        queue_manager.set_policy(std::move(policy));
+        policy_watcher = std::make_unique<matchmaker::PolicyWatcher>(
+            policy_file,
+            [&queue_manager](std::unique_ptr<const matchmaker::PolicySet> reloaded) {
+                queue_manager.set_policy(std::move(reloaded));
+                g_wakeup.notify();
+            });
+    }
+
+    // Optional Redis-backed queue state, so a restart does not drop the queue
+    std::unique_ptr<matchmaker::RedisQueueStore> store;
+    if (const char* redis_url = std::getenv("MATCHMAKER_REDIS_URL")) {
+        matchmaker::RedisQueueStoreConfig store_config;
+        if (!matchmaker::RedisConnection::parse_url(redis_url, store_config.host, store_config.port)) {
+            spdlog::error("Invalid MATCHMAKER_REDIS_URL: {}", redis_url);
+            return 1;
+        }
+        store = std::make_unique<matchmaker::RedisQueueStore>(store_config);
+        queue_manager.set_store(store.get());
+        size_t restored = queue_manager.restore_from_store();
+        if (!store->last_error().empty()) {
+            spdlog::warn("Queue store {}: {}", redis_url, store->last_error());
+        }
+        spdlog::info("Queue store {}: restored {} parties", redis_url, restored);
+    }
+
+    // Optional columnar export of formed matches for offline analysis
+    std::unique_ptr<matchmaker::MatchExporter> exporter;
+    if (const char* export_dir = std::getenv("MATCH_EXPORT_DIR")) {
+        matchmaker::MatchExportConfig export_config;
+        export_config.directory = export_dir;
+        exporter = std::make_unique<matchmaker::MatchExporter>(export_config);
+        spdlog::info("Exporting matches to {}", export_dir);
+    }
+
+    // Optional time-to-match tracing, exported as OTLP/JSON lines for a local
+    // collector (otlpjsonfile receiver) to pick up
+    std::unique_ptr<matchmaker::Tracer> tracer;
+    if (const char* trace_file = std::getenv("MATCHMAKER_TRACE_FILE")) {
+        tracer = std::make_unique<matchmaker::Tracer>(
+            std::make_unique<matchmaker::OtlpFileExporter>(trace_file));
+        queue_manager.set_tracer(tracer.get());
+        spdlog::info("Writing time-to-match traces to {}", trace_file);
+    }
+
+    // Hot-path events go through the binary logger; formatting and sink I/O
+    // happen on its background thread
+    matchmaker::BinaryLogger::Config log_config;
+    if (const char* binlog_path = std::getenv("MATCHMAKER_BINLOG")) {
+        log_config.path = binlog_path;
+        spdlog::info("Writing binary log to {}", binlog_path);
+    }
+    matchmaker::BinaryLogger event_log(log_config);
+
+    // Prometheus scrape endpoint (ops/prometheus/prometheus.yml expects :9091)
+    matchmaker::MetricsRegistry metrics;
+    describe_metrics(metrics);
+    const char* metrics_port = std::getenv("MATCHMAKER_METRICS_PORT");
+    matchmaker::MetricsServer metrics_server(metrics, metrics_port ? std::atoi(metrics_port) : 9091);
+    if (metrics_server.listening()) {
+        spdlog::info("Serving metrics on :{}/metrics", metrics_server.port());
+    }
 
     // Initialize NATS client (mock for now)
     auto nats = matchmaker::create_nats_client(true);
@@ -46,66 +390,350 @@ int main() {
         return 1;
     }
 
-    // Subscribe to queue events
-    nats->subscribe_queue_events(
-        "matchmaker.queue.*",
-        [&queue_manager](const matchmaker::QueueEntry& entry) {
-            spdlog::info("Queue event: party={}, region={}, mode={}, mmr={}",
-                entry.party_id, entry.region, entry.mode, entry.avg_mmr);
-            queue_manager.enqueue(entry);
+    auto on_queue_event = [&queue_manager, &event_log](const matchmaker::QueueEvent& event) {
+        const auto& entry = event.entry;
+        event_log.log(matchmaker::LogEvent::QueueEvent,
+            entry.party_id, entry.region, entry.mode, entry.avg_mmr);
+        if (event.type == matchmaker::QueueEvent::Type::Leave) {
+            queue_manager.dequeue(entry.party_id);
+            g_wakeup.notify();
+            return;
+        }
+        matchmaker::EnqueueRejection reason{};
+        if (!queue_manager.enqueue(entry, &reason)) {
+            spdlog::debug("Rejected party {} ({}:{}:{}): {}", entry.party_id,
+                entry.region, entry.mode, entry.team_size, rejection_reason(reason));
+            return;
+        }
+        g_wakeup.notify();
+    };
+
+    // Queue events (matchmaker.queue.{mode}.{region}) arrive either pushed
+    // (no acks) or, with MATCHMAKER_JETSTREAM_BATCH=N, through a durable pull
+    // consumer that fetches N at a time and acks each batch once the tick has
+    // written it to the queue store. Undecodable events are republished on
+    // matchmaker.deadletter.queue before they are acked. The consumer runs on
+    // the in-process stand-in until nats.c is integrated, like the mock
+    // client above.
+    matchmaker::JetStreamStandIn jetstream;
+    std::unique_ptr<matchmaker::PullConsumer> pull_consumer;
+    std::unique_ptr<matchmaker::DurableQueueIngest> ingest;
+    if (const char* batch = std::getenv("MATCHMAKER_JETSTREAM_BATCH")) {
+        pull_consumer = jetstream.pull_consumer({});
+        ingest = std::make_unique<matchmaker::DurableQueueIngest>(
+            *pull_consumer, queue_manager, on_queue_event, static_cast<size_t>(std::atoll(batch)));
+        ingest->set_dead_letter([&jetstream](const matchmaker::JetStreamMessage& message) {
+            spdlog::warn("Dead-lettering undecodable queue event {} on {}", message.stream_sequence,
+                message.subject);
+            jetstream.publish("matchmaker.deadletter.queue", message.data);
+            return true;
+        });
+        spdlog::info("Pulling queue events in batches of {} (resuming after sequence {})",
+            std::atoll(batch), queue_manager.ingest_checkpoint());
+    } else {
+        nats->subscribe_queue_events("matchmaker.queue.>", on_queue_event);
+    }
+
+    // Game servers ask for replacements when a player drops mid-match
+    nats->subscribe_backfill_requests(
+        "matchmaker.backfill.request",
+        [&queue_manager](const matchmaker::BackfillRequest& request) {
+            if (!queue_manager.request_backfill(request)) {
+                spdlog::debug("Rejected backfill for match {} ({}:{}:{}, {} slots)", request.match_id,
+                    request.region, request.mode, request.team_size, request.open_slots);
+                return;
+            }
+            g_wakeup.notify();
         }
     );
 
+    // Further titles' queue events arrive on matchmaker.<tenant>.queue.>
+    for (const auto& spec : tenant_specs) {
+        matchmaker::TenantConfig tenant_config;
+        auto colon = spec.find(':');
+        tenant_config.name = spec.substr(0, colon);
+        tenant_config.queue = config;
+        tenant_config.queue.position_update_interval_ms = 0;    // Positions are published for the primary title only
+        if (colon != std::string::npos) {
+            tenant_config.cpu_budget = std::chrono::microseconds(std::atoll(spec.c_str() + colon + 1));
+        }
+        auto* tenant_queue = tenants.add_tenant(tenant_config);
+        if (tenant_queue == nullptr) {
+            spdlog::error("Invalid or duplicate tenant in MATCHMAKER_TENANTS: {}", spec);
+            return 1;
+        }
+        nats->subscribe_queue_events("matchmaker." + tenant_config.name + ".queue.>",
+            [tenant_queue, tenant = tenant_config.name](const matchmaker::QueueEvent& event) {
+                const auto& entry = event.entry;
+                if (event.type == matchmaker::QueueEvent::Type::Leave) {
+                    tenant_queue->dequeue(entry.party_id);
+                    g_wakeup.notify();
+                    return;
+                }
+                matchmaker::EnqueueRejection reason{};
+                if (!tenant_queue->enqueue(entry, &reason)) {
+                    spdlog::debug("Rejected party {} for tenant {}: {}", entry.party_id, tenant,
+                        rejection_reason(reason));
+                    return;
+                }
+                g_wakeup.notify();
+            });
+        spdlog::info("Hosting tenant {} (cpu budget {}us per tick)", tenant_config.name,
+            tenant_config.cpu_budget.count());
+    }
+
     spdlog::info("Matchmaker service running. Press Ctrl+C to stop.");
 
-    // Main tick loop
-    const int tick_interval_ms = 200;
+    // Main tick loop. Between ticks the loop sleeps until the next time a
+    // tick could change anything (see QueueManager::next_wakeup), so an idle
+    // queue costs no CPU; queue events wake it at once, and it never ticks
+    // faster than the tick interval.
+    const int default_tick_interval_ms = 200;
+    const auto stats_interval = std::chrono::seconds(10);
     auto last_stats_time = std::chrono::steady_clock::now();
     size_t total_matches = 0;
+    uint64_t ticks = 0;
+    uint64_t early_wakeups = 0;
 
     while (g_running) {
         auto tick_start = std::chrono::steady_clock::now();
 
-        // Process matchmaking
-        auto matches = queue_manager.tick();
+        if (ingest) {
+            ingest->poll();
+        }
+
+        // Process matchmaking for every tenant, the primary title first
+        auto tenant_matches = tenants.tick();
+        ticks++;
+
+        // The tick wrote the batch to the store; now it is safe to ack
+        if (ingest) {
+            ingest->commit();
+        }
+
+        // The fastest bucket cadence in the active policy drives the loop
+        int tick_interval_ms = queue_manager.policy().min_tick_interval_ms();
+        if (tick_interval_ms <= 0) {
+            tick_interval_ms = default_tick_interval_ms;
+        }
 
         // Publish match found events
-        for (const auto& match : matches) {
-            spdlog::info("Match formed: id={}, region={}, mode={}, mmr={}, quality={:.2f}",
-                match.match_id, match.region, match.mode, match.avg_mmr, match.quality_score);
+        for (const auto& result : tenant_matches) {
+            for (const auto& match : result.matches) {
+                event_log.log(matchmaker::LogEvent::MatchFormed,
+                    match.match_id, match.region, match.mode, match.avg_mmr, match.quality_score);
+
+                auto publish_start = std::chrono::system_clock::now();
+                nats->publish_match_found(match);
+                total_matches++;
+                if (tracer) {
+                    tracer->on_published(match, publish_start, std::chrono::system_clock::now());
+                }
+
+                if (exporter) {
+                    exporter->append(match);
+                }
+            }
+        }
+
+        for (const auto& result : queue_manager.take_backfill_results()) {
+            nats->publish_backfill_result(result);
+        }
 
-            nats->publish_match_found(match);
-            total_matches++;
+        for (const auto& update : queue_manager.take_position_updates()) {
+            nats->publish_queue_positions(update);
         }
 
         // Log stats every 10 seconds
         auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::seconds>(now - last_stats_time).count() >= 10) {
+        if (now - last_stats_time >= stats_interval) {
             auto bucket_sizes = queue_manager.get_bucket_sizes();
-            spdlog::info("Stats: total_queued={}, total_matches={}, buckets={}",
-                queue_manager.get_queue_size(), total_matches, bucket_sizes.size());
+            if (exporter) {
+                exporter->flush();
+            }
+            if (tracer) {
+                tracer->flush();
+                spdlog::info("Tracing: sample_rate={:.4f}, tracked={}, spans_exported={}, spans_dropped={}",
+                    tracer->sample_rate(), tracer->tracked_parties(),
+                    tracer->spans_exported(), tracer->spans_dropped());
+            }
+
+            spdlog::info("Stats: total_queued={}, total_matches={}, buckets={}, log_dropped={}, ticks={}, "
+                         "early_wakeups={}",
+                queue_manager.get_queue_size(), total_matches, bucket_sizes.size(),
+                event_log.dropped(), ticks, early_wakeups);
+            metrics.set("matchmaker_ticks_total", static_cast<double>(ticks));
+            metrics.set("matchmaker_early_wakeups_total", static_cast<double>(early_wakeups));
+
+            auto memory = queue_manager.get_memory_stats();
+            spdlog::info("Memory: total={}KB, party_index={}KB, id_arena={}KB, buckets={}KB, graphs={}KB, "
+                         "budget={}KB, rejected={}",
+                memory.total() >> 10, memory.party_index_bytes >> 10, memory.id_arena_bytes >> 10,
+                memory.bucket_bytes >> 10, memory.graph_bytes >> 10, memory.budget_bytes >> 10,
+                memory.admission_rejections);
+            auto lifecycle = queue_manager.get_bucket_lifecycle_stats();
+            spdlog::info("Buckets: live={}, created={}, evicted={}, recycled={}, rejected={}/{}/{}/{}/{} "
+                         "(region/mode/team_size/party_size/limit)",
+                lifecycle.live, lifecycle.created, lifecycle.evicted, lifecycle.recycled,
+                lifecycle.rejected_region, lifecycle.rejected_mode, lifecycle.rejected_team_size,
+                lifecycle.rejected_party_size, lifecycle.rejected_bucket_limit);
+            export_queue_metrics(metrics, memory, lifecycle, total_matches);
+            if (store) {
+                spdlog::info("Queue store: round_trips={}, write_failures={}, pending_ops={}",
+                    store->round_trips(), queue_manager.store_write_failures(),
+                    queue_manager.pending_store_ops());
+                metrics.set("matchmaker_store_round_trips_total", static_cast<double>(store->round_trips()));
+                metrics.set("matchmaker_store_write_failures_total",
+                            static_cast<double>(queue_manager.store_write_failures()));
+                metrics.set("matchmaker_store_pending_ops", static_cast<double>(queue_manager.pending_store_ops()));
+            }
+            const auto& backfill = queue_manager.get_backfill_stats();
+            spdlog::info("Backfill: pending={}, filled={}, expired={}, rejected={}, players={}, "
+                         "avg_fill_ms={:.1f}",
+                backfill.pending, backfill.filled, backfill.expired, backfill.rejected,
+                backfill.players_assigned,
+                backfill.fill_latency.count > 0
+                    ? 1000.0 * backfill.fill_latency.sum / static_cast<double>(backfill.fill_latency.count) : 0.0);
+            metrics.set("matchmaker_backfill_pending", static_cast<double>(backfill.pending));
+            metrics.set("matchmaker_backfill_requests_total", static_cast<double>(backfill.filled),
+                        {{"result", "filled"}});
+            metrics.set("matchmaker_backfill_requests_total", static_cast<double>(backfill.expired),
+                        {{"result", "expired"}});
+            metrics.set("matchmaker_backfill_requests_total", static_cast<double>(backfill.cancelled),
+                        {{"result", "cancelled"}});
+            metrics.set("matchmaker_backfill_requests_total", static_cast<double>(backfill.rejected),
+                        {{"result", "rejected"}});
+            metrics.set("matchmaker_backfill_players_total", static_cast<double>(backfill.players_assigned));
+            metrics.set_histogram("matchmaker_backfill_fill_latency_seconds", backfill.fill_latency);
+            const auto& lane_anchors = queue_manager.get_lane_anchor_counts();
+            for (size_t lane = 0; lane < lane_anchors.size(); ++lane) {
+                metrics.set("matchmaker_lane_anchors_total", static_cast<double>(lane_anchors[lane]),
+                            {{"lane", matchmaker::lane_name(static_cast<matchmaker::PriorityLane>(lane))}});
+            }
+
+            for (size_t i = 0; i < tenants.tenant_count(); ++i) {
+                const std::string& tenant = tenants.config(i).name;
+                const auto& tenant_stats = tenants.stats(i);
+                const auto& budget = tenants.queue_manager(i).get_tick_budget_stats();
+                size_t queued = tenants.queue_manager(i).get_queue_size();
+                spdlog::info("Tenant {}: queued={}, matches={}, over_budget_ticks={}, deferred_buckets={}, "
+                             "cpu_ms={:.1f}",
+                    tenant, queued, tenant_stats.matches, budget.over_budget_ticks, budget.deferred_buckets,
+                    std::chrono::duration<double, std::milli>(budget.cpu_time).count());
+                metrics.set("matchmaker_tenant_queued_parties", static_cast<double>(queued),
+                            {{"tenant", tenant}});
+                metrics.set("matchmaker_tenant_matches_total", static_cast<double>(tenant_stats.matches),
+                            {{"tenant", tenant}});
+                metrics.set("matchmaker_tenant_over_budget_ticks_total",
+                            static_cast<double>(budget.over_budget_ticks), {{"tenant", tenant}});
+                metrics.set("matchmaker_tenant_deferred_buckets_total",
+                            static_cast<double>(budget.deferred_buckets), {{"tenant", tenant}});
+                metrics.set_histogram("matchmaker_tenant_tick_cpu_seconds", tenant_stats.tick_cpu_seconds,
+                                      {{"tenant", tenant}});
+            }
+
+            if (ingest) {
+                const auto& ingest_stats = ingest->stats();
+                spdlog::info("Ingest: applied={}, redelivered={}, skipped={}, malformed={}, dead_lettered={}, "
+                             "acks={}, acked_through={}, stalled={}",
+                    ingest_stats.applied, ingest_stats.redelivered, ingest_stats.skipped,
+                    ingest_stats.malformed, ingest_stats.dead_lettered, ingest_stats.acks,
+                    ingest->acked_sequence(), ingest->stalled());
+                metrics.set("matchmaker_ingest_events_total", static_cast<double>(ingest_stats.applied),
+                            {{"result", "applied"}});
+                metrics.set("matchmaker_ingest_events_total", static_cast<double>(ingest_stats.redelivered),
+                            {{"result", "redelivered"}});
+                metrics.set("matchmaker_ingest_events_total", static_cast<double>(ingest_stats.skipped),
+                            {{"result", "skipped"}});
+                metrics.set("matchmaker_ingest_events_total", static_cast<double>(ingest_stats.malformed),
+                            {{"result", "malformed"}});
+                metrics.set("matchmaker_ingest_events_total", static_cast<double>(ingest_stats.dead_lettered),
+                            {{"result", "dead_lettered"}});
+                metrics.set("matchmaker_ingest_stalled", ingest->stalled() ? 1.0 : 0.0);
+                metrics.set("matchmaker_ingest_acks_total", static_cast<double>(ingest_stats.acks));
+            }
+            if (policy_watcher) {
+                metrics.set("matchmaker_policy_reloads_total", static_cast<double>(policy_watcher->reloads()),
+                            {{"result", "applied"}});
+                metrics.set("matchmaker_policy_reloads_total", static_cast<double>(policy_watcher->failures()),
+                            {{"result", "rejected"}});
+            }
 
             for (const auto& [bucket, size] : bucket_sizes) {
-                spdlog::debug("  Bucket {}: {} parties", bucket, size);
+                const auto& usage = memory.buckets[bucket];
+                spdlog::debug("  Bucket {}: {} parties, {}KB (entries={}KB, ids={}KB, graph={}KB)",
+                    bucket, size, usage.total() >> 10, usage.entry_bytes >> 10,
+                    usage.id_bytes >> 10, usage.graph_bytes >> 10);
+            }
+
+            for (const auto& [bucket, cmp] : queue_manager.get_shadow_comparisons()) {
+                spdlog::info("  Shadow {}: {} vs {}: tick_us={:.1f}/{:.1f}, matches={}/{}, "
+                             "quality={:.2f}/{:.2f}, wait_s={:.1f}/{:.1f}, dropped={}",
+                    bucket, cmp.live_strategy, cmp.shadow_strategy,
+                    cmp.live.avg_tick_us(), cmp.shadow.avg_tick_us(),
+                    cmp.live.matches, cmp.shadow.matches,
+                    cmp.live.avg_quality(), cmp.shadow.avg_quality(),
+                    cmp.live.avg_wait_sec(), cmp.shadow.avg_wait_sec(),
+                    cmp.dropped_ticks);
             }
 
             last_stats_time = now;
         }
 
-        // Sleep for remainder of tick interval
+        // Sleep for at least the remainder of the tick interval, and on until
+        // the next deadline when nothing is due sooner. A pull consumer has
+        // to be polled, so it keeps the loop at the tick interval.
+        auto tick_interval = std::chrono::milliseconds(tick_interval_ms);
         auto tick_duration = std::chrono::steady_clock::now() - tick_start;
-        auto sleep_time = std::chrono::milliseconds(tick_interval_ms) - tick_duration;
-
-        if (sleep_time.count() > 0) {
-            std::this_thread::sleep_for(sleep_time);
-        } else {
-            spdlog::warn("Tick took longer than {}ms: {}ms",
+        auto sleep_time = tick_interval - tick_duration;
+        if (sleep_time.count() <= 0) {
+            event_log.log(matchmaker::LogEvent::TickOverrun,
                 tick_interval_ms,
                 std::chrono::duration_cast<std::chrono::milliseconds>(tick_duration).count());
         }
+
+        auto wall_now = std::chrono::system_clock::now();
+        auto wake_at = std::chrono::system_clock::time_point::max();
+        for (size_t i = 0; i < tenants.tenant_count(); ++i) {
+            wake_at = std::min(wake_at, tenants.queue_manager(i).next_wakeup(wall_now));
+        }
+        std::chrono::nanoseconds idle_time = last_stats_time + stats_interval - std::chrono::steady_clock::now();
+        if (wake_at != std::chrono::system_clock::time_point::max()) {
+            idle_time = std::min<std::chrono::nanoseconds>(idle_time, wake_at - wall_now);
+        }
+
+        if (ingest || idle_time <= sleep_time) {
+            if (sleep_time.count() > 0) {
+                std::this_thread::sleep_for(sleep_time);
+            }
+        } else if (g_wakeup.wait_for(idle_time)) {
+            // Woken by an arrival: tick now unless the last tick was too recent
+            early_wakeups++;
+            auto since_tick = std::chrono::steady_clock::now() - tick_start;
+            if (since_tick < tick_interval) {
+                std::this_thread::sleep_for(tick_interval - since_tick);
+            }
+        }
     }
 
     spdlog::info("Matchmaker service shutting down...");
+    event_log.flush();
+    if (exporter) {
+        exporter->rotate();
+    }
+    if (tracer) {
+        queue_manager.set_tracer(nullptr);
+        tracer->flush();
+    }
+    if (store) {
+        queue_manager.flush_store();
+    }
+    if (ingest) {
+        ingest->commit();
+    }
+    if (store) {
+        queue_manager.set_store(nullptr);
+    }
     nats->disconnect();
 
     return 0;
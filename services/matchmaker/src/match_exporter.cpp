@@ -0,0 +1,182 @@
+#include "matchmaker/match_exporter.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+namespace matchmaker {
+
+namespace {
+
+constexpr char kFileMagic[8] = {'M', 'M', 'C', 'O', 'L', '0', '0', '1'};
+constexpr char kFooterMagic[8] = {'M', 'M', 'C', 'O', 'L', 'E', 'N', 'D'};
+constexpr uint32_t kRowGroupMagic = 0x50524752;  // "RGRP" little-endian
+constexpr uint32_t kColumnCount = 12;
+
+enum ColumnType : uint8_t {
+    kInt32 = 0,
+    kInt64 = 1,
+    kFloat64 = 2,
+    kUtf8 = 3,
+};
+
+int64_t to_ms(std::chrono::system_clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+}  // namespace
+
+MatchExporter::MatchExporter(const MatchExportConfig& config)
+    : config_(config) {}
+
+MatchExporter::~MatchExporter() {
+    rotate();
+}
+
+void MatchExporter::append(const MatchResult& match) {
+    int64_t formed_at_ms = to_ms(match.formed_at.time_since_epoch());
+
+    for (size_t i = 0; i < match.party_ids.size(); ++i) {
+        formed_at_ms_.push_back(formed_at_ms);
+        match_id_.push(match.match_id);
+        region_.push(match.region);
+        mode_.push(match.mode);
+        team_size_.push_back(match.team_size);
+        party_id_.push(match.party_ids[i]);
+        party_mmr_.push_back(i < match.party_mmrs.size() ? match.party_mmrs[i] : 0);
+        wait_ms_.push_back(i < match.party_enqueued_at.size()
+            ? to_ms(match.formed_at - match.party_enqueued_at[i]) : 0);
+        mmr_band_.push_back(match.mmr_band);
+        match_avg_mmr_.push_back(match.avg_mmr);
+        mmr_variance_.push_back(match.mmr_variance);
+        quality_score_.push_back(match.quality_score);
+        pending_rows_++;
+    }
+
+    if (pending_rows_ >= config_.rows_per_group) {
+        flush();
+    }
+}
+
+void MatchExporter::flush() {
+    if (pending_rows_ == 0) {
+        return;
+    }
+    if (file_ == nullptr && !open_file()) {
+        // Export is best effort: never let a bad directory grow the buffers
+        rows_dropped_ += pending_rows_;
+        clear_pending();
+        return;
+    }
+
+    uint32_t header[3] = {kRowGroupMagic, static_cast<uint32_t>(pending_rows_), kColumnCount};
+    write_bytes(header, sizeof(header));
+    write_column("formed_at_ms", kInt64, formed_at_ms_);
+    write_column("match_id", match_id_);
+    write_column("region", region_);
+    write_column("mode", mode_);
+    write_column("team_size", kInt32, team_size_);
+    write_column("party_id", party_id_);
+    write_column("party_mmr", kInt32, party_mmr_);
+    write_column("wait_ms", kInt64, wait_ms_);
+    write_column("mmr_band", kInt32, mmr_band_);
+    write_column("match_avg_mmr", kInt32, match_avg_mmr_);
+    write_column("mmr_variance", kInt32, mmr_variance_);
+    write_column("quality_score", kFloat64, quality_score_);
+
+    file_row_groups_++;
+    file_rows_ += pending_rows_;
+    rows_written_ += pending_rows_;
+    clear_pending();
+
+    if (file_bytes_ >= config_.max_file_bytes) {
+        close_file();
+    }
+}
+
+void MatchExporter::clear_pending() {
+    pending_rows_ = 0;
+    formed_at_ms_.clear();
+    match_id_.clear();
+    region_.clear();
+    mode_.clear();
+    team_size_.clear();
+    party_id_.clear();
+    party_mmr_.clear();
+    wait_ms_.clear();
+    mmr_band_.clear();
+    match_avg_mmr_.clear();
+    mmr_variance_.clear();
+    quality_score_.clear();
+}
+
+void MatchExporter::rotate() {
+    flush();
+    close_file();
+}
+
+bool MatchExporter::open_file() {
+    auto now_ms = to_ms(std::chrono::system_clock::now().time_since_epoch());
+    file_path_ = (std::filesystem::path(config_.directory) /
+        (config_.file_prefix + "-" + std::to_string(now_ms) + "-" +
+         std::to_string(file_sequence_++) + ".mmcol")).string();
+
+    file_ = std::fopen((file_path_ + ".tmp").c_str(), "wb");
+    if (file_ == nullptr) {
+        return false;
+    }
+
+    io_buffer_.resize(config_.io_buffer_bytes);
+    std::setvbuf(file_, io_buffer_.data(), _IOFBF, io_buffer_.size());
+
+    file_bytes_ = 0;
+    file_row_groups_ = 0;
+    file_rows_ = 0;
+    write_bytes(kFileMagic, sizeof(kFileMagic));
+    return true;
+}
+
+void MatchExporter::close_file() {
+    if (file_ == nullptr) {
+        return;
+    }
+
+    write_bytes(&file_row_groups_, sizeof(file_row_groups_));
+    write_bytes(&file_rows_, sizeof(file_rows_));
+    write_bytes(kFooterMagic, sizeof(kFooterMagic));
+    std::fclose(file_);
+    file_ = nullptr;
+
+    std::error_code ec;
+    std::filesystem::rename(file_path_ + ".tmp", file_path_, ec);
+    files_completed_++;
+}
+
+void MatchExporter::write_bytes(const void* data, size_t size) {
+    std::fwrite(data, 1, size, file_);
+    file_bytes_ += size;
+}
+
+template <typename T>
+void MatchExporter::write_column(const char* name, uint8_t type, const std::vector<T>& values) {
+    uint16_t name_len = static_cast<uint16_t>(std::strlen(name));
+    uint64_t byte_len = values.size() * sizeof(T);
+    write_bytes(&name_len, sizeof(name_len));
+    write_bytes(name, name_len);
+    write_bytes(&type, sizeof(type));
+    write_bytes(&byte_len, sizeof(byte_len));
+    write_bytes(values.data(), byte_len);
+}
+
+void MatchExporter::write_column(const char* name, const StringColumn& values) {
+    uint16_t name_len = static_cast<uint16_t>(std::strlen(name));
+    uint8_t type = kUtf8;
+    uint64_t byte_len = values.offsets.size() * sizeof(int32_t) + values.data.size();
+    write_bytes(&name_len, sizeof(name_len));
+    write_bytes(name, name_len);
+    write_bytes(&type, sizeof(type));
+    write_bytes(&byte_len, sizeof(byte_len));
+    write_bytes(values.offsets.data(), values.offsets.size() * sizeof(int32_t));
+    write_bytes(values.data.data(), values.data.size());
+}
+
+} // namespace matchmaker
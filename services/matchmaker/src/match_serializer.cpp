@@ -0,0 +1,199 @@
+#include "matchmaker/match_serializer.hpp"
+#include <charconv>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace matchmaker {
+
+namespace {
+
+// Offset of the first byte in [p, p + n) that must be escaped, or n
+size_t find_escape(const char* p, size_t n) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_max = _mm_set1_epi8(0x1F);
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // Unsigned chunk <= 0x1F  <=>  max(chunk, 0x1F) == 0x1F
+        __m128i is_control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, control_max), control_max);
+        __m128i needs_escape = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            is_control);
+        int mask = _mm_movemask_epi8(needs_escape);
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        unsigned char c = static_cast<unsigned char>(p[i]);
+        if (c < 0x20 || c == '"' || c == '\\') {
+            return i;
+        }
+    }
+    return n;
+}
+
+void append_escape(std::string& out, unsigned char c) {
+    switch (c) {
+        case '"':  out += "\\\""; return;
+        case '\\': out += "\\\\"; return;
+        case '\b': out += "\\b"; return;
+        case '\f': out += "\\f"; return;
+        case '\n': out += "\\n"; return;
+        case '\r': out += "\\r"; return;
+        case '\t': out += "\\t"; return;
+        default: {
+            static constexpr char kHex[] = "0123456789abcdef";
+            char buf[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0x0F]};
+            out.append(buf, sizeof(buf));
+        }
+    }
+}
+
+template <typename T>
+void append_number(std::string& out, T value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+void append_string_array(std::string& out, const std::vector<std::string>& values) {
+    out.push_back('[');
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        append_json_string(out, values[i]);
+    }
+    out.push_back(']');
+}
+
+}  // namespace
+
+void append_json_string(std::string& out, std::string_view s) {
+    out.push_back('"');
+    while (!s.empty()) {
+        size_t run = find_escape(s.data(), s.size());
+        out.append(s.data(), run);
+        if (run == s.size()) {
+            break;
+        }
+        append_escape(out, static_cast<unsigned char>(s[run]));
+        s.remove_prefix(run + 1);
+    }
+    out.push_back('"');
+}
+
+void write_match_found(std::string& out, const MatchResult& match) {
+    out += "{\"match_id\":";
+    append_json_string(out, match.match_id);
+    out += ",\"region\":";
+    append_json_string(out, match.region);
+    out += ",\"mode\":";
+    append_json_string(out, match.mode);
+    out += ",\"team_size\":";
+    append_number(out, match.team_size);
+
+    out += ",\"teams\":[";
+    for (size_t i = 0; i < match.teams.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        append_string_array(out, match.teams[i]);
+    }
+    out.push_back(']');
+
+    out += ",\"party_ids\":";
+    append_string_array(out, match.party_ids);
+    out += ",\"avg_mmr\":";
+    append_number(out, match.avg_mmr);
+    out += ",\"mmr_variance\":";
+    append_number(out, match.mmr_variance);
+    out += ",\"quality_score\":";
+    if (std::isfinite(match.quality_score)) {
+        append_number(out, match.quality_score);  // Shortest round-trip form
+    } else {
+        out += "null";  // Same as nlohmann::json for NaN/inf
+    }
+    out.push_back('}');
+}
+
+std::string_view serialize_match_found(const MatchResult& match) {
+    static thread_local std::string buffer;
+    buffer.clear();  // Keeps capacity, so steady state does not allocate
+    write_match_found(buffer, match);
+    return buffer;
+}
+
+void write_backfill_result(std::string& out, const BackfillResult& result) {
+    out += "{\"match_id\":";
+    append_json_string(out, result.match_id);
+    out += ",\"region\":";
+    append_json_string(out, result.region);
+    out += ",\"mode\":";
+    append_json_string(out, result.mode);
+    out += ",\"team_size\":";
+    append_number(out, result.team_size);
+    out += ",\"party_ids\":";
+    append_string_array(out, result.party_ids);
+
+    out += ",\"players\":[";
+    for (size_t i = 0; i < result.players.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        append_string_array(out, result.players[i]);
+    }
+    out.push_back(']');
+
+    out += ",\"open_slots\":";
+    append_number(out, result.open_slots);
+    out += result.expired ? ",\"expired\":true" : ",\"expired\":false";
+    out += ",\"latency_ms\":";
+    append_number(out, result.latency.count() / 1000);
+    out.push_back('}');
+}
+
+std::string_view serialize_backfill_result(const BackfillResult& result) {
+    static thread_local std::string buffer;
+    buffer.clear();
+    write_backfill_result(buffer, result);
+    return buffer;
+}
+
+void write_queue_positions(std::string& out, const QueuePositionUpdate& update) {
+    out += "{\"bucket\":";
+    append_json_string(out, update.bucket);
+    out += ",\"queued\":";
+    append_number(out, update.queued);
+    out += ",\"positions\":[";
+    for (size_t i = 0; i < update.positions.size(); ++i) {
+        if (i > 0) {
+            out.push_back(',');
+        }
+        out.push_back('[');
+        append_json_string(out, update.positions[i].first);
+        out.push_back(',');
+        append_number(out, update.positions[i].second);
+        out.push_back(']');
+    }
+    out += "]}";
+}
+
+std::string_view serialize_queue_positions(const QueuePositionUpdate& update) {
+    static thread_local std::string buffer;
+    buffer.clear();
+    write_queue_positions(buffer, update);
+    return buffer;
+}
+
+} // namespace matchmaker
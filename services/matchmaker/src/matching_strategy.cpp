@@ -0,0 +1,182 @@
+#include "matchmaker/matching_strategy.hpp"
+#include "matchmaker/team_builder.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace matchmaker {
+
+std::vector<MatchResult> WaitOrderStrategy::form_matches(
+    const QueueBucket& bucket,
+    std::vector<QueueEntry>& entries,
+    const QueueConfig& config,
+    std::chrono::system_clock::time_point now
+) const {
+    std::vector<MatchResult> matches;
+
+    // Matched parties are dropped from a working copy; entries is left intact
+    std::vector<QueueEntry> remaining = entries;
+    std::sort(remaining.begin(), remaining.end(),
+        [](const QueueEntry& a, const QueueEntry& b) {
+            return a.enqueued_at < b.enqueued_at;
+        });
+
+    while (remaining.size() >= 2) {
+        int mmr_tolerance = config.mmr_band_at(remaining[0].enqueued_at, now);
+
+        auto match_opt = TeamBuilder::try_form_match(remaining, bucket.team_size, 2, mmr_tolerance);
+        if (!match_opt.has_value() || match_opt->quality_score < config.min_match_quality) {
+            break;
+        }
+
+        match_opt->mmr_band = mmr_tolerance;
+
+        std::unordered_set<std::string> matched(match_opt->party_ids.begin(),
+                                                match_opt->party_ids.end());
+        remaining.erase(
+            std::remove_if(remaining.begin(), remaining.end(),
+                [&matched](const QueueEntry& e) { return matched.count(e.party_id) > 0; }),
+            remaining.end()
+        );
+        matches.push_back(std::move(*match_opt));
+    }
+
+    return matches;
+}
+
+ShadowEvaluator::ShadowEvaluator(size_t max_pending)
+    : max_pending_(max_pending),
+      worker_([this] { run(); }) {}
+
+ShadowEvaluator::~ShadowEvaluator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    worker_.join();
+}
+
+bool ShadowEvaluator::reserve(const QueueBucket& bucket, std::vector<QueueEntry>& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (jobs_.size() + reserved_ >= max_pending_) {
+        comparisons_[bucket.key()].dropped_ticks++;
+        return false;
+    }
+    reserved_++;
+    if (!spare_snapshots_.empty()) {
+        snapshot = std::move(spare_snapshots_.back());
+        spare_snapshots_.pop_back();
+    }
+    return true;
+}
+
+void ShadowEvaluator::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reserved_--;
+        jobs_.push_back(std::move(job));
+    }
+    work_cv_.notify_one();
+}
+
+void ShadowEvaluator::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+}
+
+std::unordered_map<std::string, ShadowComparison> ShadowEvaluator::get_comparisons() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return comparisons_;
+}
+
+void ShadowEvaluator::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            busy_ = true;
+        }
+
+        std::unordered_map<std::string, std::chrono::system_clock::time_point> enqueued_at;
+        enqueued_at.reserve(job.snapshot.size());
+        for (const auto& entry : job.snapshot) {
+            enqueued_at.emplace(entry.party_id, entry.enqueued_at);
+        }
+
+        // Withhold what the candidate already matched; forget parties that
+        // have since left the queue
+        std::string key = job.bucket.key();
+        auto& withheld = withheld_[key];
+        std::unordered_set<std::string> still_queued;
+        job.snapshot.erase(
+            std::remove_if(job.snapshot.begin(), job.snapshot.end(),
+                [&](const QueueEntry& e) {
+                    auto it = withheld.find(e.party_id);
+                    if (it == withheld.end()) {
+                        return false;
+                    }
+                    still_queued.insert(std::move(withheld.extract(it).value()));
+                    return true;
+                }),
+            job.snapshot.end()
+        );
+        withheld.swap(still_queued);
+
+        std::vector<MatchResult> shadow_matches;
+        auto start = std::chrono::steady_clock::now();
+        if (job.snapshot.size() >= 2) {
+            shadow_matches = job.strategy->form_matches(job.bucket, job.snapshot, job.config, job.now);
+        }
+        uint64_t shadow_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        for (const auto& match : shadow_matches) {
+            withheld.insert(match.party_ids.begin(), match.party_ids.end());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& comparison = comparisons_[key];
+            comparison.live_strategy = job.live_strategy;
+            comparison.shadow_strategy = job.strategy->name();
+            accumulate(comparison.live, job.live_matches, enqueued_at, job.now, job.live_tick_ns);
+            accumulate(comparison.shadow, shadow_matches, enqueued_at, job.now, shadow_ns);
+            if (spare_snapshots_.size() < max_pending_) {
+                spare_snapshots_.push_back(std::move(job.snapshot));
+            }
+            busy_ = false;
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+void ShadowEvaluator::accumulate(
+    StrategyStats& stats,
+    const std::vector<MatchResult>& matches,
+    const std::unordered_map<std::string, std::chrono::system_clock::time_point>& enqueued_at,
+    std::chrono::system_clock::time_point now,
+    uint64_t tick_ns
+) {
+    stats.ticks++;
+    stats.total_tick_ns += tick_ns;
+    stats.matches += matches.size();
+
+    for (const auto& match : matches) {
+        stats.quality_sum += match.quality_score;
+        for (const auto& party_id : match.party_ids) {
+            auto it = enqueued_at.find(party_id);
+            if (it != enqueued_at.end()) {
+                stats.wait_sec_sum += std::chrono::duration<double>(now - it->second).count();
+                stats.parties_matched++;
+            }
+        }
+    }
+}
+
+} // namespace matchmaker
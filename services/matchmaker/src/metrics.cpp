@@ -0,0 +1,209 @@
+#include "matchmaker/metrics.hpp"
+#include <spdlog/spdlog.h>
+#include <cmath>
+#include <cstdio>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace matchmaker {
+
+namespace {
+
+std::string render_labels(const MetricLabels& labels) {
+    if (labels.empty()) {
+        return "";
+    }
+    std::string out = "{";
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        out += labels[i].first;
+        out += "=\"";
+        for (char c : labels[i].second) {
+            if (c == '\\' || c == '"') {
+                out += '\\';
+                out += c;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+    out += '}';
+    return out;
+}
+
+std::string format_value(double value) {
+    if (std::isnan(value)) {
+        return "NaN";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%.17g", value);
+    return std::string(buf, static_cast<size_t>(n));
+}
+
+void send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+} // namespace
+
+void MetricsRegistry::describe(const std::string& name, Type type, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Family& family = families_[name];
+    family.type = type;
+    family.help = help;
+}
+
+void MetricsRegistry::set(const std::string& name, double value, const MetricLabels& labels) {
+    std::string key = render_labels(labels);
+    std::lock_guard<std::mutex> lock(mutex_);
+    families_[name].series[std::move(key)] = value;
+}
+
+void MetricsRegistry::set_histogram(const std::string& name, const Histogram& histogram,
+                                    const MetricLabels& labels) {
+    std::string key = render_labels(labels);
+    std::lock_guard<std::mutex> lock(mutex_);
+    families_[name].histograms.insert_or_assign(std::move(key), std::make_pair(labels, histogram));
+}
+
+void MetricsRegistry::clear(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = families_.find(name);
+    if (it != families_.end()) {
+        it->second.series.clear();
+        it->second.histograms.clear();
+    }
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    for (const auto& [name, family] : families_) {
+        if (!family.help.empty()) {
+            out += "# HELP " + name + " " + family.help + "\n";
+        }
+        const char* type = family.type == Type::Counter ? " counter\n"
+            : family.type == Type::Histogram ? " histogram\n" : " gauge\n";
+        out += "# TYPE " + name + type;
+        for (const auto& [labels, value] : family.series) {
+            out += name + labels + " " + format_value(value) + "\n";
+        }
+        for (const auto& [key, entry] : family.histograms) {
+            const auto& [labels, histogram] = entry;
+            // Buckets are cumulative in the exposition format
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i <= histogram.bounds.size(); ++i) {
+                cumulative += histogram.counts[i];
+                MetricLabels bucket_labels = labels;
+                bucket_labels.emplace_back("le", i < histogram.bounds.size()
+                    ? format_value(histogram.bounds[i]) : "+Inf");
+                out += name + "_bucket" + render_labels(bucket_labels) + " "
+                    + format_value(static_cast<double>(cumulative)) + "\n";
+            }
+            out += name + "_sum" + key + " " + format_value(histogram.sum) + "\n";
+            out += name + "_count" + key + " " + format_value(static_cast<double>(histogram.count)) + "\n";
+        }
+    }
+    return out;
+}
+
+MetricsServer::MetricsServer(const MetricsRegistry& registry, int port)
+    : registry_(registry) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        spdlog::error("Metrics server: socket() failed");
+        return;
+    }
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 16) != 0) {
+        spdlog::error("Metrics server: cannot listen on port {}", port);
+        ::close(fd);
+        return;
+    }
+
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    listen_fd_ = fd;
+    worker_ = std::thread([this] { run(); });
+}
+
+MetricsServer::~MetricsServer() {
+    stopping_ = true;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+    }
+}
+
+void MetricsServer::run() {
+    while (!stopping_) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) <= 0) {
+            continue;
+        }
+        int client = ::accept(listen_fd_, nullptr, nullptr);
+        if (client >= 0) {
+            serve(client);
+            ::close(client);
+        }
+    }
+}
+
+void MetricsServer::serve(int client_fd) {
+    // Read the request head; the path is all that matters
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        pollfd pfd{client_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 1000) <= 0) {
+            return;
+        }
+        ssize_t n = ::recv(client_fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            return;
+        }
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    std::string response;
+    if (request.rfind("GET /metrics", 0) == 0) {
+        std::string body = registry_.render();
+        response = "HTTP/1.1 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4\r\n"
+                   "Connection: close\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    } else {
+        response = "HTTP/1.1 404 Not Found\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+    }
+    send_all(client_fd, response);
+}
+
+} // namespace matchmaker
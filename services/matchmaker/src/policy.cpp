@@ -0,0 +1,228 @@
+#include "matchmaker/policy.hpp"
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+namespace matchmaker {
+
+namespace {
+
+bool fail(std::string* error, std::string message) {
+    if (error != nullptr) {
+        *error = std::move(message);
+    }
+    return false;
+}
+
+// Overlay the fields present in `object` onto `policy`
+bool read_policy(const nlohmann::json& object, BucketPolicy& policy, const std::string& where, std::string* error) {
+    if (!object.is_object()) {
+        return fail(error, where + ": expected an object");
+    }
+    try {
+        policy.mmr_band_initial = object.value("mmr_band_initial", policy.mmr_band_initial);
+        policy.mmr_band_max = object.value("mmr_band_max", policy.mmr_band_max);
+        policy.mmr_band_growth_per_sec = object.value("mmr_band_growth_per_sec", policy.mmr_band_growth_per_sec);
+        policy.max_wait_time_sec = object.value("max_wait_time_sec", policy.max_wait_time_sec);
+        policy.min_match_quality = object.value("min_match_quality", policy.min_match_quality);
+        policy.tick_interval_ms = object.value("tick_interval_ms", policy.tick_interval_ms);
+        if (object.contains("lane_weights")) {
+            const auto& weights = object["lane_weights"];
+            if (!weights.is_object()) {
+                return fail(error, where + ": lane_weights: expected an object");
+            }
+            for (const auto& [name, weight] : weights.items()) {
+                PriorityLane lane;
+                if (!parse_lane(name, lane)) {
+                    return fail(error, where + ": lane_weights: unknown lane " + name);
+                }
+                policy.lane_weights[static_cast<size_t>(lane)] = weight.get<int>();
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        return fail(error, where + ": " + e.what());
+    }
+
+    if (policy.mmr_band_initial < 0 || policy.mmr_band_max < policy.mmr_band_initial) {
+        return fail(error, where + ": need 0 <= mmr_band_initial <= mmr_band_max");
+    }
+    if (policy.mmr_band_growth_per_sec < 0) {
+        return fail(error, where + ": mmr_band_growth_per_sec must be >= 0");
+    }
+    if (policy.max_wait_time_sec <= 0) {
+        return fail(error, where + ": max_wait_time_sec must be > 0");
+    }
+    if (policy.min_match_quality < 0.0 || policy.min_match_quality > 1.0) {
+        return fail(error, where + ": min_match_quality must be within [0, 1]");
+    }
+    if (policy.tick_interval_ms < 0) {
+        return fail(error, where + ": tick_interval_ms must be >= 0");
+    }
+    for (int weight : policy.lane_weights) {
+        if (weight < 1 || weight > kMaxLaneWeight) {
+            return fail(error, where + ": lane_weights must be within [1, " + std::to_string(kMaxLaneWeight) + "]");
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+BucketPolicy BucketPolicy::from_config(const QueueConfig& config) {
+    BucketPolicy policy;
+    policy.mmr_band_initial = config.mmr_band_initial;
+    policy.mmr_band_max = config.mmr_band_max;
+    policy.mmr_band_growth_per_sec = config.mmr_band_growth_per_sec;
+    policy.max_wait_time_sec = config.max_wait_time_sec;
+    policy.min_match_quality = config.min_match_quality;
+    policy.lane_weights = config.lane_weights;
+    return policy;
+}
+
+QueueConfig BucketPolicy::to_config() const {
+    QueueConfig config;
+    config.mmr_band_initial = mmr_band_initial;
+    config.mmr_band_max = mmr_band_max;
+    config.mmr_band_growth_per_sec = mmr_band_growth_per_sec;
+    config.max_wait_time_sec = max_wait_time_sec;
+    config.min_match_quality = min_match_quality;
+    config.lane_weights = lane_weights;
+    return config;
+}
+
+bool PolicySet::Rule::matches(const QueueBucket& bucket) const {
+    return (region.empty() || region == bucket.region)
+        && (mode.empty() || mode == bucket.mode)
+        && (team_size == 0 || team_size == bucket.team_size);
+}
+
+PolicySet::PolicySet(BucketPolicy default_policy, std::vector<Rule> rules)
+    : default_policy_(default_policy), rules_(std::move(rules)) {}
+
+const BucketPolicy& PolicySet::resolve(const QueueBucket& bucket) const {
+    for (const auto& rule : rules_) {
+        if (rule.matches(bucket)) {
+            return rule.policy;
+        }
+    }
+    return default_policy_;
+}
+
+int PolicySet::min_tick_interval_ms() const {
+    int interval = default_policy_.tick_interval_ms;
+    for (const auto& rule : rules_) {
+        int candidate = rule.policy.tick_interval_ms;
+        if (candidate > 0 && (interval == 0 || candidate < interval)) {
+            interval = candidate;
+        }
+    }
+    return interval;
+}
+
+std::unique_ptr<PolicySet> PolicySet::parse(const std::string& text, std::string* error) {
+    auto doc = nlohmann::json::parse(text, nullptr, false);
+    if (doc.is_discarded() || !doc.is_object()) {
+        fail(error, "not a JSON object");
+        return nullptr;
+    }
+
+    BucketPolicy default_policy;
+    if (doc.contains("default") && !read_policy(doc["default"], default_policy, "default", error)) {
+        return nullptr;
+    }
+
+    std::vector<Rule> rules;
+    if (doc.contains("buckets")) {
+        const auto& buckets = doc["buckets"];
+        if (!buckets.is_array()) {
+            fail(error, "buckets: expected an array");
+            return nullptr;
+        }
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            const auto& object = buckets[i];
+            std::string where = "buckets[" + std::to_string(i) + "]";
+            Rule rule;
+            rule.policy = default_policy;
+            if (!read_policy(object, rule.policy, where, error)) {
+                return nullptr;
+            }
+            try {
+                rule.region = object.value("region", std::string());
+                rule.mode = object.value("mode", std::string());
+                rule.team_size = object.value("team_size", 0);
+            } catch (const nlohmann::json::exception& e) {
+                fail(error, where + ": " + e.what());
+                return nullptr;
+            }
+            rules.push_back(std::move(rule));
+        }
+    }
+
+    return std::make_unique<PolicySet>(default_policy, std::move(rules));
+}
+
+std::unique_ptr<PolicySet> PolicySet::load(const std::string& path, std::string* error) {
+    std::ifstream in(path);
+    if (!in) {
+        fail(error, "cannot open " + path);
+        return nullptr;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return parse(buffer.str(), error);
+}
+
+PolicyWatcher::PolicyWatcher(std::string path, Callback on_reload, std::chrono::milliseconds poll_interval)
+    : path_(std::move(path)), on_reload_(std::move(on_reload)), poll_interval_(poll_interval) {
+    changed();  // Baseline: the caller has already loaded the current file
+    worker_ = std::thread([this] { run(); });
+}
+
+PolicyWatcher::~PolicyWatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool PolicyWatcher::changed() {
+    std::error_code ec;
+    auto write_time = std::filesystem::last_write_time(path_, ec);
+    if (ec) {
+        return false;
+    }
+    auto size = std::filesystem::file_size(path_, ec);
+    if (ec || (write_time == last_write_ && size == last_size_)) {
+        return false;
+    }
+    last_write_ = write_time;
+    last_size_ = size;
+    return true;
+}
+
+void PolicyWatcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_cv_.wait_for(lock, poll_interval_, [this] { return stopping_; })) {
+        if (!changed()) {
+            continue;
+        }
+        std::string error;
+        auto policy = PolicySet::load(path_, &error);
+        if (!policy) {
+            failures_.fetch_add(1, std::memory_order_relaxed);
+            spdlog::error("Policy reload from {} failed, keeping current policy: {}", path_, error);
+            continue;
+        }
+        reloads_.fetch_add(1, std::memory_order_relaxed);
+        spdlog::info("Reloaded policy from {}: {} bucket rules", path_, policy->rules().size());
+        on_reload_(std::move(policy));
+    }
+}
+
+} // namespace matchmaker
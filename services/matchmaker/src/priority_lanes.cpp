@@ -0,0 +1,65 @@
+#include "matchmaker/priority_lanes.hpp"
+#include <algorithm>
+
+namespace matchmaker {
+
+namespace {
+
+constexpr std::array<const char*, kPriorityLaneCount> kLaneNames = {"normal", "requeue", "backfill", "vip"};
+
+} // namespace
+
+const char* lane_name(PriorityLane lane) {
+    return kLaneNames[static_cast<size_t>(lane)];
+}
+
+bool parse_lane(std::string_view name, PriorityLane& lane) {
+    for (size_t i = 0; i < kPriorityLaneCount; ++i) {
+        if (name == kLaneNames[i]) {
+            lane = static_cast<PriorityLane>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+LaneScheduler::LaneScheduler(const LaneWeights& weights) : weights_(weights) {
+    int total = 0;
+    for (int& weight : weights_) {
+        weight = std::clamp(weight, 1, kMaxLaneWeight);
+        total += weight;
+    }
+
+    // Smooth weighted round-robin: every step each lane gains its weight and
+    // the richest lane takes the turn, paying back the total
+    std::array<int, kPriorityLaneCount> credit{};
+    cycle_.reserve(static_cast<size_t>(total));
+    for (int step = 0; step < total; ++step) {
+        size_t best = 0;
+        for (size_t i = 0; i < kPriorityLaneCount; ++i) {
+            credit[i] += weights_[i];
+            if (credit[i] > credit[best]) {
+                best = i;
+            }
+        }
+        credit[best] -= total;
+        cycle_.push_back(static_cast<PriorityLane>(best));
+    }
+}
+
+bool LaneScheduler::pick(uint8_t waiting, PriorityLane& lane) {
+    if (waiting == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < cycle_.size(); ++i) {
+        PriorityLane candidate = cycle_[cursor_];
+        cursor_ = cursor_ + 1 == cycle_.size() ? 0 : cursor_ + 1;
+        if (waiting & lane_bit(candidate)) {
+            lane = candidate;
+            return true;
+        }
+    }
+    return false;  // Unreachable: every lane appears in the cycle
+}
+
+} // namespace matchmaker
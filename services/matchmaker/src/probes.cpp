@@ -0,0 +1,14 @@
+#include "matchmaker/probes.hpp"
+
+#if MATCHMAKER_USDT
+
+// Tracers locate semaphores through the .probes section and increment them
+// while attached
+#define MATCHMAKER_PROBE_DEFINE_SEMAPHORE(name) \
+    __attribute__((section(".probes"), used)) volatile unsigned short MATCHMAKER_PROBE_SEMAPHORE(name) = 0;
+extern "C" {
+MATCHMAKER_PROBE_LIST(MATCHMAKER_PROBE_DEFINE_SEMAPHORE)
+}
+#undef MATCHMAKER_PROBE_DEFINE_SEMAPHORE
+
+#endif
@@ -0,0 +1,192 @@
+#include "matchmaker/queue_events.hpp"
+#include "matchmaker/party_index.hpp"
+#include <nlohmann/json.hpp>
+#include <cstdio>
+
+namespace matchmaker {
+
+namespace {
+
+bool read_digits(std::string_view text, size_t& pos, size_t count, int& value) {
+    if (pos + count > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < count; ++i) {
+        char c = text[pos + i];
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    pos += count;
+    return true;
+}
+
+bool skip_char(std::string_view text, size_t& pos, char c) {
+    if (pos >= text.size() || text[pos] != c) {
+        return false;
+    }
+    ++pos;
+    return true;
+}
+
+std::string to_traceparent(const TraceContext& trace) {
+    return "00-" + trace.trace_id + "-" + trace.parent_span_id + (trace.sampled ? "-01" : "-00");
+}
+
+} // namespace
+
+std::optional<std::chrono::system_clock::time_point> parse_iso8601(std::string_view text) {
+    using namespace std::chrono;
+
+    size_t pos = 0;
+    int y = 0, mo = 0, d = 0, h = 0, mi = 0, s = 0;
+    if (!read_digits(text, pos, 4, y) || !skip_char(text, pos, '-') ||
+        !read_digits(text, pos, 2, mo) || !skip_char(text, pos, '-') ||
+        !read_digits(text, pos, 2, d)) {
+        return std::nullopt;
+    }
+    if (pos >= text.size() || (text[pos] != 'T' && text[pos] != 't' && text[pos] != ' ')) {
+        return std::nullopt;
+    }
+    ++pos;
+    if (!read_digits(text, pos, 2, h) || !skip_char(text, pos, ':') ||
+        !read_digits(text, pos, 2, mi) || !skip_char(text, pos, ':') ||
+        !read_digits(text, pos, 2, s)) {
+        return std::nullopt;
+    }
+
+    // Fraction: nanoseconds are kept, further digits ignored
+    int64_t fraction_ns = 0;
+    if (skip_char(text, pos, '.')) {
+        size_t digits = 0;
+        int64_t scale = 100000000;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            fraction_ns += (text[pos] - '0') * scale;
+            scale /= 10;
+            ++pos;
+            ++digits;
+        }
+        if (digits == 0) {
+            return std::nullopt;
+        }
+    }
+
+    minutes offset{0};
+    if (pos < text.size()) {
+        if (text[pos] == 'Z' || text[pos] == 'z') {
+            ++pos;
+        } else if (text[pos] == '+' || text[pos] == '-') {
+            int sign = text[pos] == '-' ? -1 : 1;
+            int oh = 0, om = 0;
+            ++pos;
+            if (!read_digits(text, pos, 2, oh) || !skip_char(text, pos, ':') ||
+                !read_digits(text, pos, 2, om) || oh > 23 || om > 59) {
+                return std::nullopt;
+            }
+            offset = minutes(sign * (oh * 60 + om));
+        }
+    }
+    if (pos != text.size()) {
+        return std::nullopt;
+    }
+
+    year_month_day date{year{y}, month{static_cast<unsigned>(mo)}, day{static_cast<unsigned>(d)}};
+    if (!date.ok() || h > 23 || mi > 59 || s > 60) {
+        return std::nullopt;
+    }
+    auto utc = sys_days(date) + hours(h) + minutes(mi) + seconds(s) + nanoseconds(fraction_ns) - offset;
+    return time_point_cast<system_clock::duration>(utc);
+}
+
+void append_iso8601(std::string& out, std::chrono::system_clock::time_point time) {
+    using namespace std::chrono;
+
+    auto us = floor<microseconds>(time);
+    auto date_days = floor<days>(us);
+    year_month_day date{date_days};
+    hh_mm_ss clock{us - date_days};
+    char buf[48];
+    int n = std::snprintf(buf, sizeof(buf), "%04d-%02u-%02uT%02d:%02d:%02d.%06lld+00:00",
+        static_cast<int>(date.year()), static_cast<unsigned>(date.month()), static_cast<unsigned>(date.day()),
+        static_cast<int>(clock.hours().count()), static_cast<int>(clock.minutes().count()),
+        static_cast<int>(clock.seconds().count()), static_cast<long long>(clock.subseconds().count()));
+    out.append(buf, static_cast<size_t>(n));
+}
+
+std::optional<QueueEvent> decode_queue_event(std::string_view payload) {
+    auto doc = nlohmann::json::parse(payload.begin(), payload.end(), nullptr, false);
+    if (doc.is_discarded() || !doc.is_object()) {
+        return std::nullopt;
+    }
+    try {
+        QueueEvent event;
+        QueueEntry& entry = event.entry;
+        const auto type = doc.at("event_type").get<std::string>();
+        entry.party_id = doc.at("party_id").get<std::string>();
+        entry.party_hash = hash_party_id(entry.party_id);
+        entry.region = doc.at("region").get<std::string>();
+        entry.mode = doc.at("mode").get<std::string>();
+
+        if (type == "queue_leave") {
+            event.type = QueueEvent::Type::Leave;
+            entry.team_size = 0;
+            entry.party_size = 0;
+            entry.avg_mmr = 0;
+            return event;
+        }
+        if (type != "queue_enter") {
+            return std::nullopt;
+        }
+
+        entry.team_size = doc.at("team_size").get<int>();
+        entry.party_size = doc.at("party_size").get<int>();
+        entry.avg_mmr = doc.at("avg_mmr").get<int>();
+        auto enqueued_at = parse_iso8601(doc.at("timestamp").get<std::string>());
+        if (!enqueued_at) {
+            return std::nullopt;
+        }
+        entry.enqueued_at = *enqueued_at;
+
+        // A missing or invalid traceparent starts a new trace, as W3C asks
+        if (auto it = doc.find("traceparent"); it != doc.end() && it->is_string()) {
+            entry.trace = TraceContext::from_traceparent(it->get_ref<const std::string&>());
+        }
+        entry.player_ids = doc.value("player_ids", std::vector<std::string>{});
+        if (doc.contains("lane") && !parse_lane(doc["lane"].get<std::string>(), entry.lane)) {
+            return std::nullopt;
+        }
+        return event;
+    } catch (const nlohmann::json::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::string encode_queue_enter(const QueueEntry& entry) {
+    std::string timestamp;
+    append_iso8601(timestamp, entry.enqueued_at);
+
+    nlohmann::json doc = {
+        {"event_type", "queue_enter"},
+        {"party_id", entry.party_id},
+        {"mode", entry.mode},
+        {"team_size", entry.team_size},
+        {"avg_mmr", entry.avg_mmr},
+        {"region", entry.region},
+        {"party_size", entry.party_size},
+        {"timestamp", std::move(timestamp)},
+    };
+    if (entry.trace.valid()) {
+        doc["traceparent"] = to_traceparent(entry.trace);
+    }
+    if (!entry.player_ids.empty()) {
+        doc["player_ids"] = entry.player_ids;
+    }
+    if (entry.lane != PriorityLane::Normal) {
+        doc["lane"] = lane_name(entry.lane);
+    }
+    return doc.dump();
+}
+
+} // namespace matchmaker
@@ -1,185 +1,1394 @@
 #include "matchmaker/queue_manager.hpp"
 #include "matchmaker/team_builder.hpp"
+#include "matchmaker/compatibility_graph.hpp"
+#include "matchmaker/matching_strategy.hpp"
+#include "matchmaker/policy.hpp"
+#include "matchmaker/queue_store.hpp"
+#include "matchmaker/tracing.hpp"
+#include "matchmaker/probes.hpp"
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <random>
-#include <sstream>
-#include <iomanip>
+#include <string_view>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+#include <time.h>
 
 namespace matchmaker {
 
+namespace {
+
+// Evicted bucket storage larger than this is released instead of recycled
+constexpr size_t kMaxRecycledCapacity = 256;
+
+// MMR index tree node: colour, parent/left/right links and the value
+constexpr size_t kMmrIndexNodeBytes = 4 * sizeof(void*) + sizeof(std::pair<const int, const void*>) + sizeof(int);
+
+// Heap owned by an entry's non-ID fields
+int64_t entry_heap_bytes(const QueueEntry& entry) {
+    return static_cast<int64_t>(
+        string_heap_bytes(entry.region) + string_heap_bytes(entry.mode)
+        + string_heap_bytes(entry.trace.trace_id) + string_heap_bytes(entry.trace.parent_span_id)
+        + entry.player_ids.capacity() * sizeof(std::string));
+}
+
+// Copies the fields strategies read (player IDs feed the quality score)
+// into a recycled snapshot, reusing its strings' storage. Region, mode and
+// trace context are left out.
+void copy_strategy_input(const std::vector<QueueEntry>& entries, std::vector<QueueEntry>& snapshot) {
+    snapshot.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const QueueEntry& from = entries[i];
+        QueueEntry& to = snapshot[i];
+        to.party_id.assign(from.party_id);
+        to.team_size = from.team_size;
+        to.party_size = from.party_size;
+        to.avg_mmr = from.avg_mmr;
+        to.enqueued_at = from.enqueued_at;
+        to.lane = from.lane;
+        to.party_hash = from.party_hash;
+        to.player_ids.resize(from.player_ids.size());
+        for (size_t p = 0; p < from.player_ids.size(); ++p) {
+            to.player_ids[p].assign(from.player_ids[p]);
+        }
+    }
+}
+
+// Party ID (entry and index key) and player ID string data
+int64_t id_heap_bytes(const QueueEntry& entry) {
+    size_t bytes = 2 * string_heap_bytes(entry.party_id);
+    for (const auto& player_id : entry.player_ids) {
+        bytes += string_heap_bytes(player_id);
+    }
+    return static_cast<int64_t>(bytes);
+}
+
+} // namespace
+
+std::chrono::nanoseconds thread_cpu_time() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+#endif
+}
+
 QueueManager::QueueManager(const QueueConfig& config)
-    : config_(config) {}
+    : config_(config),
+      policy_(std::make_unique<PolicySet>(BucketPolicy::from_config(config))),
+      allowed_regions_(config.allowed_regions.begin(), config.allowed_regions.end()),
+      allowed_modes_(config.allowed_modes.begin(), config.allowed_modes.end()),
+      party_to_bucket_(&party_index_account_) {}
+
+QueueManager::~QueueManager() {
+    delete pending_policy_.exchange(nullptr, std::memory_order_acquire);
+}
+
+void QueueManager::set_policy(std::unique_ptr<const PolicySet> policy) {
+    // A policy published before the previous one was adopted supersedes it
+    delete pending_policy_.exchange(policy.release(), std::memory_order_acq_rel);
+}
+
+QueueManager::BucketPolicyState& QueueManager::bucket_policy(const QueueBucket& bucket) {
+    auto [it, inserted] = bucket_policies_.try_emplace(bucket);
+    if (inserted) {
+        const BucketPolicy& policy = policy_->resolve(bucket);
+        it->second.config = policy.to_config();
+        it->second.tick_interval_ms = policy.tick_interval_ms;
+        it->second.lanes = LaneScheduler(policy.lane_weights);
+    }
+    return it->second;
+}
+
+void QueueManager::adopt_pending_policy(std::chrono::system_clock::time_point now) {
+    const PolicySet* pending = pending_policy_.exchange(nullptr, std::memory_order_acquire);
+    if (pending == nullptr) {
+        return;
+    }
+    policy_.reset(pending);
+
+    for (auto& [bucket, state] : bucket_policies_) {
+        const BucketPolicy& policy = policy_->resolve(bucket);
+        state.tick_interval_ms = policy.tick_interval_ms;
+        BucketPolicy previous = BucketPolicy::from_config(state.config);
+        previous.tick_interval_ms = policy.tick_interval_ms;
+        if (previous == policy) {
+            continue;
+        }
+        state.config = policy.to_config();
+        state.unevaluated = true;
+        if (state.lanes.weights() != LaneScheduler(policy.lane_weights).weights()) {
+            state.lanes = LaneScheduler(policy.lane_weights);
+        }
+
+        // Widening events were scheduled under the old band parameters
+        auto graph_it = graphs_.find(bucket);
+        auto bucket_it = buckets_.find(bucket);
+        if (graph_it != graphs_.end() && bucket_it != buckets_.end()) {
+            auto graph = std::make_unique<CompatibilityGraph>(state.config);
+            for (const auto& entry : bucket_it->second) {
+                graph->add(entry, now);
+            }
+            graph_it->second = std::move(graph);
+        }
+    }
+}
+
+bool QueueManager::enqueue(const QueueEntry& entry, EnqueueRejection* rejection) {
+    auto reject = [rejection](EnqueueRejection reason, uint64_t& counter) {
+        counter++;
+        if (rejection != nullptr) {
+            *rejection = reason;
+        }
+        return false;
+    };
+
+    // Allow-lists first, so unknown values never get as far as a bucket
+    if (!allowed_regions_.empty() && allowed_regions_.count(entry.region) == 0) {
+        return reject(EnqueueRejection::Region, lifecycle_.rejected_region);
+    }
+    if (!allowed_modes_.empty() && allowed_modes_.count(entry.mode) == 0) {
+        return reject(EnqueueRejection::Mode, lifecycle_.rejected_mode);
+    }
+    if (entry.team_size < 1) {
+        return reject(EnqueueRejection::TeamSize, lifecycle_.rejected_team_size);
+    }
+    if (entry.party_size < 1 || entry.party_size > entry.team_size) {
+        return reject(EnqueueRejection::PartySize, lifecycle_.rejected_party_size);
+    }
 
-void QueueManager::enqueue(const QueueEntry& entry) {
     QueueBucket bucket{entry.region, entry.mode, entry.team_size};
+    auto bucket_it = buckets_.find(bucket);
+    if (bucket_it == buckets_.end() && config_.max_buckets > 0 && buckets_.size() >= config_.max_buckets) {
+        return reject(EnqueueRejection::BucketLimit, lifecycle_.rejected_bucket_limit);
+    }
+
+    int64_t entry_bytes = entry_heap_bytes(entry);
+    int64_t id_bytes = id_heap_bytes(entry);
+
+    // Admission control: the entry, its index nodes and its heap must fit,
+    // including the entry vector's growth when it is full
+    if (config_.memory_budget_bytes > 0) {
+        size_t slot_bytes = sizeof(QueueEntry);
+        if (bucket_it != buckets_.end() && bucket_it->second.size() == bucket_it->second.capacity()) {
+            slot_bytes = std::max<size_t>(bucket_it->second.capacity(), 1) * sizeof(QueueEntry);
+        }
+        int64_t projected = memory_bytes() + entry_bytes + id_bytes
+            + static_cast<int64_t>(slot_bytes + party_to_bucket_.insert_growth_bytes() + kMmrIndexNodeBytes);
+        if (auto graph_it = graphs_.find(bucket); graph_it != graphs_.end() && graph_it->second) {
+            projected += graph_it->second->add_growth_bytes();
+        }
+        if (projected > static_cast<int64_t>(config_.memory_budget_bytes)) {
+            return reject(EnqueueRejection::MemoryBudget, admission_rejections_);
+        }
+    }
+
+    // A redelivered or retried enqueue replaces the party's queued entry
+    // rather than adding a second one it could be matched against
+    if (auto* queued = party_to_bucket_.find(entry.party_id)) {
+        remove_queued(queued, "requeued");
+    }
 
     // Add to bucket
-    buckets_[bucket].push_back(entry);
+    if (bucket_it == buckets_.end()) {
+        create_bucket(bucket);
+        bucket_it = buckets_.find(bucket);
+    }
+    auto& entries = bucket_it->second;
+    if (entries.empty()) {
+        idle_since_.erase(bucket);
+    }
+    uint64_t party_hash = entry.party_hash != 0 ? entry.party_hash : hash_party_id(entry.party_id);
+    size_t old_capacity = entries.capacity();
+    entries.push_back(entry);
+    entries.back().party_hash = party_hash;
+    entry_capacity_bytes_ += static_cast<int64_t>((entries.capacity() - old_capacity) * sizeof(QueueEntry));
+    MATCHMAKER_PROBE(enqueue, entry.party_id.c_str(), bucket.region.c_str(), bucket.mode.c_str(),
+                     bucket.team_size, entry.avg_mmr, entries.size());
 
     // Track party for fast lookup
-    party_to_bucket_[entry.party_id] = bucket;
+    auto* record = party_to_bucket_.try_emplace(entry.party_id, party_hash).first;
+    auto& location = record->value;
+    auto& index = mmr_index_.try_emplace(bucket, MmrIndex::allocator_type(&party_index_account_)).first->second;
+    location.mmr_slot = index.emplace(entry.avg_mmr, IndexedParty{&record->key, entry.party_size});
+    location.bucket = &bucket_it->first;
+    location.slot = static_cast<uint32_t>(entries.size() - 1);
+    location.entry_bytes = entry_bytes;
+    location.id_bytes = id_bytes;
+
+    location.sequence = ++enqueue_sequence_;
+    location.enqueued_ticks = entry.enqueued_at.time_since_epoch().count();
+    location.mmr = entry.avg_mmr;
+    location.party_size = entry.party_size;
+    auto& positions = positions_.try_emplace(bucket, &party_index_account_).first->second;
+    positions.players += entry.party_size;
+    positions.by_wait.insert({location.enqueued_ticks, location.sequence}, record);
+    positions.by_mmr.insert({location.mmr, location.sequence}, record);
+    positions.changed = true;
+    positions_changed_ = true;
+
+    auto& heap = bucket_heap_[bucket];
+    heap.entry_bytes += entry_bytes;
+    heap.id_bytes += id_bytes;
+    entry_heap_bytes_ += entry_bytes;
+    id_bytes_ += id_bytes;
+
+    // The next matching pass has a new party to consider
+    BucketPolicyState& policy = bucket_policy(bucket);
+    policy.unevaluated = true;
+
+    // Team buckets track which parties are mutually within band
+    if (bucket.team_size > 1) {
+        auto& graph = graphs_[bucket];
+        if (!graph) {
+            graph = std::make_unique<CompatibilityGraph>(policy.config);
+        }
+        graph->add(entry, std::chrono::system_clock::now());
+    }
+
+    if (store_ != nullptr) {
+        store_ops_.push_back({StoreOp::Type::Add, bucket.key(), entry.party_id, entry.avg_mmr,
+                              encode_queue_entry(entry)});
+    }
+
+    if (tracer_ != nullptr) {
+        tracer_->on_enqueued(entry, bucket.key(), std::chrono::system_clock::now());
+    }
+    return true;
 }
 
-void QueueManager::dequeue(const std::string& party_id) {
+void QueueManager::dequeue(std::string_view party_id) {
     // Find which bucket this party is in
-    auto it = party_to_bucket_.find(party_id);
-    if (it == party_to_bucket_.end()) {
+    auto* record = party_to_bucket_.find(party_id);
+    if (record == nullptr) {
         return;  // Party not in queue
     }
+    remove_queued(record, "dequeued");
+}
 
-    QueueBucket bucket = it->second;
+void QueueManager::remove_queued(PartyIndex::Record* record, const char* reason) {
+    const QueueBucket& bucket = *record->value.bucket;
+    const std::string& id = record->key;
     auto& entries = buckets_[bucket];
 
     // Remove from bucket
-    entries.erase(
-        std::remove_if(entries.begin(), entries.end(),
-            [&party_id](const QueueEntry& e) { return e.party_id == party_id; }),
-        entries.end()
-    );
+    if (bucket.team_size > 1) {
+        erase_slot(entries, record->value.slot);
+    } else {
+        entries.erase(
+            std::remove_if(entries.begin(), entries.end(),
+                [&id](const QueueEntry& e) { return e.party_id == id; }),
+            entries.end()
+        );
+    }
+    MATCHMAKER_PROBE(dequeue, id.c_str(), bucket.region.c_str(), bucket.mode.c_str(),
+                     bucket.team_size, entries.size());
+
+    if (auto* graph = find_graph(bucket)) {
+        graph->remove(id);
+    }
+
+    if (tracer_ != nullptr) {
+        tracer_->on_removed(id, reason, std::chrono::system_clock::now());
+    }
 
-    // Remove from lookup
-    party_to_bucket_.erase(it);
+    // Remove from lookup (releases the record holding id)
+    forget_party(id, record->hash);
 }
 
-bool QueueManager::is_queued(const std::string& party_id) const {
-    return party_to_bucket_.find(party_id) != party_to_bucket_.end();
+bool QueueManager::is_queued(std::string_view party_id) const {
+    return party_to_bucket_.find(party_id) != nullptr;
 }
 
 std::vector<MatchResult> QueueManager::tick() {
     std::vector<MatchResult> matches;
     auto now = std::chrono::system_clock::now();
+    auto tick_start = std::chrono::steady_clock::now();
+    auto cpu_start = thread_cpu_time();
+    adopt_pending_policy(now);
+    MATCHMAKER_PROBE(tick_start, buckets_.size(), party_to_bucket_.size());
+
+    // Backfills take priority over forming new matches, but a party past
+    // its wait limit times out first rather than being placed
+    if (!backfills_.empty()) {
+        for (const auto& [bucket, requests] : backfills_) {
+            auto entries_it = buckets_.find(bucket);
+            if (entries_it != buckets_.end()) {
+                remove_timed_out_entries(bucket, entries_it->second, bucket_policy(bucket).config, now);
+            }
+        }
+        serve_backfills(now);
+    }
+    backfill_arrived_ = false;
+
+    // Process each bucket independently. Under a CPU budget the sweep
+    // resumes where the last over-budget tick stopped and wraps around.
+    bool budgeted = tick_budget_.count() > 0;
+    auto it = buckets_.begin();
+    if (budgeted && resume_bucket_) {
+        // By key: buckets created since may have rehashed the map
+        it = buckets_.find(*resume_bucket_);
+        if (it == buckets_.end()) {
+            it = buckets_.begin();
+        }
+    }
+    resume_bucket_.reset();
+    size_t processed = 0;
+    for (size_t remaining = buckets_.size(); remaining > 0; --remaining) {
+        if (it == buckets_.end()) {
+            it = buckets_.begin();
+        }
+        if (budgeted && processed > 0 && thread_cpu_time() - cpu_start >= tick_budget_) {
+            resume_bucket_ = it->first;
+            tick_budget_stats_.over_budget_ticks++;
+            tick_budget_stats_.deferred_buckets += remaining;
+            break;
+        }
+        processed++;
+        auto current = it++;
+        const QueueBucket& bucket = current->first;
+        auto& entries = current->second;
+        BucketPolicyState& policy = bucket_policy(bucket);
 
-    // Process each bucket independently
-    for (auto& [bucket, entries] : buckets_) {
         // Always remove timed-out entries, even from small buckets
-        remove_timed_out_entries(entries, now);
+        remove_timed_out_entries(bucket, entries, policy.config, now);
 
+        if (entries.empty() && evict_if_idle(bucket, entries, now)) {
+            buckets_.erase(current);
+            continue;
+        }
         if (entries.size() < 2) {
+            if (tracer_ != nullptr) {
+                trace_bucket_evaluation(bucket, entries, {}, now);
+            }
             continue;  // Need at least 2 parties to form a match
         }
+        if (policy.tick_interval_ms > 0 &&
+            now - policy.last_matched < std::chrono::milliseconds(policy.tick_interval_ms)) {
+            continue;  // Bucket runs at a slower cadence than the tick
+        }
+        policy.last_matched = now;
 
         // Try to form matches
-        auto bucket_matches = process_bucket(bucket, entries);
+        bool probed = MATCHMAKER_PROBE_ENABLED(bucket_processed);
+        size_t size_before = entries.size();
+        auto bucket_start = probed ? std::chrono::steady_clock::now() : tick_start;
+        auto bucket_matches = process_bucket(bucket, entries, policy.config);
+        if (probed) {
+            int64_t bucket_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - bucket_start).count();
+            MATCHMAKER_PROBE(bucket_processed, bucket.region.c_str(), bucket.mode.c_str(),
+                             bucket.team_size, size_before, bucket_matches.size(), bucket_ns);
+        }
+        if (MATCHMAKER_PROBE_ENABLED(match_formed)) {
+            for (const auto& match : bucket_matches) {
+                MATCHMAKER_PROBE(match_formed, match.match_id.c_str(), bucket.region.c_str(),
+                                 bucket.mode.c_str(), bucket.team_size, match.avg_mmr,
+                                 static_cast<int>(match.quality_score * 1000));
+            }
+        }
+        if (tracer_ != nullptr) {
+            trace_bucket_evaluation(bucket, entries, bucket_matches, now);
+        }
+        // Leftovers of a pass that formed matches may pair up differently
+        policy.unevaluated = !bucket_matches.empty();
         matches.insert(matches.end(), bucket_matches.begin(), bucket_matches.end());
     }
 
+    if (store_ != nullptr) {
+        flush_store();
+    }
+
+    if (config_.position_update_interval_ms > 0 && positions_changed_
+        && now - last_position_update_ >= std::chrono::milliseconds(config_.position_update_interval_ms)) {
+        collect_position_updates(now);
+    }
+
+    tick_budget_stats_.ticks++;
+    tick_budget_stats_.last_tick_cpu = thread_cpu_time() - cpu_start;
+    tick_budget_stats_.cpu_time += tick_budget_stats_.last_tick_cpu;
+
+    auto tick_duration = std::chrono::steady_clock::now() - tick_start;
+    if (tracer_ != nullptr) {
+        tracer_->on_tick_complete(tick_duration);
+    }
+    MATCHMAKER_PROBE(tick_end, matches.size(),
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(tick_duration).count(),
+                     party_to_bucket_.size());
+
     return matches;
 }
 
+std::chrono::system_clock::time_point QueueManager::next_wakeup(
+    std::chrono::system_clock::time_point now
+) const {
+    using TimePoint = std::chrono::system_clock::time_point;
+    if (pending_policy_.load(std::memory_order_acquire) != nullptr || !store_ops_.empty()
+        || resume_bucket_ || backfill_arrived_) {
+        return now;
+    }
+
+    TimePoint wake = TimePoint::max();
+    for (const auto& [bucket, entries] : buckets_) {
+        if (entries.empty()) {
+            // Empty buckets are stamped idle on the next visit, then evicted
+            auto idle_it = idle_since_.find(bucket);
+            if (idle_it == idle_since_.end()) {
+                return now;
+            }
+            wake = std::min(wake, idle_it->second + std::chrono::seconds(config_.bucket_idle_evict_sec));
+            continue;
+        }
+        auto policy_it = bucket_policies_.find(bucket);
+        if (policy_it == bucket_policies_.end()) {
+            return now;
+        }
+        const BucketPolicyState& policy = policy_it->second;
+
+        // Timeouts fire once the wait is strictly past max_wait_time_sec;
+        // the longest-waiting party heads the wait-order tree
+        const BucketPositions& positions = positions_.at(bucket);
+        TimePoint oldest{TimePoint::duration(positions.by_wait.front().first.value)};
+        wake = std::min(wake, oldest + std::chrono::seconds(policy.config.max_wait_time_sec)
+                                     + std::chrono::milliseconds(1));
+        if (entries.size() < 2 || positions.players < 2 * bucket.team_size) {
+            continue;   // Nothing to match until someone else arrives
+        }
+
+        // Otherwise a pass can only change its outcome once a band widens
+        TimePoint due = now;
+        if (!policy.unevaluated) {
+            auto graph_it = graphs_.find(bucket);
+            due = graph_it != graphs_.end() ? graph_it->second->next_widening() : policy.next_band_step;
+        }
+        if (policy.tick_interval_ms > 0 && due != TimePoint::max()) {
+            due = std::max(due, policy.last_matched + std::chrono::milliseconds(policy.tick_interval_ms));
+        }
+        wake = std::min(wake, due);
+    }
+
+    if (config_.position_update_interval_ms > 0 && positions_changed_) {
+        wake = std::min(wake, last_position_update_ + std::chrono::milliseconds(config_.position_update_interval_ms));
+    }
+
+    for (const auto& [bucket, requests] : backfills_) {
+        auto policy_it = bucket_policies_.find(bucket);
+        QueueConfig config = policy_it != bucket_policies_.end()
+            ? policy_it->second.config : policy_->resolve(bucket).to_config();
+        for (const auto& pending : requests) {
+            wake = std::min({wake, pending.request.deadline,
+                             config.next_band_step(pending.request.requested_at, now)});
+        }
+    }
+    return std::max(wake, now);
+}
+
+void QueueManager::trace_bucket_evaluation(
+    const QueueBucket& bucket,
+    const std::vector<QueueEntry>& entries,
+    const std::vector<MatchResult>& bucket_matches,
+    std::chrono::system_clock::time_point now
+) {
+    std::string key = bucket.key();
+    if (!tracer_->is_tracking(key)) {
+        return;
+    }
+
+    for (const auto& match : bucket_matches) {
+        tracer_->on_matched(match);
+    }
+
+    // Parties hold at least one player each, so only small buckets can be
+    // short of a full match
+    SkipReason reason = SkipReason::Band;
+    size_t needed = static_cast<size_t>(bucket.team_size) * 2;
+    if (entries.size() < needed) {
+        size_t players = 0;
+        for (const auto& entry : entries) {
+            players += entry.party_size;
+        }
+        if (players < needed) {
+            reason = SkipReason::InsufficientPlayers;
+        }
+    }
+    tracer_->on_evaluated(key, reason, now);
+}
+
 std::vector<MatchResult> QueueManager::process_bucket(
     QueueBucket bucket,
-    std::vector<QueueEntry>& entries
+    std::vector<QueueEntry>& entries,
+    const QueueConfig& config
 ) {
-    std::vector<MatchResult> matches;
     auto now = std::chrono::system_clock::now();
 
+    auto shadow_it = shadow_strategies_.find(bucket);
+    if (shadow_it == shadow_strategies_.end()) {
+        return run_live_strategy(bucket, entries, config, now);
+    }
+
+    // Capture the tick input before the live strategy consumes it, unless
+    // the evaluator is behind and would drop the job anyway
+    ShadowEvaluator::Job job;
+    if (!shadow_evaluator_->reserve(bucket, job.snapshot)) {
+        return run_live_strategy(bucket, entries, config, now);
+    }
+    job.bucket = bucket;
+    job.strategy = shadow_it->second;
+    job.live_strategy = live_strategy_name(bucket);
+    job.config = config;
+    job.now = now;
+    copy_strategy_input(entries, job.snapshot);
+
+    auto start = std::chrono::steady_clock::now();
+    auto matches = run_live_strategy(bucket, entries, config, now);
+    job.live_tick_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+    job.live_matches = matches;
+
+    shadow_evaluator_->submit(std::move(job));
+    return matches;
+}
+
+std::vector<MatchResult> QueueManager::run_live_strategy(
+    const QueueBucket& bucket,
+    std::vector<QueueEntry>& entries,
+    const QueueConfig& config,
+    std::chrono::system_clock::time_point now
+) {
+    auto it = strategies_.find(bucket);
+    if (it != strategies_.end()) {
+        return apply_strategy(bucket, *it->second, entries, config, now);
+    }
+    if (bucket.team_size == 1) {
+        return process_1v1_bucket(bucket, entries, config, now);
+    }
+    return process_cluster_bucket(bucket, entries, config, now);
+}
+
+std::string QueueManager::live_strategy_name(const QueueBucket& bucket) const {
+    auto it = strategies_.find(bucket);
+    if (it != strategies_.end()) {
+        return it->second->name();
+    }
+    return bucket.team_size == 1 ? "adjacent_1v1" : "compatibility_clusters";
+}
+
+std::vector<MatchResult> QueueManager::apply_strategy(
+    const QueueBucket& bucket,
+    const MatchingStrategy& strategy,
+    std::vector<QueueEntry>& entries,
+    const QueueConfig& config,
+    std::chrono::system_clock::time_point now
+) {
+    auto matches = strategy.form_matches(bucket, entries, config, now);
+
+    CompatibilityGraph* graph = find_graph(bucket);
+    std::vector<std::string> matched_party_ids;
+    for (auto& match : matches) {
+        match.match_id = generate_match_id();
+        match.region = bucket.region;
+        match.mode = bucket.mode;
+        match.team_size = bucket.team_size;
+        match.formed_at = now;
+
+        for (const auto& party_id : match.party_ids) {
+            if (graph != nullptr) {
+                graph->remove(party_id);
+            }
+            forget_party(party_id);
+            matched_party_ids.push_back(party_id);
+        }
+    }
+
+    if (!matched_party_ids.empty()) {
+        remove_matched_parties(entries, matched_party_ids);
+    }
+
+    // Strategies may reorder entries
+    if (bucket.team_size > 1) {
+        restamp_slots(entries);
+    }
+
+    // Keep the band step next_wakeup reads current: team buckets through
+    // the graph's widening queue, 1v1 buckets as the sweep would
+    if (graph != nullptr) {
+        graph->advance(now);
+    } else if (bucket.team_size == 1) {
+        auto next_band_step = std::chrono::system_clock::time_point::max();
+        for (const auto& entry : entries) {
+            next_band_step = std::min(next_band_step, config.next_band_step(entry.enqueued_at, now));
+        }
+        bucket_policy(bucket).next_band_step = next_band_step;
+    }
+    return matches;
+}
+
+std::vector<MatchResult> QueueManager::process_cluster_bucket(
+    const QueueBucket& bucket,
+    std::vector<QueueEntry>& entries,
+    const QueueConfig& config,
+    std::chrono::system_clock::time_point now
+) {
+    std::vector<MatchResult> matches;
+
+    // Only clusters of mutually in-band parties that changed since their
+    // last attempt and hold enough players are worth evaluating
+    CompatibilityGraph* graph = find_graph(bucket);
+    if (graph == nullptr) {
+        return matches;
+    }
+    graph->advance(now);
+    auto clusters = graph->take_viable_clusters(bucket.team_size * 2);
+    if (clusters.empty()) {
+        return matches;
+    }
+
+    // Cluster members are found through their recorded slots, so the work
+    // is proportional to the clusters rather than the bucket
+    LaneScheduler& lanes = bucket_policy(bucket).lanes;
+    for (const auto& members : clusters) {
+        std::vector<QueueEntry> cluster;
+        cluster.reserve(members.size());
+        for (const auto& party_id : members) {
+            if (const auto* record = party_to_bucket_.find(party_id)) {
+                cluster.push_back(entries[record->value.slot]);
+            }
+        }
+
+        for (auto& match : match_cluster(bucket, std::move(cluster), config, lanes, now)) {
+            // Remove matched parties from the queue, the lookup map and the graph
+            for (const auto& party_id : match.party_ids) {
+                auto* record = party_to_bucket_.find(party_id);
+                uint64_t party_hash = record->hash;
+                erase_slot(entries, record->value.slot);
+                graph->remove(party_id);
+                forget_party(party_id, party_hash);
+            }
+            matches.push_back(std::move(match));
+        }
+    }
+
+    return matches;
+}
+
+std::vector<MatchResult> QueueManager::match_cluster(
+    const QueueBucket& bucket,
+    std::vector<QueueEntry> cluster,
+    const QueueConfig& config,
+    LaneScheduler& lanes,
+    std::chrono::system_clock::time_point now
+) {
+    std::vector<MatchResult> matches;
+
     // Sort by wait time (longest waiting first - fairness)
-    std::sort(entries.begin(), entries.end(),
+    std::sort(cluster.begin(), cluster.end(),
         [](const QueueEntry& a, const QueueEntry& b) {
             return a.enqueued_at < b.enqueued_at;
         });
 
+    // Lanes with parties left in the cluster. A lane whose anchor cannot
+    // form an acceptable match sits out the rest of this cluster.
+    std::array<size_t, kPriorityLaneCount> lane_sizes{};
+    for (const auto& entry : cluster) {
+        lane_sizes[static_cast<size_t>(entry.lane)]++;
+    }
+    uint8_t waiting = 0;
+    for (size_t i = 0; i < kPriorityLaneCount; ++i) {
+        if (lane_sizes[i] > 0) {
+            waiting |= lane_bit(static_cast<PriorityLane>(i));
+        }
+    }
+
     // Try to form matches until we can't anymore
-    while (entries.size() >= 2) {
-        // Calculate MMR band for the longest-waiting party
-        int mmr_tolerance = calculate_mmr_band(entries[0], now);
+    PriorityLane lane;
+    while (cluster.size() >= 2 && lanes.pick(waiting, lane)) {
+        // The lane's longest-waiting party anchors the attempt: move it to
+        // the front, keeping everyone else in wait order
+        auto anchor = std::find_if(cluster.begin(), cluster.end(),
+            [lane](const QueueEntry& e) { return e.lane == lane; });
+        std::rotate(cluster.begin(), anchor, anchor + 1);
+
+        // Calculate MMR band for the anchor
+        int mmr_tolerance = config.mmr_band_at(cluster[0].enqueued_at, now);
 
         // Attempt to form a match
         auto match_opt = TeamBuilder::try_form_match(
-            entries,
+            cluster,
             bucket.team_size,
             2,  // 2 teams (can be configurable later)
             mmr_tolerance
         );
 
-        if (!match_opt.has_value()) {
-            // Can't form any more matches in this bucket
-            break;
+        // Match quality too low: wait for better options
+        bool rejected = match_opt.has_value() && match_opt->quality_score < config.min_match_quality;
+        if (rejected && tracer_ != nullptr) {
+            tracer_->on_quality_rejected(cluster);
         }
-
-        MatchResult match = match_opt.value();
-
-        // Check quality threshold
-        if (match.quality_score < config_.min_match_quality) {
-            // Match quality too low, wait for better options
-            break;
+        if (!match_opt.has_value() || rejected) {
+            std::rotate(cluster.begin(), cluster.begin() + 1, anchor + 1);
+            waiting &= static_cast<uint8_t>(~lane_bit(lane));
+            continue;
         }
 
-        // Generate UUID v4 for match ID using a non-deterministic source.
-        // std::random_device is queried for every draw so the output cannot
-        // be reconstructed from prior match IDs the way an mt19937 stream can.
-        static thread_local std::random_device rd;
-        auto draw = [&]() -> uint32_t { return rd(); };
-
-        // UUID v4 format: xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx
-        std::stringstream ss;
-        ss << std::hex << std::setfill('0');
-        ss << std::setw(8) << draw() << "-";
-        ss << std::setw(4) << (draw() & 0xFFFF) << "-";
-        ss << std::setw(4) << ((draw() & 0x0FFF) | 0x4000) << "-";  // Version 4
-        ss << std::setw(4) << ((draw() & 0x3FFF) | 0x8000) << "-";  // Variant
-        ss << std::setw(8) << draw();
-        ss << std::setw(4) << (draw() & 0xFFFF);
-        match.match_id = ss.str();
+        MatchResult match = std::move(*match_opt);
+        match.match_id = generate_match_id();
 
         // Fill in region/mode from bucket
         match.region = bucket.region;
         match.mode = bucket.mode;
         match.team_size = bucket.team_size;
+        match.mmr_band = mmr_tolerance;
+        match.formed_at = now;
+        lane_anchors_[static_cast<size_t>(lane)]++;
 
-        matches.push_back(match);
+        std::unordered_set<std::string_view> matched(match.party_ids.begin(), match.party_ids.end());
+        for (const auto& entry : cluster) {
+            if (matched.count(entry.party_id) > 0 &&
+                --lane_sizes[static_cast<size_t>(entry.lane)] == 0) {
+                waiting &= static_cast<uint8_t>(~lane_bit(entry.lane));
+            }
+        }
+        remove_matched_parties(cluster, match.party_ids);
+        matches.push_back(std::move(match));
+    }
 
-        // Remove matched parties from queue
-        remove_matched_parties(entries, match.party_ids);
+    return matches;
+}
 
-        // Also remove from lookup map
-        for (const auto& party_id : match.party_ids) {
-            party_to_bucket_.erase(party_id);
+std::vector<MatchResult> QueueManager::process_1v1_bucket(
+    const QueueBucket& bucket,
+    std::vector<QueueEntry>& entries,
+    const QueueConfig& config,
+    std::chrono::system_clock::time_point now
+) {
+    std::vector<MatchResult> matches;
+
+    // 1v1 buckets are kept in MMR order (ties by wait time). Removals preserve
+    // order and enqueue appends, so only the unsorted tail needs sorting
+    // before a linear merge.
+    auto by_mmr = [](const QueueEntry& a, const QueueEntry& b) {
+        if (a.avg_mmr != b.avg_mmr) {
+            return a.avg_mmr < b.avg_mmr;
+        }
+        return a.enqueued_at < b.enqueued_at;
+    };
+    auto sorted_end = std::is_sorted_until(entries.begin(), entries.end(), by_mmr);
+    if (sorted_end != entries.end()) {
+        std::sort(sorted_end, entries.end(), by_mmr);
+        std::inplace_merge(entries.begin(), sorted_end, entries.end(), by_mmr);
+    }
+
+    // Noting the earliest band step on the way lets next_wakeup skip a pass
+    std::vector<TeamBuilder::SoloCandidate> candidates;
+    candidates.reserve(entries.size());
+    auto next_band_step = std::chrono::system_clock::time_point::max();
+    for (const auto& entry : entries) {
+        int band = -1;
+        if (entry.party_size == 1) {
+            auto waited = std::chrono::duration_cast<std::chrono::seconds>(now - entry.enqueued_at);
+            band = config.mmr_band_after(waited);
+            if (config.band_can_widen(band)) {
+                next_band_step = std::min(next_band_step, entry.enqueued_at + waited + std::chrono::seconds(1));
+            }
         }
+        candidates.push_back({entry.avg_mmr, band, entry.enqueued_at.time_since_epoch().count()});
+    }
+    bucket_policy(bucket).next_band_step = next_band_step;
+
+    auto pairs = TeamBuilder::pair_adjacent_1v1(candidates, config.min_match_quality);
+    if (pairs.empty()) {
+        return matches;
     }
 
+    std::vector<char> matched(entries.size(), 0);
+    matches.reserve(pairs.size());
+    for (const auto& [a, b] : pairs) {
+        MatchResult match = TeamBuilder::build_1v1_match(entries[a], entries[b]);
+        match.match_id = generate_match_id();
+        match.region = bucket.region;
+        match.mode = bucket.mode;
+        match.team_size = bucket.team_size;
+        match.mmr_band = std::min(candidates[a].mmr_band, candidates[b].mmr_band);
+        match.formed_at = now;
+        matches.push_back(std::move(match));
+
+        matched[a] = 1;
+        matched[b] = 1;
+        forget_party(entries[a].party_id, entries[a].party_hash);
+        forget_party(entries[b].party_id, entries[b].party_hash);
+    }
+
+    // Single compaction pass keeps the survivors in MMR order
+    size_t write = 0;
+    for (size_t read = 0; read < entries.size(); ++read) {
+        if (!matched[read]) {
+            if (write != read) {
+                entries[write] = std::move(entries[read]);
+            }
+            ++write;
+        }
+    }
+    entries.erase(entries.begin() + write, entries.end());
+
     return matches;
 }
 
-int QueueManager::calculate_mmr_band(
-    const QueueEntry& entry,
-    std::chrono::system_clock::time_point now
-) const {
-    auto wait_time_sec = std::chrono::duration_cast<std::chrono::seconds>(
-        now - entry.enqueued_at
-    ).count();
+void QueueManager::set_strategy(
+    const QueueBucket& bucket,
+    std::shared_ptr<const MatchingStrategy> strategy
+) {
+    if (strategy) {
+        strategies_[bucket] = std::move(strategy);
+    } else {
+        strategies_.erase(bucket);
+    }
+}
+
+void QueueManager::set_shadow_strategy(
+    const QueueBucket& bucket,
+    std::shared_ptr<const MatchingStrategy> strategy
+) {
+    if (!strategy) {
+        shadow_strategies_.erase(bucket);
+        return;
+    }
+    if (!shadow_evaluator_) {
+        shadow_evaluator_ = std::make_unique<ShadowEvaluator>();
+    }
+    shadow_strategies_[bucket] = std::move(strategy);
+}
+
+std::unordered_map<std::string, ShadowComparison> QueueManager::get_shadow_comparisons() const {
+    if (!shadow_evaluator_) {
+        return {};
+    }
+    return shadow_evaluator_->get_comparisons();
+}
+
+void QueueManager::flush_shadow_evaluations() {
+    if (shadow_evaluator_) {
+        shadow_evaluator_->flush();
+    }
+}
+
+std::string QueueManager::generate_match_id() {
+    // Generate UUID v4 for match ID using a non-deterministic source.
+    // Random bytes come straight from the OS CSPRNG so the output cannot be
+    // reconstructed from prior match IDs the way an mt19937 stream can. They
+    // are fetched in blocks so a tick forming many matches does not pay one
+    // syscall per draw.
+    static thread_local std::array<uint8_t, 512> pool;
+    static thread_local size_t pool_pos = pool.size();
+
+    if (pool_pos + 16 > pool.size()) {
+#if defined(__linux__)
+        size_t filled = 0;
+        while (filled < pool.size()) {
+            ssize_t n = getrandom(pool.data() + filled, pool.size() - filled, 0);
+            if (n > 0) {
+                filled += static_cast<size_t>(n);
+            }
+        }
+#else
+        static thread_local std::random_device rd;
+        for (size_t i = 0; i < pool.size(); i += 4) {
+            uint32_t word = rd();
+            std::memcpy(pool.data() + i, &word, 4);
+        }
+#endif
+        pool_pos = 0;
+    }
+
+    uint8_t bytes[16];
+    std::memcpy(bytes, pool.data() + pool_pos, sizeof(bytes));
+    pool_pos += sizeof(bytes);
+
+    bytes[6] = (bytes[6] & 0x0F) | 0x40;  // Version 4
+    bytes[8] = (bytes[8] & 0x3F) | 0x80;  // Variant
 
-    int band = config_.mmr_band_initial + (wait_time_sec * config_.mmr_band_growth_per_sec);
-    return std::min(band, config_.mmr_band_max);
+    // UUID v4 format: xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string id(36, '-');
+    size_t out = 0;
+    for (size_t i = 0; i < sizeof(bytes); ++i) {
+        if (out == 8 || out == 13 || out == 18 || out == 23) {
+            ++out;
+        }
+        id[out++] = kHex[bytes[i] >> 4];
+        id[out++] = kHex[bytes[i] & 0x0F];
+    }
+    return id;
 }
 
 void QueueManager::remove_matched_parties(
     std::vector<QueueEntry>& entries,
     const std::vector<std::string>& party_ids
 ) {
+    std::unordered_set<std::string_view> matched(party_ids.begin(), party_ids.end());
+
     entries.erase(
         std::remove_if(entries.begin(), entries.end(),
-            [&party_ids](const QueueEntry& e) {
-                return std::find(party_ids.begin(), party_ids.end(), e.party_id) != party_ids.end();
+            [&matched](const QueueEntry& e) {
+                return matched.count(e.party_id) > 0;
             }),
         entries.end()
     );
 }
 
 void QueueManager::remove_timed_out_entries(
+    const QueueBucket& bucket,
     std::vector<QueueEntry>& entries,
+    const QueueConfig& config,
     std::chrono::system_clock::time_point now
 ) {
-    auto timeout_duration = std::chrono::seconds(config_.max_wait_time_sec);
+    auto positions_it = positions_.find(bucket);
+    if (positions_it == positions_.end()) {
+        return;
+    }
+    PositionTree& by_wait = positions_it->second.by_wait;
+    auto timeout_duration = std::chrono::seconds(config.max_wait_time_sec);
+    CompatibilityGraph* graph = find_graph(bucket);
 
-    entries.erase(
-        std::remove_if(entries.begin(), entries.end(),
-            [&](const QueueEntry& e) {
-                auto wait_time = now - e.enqueued_at;
-                return wait_time > timeout_duration;
-            }),
-        entries.end()
-    );
+    // The wait-order tree yields the timed-out parties oldest first, so the
+    // cost is proportional to the evictions rather than the bucket
+    std::vector<std::string> expired;
+    while (!by_wait.empty()) {
+        PartyIndex::Record* record = by_wait.front().second;
+        auto enqueued_at = std::chrono::system_clock::time_point(
+            std::chrono::system_clock::duration(record->value.enqueued_ticks));
+        auto wait_time = now - enqueued_at;
+        if (wait_time <= timeout_duration) {
+            break;
+        }
+
+        std::string party_id = record->key;
+        uint64_t party_hash = record->hash;
+        if (bucket.team_size > 1) {
+            erase_slot(entries, record->value.slot);
+        }
+        if (graph != nullptr) {
+            graph->remove(party_id);
+        }
+        if (tracer_ != nullptr) {
+            tracer_->on_removed(party_id, "timeout", now);
+        }
+        MATCHMAKER_PROBE(timeout_evict, party_id.c_str(), bucket.region.c_str(),
+                         bucket.mode.c_str(), bucket.team_size,
+                         std::chrono::duration_cast<std::chrono::milliseconds>(wait_time).count());
+        forget_party(party_id, party_hash);     // Also drops the tree key
+        expired.push_back(std::move(party_id));
+    }
+
+    // 1v1 buckets keep their MMR order: one compaction pass, only when needed
+    if (bucket.team_size == 1 && !expired.empty()) {
+        remove_matched_parties(entries, expired);
+    }
+}
+
+void QueueManager::erase_slot(std::vector<QueueEntry>& entries, uint32_t slot) {
+    if (slot + 1 != entries.size()) {
+        entries[slot] = std::move(entries.back());
+        const QueueEntry& moved = entries[slot];
+        party_to_bucket_.find(moved.party_id, moved.party_hash)->value.slot = slot;
+    }
+    entries.pop_back();
+}
+
+void QueueManager::restamp_slots(const std::vector<QueueEntry>& entries) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        party_to_bucket_.find(entries[i].party_id, entries[i].party_hash)->value.slot = static_cast<uint32_t>(i);
+    }
+}
+
+void QueueManager::forget_party(std::string_view party_id, uint64_t party_hash) {
+    auto* record = party_to_bucket_.find(party_id, party_hash != 0 ? party_hash : hash_party_id(party_id));
+    if (record == nullptr) {
+        return;
+    }
+    const PartyLocation& location = record->value;
+    const QueueBucket& bucket = *location.bucket;
+    auto index_it = mmr_index_.find(bucket);
+    if (index_it != mmr_index_.end()) {
+        index_it->second.erase(location.mmr_slot);
+    }
+    unindex_position(location);
+    auto& heap = bucket_heap_[bucket];
+    heap.entry_bytes -= location.entry_bytes;
+    heap.id_bytes -= location.id_bytes;
+    entry_heap_bytes_ -= location.entry_bytes;
+    id_bytes_ -= location.id_bytes;
+    if (store_ != nullptr) {
+        store_ops_.push_back({StoreOp::Type::Remove, bucket.key(), record->key, 0, {}});
+    }
+    party_to_bucket_.erase(record);
+}
+
+void QueueManager::unindex_position(const PartyLocation& location) {
+    auto it = positions_.find(*location.bucket);
+    if (it == positions_.end()) {
+        return;
+    }
+    it->second.by_wait.erase({location.enqueued_ticks, location.sequence});
+    it->second.by_mmr.erase({location.mmr, location.sequence});
+    it->second.players -= location.party_size;
+    it->second.changed = true;
+    positions_changed_ = true;
+}
+
+std::optional<QueuePosition> QueueManager::get_queue_position(std::string_view party_id) const {
+    const auto* record = party_to_bucket_.find(party_id);
+    if (record == nullptr) {
+        return std::nullopt;
+    }
+    const PartyLocation& location = record->value;
+    const QueueBucket& bucket = *location.bucket;
+    const BucketPositions& positions = positions_.at(bucket);
+    auto policy_it = bucket_policies_.find(bucket);
+    QueueConfig config = policy_it != bucket_policies_.end()
+        ? policy_it->second.config : policy_->resolve(bucket).to_config();
+
+    QueuePosition result;
+    result.position = positions.by_wait.rank({location.enqueued_ticks, location.sequence}) + 1;
+    result.queued = positions.by_wait.size();
+    result.band = config.mmr_band_at(
+        std::chrono::system_clock::time_point(std::chrono::system_clock::duration(location.enqueued_ticks)),
+        std::chrono::system_clock::now());
+    result.in_band = positions.by_mmr.count_between(location.mmr - result.band, location.mmr + result.band) - 1;
+    return result;
+}
+
+std::vector<QueuePositionUpdate> QueueManager::take_position_updates() {
+    std::vector<QueuePositionUpdate> updates;
+    updates.swap(position_updates_);
+    return updates;
+}
+
+void QueueManager::collect_position_updates(std::chrono::system_clock::time_point now) {
+    // Only buckets whose membership changed can have moved positions; within
+    // them, report just the parties whose position differs from the last report
+    for (auto& [bucket, positions] : positions_) {
+        if (!positions.changed) {
+            continue;
+        }
+        positions.changed = false;
+        QueuePositionUpdate update;
+        update.bucket = bucket.key();
+        update.queued = positions.by_wait.size();
+        positions.by_wait.for_each([&update](size_t rank, PartyIndex::Record* record) {
+            auto position = static_cast<uint32_t>(rank + 1);
+            if (record->value.reported_position != position) {
+                record->value.reported_position = position;
+                update.positions.emplace_back(record->key, position);
+            }
+        });
+        if (!update.positions.empty()) {
+            position_updates_.push_back(std::move(update));
+        }
+    }
+    positions_changed_ = false;
+    last_position_update_ = now;
+}
+
+size_t QueueManager::restore_from_store() {
+    if (store_ == nullptr) {
+        return 0;
+    }
+    auto entries = store_->load();
+    if (!entries) {
+        return 0;
+    }
+    if (auto checkpoint = store_->load_checkpoint()) {
+        ingest_checkpoint_ = std::max(ingest_checkpoint_, *checkpoint);
+    }
+
+    size_t pending = store_ops_.size();
+    std::vector<StoreOp> rejected;
+    size_t restored = 0;
+    for (const auto& entry : *entries) {
+        if (is_queued(entry.party_id)) {
+            continue;
+        }
+        if (enqueue(entry)) {
+            restored++;
+        } else {
+            // No longer admissible (allow-lists or limits changed): drop it
+            QueueBucket bucket{entry.region, entry.mode, entry.team_size};
+            rejected.push_back({StoreOp::Type::Remove, bucket.key(), entry.party_id, 0, {}});
+        }
+    }
+
+    // Restored entries are already persisted; only the drops need writing
+    store_ops_.resize(pending);
+    store_ops_.insert(store_ops_.end(), std::make_move_iterator(rejected.begin()),
+                      std::make_move_iterator(rejected.end()));
+    return restored;
+}
+
+bool QueueManager::flush_store() {
+    if (store_ == nullptr || store_ops_.empty()) {
+        return true;
+    }
+    if (!store_->apply(store_ops_)) {
+        store_write_failures_++;
+        return false;
+    }
+    store_ops_.clear();
+    return true;
+}
+
+size_t QueueManager::pending_store_ops() const {
+    return store_ops_.size();
+}
+
+void QueueManager::checkpoint_ingest(uint64_t sequence) {
+    ingest_checkpoint_ = sequence;
+    if (store_ == nullptr) {
+        return;
+    }
+    // Only the latest checkpoint in a batch matters
+    if (!store_ops_.empty() && store_ops_.back().type == StoreOp::Type::Checkpoint) {
+        store_ops_.back().payload = std::to_string(sequence);
+    } else {
+        store_ops_.push_back({StoreOp::Type::Checkpoint, {}, {}, 0, std::to_string(sequence)});
+    }
+}
+
+bool QueueManager::request_backfill(const BackfillRequest& request) {
+    backfill_stats_.requested++;
+    bool known_bucket = (allowed_regions_.empty() || allowed_regions_.count(request.region) > 0)
+        && (allowed_modes_.empty() || allowed_modes_.count(request.mode) > 0);
+    if (!known_bucket || request.team_size < 1 || request.open_slots < 1 || request.match_id.empty()
+        || backfill_buckets_.count(request.match_id) > 0) {
+        backfill_stats_.rejected++;
+        return false;
+    }
+
+    QueueBucket bucket{request.region, request.mode, request.team_size};
+    backfill_buckets_.emplace(request.match_id, bucket);
+    backfills_[bucket].push_back({request, request.open_slots});
+    backfill_stats_.pending++;
+    backfill_arrived_ = true;
+    return true;
+}
+
+bool QueueManager::cancel_backfill(const std::string& match_id) {
+    auto it = backfill_buckets_.find(match_id);
+    if (it == backfill_buckets_.end()) {
+        return false;
+    }
+    auto bucket_it = backfills_.find(it->second);
+    auto& pending = bucket_it->second;
+    pending.erase(std::find_if(pending.begin(), pending.end(),
+        [&match_id](const PendingBackfill& p) { return p.request.match_id == match_id; }));
+    if (pending.empty()) {
+        backfills_.erase(bucket_it);
+    }
+    backfill_buckets_.erase(it);
+    backfill_stats_.pending--;
+    backfill_stats_.cancelled++;
+    return true;
+}
+
+std::vector<BackfillResult> QueueManager::take_backfill_results() {
+    std::vector<BackfillResult> results;
+    results.swap(backfill_results_);
+    return results;
+}
+
+void QueueManager::serve_backfills(std::chrono::system_clock::time_point now) {
+    for (auto bucket_it = backfills_.begin(); bucket_it != backfills_.end();) {
+        const QueueBucket& bucket = bucket_it->first;
+        auto& requests = bucket_it->second;
+        auto policy_it = bucket_policies_.find(bucket);
+        QueueConfig config = policy_it != bucket_policies_.end()
+            ? policy_it->second.config : policy_->resolve(bucket).to_config();
+        size_t first_result = backfill_results_.size();
+
+        // Oldest request first; each takes the nearest parties still indexed
+        for (auto it = requests.begin(); it != requests.end();) {
+            PendingBackfill& pending = *it;
+            const BackfillRequest& request = pending.request;
+            BackfillResult result;
+            result.match_id = request.match_id;
+            result.region = request.region;
+            result.mode = request.mode;
+            result.team_size = request.team_size;
+
+            if (now >= request.deadline) {
+                result.expired = true;
+            } else {
+                fill_backfill(bucket, pending, config.mmr_band_at(request.requested_at, now), result);
+            }
+            result.open_slots = pending.open_slots;
+            result.latency = std::chrono::duration_cast<std::chrono::microseconds>(now - request.requested_at);
+
+            bool done = result.expired || pending.open_slots == 0;
+            if (result.expired) {
+                backfill_stats_.expired++;
+            } else if (done) {
+                backfill_stats_.filled++;
+                backfill_stats_.fill_latency.observe(std::chrono::duration<double>(result.latency).count());
+            }
+            if (result.expired || !result.party_ids.empty()) {
+                backfill_results_.push_back(std::move(result));
+            }
+            if (done) {
+                backfill_buckets_.erase(request.match_id);
+                backfill_stats_.pending--;
+                it = requests.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // 1v1 buckets stay in MMR order: one compaction pass hands the
+        // assigned parties' players to their results and drops them
+        if (bucket.team_size == 1 && backfill_results_.size() > first_result) {
+            std::unordered_map<std::string_view, std::vector<std::string>*> assigned;
+            std::vector<int> assigned_mmrs;     // Cheap pre-check before hashing an ID
+            for (size_t r = first_result; r < backfill_results_.size(); ++r) {
+                auto& result = backfill_results_[r];
+                result.players.resize(result.party_ids.size());
+                for (size_t i = 0; i < result.party_ids.size(); ++i) {
+                    assigned.emplace(result.party_ids[i], &result.players[i]);
+                    assigned_mmrs.push_back(result.party_mmrs[i]);
+                }
+            }
+            std::sort(assigned_mmrs.begin(), assigned_mmrs.end());
+            auto entries_it = buckets_.find(bucket);
+            if (!assigned.empty() && entries_it != buckets_.end()) {
+                auto& entries = entries_it->second;
+                entries.erase(
+                    std::remove_if(entries.begin(), entries.end(),
+                        [&](QueueEntry& e) {
+                            if (!std::binary_search(assigned_mmrs.begin(), assigned_mmrs.end(), e.avg_mmr)) {
+                                return false;
+                            }
+                            auto found = assigned.find(e.party_id);
+                            if (found == assigned.end()) {
+                                return false;
+                            }
+                            *found->second = std::move(e.player_ids);
+                            return true;
+                        }),
+                    entries.end());
+            }
+        }
+
+        if (requests.empty()) {
+            bucket_it = backfills_.erase(bucket_it);
+        } else {
+            ++bucket_it;
+        }
+    }
+}
+
+void QueueManager::fill_backfill(const QueueBucket& bucket, PendingBackfill& pending, int band,
+                                 BackfillResult& result) {
+    auto index_it = mmr_index_.find(bucket);
+    if (index_it == mmr_index_.end()) {
+        return;
+    }
+    MmrIndex& index = index_it->second;
+    int target = pending.request.target_mmr;
+
+    // Walk outwards from the target, nearest MMR first, skipping parties
+    // too large for the remaining slots
+    std::vector<MmrIndex::iterator> chosen;
+    int open = pending.open_slots;
+    auto up = index.lower_bound(target);
+    auto down = up;
+    while (open > 0) {
+        bool has_up = up != index.end() && up->first - target <= band;
+        bool has_down = down != index.begin() && target - std::prev(down)->first <= band;
+        if (!has_up && !has_down) {
+            break;
+        }
+        MmrIndex::iterator pick;
+        if (has_up && (!has_down || up->first - target <= target - std::prev(down)->first)) {
+            pick = up++;
+        } else {
+            pick = --down;
+        }
+        if (pick->second.party_size <= open) {
+            open -= pick->second.party_size;
+            chosen.push_back(pick);
+        }
+    }
+
+    CompatibilityGraph* graph = find_graph(bucket);
+    auto& entries = buckets_.find(bucket)->second;
+    auto now = std::chrono::system_clock::now();
+    for (auto pick : chosen) {
+        std::string party_id = *pick->second.party_id;
+        result.party_mmrs.push_back(pick->first);
+        if (bucket.team_size > 1) {
+            // Team buckets hand over the players through the entry's slot
+            auto* record = party_to_bucket_.find(party_id);
+            result.players.push_back(std::move(entries[record->value.slot].player_ids));
+            erase_slot(entries, record->value.slot);
+        }
+        if (graph != nullptr) {
+            graph->remove(party_id);
+        }
+        if (tracer_ != nullptr) {
+            tracer_->on_removed(party_id, "backfill", now);
+        }
+        forget_party(party_id);     // Also drops the index slot
+        result.party_ids.push_back(std::move(party_id));
+    }
+    backfill_stats_.players_assigned += static_cast<uint64_t>(pending.open_slots - open);
+    pending.open_slots = open;
+}
+
+std::vector<QueueEntry>& QueueManager::create_bucket(const QueueBucket& bucket) {
+    std::vector<QueueEntry> storage;
+    if (!bucket_freelist_.empty()) {
+        storage = std::move(bucket_freelist_.back());
+        bucket_freelist_.pop_back();
+        lifecycle_.recycled++;
+    }
+    lifecycle_.created++;
+    return buckets_.emplace(bucket, std::move(storage)).first->second;
+}
+
+bool QueueManager::evict_if_idle(
+    const QueueBucket& bucket,
+    std::vector<QueueEntry>& entries,
+    std::chrono::system_clock::time_point now
+) {
+    auto idle_it = idle_since_.try_emplace(bucket, now).first;
+    if (now - idle_it->second < std::chrono::seconds(config_.bucket_idle_evict_sec)) {
+        return false;
+    }
+
+    // Nothing is queued here, so no party index entry refers to the bucket
+    idle_since_.erase(idle_it);
+    bucket_policies_.erase(bucket);
+    graphs_.erase(bucket);
+    bucket_heap_.erase(bucket);
+    mmr_index_.erase(bucket);
+    positions_.erase(bucket);
+    if (bucket_freelist_.size() < config_.bucket_freelist_size && entries.capacity() <= kMaxRecycledCapacity) {
+        bucket_freelist_.push_back(std::move(entries));
+    } else {
+        entry_capacity_bytes_ -= static_cast<int64_t>(entries.capacity() * sizeof(QueueEntry));
+    }
+    lifecycle_.evicted++;
+    return true;
+}
+
+CompatibilityGraph* QueueManager::find_graph(const QueueBucket& bucket) {
+    auto it = graphs_.find(bucket);
+    return it == graphs_.end() ? nullptr : it->second.get();
 }
 
 size_t QueueManager::get_queue_size() const {
@@ -206,4 +1415,51 @@ std::unordered_map<std::string, size_t> QueueManager::get_bucket_sizes() const {
     return sizes;
 }
 
+BucketLifecycleStats QueueManager::get_bucket_lifecycle_stats() const {
+    BucketLifecycleStats stats = lifecycle_;
+    stats.live = buckets_.size();
+    stats.freelist = bucket_freelist_.size();
+    return stats;
+}
+
+int64_t QueueManager::memory_bytes() const {
+    int64_t total = party_index_account_.bytes + entry_heap_bytes_ + id_bytes_ + entry_capacity_bytes_;
+    for (const auto& [bucket, graph] : graphs_) {
+        total += graph->memory_bytes();
+    }
+    return total;
+}
+
+MemoryStats QueueManager::get_memory_stats() const {
+    MemoryStats stats;
+    stats.party_index_bytes = party_index_account_.bytes;
+    stats.party_index_allocations = party_index_account_.allocations;
+    stats.id_arena_bytes = id_bytes_;
+    stats.budget_bytes = static_cast<int64_t>(config_.memory_budget_bytes);
+    stats.admission_rejections = admission_rejections_;
+
+    for (const auto& [bucket, entries] : buckets_) {
+        BucketMemory& memory = stats.buckets[bucket.key()];
+        memory.parties = entries.size();
+        memory.entry_bytes = static_cast<int64_t>(entries.capacity() * sizeof(QueueEntry));
+
+        auto heap_it = bucket_heap_.find(bucket);
+        if (heap_it != bucket_heap_.end()) {
+            memory.entry_bytes += heap_it->second.entry_bytes;
+            memory.id_bytes = heap_it->second.id_bytes;
+        }
+        auto graph_it = graphs_.find(bucket);
+        if (graph_it != graphs_.end()) {
+            memory.graph_bytes = graph_it->second->memory_bytes();
+        }
+
+        stats.bucket_bytes += memory.entry_bytes;
+        stats.graph_bytes += memory.graph_bytes;
+    }
+    for (const auto& storage : bucket_freelist_) {
+        stats.freelist_bytes += static_cast<int64_t>(storage.capacity() * sizeof(QueueEntry));
+    }
+    return stats;
+}
+
 } // namespace matchmaker
@@ -0,0 +1,163 @@
+#include "matchmaker/queue_store.hpp"
+#include "matchmaker/match_serializer.hpp"
+#include <nlohmann/json.hpp>
+#include <charconv>
+
+namespace matchmaker {
+
+namespace {
+
+void append_field(std::string& out, const char* key, int64_t value) {
+    out += '"';
+    out += key;
+    out += "\":";
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+    out += ',';
+}
+
+void append_field(std::string& out, const char* key, const std::string& value) {
+    out += '"';
+    out += key;
+    out += "\":";
+    append_json_string(out, value);
+    out += ',';
+}
+
+} // namespace
+
+std::string encode_queue_entry(const QueueEntry& entry) {
+    std::string out;
+    out.reserve(160 + 48 * entry.player_ids.size());
+    out += '{';
+    append_field(out, "party_id", entry.party_id);
+    append_field(out, "region", entry.region);
+    append_field(out, "mode", entry.mode);
+    append_field(out, "team_size", entry.team_size);
+    append_field(out, "party_size", entry.party_size);
+    append_field(out, "avg_mmr", entry.avg_mmr);
+    if (entry.lane != PriorityLane::Normal) {
+        append_field(out, "lane", std::string(lane_name(entry.lane)));
+    }
+    append_field(out, "enqueued_at_us", std::chrono::duration_cast<std::chrono::microseconds>(
+        entry.enqueued_at.time_since_epoch()).count());
+    out += "\"player_ids\":[";
+    for (size_t i = 0; i < entry.player_ids.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        append_json_string(out, entry.player_ids[i]);
+    }
+    out += "]}";
+    return out;
+}
+
+std::optional<QueueEntry> decode_queue_entry(const std::string& payload) {
+    auto doc = nlohmann::json::parse(payload, nullptr, false);
+    if (doc.is_discarded() || !doc.is_object()) {
+        return std::nullopt;
+    }
+    try {
+        QueueEntry entry;
+        entry.party_id = doc.at("party_id").get<std::string>();
+        entry.party_hash = hash_party_id(entry.party_id);
+        entry.region = doc.at("region").get<std::string>();
+        entry.mode = doc.at("mode").get<std::string>();
+        entry.team_size = doc.at("team_size").get<int>();
+        entry.party_size = doc.at("party_size").get<int>();
+        entry.avg_mmr = doc.at("avg_mmr").get<int>();
+        entry.enqueued_at = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::microseconds(doc.at("enqueued_at_us").get<int64_t>())));
+        entry.player_ids = doc.value("player_ids", std::vector<std::string>{});
+        if (doc.contains("lane") && !parse_lane(doc["lane"].get<std::string>(), entry.lane)) {
+            return std::nullopt;
+        }
+        return entry;
+    } catch (const nlohmann::json::exception&) {
+        return std::nullopt;
+    }
+}
+
+bool InMemoryQueueStore::apply(const std::vector<StoreOp>& ops) {
+    for (const auto& op : ops) {
+        if (op.type == StoreOp::Type::Add) {
+            entries_[op.party_id] = op.payload;
+        } else if (op.type == StoreOp::Type::Remove) {
+            entries_.erase(op.party_id);
+        } else {
+            checkpoint_ = std::stoull(op.payload);
+        }
+    }
+    return true;
+}
+
+std::optional<std::vector<QueueEntry>> InMemoryQueueStore::load() {
+    std::vector<QueueEntry> entries;
+    entries.reserve(entries_.size());
+    for (const auto& [party_id, payload] : entries_) {
+        if (auto entry = decode_queue_entry(payload)) {
+            entries.push_back(std::move(*entry));
+        }
+    }
+    return entries;
+}
+
+RedisQueueStore::RedisQueueStore(const RedisQueueStoreConfig& config)
+    : config_(config), connection_(config.host, config.port, config.timeout) {}
+
+bool RedisQueueStore::apply(const std::vector<StoreOp>& ops) {
+    if (ops.empty()) {
+        return true;
+    }
+
+    std::string entries = entries_key();
+    std::vector<RedisCommand> commands;
+    commands.reserve(ops.size() * 2);
+    for (const auto& op : ops) {
+        if (op.type == StoreOp::Type::Checkpoint) {
+            commands.push_back({"SET", checkpoint_key(), op.payload});
+            continue;
+        }
+        std::string zset = bucket_key(op.bucket);
+        if (op.type == StoreOp::Type::Add) {
+            commands.push_back({"ZADD", std::move(zset), std::to_string(op.mmr), op.party_id});
+            commands.push_back({"HSET", entries, op.party_id, op.payload});
+        } else {
+            commands.push_back({"ZREM", std::move(zset), op.party_id});
+            commands.push_back({"HDEL", entries, op.party_id});
+        }
+    }
+    return connection_.batch(commands).has_value();
+}
+
+std::optional<std::vector<QueueEntry>> RedisQueueStore::load() {
+    auto reply = connection_.command({"HGETALL", entries_key()});
+    if (!reply || reply->type != RedisReply::Type::Array) {
+        return std::nullopt;
+    }
+
+    std::vector<QueueEntry> entries;
+    entries.reserve(reply->elements.size() / 2);
+    for (size_t i = 1; i < reply->elements.size(); i += 2) {
+        if (auto entry = decode_queue_entry(reply->elements[i].str)) {
+            entries.push_back(std::move(*entry));
+        }
+    }
+    return entries;
+}
+
+std::optional<uint64_t> RedisQueueStore::load_checkpoint() {
+    auto reply = connection_.command({"GET", checkpoint_key()});
+    if (!reply || reply->is_error()) {
+        return std::nullopt;
+    }
+    uint64_t sequence = 0;
+    if (reply->type == RedisReply::Type::Bulk) {
+        std::from_chars(reply->str.data(), reply->str.data() + reply->str.size(), sequence);
+    }
+    return sequence;
+}
+
+} // namespace matchmaker
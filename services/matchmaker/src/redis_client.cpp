@@ -0,0 +1,778 @@
+#include "matchmaker/redis_client.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace matchmaker {
+
+namespace {
+
+enum class ParseResult { Complete, Incomplete, Invalid };
+
+void append_int(std::string& out, int64_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+void encode_command(std::string& out, const RedisCommand& command) {
+    out += '*';
+    append_int(out, static_cast<int64_t>(command.size()));
+    out += "\r\n";
+    for (const auto& arg : command) {
+        out += '$';
+        append_int(out, static_cast<int64_t>(arg.size()));
+        out += "\r\n";
+        out += arg;
+        out += "\r\n";
+    }
+}
+
+void encode_reply(std::string& out, const RedisReply& reply) {
+    switch (reply.type) {
+        case RedisReply::Type::Status:
+            out += '+';
+            out += reply.str;
+            out += "\r\n";
+            break;
+        case RedisReply::Type::Error:
+            out += '-';
+            out += reply.str;
+            out += "\r\n";
+            break;
+        case RedisReply::Type::Integer:
+            out += ':';
+            append_int(out, reply.integer);
+            out += "\r\n";
+            break;
+        case RedisReply::Type::Bulk:
+            out += '$';
+            append_int(out, static_cast<int64_t>(reply.str.size()));
+            out += "\r\n";
+            out += reply.str;
+            out += "\r\n";
+            break;
+        case RedisReply::Type::Nil:
+            out += "$-1\r\n";
+            break;
+        case RedisReply::Type::Array:
+            out += '*';
+            append_int(out, static_cast<int64_t>(reply.elements.size()));
+            out += "\r\n";
+            for (const auto& element : reply.elements) {
+                encode_reply(out, element);
+            }
+            break;
+    }
+}
+
+// Parse one value starting at pos; pos is only advanced on Complete
+ParseResult parse_reply(const std::string& buf, size_t& pos, RedisReply& reply) {
+    size_t line_end = buf.find("\r\n", pos);
+    if (line_end == std::string::npos) {
+        return ParseResult::Incomplete;
+    }
+    if (line_end == pos) {
+        return ParseResult::Invalid;
+    }
+    char kind = buf[pos];
+    const char* first = buf.data() + pos + 1;
+    const char* last = buf.data() + line_end;
+    size_t next = line_end + 2;
+
+    auto parse_length = [&](int64_t& value) {
+        auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+    };
+
+    switch (kind) {
+        case '+':
+            reply = RedisReply::status(std::string(first, last));
+            break;
+        case '-':
+            reply = RedisReply::error(std::string(first, last));
+            break;
+        case ':': {
+            int64_t value = 0;
+            if (!parse_length(value)) {
+                return ParseResult::Invalid;
+            }
+            reply = RedisReply::number(value);
+            break;
+        }
+        case '$': {
+            int64_t length = 0;
+            if (!parse_length(length)) {
+                return ParseResult::Invalid;
+            }
+            if (length < 0) {
+                reply = RedisReply{};
+                break;
+            }
+            if (buf.size() < next + static_cast<size_t>(length) + 2) {
+                return ParseResult::Incomplete;
+            }
+            reply = RedisReply::bulk(buf.substr(next, static_cast<size_t>(length)));
+            next += static_cast<size_t>(length) + 2;
+            break;
+        }
+        case '*': {
+            int64_t count = 0;
+            if (!parse_length(count)) {
+                return ParseResult::Invalid;
+            }
+            RedisReply array;
+            if (count < 0) {
+                reply = array;
+                break;
+            }
+            array.type = RedisReply::Type::Array;
+            array.elements.resize(static_cast<size_t>(count));
+            for (auto& element : array.elements) {
+                ParseResult result = parse_reply(buf, next, element);
+                if (result != ParseResult::Complete) {
+                    return result;
+                }
+            }
+            reply = std::move(array);
+            break;
+        }
+        default:
+            return ParseResult::Invalid;
+    }
+    pos = next;
+    return ParseResult::Complete;
+}
+
+std::string upper(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::toupper(c); });
+    return s;
+}
+
+bool parse_score(const std::string& s, double& score) {
+    if (s == "-inf") {
+        score = -HUGE_VAL;
+        return true;
+    }
+    if (s == "+inf" || s == "inf") {
+        score = HUGE_VAL;
+        return true;
+    }
+    char* end = nullptr;
+    score = std::strtod(s.c_str(), &end);
+    return end != s.c_str() && *end == '\0';
+}
+
+std::string format_score(double score) {
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "%.17g", score);
+    return std::string(buf, static_cast<size_t>(n));
+}
+
+const RedisReply kWrongArgs = RedisReply::error("ERR wrong number of arguments");
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// RedisConnection
+// ---------------------------------------------------------------------------
+
+RedisConnection::RedisConnection(std::string host, int port, std::chrono::milliseconds timeout)
+    : host_(std::move(host)), port_(port), timeout_(timeout) {}
+
+RedisConnection::~RedisConnection() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool RedisConnection::parse_url(const std::string& url, std::string& host, int& port) {
+    const std::string scheme = "redis://";
+    if (url.rfind(scheme, 0) != 0) {
+        return false;
+    }
+    std::string rest = url.substr(scheme.size());
+    rest = rest.substr(0, rest.find('/'));
+    size_t at = rest.rfind('@');
+    if (at != std::string::npos) {
+        rest = rest.substr(at + 1);  // Credentials are not supported
+    }
+    size_t colon = rest.rfind(':');
+    host = rest.substr(0, colon);
+    port = 6379;
+    if (colon != std::string::npos) {
+        auto result = std::from_chars(rest.data() + colon + 1, rest.data() + rest.size(), port);
+        if (result.ec != std::errc() || result.ptr != rest.data() + rest.size()) {
+            return false;
+        }
+    }
+    return !host.empty();
+}
+
+const std::string& RedisConnection::batch_script() {
+    static const std::string script =
+        "local i, n = 1, 0\n"
+        "while i <= #ARGV do\n"
+        "  local argc = tonumber(ARGV[i])\n"
+        "  redis.call(unpack(ARGV, i + 1, i + argc))\n"
+        "  i = i + argc + 1\n"
+        "  n = n + 1\n"
+        "end\n"
+        "return n\n";
+    return script;
+}
+
+bool RedisConnection::connect() {
+    if (fd_ >= 0) {
+        return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    std::string port = std::to_string(port_);
+    if (::getaddrinfo(host_.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        last_error_ = "cannot resolve " + host_;
+        return false;
+    }
+
+    int timeout_ms = static_cast<int>(timeout_.count());
+    for (addrinfo* ai = addresses; ai != nullptr && fd_ < 0; ai = ai->ai_next) {
+        int fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+
+        // Non-blocking connect so the timeout applies, then back to blocking
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int rc = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc != 0) {
+            pollfd pfd{fd, POLLOUT, 0};
+            int err = 0;
+            socklen_t len = sizeof(err);
+            if (::poll(&pfd, 1, timeout_ms) != 1 ||
+                ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+                ::close(fd);
+                continue;
+            }
+        }
+        ::fcntl(fd, F_SETFL, flags);
+
+        timeval tv{};
+        tv.tv_sec = timeout_ms / 1000;
+        tv.tv_usec = (timeout_ms % 1000) * 1000;
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fd_ = fd;
+    }
+    ::freeaddrinfo(addresses);
+
+    if (fd_ < 0) {
+        last_error_ = "cannot connect to " + host_ + ":" + port;
+        return false;
+    }
+    read_buf_.clear();
+    read_pos_ = 0;
+    return true;
+}
+
+void RedisConnection::close_with(std::string error) {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    last_error_ = std::move(error);
+}
+
+bool RedisConnection::send_buffer() {
+    size_t sent = 0;
+    while (sent < write_buf_.size()) {
+        ssize_t n = ::send(fd_, write_buf_.data() + sent, write_buf_.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            close_with("write failed");
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool RedisConnection::read_reply(RedisReply& reply) {
+    while (true) {
+        ParseResult result = parse_reply(read_buf_, read_pos_, reply);
+        if (result == ParseResult::Complete) {
+            return true;
+        }
+        if (result == ParseResult::Invalid) {
+            close_with("protocol error");
+            return false;
+        }
+
+        // Drop consumed bytes before growing the buffer
+        if (read_pos_ > 0) {
+            read_buf_.erase(0, read_pos_);
+            read_pos_ = 0;
+        }
+        char chunk[16384];
+        ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            close_with(n == 0 ? "connection closed" : "read timed out");
+            return false;
+        }
+        read_buf_.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+std::optional<std::vector<RedisReply>> RedisConnection::pipeline(const std::vector<RedisCommand>& commands) {
+    if (!connect()) {
+        return std::nullopt;
+    }
+    write_buf_.clear();
+    for (const auto& command : commands) {
+        encode_command(write_buf_, command);
+    }
+    if (!send_buffer()) {
+        return std::nullopt;
+    }
+    round_trips_++;
+
+    std::vector<RedisReply> replies(commands.size());
+    for (auto& reply : replies) {
+        if (!read_reply(reply)) {
+            return std::nullopt;
+        }
+    }
+    return replies;
+}
+
+std::optional<RedisReply> RedisConnection::command(const RedisCommand& command) {
+    auto replies = pipeline({command});
+    if (!replies) {
+        return std::nullopt;
+    }
+    return std::move(replies->front());
+}
+
+std::optional<int64_t> RedisConnection::batch(const std::vector<RedisCommand>& commands) {
+    if (commands.empty()) {
+        return 0;
+    }
+
+    RedisCommand eval{"EVALSHA", batch_sha_, "0"};
+    for (const auto& command : commands) {
+        eval.push_back(std::to_string(command.size()));
+        eval.insert(eval.end(), command.begin(), command.end());
+    }
+
+    std::optional<RedisReply> reply;
+    if (!batch_sha_.empty()) {
+        reply = this->command(eval);
+        if (!reply) {
+            return std::nullopt;
+        }
+    }
+
+    // First use, or the server lost its script cache: load and run in one trip
+    if (batch_sha_.empty() || (reply->is_error() && reply->str.rfind("NOSCRIPT", 0) == 0)) {
+        eval[0] = "EVAL";
+        eval[1] = batch_script();
+        auto replies = pipeline({{"SCRIPT", "LOAD", batch_script()}, eval});
+        if (!replies) {
+            return std::nullopt;
+        }
+        if ((*replies)[0].type == RedisReply::Type::Bulk) {
+            batch_sha_ = (*replies)[0].str;
+        }
+        reply = std::move((*replies)[1]);
+    }
+
+    if (reply->type != RedisReply::Type::Integer) {
+        last_error_ = reply->is_error() ? reply->str : "unexpected batch reply";
+        return std::nullopt;
+    }
+    return reply->integer;
+}
+
+// ---------------------------------------------------------------------------
+// RespStandIn
+// ---------------------------------------------------------------------------
+
+RespStandIn::RespStandIn() {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return;
+    }
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 16) != 0) {
+        ::close(fd);
+        return;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    listen_fd_ = fd;
+    worker_ = std::thread([this] { run(); });
+}
+
+RespStandIn::~RespStandIn() {
+    stopping_ = true;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+    }
+}
+
+void RespStandIn::run() {
+    struct Client {
+        std::string in;
+        std::string out;
+    };
+    std::unordered_map<int, Client> clients;
+
+    while (!stopping_) {
+        std::vector<pollfd> fds;
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const auto& [fd, client] : clients) {
+            fds.push_back({fd, POLLIN, 0});
+        }
+        if (::poll(fds.data(), fds.size(), 50) <= 0) {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd >= 0) {
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                clients[fd];
+            }
+        }
+
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            int fd = fds[i].fd;
+            Client& client = clients[fd];
+            char chunk[65536];
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                ::close(fd);
+                clients.erase(fd);
+                continue;
+            }
+            client.in.append(chunk, static_cast<size_t>(n));
+
+            // Drain what has arrived so a large batch is not re-parsed per chunk
+            while ((n = ::recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT)) > 0) {
+                client.in.append(chunk, static_cast<size_t>(n));
+            }
+
+            // Answer every complete command; a pipelined batch gets one write
+            size_t pos = 0;
+            bool broken = false;
+            while (true) {
+                RedisReply request;
+                ParseResult result = parse_reply(client.in, pos, request);
+                if (result == ParseResult::Incomplete) {
+                    break;
+                }
+                if (result == ParseResult::Invalid || request.type != RedisReply::Type::Array) {
+                    broken = true;
+                    break;
+                }
+                RedisCommand command;
+                for (auto& element : request.elements) {
+                    command.push_back(std::move(element.str));
+                }
+                encode_reply(client.out, execute(command));
+            }
+            client.in.erase(0, pos);
+
+            size_t sent = 0;
+            while (sent < client.out.size()) {
+                ssize_t w = ::send(fd, client.out.data() + sent, client.out.size() - sent, MSG_NOSIGNAL);
+                if (w <= 0) {
+                    broken = true;
+                    break;
+                }
+                sent += static_cast<size_t>(w);
+            }
+            client.out.clear();
+            if (broken) {
+                ::close(fd);
+                clients.erase(fd);
+            }
+        }
+    }
+
+    for (const auto& [fd, client] : clients) {
+        ::close(fd);
+    }
+}
+
+RedisReply RespStandIn::execute(const RedisCommand& command) {
+    commands_served_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dispatch(command);
+}
+
+RedisReply RespStandIn::dispatch(const RedisCommand& command) {
+    if (command.empty()) {
+        return RedisReply::error("ERR empty command");
+    }
+    const std::string name = upper(command[0]);
+    const size_t argc = command.size();
+
+    auto array = [](std::vector<std::string> values) {
+        RedisReply reply;
+        reply.type = RedisReply::Type::Array;
+        for (auto& value : values) {
+            reply.elements.push_back(RedisReply::bulk(std::move(value)));
+        }
+        return reply;
+    };
+
+    if (name == "PING") {
+        return RedisReply::status("PONG");
+    }
+    if (name == "FLUSHALL" || name == "FLUSHDB") {
+        strings_.clear();
+        hashes_.clear();
+        sets_.clear();
+        zsets_.clear();
+        return RedisReply::status("OK");
+    }
+    if (name == "SET" && argc == 3) {
+        strings_[command[1]] = command[2];
+        return RedisReply::status("OK");
+    }
+    if (name == "GET" && argc == 2) {
+        auto it = strings_.find(command[1]);
+        return it == strings_.end() ? RedisReply{} : RedisReply::bulk(it->second);
+    }
+    if (name == "DEL" && argc >= 2) {
+        int64_t removed = 0;
+        for (size_t i = 1; i < argc; ++i) {
+            removed += static_cast<int64_t>(strings_.erase(command[i]) + hashes_.erase(command[i])
+                                            + sets_.erase(command[i]) + zsets_.erase(command[i]));
+        }
+        return RedisReply::number(removed);
+    }
+
+    // Hashes
+    if (name == "HSET") {
+        if (argc < 4 || argc % 2 != 0) {
+            return kWrongArgs;
+        }
+        auto& hash = hashes_[command[1]];
+        int64_t added = 0;
+        for (size_t i = 2; i + 1 < argc; i += 2) {
+            added += hash.insert_or_assign(command[i], command[i + 1]).second ? 1 : 0;
+        }
+        return RedisReply::number(added);
+    }
+    if (name == "HGET" && argc == 3) {
+        auto it = hashes_.find(command[1]);
+        if (it == hashes_.end()) {
+            return RedisReply{};
+        }
+        auto field = it->second.find(command[2]);
+        return field == it->second.end() ? RedisReply{} : RedisReply::bulk(field->second);
+    }
+    if (name == "HDEL" && argc >= 3) {
+        auto it = hashes_.find(command[1]);
+        int64_t removed = 0;
+        if (it != hashes_.end()) {
+            for (size_t i = 2; i < argc; ++i) {
+                removed += static_cast<int64_t>(it->second.erase(command[i]));
+            }
+            if (it->second.empty()) {
+                hashes_.erase(it);
+            }
+        }
+        return RedisReply::number(removed);
+    }
+    if (name == "HLEN" && argc == 2) {
+        auto it = hashes_.find(command[1]);
+        return RedisReply::number(it == hashes_.end() ? 0 : static_cast<int64_t>(it->second.size()));
+    }
+    if (name == "HGETALL" && argc == 2) {
+        std::vector<std::string> values;
+        auto it = hashes_.find(command[1]);
+        if (it != hashes_.end()) {
+            for (const auto& [field, value] : it->second) {
+                values.push_back(field);
+                values.push_back(value);
+            }
+        }
+        return array(std::move(values));
+    }
+
+    // Sets
+    if (name == "SADD" && argc >= 3) {
+        auto& set = sets_[command[1]];
+        int64_t added = 0;
+        for (size_t i = 2; i < argc; ++i) {
+            added += set.insert(command[i]).second ? 1 : 0;
+        }
+        return RedisReply::number(added);
+    }
+    if (name == "SREM" && argc >= 3) {
+        auto it = sets_.find(command[1]);
+        int64_t removed = 0;
+        if (it != sets_.end()) {
+            for (size_t i = 2; i < argc; ++i) {
+                removed += static_cast<int64_t>(it->second.erase(command[i]));
+            }
+            if (it->second.empty()) {
+                sets_.erase(it);
+            }
+        }
+        return RedisReply::number(removed);
+    }
+    if (name == "SMEMBERS" && argc == 2) {
+        auto it = sets_.find(command[1]);
+        if (it == sets_.end()) {
+            return array({});
+        }
+        return array(std::vector<std::string>(it->second.begin(), it->second.end()));
+    }
+
+    // Sorted sets
+    if (name == "ZADD") {
+        if (argc < 4 || argc % 2 != 0) {
+            return kWrongArgs;
+        }
+        auto& zset = zsets_[command[1]];
+        int64_t added = 0;
+        for (size_t i = 2; i + 1 < argc; i += 2) {
+            double score = 0;
+            if (!parse_score(command[i], score)) {
+                return RedisReply::error("ERR value is not a valid float");
+            }
+            added += zset.insert_or_assign(command[i + 1], score).second ? 1 : 0;
+        }
+        return RedisReply::number(added);
+    }
+    if (name == "ZREM" && argc >= 3) {
+        auto it = zsets_.find(command[1]);
+        int64_t removed = 0;
+        if (it != zsets_.end()) {
+            for (size_t i = 2; i < argc; ++i) {
+                removed += static_cast<int64_t>(it->second.erase(command[i]));
+            }
+            if (it->second.empty()) {
+                zsets_.erase(it);
+            }
+        }
+        return RedisReply::number(removed);
+    }
+    if (name == "ZCARD" && argc == 2) {
+        auto it = zsets_.find(command[1]);
+        return RedisReply::number(it == zsets_.end() ? 0 : static_cast<int64_t>(it->second.size()));
+    }
+    if (name == "ZSCORE" && argc == 3) {
+        auto it = zsets_.find(command[1]);
+        if (it == zsets_.end()) {
+            return RedisReply{};
+        }
+        auto member = it->second.find(command[2]);
+        return member == it->second.end() ? RedisReply{} : RedisReply::bulk(format_score(member->second));
+    }
+    if (name == "ZRANGEBYSCORE" && argc == 4) {
+        double min = 0;
+        double max = 0;
+        if (!parse_score(command[2], min) || !parse_score(command[3], max)) {
+            return RedisReply::error("ERR min or max is not a float");
+        }
+        std::vector<std::pair<double, std::string>> members;
+        auto it = zsets_.find(command[1]);
+        if (it != zsets_.end()) {
+            for (const auto& [member, score] : it->second) {
+                if (score >= min && score <= max) {
+                    members.emplace_back(score, member);
+                }
+            }
+        }
+        std::sort(members.begin(), members.end());
+        std::vector<std::string> values;
+        for (auto& [score, member] : members) {
+            values.push_back(std::move(member));
+        }
+        return array(std::move(values));
+    }
+
+    // Scripts: only the batch script is understood
+    if (name == "SCRIPT" && argc == 3 && upper(command[1]) == "LOAD") {
+        std::string sha = std::to_string(std::hash<std::string>{}(command[2]));
+        scripts_[sha] = command[2];
+        return RedisReply::bulk(sha);
+    }
+    if ((name == "EVALSHA" || name == "EVAL") && argc >= 3) {
+        std::string body = command[1];
+        if (name == "EVALSHA") {
+            auto it = scripts_.find(command[1]);
+            if (it == scripts_.end()) {
+                return RedisReply::error("NOSCRIPT No matching script. Please use EVAL.");
+            }
+            body = it->second;
+        }
+        if (body != RedisConnection::batch_script()) {
+            return RedisReply::error("ERR stand-in only runs RedisConnection::batch_script()");
+        }
+        int64_t numkeys = 0;
+        auto result = std::from_chars(command[2].data(), command[2].data() + command[2].size(), numkeys);
+        if (result.ec != std::errc() || numkeys < 0 || static_cast<size_t>(numkeys) + 3 > argc) {
+            return RedisReply::error("ERR invalid number of keys");
+        }
+        return run_batch(command, 3 + static_cast<size_t>(numkeys));
+    }
+
+    return RedisReply::error("ERR unknown command '" + command[0] + "'");
+}
+
+RedisReply RespStandIn::run_batch(const RedisCommand& command, size_t argv_start) {
+    int64_t executed = 0;
+    size_t i = argv_start;
+    while (i < command.size()) {
+        size_t group = 0;
+        auto result = std::from_chars(command[i].data(), command[i].data() + command[i].size(), group);
+        if (result.ec != std::errc() || group == 0 || i + 1 + group > command.size()) {
+            return RedisReply::error("ERR malformed batch");
+        }
+        RedisCommand inner(command.begin() + static_cast<std::ptrdiff_t>(i + 1),
+                           command.begin() + static_cast<std::ptrdiff_t>(i + 1 + group));
+        RedisReply reply = dispatch(inner);
+        if (reply.is_error()) {
+            return reply;  // Like redis.call: earlier writes stay applied
+        }
+        executed++;
+        i += 1 + group;
+    }
+    return RedisReply::number(executed);
+}
+
+} // namespace matchmaker
@@ -1,4 +1,5 @@
 #include "matchmaker/team_builder.hpp"
+#include "matchmaker/probes.hpp"
 #include <algorithm>
 #include <numeric>
 #include <cmath>
@@ -74,6 +75,8 @@ std::optional<MatchResult> TeamBuilder::try_form_match(
                     result.teams[team_idx].push_back(player_id);
                 }
                 result.party_ids.push_back(entry->party_id);
+                result.party_mmrs.push_back(entry->avg_mmr);
+                result.party_enqueued_at.push_back(entry->enqueued_at);
                 result.avg_mmr += entry->avg_mmr * entry->party_size;
                 total_players += entry->party_size;
             }
@@ -83,9 +86,12 @@ std::optional<MatchResult> TeamBuilder::try_form_match(
         result.mmr_variance = calculate_mmr_variance(combination);
         result.quality_score = calculate_match_quality(result, entries);
 
+        MATCHMAKER_PROBE(team_formed, entries.size(), team_size, mmr_tolerance, combination.size(),
+                         static_cast<int>(result.quality_score * 1000));
         return result;
     }
 
+    MATCHMAKER_PROBE(team_rejected, entries.size(), team_size, mmr_tolerance);
     return std::nullopt;
 }
 
@@ -115,16 +121,22 @@ double TeamBuilder::calculate_match_quality(
     }
 
     // Calculate MMR difference between teams
-    double mmr_balance = 1.0;
+    int mmr_diff = 0;
     if (team_mmrs.size() >= 2) {
         int max_mmr = *std::max_element(team_mmrs.begin(), team_mmrs.end());
         int min_mmr = *std::min_element(team_mmrs.begin(), team_mmrs.end());
-        int mmr_diff = max_mmr - min_mmr;
-        mmr_balance = 1.0 - (std::min(mmr_diff, 500) / 500.0);  // Normalize to 0-1
+        mmr_diff = max_mmr - min_mmr;
     }
 
+    return score_quality(mmr_diff, match.mmr_variance);
+}
+
+double TeamBuilder::score_quality(int team_mmr_diff, int mmr_variance) {
+    // Factor 1: MMR balance between teams (0-1, higher is better)
+    double mmr_balance = 1.0 - (std::min(team_mmr_diff, 500) / 500.0);  // Normalize to 0-1
+
     // Factor 2: Low MMR variance within match (0-1, lower variance is better)
-    double variance_score = 1.0 - (std::min(match.mmr_variance, 1000) / 1000.0);
+    double variance_score = 1.0 - (std::min(mmr_variance, 1000) / 1000.0);
 
     // Factor 3: Wait time fairness (currently simple, could be improved)
     double wait_score = 1.0;  // Simplified for now
@@ -133,6 +145,121 @@ double TeamBuilder::calculate_match_quality(
     return (mmr_balance * 0.5) + (variance_score * 0.3) + (wait_score * 0.2);
 }
 
+double TeamBuilder::quality_1v1(int mmr_a, int mmr_b) {
+    // Same integer math as calculate_avg_mmr/calculate_mmr_variance for two solo parties
+    int avg_mmr = (mmr_a + mmr_b) / 2;
+    int diff_a = mmr_a - avg_mmr;
+    int diff_b = mmr_b - avg_mmr;
+    int variance = std::sqrt((diff_a * diff_a + diff_b * diff_b) / 2);
+    return score_quality(std::abs(mmr_a - mmr_b), variance);
+}
+
+std::vector<std::pair<size_t, size_t>> TeamBuilder::pair_adjacent_1v1(
+    const std::vector<SoloCandidate>& candidates,
+    double min_quality
+) {
+    std::vector<std::pair<size_t, size_t>> pairs;
+    pairs.reserve(candidates.size() / 2);
+
+    // 1v1 quality only depends on the MMR gap and never improves as it grows,
+    // so the quality threshold reduces to a maximum gap computed once.
+    int max_quality_gap = -1;
+    while (max_quality_gap < 2000 && quality_1v1(0, max_quality_gap + 1) >= min_quality) {
+        ++max_quality_gap;
+    }
+
+    auto compatible = [&](size_t a, size_t b) {
+        const auto& lhs = candidates[a];
+        const auto& rhs = candidates[b];
+        int gap = rhs.mmr - lhs.mmr;
+        return gap <= max_quality_gap && gap <= lhs.mmr_band && gap <= rhs.mmr_band;
+    };
+
+    // Entries that cannot pair this tick (negative band) are passed over, so
+    // their MMR neighbours are compared with each other
+    const size_t n = candidates.size();
+    auto next_pairable = [&](size_t k) {
+        while (k < n && candidates[k].mmr_band < 0) {
+            ++k;
+        }
+        return k;
+    };
+
+    size_t i = next_pairable(0);
+    while (i < n) {
+        size_t j = next_pairable(i + 1);
+        if (j >= n) {
+            break;
+        }
+
+        if (!compatible(i, j)) {
+            // If i reaches the entry after j, the gap was fine and j's own
+            // band too narrow; step over j unless that strands k's partner
+            size_t k = next_pairable(j + 1);
+            if (k < n && compatible(i, k) && !compatible(j, k)) {
+                size_t after = next_pairable(k + 1);
+                if (!(after < n && compatible(k, after))) {
+                    pairs.emplace_back(i, k);
+                    i = after;
+                    continue;
+                }
+            }
+            i = j;
+            continue;
+        }
+
+        // Taking (i, j) strands the next entry unless it can pair with the
+        // one after. In that case j goes to whichever neighbour has waited
+        // longer (ties to the closer MMR), leaving i for a later tick.
+        size_t next = next_pairable(j + 1);
+        if (next < n && compatible(j, next)) {
+            size_t after = next_pairable(next + 1);
+            if (!(after < n && compatible(next, after))) {
+                const auto& left = candidates[i];
+                const auto& right = candidates[next];
+                bool prefer_right = right.enqueued_at < left.enqueued_at;
+                if (right.enqueued_at == left.enqueued_at) {
+                    int left_gap = candidates[j].mmr - left.mmr;
+                    int right_gap = right.mmr - candidates[j].mmr;
+                    prefer_right = right_gap < left_gap;
+                }
+                if (prefer_right) {
+                    i = j;
+                    continue;
+                }
+            }
+        }
+
+        pairs.emplace_back(i, j);
+        i = next_pairable(j + 1);
+    }
+
+    MATCHMAKER_PROBE(pair_sweep, candidates.size(), pairs.size());
+    return pairs;
+}
+
+MatchResult TeamBuilder::build_1v1_match(const QueueEntry& a, const QueueEntry& b) {
+    // Mirror balance_teams: the higher-MMR party lands on team 0
+    const QueueEntry& high = (b.avg_mmr > a.avg_mmr) ? b : a;
+    const QueueEntry& low = (&high == &a) ? b : a;
+
+    MatchResult result;
+    result.teams.resize(2);
+    result.teams[0] = high.player_ids;
+    result.teams[1] = low.player_ids;
+    result.party_ids = {high.party_id, low.party_id};
+    result.party_mmrs = {high.avg_mmr, low.avg_mmr};
+    result.party_enqueued_at = {high.enqueued_at, low.enqueued_at};
+    result.avg_mmr = (a.avg_mmr + b.avg_mmr) / 2;
+
+    int diff_a = a.avg_mmr - result.avg_mmr;
+    int diff_b = b.avg_mmr - result.avg_mmr;
+    result.mmr_variance = std::sqrt((diff_a * diff_a + diff_b * diff_b) / 2);
+    result.quality_score = quality_1v1(a.avg_mmr, b.avg_mmr);
+
+    return result;
+}
+
 int TeamBuilder::calculate_avg_mmr(const std::vector<const QueueEntry*>& entries) {
     if (entries.empty()) {
         return 0;
@@ -0,0 +1,102 @@
+#include "matchmaker/tenant_host.hpp"
+#include <algorithm>
+
+namespace matchmaker {
+
+TenantHost::Tenant::Tenant(const TenantConfig& tenant_config)
+    : config(tenant_config), queue_manager(tenant_config.queue) {
+    queue_manager.set_tick_budget(config.cpu_budget);
+}
+
+TenantHost::TenantHost(size_t threads) {
+    if (threads == 0) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    workers_.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+TenantHost::~TenantHost() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+QueueManager* TenantHost::add_tenant(const TenantConfig& config) {
+    if (config.name.empty() || by_name_.count(config.name) > 0) {
+        return nullptr;
+    }
+    by_name_.emplace(config.name, tenants_.size());
+    tenants_.push_back(std::make_unique<Tenant>(config));
+    return &tenants_.back()->queue_manager;
+}
+
+QueueManager* TenantHost::find(std::string_view name) {
+    auto it = by_name_.find(std::string(name));
+    return it == by_name_.end() ? nullptr : &tenants_[it->second]->queue_manager;
+}
+
+std::vector<TenantHost::TenantMatches> TenantHost::tick() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        next_.store(0, std::memory_order_relaxed);
+        busy_ = workers_.size();
+        generation_++;
+    }
+    start_cv_.notify_all();
+    run_tenants();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return busy_ == 0; });
+    }
+
+    std::vector<TenantMatches> results;
+    results.reserve(tenants_.size());
+    for (auto& tenant : tenants_) {
+        results.push_back({tenant->config.name, std::move(tenant->matches)});
+        tenant->matches.clear();
+    }
+    return results;
+}
+
+void TenantHost::worker_loop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        start_cv_.wait(lock, [this, seen] { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+            return;
+        }
+        seen = generation_;
+        lock.unlock();
+        run_tenants();
+        lock.lock();
+        if (--busy_ == 0) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+void TenantHost::run_tenants() {
+    for (size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < tenants_.size();
+         i = next_.fetch_add(1, std::memory_order_relaxed)) {
+        tick_tenant(*tenants_[i]);
+    }
+}
+
+void TenantHost::tick_tenant(Tenant& tenant) {
+    tenant.matches = tenant.queue_manager.tick();
+    tenant.stats.ticks++;
+    tenant.stats.matches += tenant.matches.size();
+    auto cpu = tenant.queue_manager.get_tick_budget_stats().last_tick_cpu;
+    tenant.stats.tick_cpu_seconds.observe(std::chrono::duration<double>(cpu).count());
+}
+
+} // namespace matchmaker
@@ -0,0 +1,483 @@
+#include "matchmaker/tracing.hpp"
+#include "matchmaker/match_serializer.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <charconv>
+#include <random>
+
+namespace matchmaker {
+
+namespace {
+
+int64_t to_ns(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+bool is_lower_hex(std::string_view s) {
+    return std::all_of(s.begin(), s.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+// Trace and span IDs only need to be unique, not unpredictable
+std::string random_hex(size_t bytes) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+
+    std::string out(bytes * 2, '0');
+    uint64_t bits = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        if (i % 8 == 0) {
+            bits = rng();
+        }
+        auto byte = static_cast<uint8_t>(bits >> ((i % 8) * 8));
+        out[i * 2] = kHex[byte >> 4];
+        out[i * 2 + 1] = kHex[byte & 0x0f];
+    }
+    return out;
+}
+
+// Accumulates the enclosing scope's wall time into the overhead window
+class OverheadTimer {
+public:
+    explicit OverheadTimer(int64_t& total)
+        : total_(total), start_(std::chrono::steady_clock::now()) {}
+    ~OverheadTimer() {
+        total_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    int64_t& total_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+void append_int(std::string& out, int64_t value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+void append_attribute(std::string& out, std::string_view key, std::string_view value) {
+    out += "{\"key\":";
+    append_json_string(out, key);
+    out += ",\"value\":{\"stringValue\":";
+    append_json_string(out, value);
+    out += "}}";
+}
+
+void append_attribute(std::string& out, std::string_view key, int64_t value) {
+    // OTLP/JSON encodes 64-bit integers as strings
+    out += "{\"key\":";
+    append_json_string(out, key);
+    out += ",\"value\":{\"intValue\":\"";
+    append_int(out, value);
+    out += "\"}}";
+}
+
+} // namespace
+
+TraceContext TraceContext::from_traceparent(std::string_view header) {
+    // version(2) - trace_id(32) - parent_id(16) - flags(2)
+    if (header.size() < 55 || header[2] != '-' || header[35] != '-' || header[52] != '-') {
+        return {};
+    }
+    auto version = header.substr(0, 2);
+    auto trace_id = header.substr(3, 32);
+    auto parent_id = header.substr(36, 16);
+    auto flags = header.substr(53, 2);
+    if (version == "ff" || !is_lower_hex(version) || !is_lower_hex(trace_id) ||
+        !is_lower_hex(parent_id) || !is_lower_hex(flags) ||
+        trace_id == std::string(32, '0') || parent_id == std::string(16, '0')) {
+        return {};
+    }
+
+    int flag_bits = 0;
+    std::from_chars(flags.data(), flags.data() + flags.size(), flag_bits, 16);
+
+    TraceContext context;
+    context.trace_id = std::string(trace_id);
+    context.parent_span_id = std::string(parent_id);
+    context.sampled = (flag_bits & 0x01) != 0;
+    return context;
+}
+
+const char* to_string(SkipReason reason) {
+    switch (reason) {
+        case SkipReason::InsufficientPlayers: return "insufficient_players";
+        case SkipReason::Band: return "band";
+        case SkipReason::Quality: return "quality";
+    }
+    return "unknown";
+}
+
+// ============================================================================
+// OtlpFileExporter
+// ============================================================================
+
+OtlpFileExporter::OtlpFileExporter(const std::string& path, std::string service_name)
+    : file_(std::fopen(path.c_str(), "ab")),
+      service_name_(std::move(service_name)) {
+    if (!file_) {
+        spdlog::error("Failed to open trace file {}", path);
+    }
+}
+
+OtlpFileExporter::~OtlpFileExporter() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+void OtlpFileExporter::export_spans(const std::vector<Span>& spans) {
+    if (!file_ || spans.empty()) {
+        return;
+    }
+    buffer_.clear();
+    write_request(buffer_, spans, service_name_);
+    buffer_ += '\n';
+    std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    std::fflush(file_);
+}
+
+void OtlpFileExporter::write_request(std::string& out, const std::vector<Span>& spans,
+                                     const std::string& service_name) {
+    out += "{\"resourceSpans\":[{\"resource\":{\"attributes\":[";
+    append_attribute(out, "service.name", service_name);
+    out += "]},\"scopeSpans\":[{\"scope\":{\"name\":\"matchmaker\"},\"spans\":[";
+
+    for (size_t i = 0; i < spans.size(); ++i) {
+        const Span& span = spans[i];
+        if (i > 0) {
+            out += ',';
+        }
+        out += "{\"traceId\":";
+        append_json_string(out, span.trace_id);
+        out += ",\"spanId\":";
+        append_json_string(out, span.span_id);
+        if (!span.parent_span_id.empty()) {
+            out += ",\"parentSpanId\":";
+            append_json_string(out, span.parent_span_id);
+        }
+        out += ",\"name\":";
+        append_json_string(out, span.name);
+        out += ",\"kind\":1,\"startTimeUnixNano\":\"";
+        append_int(out, span.start_ns);
+        out += "\",\"endTimeUnixNano\":\"";
+        append_int(out, span.end_ns);
+        out += "\",\"attributes\":[";
+
+        bool first = true;
+        for (const auto& [key, value] : span.attributes) {
+            if (!first) {
+                out += ',';
+            }
+            append_attribute(out, key, value);
+            first = false;
+        }
+        for (const auto& [key, value] : span.int_attributes) {
+            if (!first) {
+                out += ',';
+            }
+            append_attribute(out, key, value);
+            first = false;
+        }
+        out += "],\"status\":{\"code\":";
+        out += span.error ? '2' : '1';
+        out += "}}";
+    }
+
+    out += "]}]}]}";
+}
+
+// ============================================================================
+// Tracer
+// ============================================================================
+
+Tracer::Tracer(std::unique_ptr<SpanExporter> exporter, const TracerConfig& config)
+    : config_(config),
+      sample_rate_(config.initial_sample_rate),
+      exporter_(std::move(exporter)),
+      worker_([this] { run(); }) {}
+
+Tracer::~Tracer() {
+    submit_pending();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_cv_.wait(lock, [this] { return batches_.empty() && !busy_; });
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    worker_.join();
+}
+
+bool Tracer::should_sample(const std::string& trace_id) const {
+    if (sample_rate_ >= 1.0) {
+        return true;
+    }
+    // The low 56 bits of a W3C trace ID are random; compare them to the rate
+    uint64_t bits = 0;
+    std::from_chars(trace_id.data() + 18, trace_id.data() + 32, bits, 16);
+    return static_cast<double>(bits) < sample_rate_ * static_cast<double>(uint64_t{1} << 56);
+}
+
+void Tracer::on_enqueued(const QueueEntry& entry, const std::string& bucket_key, TimePoint now) {
+    if (entry.trace.valid() && !entry.trace.sampled) {
+        return;
+    }
+    if (parties_.size() >= config_.max_tracked_parties || parties_.count(entry.party_id) > 0) {
+        return;
+    }
+
+    OverheadTimer timer(window_overhead_ns_);
+    std::string trace_id = entry.trace.valid() ? entry.trace.trace_id : random_hex(16);
+    if (!should_sample(trace_id)) {
+        return;
+    }
+
+    PartyTrace trace;
+    trace.trace_id = std::move(trace_id);
+    trace.root_span_id = random_hex(8);
+    trace.parent_span_id = entry.trace.parent_span_id;
+    trace.bucket_key = bucket_key;
+    trace.enqueued_ns = to_ns(entry.enqueued_at);
+
+    Span& ingest = child_span(trace, "matchmaker.ingest", trace.enqueued_ns, to_ns(now));
+    ingest.int_attributes.emplace_back("party.size", entry.party_size);
+    ingest.int_attributes.emplace_back("party.mmr", entry.avg_mmr);
+
+    bucket_parties_[bucket_key].push_back(entry.party_id);
+    parties_.emplace(entry.party_id, std::move(trace));
+}
+
+bool Tracer::is_tracking(const std::string& bucket_key) const {
+    auto it = bucket_parties_.find(bucket_key);
+    return it != bucket_parties_.end() && !it->second.empty();
+}
+
+void Tracer::on_matched(const MatchResult& match) {
+    OverheadTimer timer(window_overhead_ns_);
+    int64_t formed_ns = to_ns(match.formed_at);
+    for (const auto& party_id : match.party_ids) {
+        auto it = parties_.find(party_id);
+        if (it == parties_.end()) {
+            continue;
+        }
+        PartyTrace& trace = it->second;
+        close_run(trace);
+
+        Span& span = child_span(trace, "matchmaker.match_formed", formed_ns, formed_ns);
+        span.attributes.emplace_back("match.id", match.match_id);
+        span.int_attributes.emplace_back("match.mmr_band", match.mmr_band);
+
+        trace.match_id = match.match_id;
+        untrack(party_id, trace.bucket_key);
+    }
+}
+
+void Tracer::on_quality_rejected(const std::vector<QueueEntry>& candidates) {
+    OverheadTimer timer(window_overhead_ns_);
+    for (const auto& entry : candidates) {
+        auto it = parties_.find(entry.party_id);
+        if (it != parties_.end()) {
+            it->second.quality_rejected = true;
+        }
+    }
+}
+
+void Tracer::on_evaluated(const std::string& bucket_key, SkipReason reason, TimePoint now) {
+    auto bucket_it = bucket_parties_.find(bucket_key);
+    if (bucket_it == bucket_parties_.end()) {
+        return;
+    }
+
+    OverheadTimer timer(window_overhead_ns_);
+    int64_t now_ns = to_ns(now);
+    for (const auto& party_id : bucket_it->second) {
+        PartyTrace& trace = parties_.at(party_id);
+        SkipReason party_reason = trace.quality_rejected ? SkipReason::Quality : reason;
+        trace.quality_rejected = false;
+
+        if (trace.evaluations > 0 && trace.run_reason != party_reason) {
+            close_run(trace);
+        }
+        if (trace.evaluations == 0) {
+            trace.run_reason = party_reason;
+            trace.run_start_ns = now_ns;
+        }
+        trace.run_end_ns = now_ns;
+        trace.evaluations++;
+    }
+}
+
+void Tracer::on_removed(const std::string& party_id, const char* outcome, TimePoint now) {
+    auto it = parties_.find(party_id);
+    if (it == parties_.end()) {
+        return;
+    }
+    OverheadTimer timer(window_overhead_ns_);
+    close_run(it->second);
+    untrack(party_id, it->second.bucket_key);
+    finish(party_id, it->second, to_ns(now), outcome, std::string_view(outcome) == "timeout");
+    parties_.erase(it);
+}
+
+void Tracer::on_published(const MatchResult& match, TimePoint start, TimePoint end) {
+    OverheadTimer timer(window_overhead_ns_);
+    int64_t start_ns = to_ns(start);
+    int64_t end_ns = to_ns(end);
+    for (const auto& party_id : match.party_ids) {
+        auto it = parties_.find(party_id);
+        if (it == parties_.end() || it->second.match_id != match.match_id) {
+            continue;
+        }
+        PartyTrace& trace = it->second;
+        Span& publish = child_span(trace, "matchmaker.publish", start_ns, end_ns);
+        publish.attributes.emplace_back("match.id", match.match_id);
+
+        finish(party_id, trace, end_ns, "matched", false);
+        parties_.erase(it);
+    }
+}
+
+void Tracer::on_tick_complete(std::chrono::nanoseconds tick_duration) {
+    window_tick_ns_ += tick_duration.count();
+    if (++window_ticks_ < config_.adjust_every_ticks) {
+        return;
+    }
+
+    // Publish and ingest hooks run outside tick(); their cost is charged to
+    // the same window so the budget covers all tracing work
+    double overhead = window_tick_ns_ > 0
+        ? static_cast<double>(window_overhead_ns_) / static_cast<double>(window_tick_ns_)
+        : 0.0;
+    if (overhead > config_.max_overhead) {
+        sample_rate_ = std::max(config_.min_sample_rate, sample_rate_ / 2);
+    } else if (overhead < config_.max_overhead / 4) {
+        sample_rate_ = std::min(config_.initial_sample_rate, sample_rate_ * 2);
+    }
+    window_ticks_ = 0;
+    window_tick_ns_ = 0;
+    window_overhead_ns_ = 0;
+
+    if (pending_.size() >= config_.batch_size) {
+        submit_pending();
+    }
+}
+
+void Tracer::flush() {
+    submit_pending();
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return batches_.empty() && !busy_; });
+}
+
+uint64_t Tracer::spans_exported() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return exported_;
+}
+
+uint64_t Tracer::spans_dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+void Tracer::close_run(PartyTrace& trace) {
+    if (trace.evaluations == 0) {
+        return;
+    }
+    Span& span = child_span(trace, "matchmaker.evaluate", trace.run_start_ns, trace.run_end_ns);
+    span.attributes.emplace_back("skip_reason", to_string(trace.run_reason));
+    span.int_attributes.emplace_back("evaluations", trace.evaluations);
+    trace.evaluations = 0;
+}
+
+void Tracer::finish(const std::string& party_id, PartyTrace& trace, int64_t end_ns,
+                    const char* outcome, bool error) {
+    Span root;
+    root.trace_id = trace.trace_id;
+    root.span_id = trace.root_span_id;
+    root.parent_span_id = trace.parent_span_id;
+    root.name = "matchmaker.time_to_match";
+    root.start_ns = trace.enqueued_ns;
+    root.end_ns = end_ns;
+    root.attributes.emplace_back("party.id", party_id);
+    root.attributes.emplace_back("queue.bucket", trace.bucket_key);
+    root.attributes.emplace_back("outcome", outcome);
+    if (!trace.match_id.empty()) {
+        root.attributes.emplace_back("match.id", trace.match_id);
+    }
+    root.int_attributes.emplace_back("wait_ms", (end_ns - trace.enqueued_ns) / 1'000'000);
+    root.error = error;
+    pending_.push_back(std::move(root));
+}
+
+Span& Tracer::child_span(const PartyTrace& trace, const char* name, int64_t start_ns, int64_t end_ns) {
+    Span& span = pending_.emplace_back();
+    span.trace_id = trace.trace_id;
+    span.span_id = random_hex(8);
+    span.parent_span_id = trace.root_span_id;
+    span.name = name;
+    span.start_ns = start_ns;
+    span.end_ns = end_ns;
+    return span;
+}
+
+void Tracer::untrack(const std::string& party_id, const std::string& bucket_key) {
+    auto it = bucket_parties_.find(bucket_key);
+    if (it == bucket_parties_.end()) {
+        return;
+    }
+    auto& ids = it->second;
+    auto pos = std::find(ids.begin(), ids.end(), party_id);
+    if (pos != ids.end()) {
+        *pos = std::move(ids.back());
+        ids.pop_back();
+    }
+    if (ids.empty()) {
+        bucket_parties_.erase(it);
+    }
+}
+
+void Tracer::submit_pending() {
+    if (pending_.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (batches_.size() >= config_.max_pending_batches) {
+            dropped_ += pending_.size();
+            pending_.clear();
+            return;
+        }
+        batches_.push_back(std::move(pending_));
+    }
+    pending_ = {};
+    work_cv_.notify_one();
+}
+
+void Tracer::run() {
+    while (true) {
+        std::vector<Span> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this] { return stopping_ || !batches_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            batch = std::move(batches_.front());
+            batches_.pop_front();
+            busy_ = true;
+        }
+
+        exporter_->export_spans(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            exported_ += batch.size();
+            busy_ = false;
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+} // namespace matchmaker
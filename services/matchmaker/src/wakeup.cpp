@@ -0,0 +1,73 @@
+#include "matchmaker/wakeup.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <poll.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#else
+#include <fcntl.h>
+#endif
+
+namespace matchmaker {
+
+Wakeup::Wakeup() {
+#ifdef __linux__
+    read_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    write_fd_ = read_fd_;
+#else
+    int fds[2];
+    if (pipe(fds) == 0) {
+        for (int fd : fds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        read_fd_ = fds[0];
+        write_fd_ = fds[1];
+    }
+#endif
+}
+
+Wakeup::~Wakeup() {
+    if (read_fd_ >= 0) {
+        close(read_fd_);
+    }
+    if (write_fd_ >= 0 && write_fd_ != read_fd_) {
+        close(write_fd_);
+    }
+}
+
+void Wakeup::notify() {
+    // A full pipe or saturated counter already means "woken"
+    uint64_t one = 1;
+    ssize_t written = write(write_fd_, &one, write_fd_ == read_fd_ ? sizeof(one) : 1);
+    (void)written;
+}
+
+bool Wakeup::wait_for(std::chrono::nanoseconds timeout) {
+    if (read_fd_ < 0) {
+        return false;
+    }
+
+    // poll() takes milliseconds; round up so a deadline is never missed early
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(std::max(timeout, std::chrono::nanoseconds(0)));
+    pollfd pfd{read_fd_, POLLIN, 0};
+    int ready;
+    do {
+        ready = poll(&pfd, 1, static_cast<int>(std::min<int64_t>(ms.count(), INT32_MAX)));
+    } while (ready < 0 && errno == EINTR);
+    if (ready <= 0) {
+        return false;
+    }
+
+    // Drain every pending notification
+    uint64_t buffer[8];
+    while (read(read_fd_, buffer, sizeof(buffer)) > 0) {
+    }
+    return true;
+}
+
+} // namespace matchmaker
@@ -1,9 +1,44 @@
 #include <gtest/gtest.h>
 #include "matchmaker/queue_manager.hpp"
+#include "matchmaker/bulk_assignment.hpp"
 #include "matchmaker/team_builder.hpp"
+#include "matchmaker/compatibility_graph.hpp"
+#include "matchmaker/matching_strategy.hpp"
+#include "matchmaker/match_exporter.hpp"
+#include "matchmaker/match_serializer.hpp"
+#include "matchmaker/nats_client.hpp"
+#include "matchmaker/binary_log.hpp"
+#include "matchmaker/tracing.hpp"
+#include "matchmaker/probes.hpp"
+#include "matchmaker/metrics.hpp"
+#include "matchmaker/policy.hpp"
+#include "matchmaker/queue_events.hpp"
+#include "matchmaker/queue_store.hpp"
+#include "matchmaker/redis_client.hpp"
+#include "matchmaker/jetstream.hpp"
+#include "matchmaker/tenant_host.hpp"
+#include "matchmaker/wakeup.hpp"
 
+#include <nlohmann/json.hpp>
+
+#if MATCHMAKER_USDT
+#include <elf.h>
+#endif
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
 #include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace matchmaker;
@@ -30,6 +65,16 @@ QueueEntry make_entry(const std::string& party_id,
     return e;
 }
 
+std::vector<TeamBuilder::SoloCandidate> to_candidates(const std::vector<QueueEntry>& entries,
+                                                      const std::vector<int>& bands) {
+    std::vector<TeamBuilder::SoloCandidate> candidates;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        candidates.push_back({entries[i].avg_mmr, bands[i],
+                              entries[i].enqueued_at.time_since_epoch().count()});
+    }
+    return candidates;
+}
+
 }  // namespace
 
 TEST(QueueManagerTest, EnqueueAndIsQueued) {
@@ -98,3 +143,1767 @@ TEST(TeamBuilderTest, RespectsMmrTolerance) {
     auto match = TeamBuilder::try_form_match(entries, 1, 2, /*mmr_tolerance=*/100);
     EXPECT_FALSE(match.has_value());
 }
+
+TEST(TeamBuilderTest, PairsAdjacentOneVOneEntries) {
+    std::vector<QueueEntry> entries = {
+        make_entry("p1", "us-east", "ranked", 1, 1000),
+        make_entry("p2", "us-east", "ranked", 1, 1020),
+        make_entry("p3", "us-east", "ranked", 1, 1500),
+        make_entry("p4", "us-east", "ranked", 1, 1510),
+    };
+    std::vector<int> bands(entries.size(), 100);
+
+    auto pairs = TeamBuilder::pair_adjacent_1v1(to_candidates(entries, bands), 0.6);
+    ASSERT_EQ(pairs.size(), 2u);
+    EXPECT_EQ(pairs[0], std::make_pair(size_t{0}, size_t{1}));
+    EXPECT_EQ(pairs[1], std::make_pair(size_t{2}, size_t{3}));
+}
+
+TEST(TeamBuilderTest, OneVOneRespectsNarrowerBand) {
+    std::vector<QueueEntry> entries = {
+        make_entry("p1", "us-east", "ranked", 1, 1000),
+        make_entry("p2", "us-east", "ranked", 1, 1150),
+    };
+
+    // p1 has widened to 200 but p2 is still at 100
+    auto pairs = TeamBuilder::pair_adjacent_1v1(to_candidates(entries, {200, 100}), 0.0);
+    EXPECT_TRUE(pairs.empty());
+}
+
+TEST(TeamBuilderTest, OneVOnePrefersLongerWaitingNeighbour) {
+    std::vector<QueueEntry> entries = {
+        make_entry("p1", "us-east", "ranked", 1, 1000),
+        make_entry("p2", "us-east", "ranked", 1, 1010),
+        make_entry("p3", "us-east", "ranked", 1, 1040),
+    };
+    entries[2].enqueued_at -= std::chrono::seconds(30);
+    std::vector<int> bands(entries.size(), 100);
+
+    auto pairs = TeamBuilder::pair_adjacent_1v1(to_candidates(entries, bands), 0.6);
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0], std::make_pair(size_t{1}, size_t{2}));
+}
+
+TEST(TeamBuilderTest, OneVOnePassesOverUnpairableAndNarrowNeighbours) {
+    // A party of 2 between two compatible solos gets band -1 from the sweep
+    std::vector<QueueEntry> entries = {
+        make_entry("p1", "us-east", "ranked", 1, 1000),
+        make_entry("duo", "us-east", "ranked", 1, 1010, 2),
+        make_entry("p2", "us-east", "ranked", 1, 1020),
+    };
+    auto pairs = TeamBuilder::pair_adjacent_1v1(to_candidates(entries, {100, -1, 100}), 0.6);
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0], std::make_pair(size_t{0}, size_t{2}));
+
+    // A solo whose band has not widened yet sits between two that reach each other
+    pairs = TeamBuilder::pair_adjacent_1v1(to_candidates(entries, {100, 0, 100}), 0.6);
+    ASSERT_EQ(pairs.size(), 1u);
+    EXPECT_EQ(pairs[0], std::make_pair(size_t{0}, size_t{2}));
+}
+
+TEST(QueueManagerTest, PartiesLargerThanATeamAreRejected) {
+    QueueManager qm;
+    EnqueueRejection reason{};
+    EXPECT_FALSE(qm.enqueue(make_entry("duo", "us-east", "ranked", 1, 1010, 2), &reason));
+    EXPECT_EQ(reason, EnqueueRejection::PartySize);
+    EXPECT_EQ(qm.get_bucket_lifecycle_stats().rejected_party_size, 1u);
+
+    qm.enqueue(make_entry("p1", "us-east", "ranked", 1, 1000));
+    qm.enqueue(make_entry("p2", "us-east", "ranked", 1, 1020));
+    EXPECT_EQ(qm.tick().size(), 1u);
+}
+
+TEST(TeamBuilderTest, OneVOneMatchAgreesWithGeneralPath) {
+    std::vector<QueueEntry> entries = {
+        make_entry("p1", "us-east", "ranked", 1, 1480),
+        make_entry("p2", "us-east", "ranked", 1, 1530),
+    };
+
+    auto general = TeamBuilder::try_form_match(entries, 1, 2, 100);
+    ASSERT_TRUE(general.has_value());
+    auto fast = TeamBuilder::build_1v1_match(entries[0], entries[1]);
+
+    EXPECT_EQ(fast.teams, general->teams);
+    EXPECT_EQ(fast.party_ids, general->party_ids);
+    EXPECT_EQ(fast.avg_mmr, general->avg_mmr);
+    EXPECT_EQ(fast.mmr_variance, general->mmr_variance);
+    EXPECT_DOUBLE_EQ(fast.quality_score, general->quality_score);
+}
+
+TEST(QueueManagerTest, OneVOneTickMatchesAndDequeues) {
+    QueueManager qm;
+    qm.enqueue(make_entry("p1", "us-east", "ranked", 1, 1500));
+    qm.enqueue(make_entry("p2", "us-east", "ranked", 1, 2400));
+    qm.enqueue(make_entry("p3", "us-east", "ranked", 1, 1520));
+
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].region, "us-east");
+    EXPECT_EQ(matches[0].team_size, 1);
+    EXPECT_FALSE(qm.is_queued("p1"));
+    EXPECT_FALSE(qm.is_queued("p3"));
+    EXPECT_TRUE(qm.is_queued("p2"));
+    EXPECT_EQ(qm.get_queue_size(), 1u);
+}
+
+TEST(QueueManagerTest, RequeueReplacesTheQueuedEntry) {
+    QueueManager qm;
+    qm.enqueue(make_entry("p1", "us-east", "ranked", 1, 1500));
+    qm.enqueue(make_entry("p1", "us-east", "ranked", 1, 1500));   // Redelivered
+    EXPECT_EQ(qm.get_queue_size(), 1u);
+    EXPECT_TRUE(qm.tick().empty());
+
+    // A retry into another bucket moves the party
+    qm.enqueue(make_entry("p1", "us-east", "ranked", 2, 1500));
+    EXPECT_EQ(qm.get_queue_size(QueueBucket{"us-east", "ranked", 1}), 0u);
+    EXPECT_EQ(qm.get_queue_size(QueueBucket{"us-east", "ranked", 2}), 1u);
+
+    qm.enqueue(make_entry("p2", "us-east", "ranked", 1, 1510));
+    qm.enqueue(make_entry("p3", "us-east", "ranked", 1, 1520));
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_NE(matches[0].party_ids[0], matches[0].party_ids[1]);
+    EXPECT_TRUE(qm.is_queued("p1"));
+}
+
+TEST(CompatibilityGraphTest, ClustersOnlyMutuallyInBandParties) {
+    CompatibilityGraph graph;
+    auto now = std::chrono::system_clock::now();
+    graph.add(make_entry("a", "us-east", "ranked", 2, 1500), now);
+    graph.add(make_entry("b", "us-east", "ranked", 2, 1550), now);
+    graph.add(make_entry("c", "us-east", "ranked", 2, 1640), now);
+    graph.add(make_entry("d", "us-east", "ranked", 2, 2500), now);
+
+    // a-b-c chain within the initial ±100 band, d isolated
+    EXPECT_EQ(graph.cluster_count(), 2u);
+    auto clusters = graph.take_viable_clusters(3);
+    ASSERT_EQ(clusters.size(), 1u);
+    EXPECT_EQ(clusters[0].size(), 3u);
+
+    // Nothing changed since the last take
+    EXPECT_TRUE(graph.take_viable_clusters(3).empty());
+}
+
+TEST(CompatibilityGraphTest, WideningBandsAddEdges) {
+    CompatibilityGraph graph;
+    auto now = std::chrono::system_clock::now();
+    auto a = make_entry("a", "us-east", "ranked", 2, 1500);
+    auto b = make_entry("b", "us-east", "ranked", 2, 1650);
+    a.enqueued_at = now;
+    b.enqueued_at = now;
+    graph.add(a, now);
+    graph.add(b, now);
+    EXPECT_EQ(graph.cluster_count(), 2u);
+
+    // 100 + 5s * 10 = 150 covers the gap for both parties
+    graph.advance(now + std::chrono::seconds(5));
+    EXPECT_EQ(graph.cluster_count(), 1u);
+    EXPECT_EQ(graph.take_viable_clusters(2).size(), 1u);
+}
+
+TEST(CompatibilityGraphTest, RemovalSplitsStaleCluster) {
+    CompatibilityGraph graph;
+    auto now = std::chrono::system_clock::now();
+    graph.add(make_entry("a", "us-east", "ranked", 2, 1400), now);
+    graph.add(make_entry("bridge", "us-east", "ranked", 2, 1490), now);
+    graph.add(make_entry("c", "us-east", "ranked", 2, 1580), now);
+    graph.add(make_entry("d", "us-east", "ranked", 2, 1590), now);
+    graph.take_viable_clusters(1);
+
+    graph.remove("bridge");
+    auto clusters = graph.take_viable_clusters(2);
+    ASSERT_EQ(clusters.size(), 1u);
+    EXPECT_EQ(clusters[0].size(), 2u);
+    EXPECT_FALSE(graph.contains("bridge"));
+    EXPECT_EQ(graph.size(), 3u);
+}
+
+TEST(QueueManagerTest, OutOfBandPartyDoesNotBlockCluster) {
+    QueueManager qm;
+    auto outlier = make_entry("outlier", "us-east", "ranked", 2, 3000);
+    outlier.enqueued_at -= std::chrono::seconds(5);  // Longest waiting
+    qm.enqueue(outlier);
+    qm.enqueue(make_entry("p1", "us-east", "ranked", 2, 1500));
+    qm.enqueue(make_entry("p2", "us-east", "ranked", 2, 1510));
+    qm.enqueue(make_entry("p3", "us-east", "ranked", 2, 1520));
+    qm.enqueue(make_entry("p4", "us-east", "ranked", 2, 1530));
+
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].party_ids.size(), 4u);
+    EXPECT_TRUE(qm.is_queued("outlier"));
+    EXPECT_EQ(qm.get_queue_size(), 1u);
+
+    // A formed cluster is not re-evaluated until something changes
+    EXPECT_TRUE(qm.tick().empty());
+}
+
+TEST(QueueManagerTest, TeamBucketRemovalsKeepEntriesFindable) {
+    QueueConfig config;
+    config.max_wait_time_sec = 10;
+    QueueManager qm(config);
+    auto stale = make_entry("stale", "us-east", "ranked", 2, 1500);
+    stale.enqueued_at -= std::chrono::seconds(30);
+    qm.enqueue(stale);
+    for (int i = 0; i < 6; ++i) {
+        qm.enqueue(make_entry("p" + std::to_string(i), "us-east", "ranked", 2, 1500 + i));
+    }
+    qm.dequeue("p1");
+    qm.enqueue(make_entry("far", "us-east", "ranked", 2, 3000));
+
+    // Timeout and dequeue moved other entries into the freed slots
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_FALSE(qm.is_queued("stale"));
+    EXPECT_EQ(qm.get_queue_size(), 2u);
+    for (const auto& party_id : matches[0].party_ids) {
+        EXPECT_FALSE(qm.is_queued(party_id));
+        EXPECT_NE(party_id, "far");
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        qm.enqueue(make_entry("late-" + std::to_string(i), "us-east", "ranked", 2, 1504));
+    }
+    matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(qm.get_queue_size(), 1u);
+    EXPECT_TRUE(qm.is_queued("far"));
+}
+
+TEST(QueueManagerTest, TimedOutPartiesLeaveLookup) {
+    QueueConfig config;
+    config.max_wait_time_sec = 10;
+    QueueManager qm(config);
+    auto stale = make_entry("stale", "us-east", "ranked", 2, 1500);
+    stale.enqueued_at -= std::chrono::seconds(30);
+    qm.enqueue(stale);
+
+    qm.tick();
+    EXPECT_FALSE(qm.is_queued("stale"));
+    EXPECT_EQ(qm.get_queue_size(), 0u);
+}
+
+namespace {
+
+// Pairs the two longest-waiting parties regardless of MMR
+class OldestPairStrategy : public MatchingStrategy {
+public:
+    std::string name() const override { return "oldest_pair"; }
+
+    std::vector<MatchResult> form_matches(const QueueBucket& /*bucket*/,
+                                          std::vector<QueueEntry>& entries,
+                                          const QueueConfig& /*config*/,
+                                          std::chrono::system_clock::time_point /*now*/) const override {
+        std::sort(entries.begin(), entries.end(), [](const QueueEntry& a, const QueueEntry& b) {
+            return a.enqueued_at < b.enqueued_at;
+        });
+        MatchResult match;
+        match.teams = {entries[0].player_ids, entries[1].player_ids};
+        match.party_ids = {entries[0].party_id, entries[1].party_id};
+        match.avg_mmr = (entries[0].avg_mmr + entries[1].avg_mmr) / 2;
+        match.mmr_variance = 0;
+        match.quality_score = 0.1;
+        return {match};
+    }
+};
+
+}  // namespace
+
+TEST(MatchingStrategyTest, LiveStrategyOverridesBuiltIn) {
+    QueueManager qm;
+    QueueBucket bucket{"us-east", "ranked", 1};
+    qm.set_strategy(bucket, std::make_shared<OldestPairStrategy>());
+
+    auto old = make_entry("old", "us-east", "ranked", 1, 1000);
+    old.enqueued_at -= std::chrono::seconds(10);
+    qm.enqueue(old);
+    qm.enqueue(make_entry("far", "us-east", "ranked", 1, 2500));
+
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].region, "us-east");
+    EXPECT_FALSE(matches[0].match_id.empty());
+    EXPECT_FALSE(qm.is_queued("old"));
+    EXPECT_EQ(qm.get_queue_size(), 0u);
+}
+
+TEST(MatchingStrategyTest, ShadowStrategyIsComparedButNotPublished) {
+    QueueManager qm;
+    QueueBucket bucket{"us-east", "ranked", 1};
+    qm.set_shadow_strategy(bucket, std::make_shared<OldestPairStrategy>());
+
+    qm.enqueue(make_entry("a", "us-east", "ranked", 1, 1000));
+    qm.enqueue(make_entry("b", "us-east", "ranked", 1, 2500));
+
+    // The live 1v1 path finds nothing in band; the shadow pairs anyway
+    EXPECT_TRUE(qm.tick().empty());
+    EXPECT_EQ(qm.get_queue_size(), 2u);
+    qm.flush_shadow_evaluations();
+
+    auto comparisons = qm.get_shadow_comparisons();
+    ASSERT_EQ(comparisons.count(bucket.key()), 1u);
+    const auto& comparison = comparisons.at(bucket.key());
+    EXPECT_EQ(comparison.live_strategy, "adjacent_1v1");
+    EXPECT_EQ(comparison.shadow_strategy, "oldest_pair");
+    EXPECT_EQ(comparison.live.ticks, 1u);
+    EXPECT_EQ(comparison.live.matches, 0u);
+    EXPECT_EQ(comparison.shadow.matches, 1u);
+    EXPECT_EQ(comparison.shadow.parties_matched, 2u);
+
+    // The shadow is not credited again for parties it already matched
+    qm.enqueue(make_entry("c", "us-east", "ranked", 1, 4000));
+    qm.tick();
+    qm.flush_shadow_evaluations();
+    comparisons = qm.get_shadow_comparisons();
+    EXPECT_EQ(comparisons.at(bucket.key()).live.ticks, 2u);
+    EXPECT_EQ(comparisons.at(bucket.key()).shadow.matches, 1u);
+}
+
+TEST(MatchingStrategyTest, WaitOrderStrategyMatchesOriginalAlgorithm) {
+    std::vector<QueueEntry> entries = {
+        make_entry("p1", "us-east", "ranked", 2, 1500),
+        make_entry("p2", "us-east", "ranked", 2, 1510),
+        make_entry("p3", "us-east", "ranked", 2, 1490),
+        make_entry("p4", "us-east", "ranked", 2, 1505),
+    };
+
+    WaitOrderStrategy strategy;
+    auto matches = strategy.form_matches(QueueBucket{"us-east", "ranked", 2}, entries,
+                                         QueueConfig{}, std::chrono::system_clock::now());
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].party_ids.size(), 4u);
+    EXPECT_EQ(entries.size(), 4u);
+}
+
+TEST(MatchExporterTest, WritesRowGroupsAndRotates) {
+    auto dir = std::filesystem::temp_directory_path() / "matchmaker_export_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    MatchExportConfig config;
+    config.directory = dir.string();
+    config.rows_per_group = 4;
+
+    {
+        MatchExporter exporter(config);
+        std::vector<QueueEntry> entries = {
+            make_entry("p1", "us-east", "ranked", 1, 1480),
+            make_entry("p2", "us-east", "ranked", 1, 1530),
+        };
+        auto match = TeamBuilder::build_1v1_match(entries[0], entries[1]);
+        match.match_id = "m1";
+        match.formed_at = entries[0].enqueued_at + std::chrono::seconds(3);
+
+        exporter.append(match);
+        exporter.append(match);  // Fills a 4-row group
+        exporter.append(match);
+        EXPECT_EQ(exporter.rows_written(), 4u);
+
+        exporter.rotate();
+        EXPECT_EQ(exporter.rows_written(), 6u);
+        EXPECT_EQ(exporter.files_completed(), 1u);
+    }
+
+    std::vector<std::filesystem::path> files;
+    for (const auto& file : std::filesystem::directory_iterator(dir)) {
+        files.push_back(file.path());
+    }
+    ASSERT_EQ(files.size(), 1u);
+    EXPECT_EQ(files[0].extension(), ".mmcol");
+
+    std::ifstream in(files[0], std::ios::binary);
+    std::string blob((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ASSERT_GT(blob.size(), 28u);
+    EXPECT_EQ(blob.substr(0, 8), "MMCOL001");
+    EXPECT_EQ(blob.substr(blob.size() - 8), "MMCOLEND");
+
+    uint32_t row_groups = 0;
+    uint64_t rows = 0;
+    std::memcpy(&row_groups, blob.data() + blob.size() - 20, sizeof(row_groups));
+    std::memcpy(&rows, blob.data() + blob.size() - 16, sizeof(rows));
+    EXPECT_EQ(row_groups, 2u);
+    EXPECT_EQ(rows, 6u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(MatchSerializerTest, RoundTripsConsumerSchema) {
+    MatchResult match;
+    match.match_id = "3f2b8c1e-7d4a-4e9b-a1c6-0d5e8f7a9b21";
+    match.region = "us-west";
+    match.mode = "ranked";
+    match.team_size = 2;
+    match.teams = {{"p1", "p2"}, {"p3", "p4"}};
+    match.party_ids = {"party1", "party2", "party3"};
+    match.avg_mmr = 1520;
+    match.mmr_variance = 45;
+    match.quality_score = 0.87;
+
+    // Fields and types read by services/api/consumers/match_consumer.py
+    nlohmann::json expected = {
+        {"match_id", match.match_id},
+        {"region", "us-west"},
+        {"mode", "ranked"},
+        {"team_size", 2},
+        {"teams", nlohmann::json::array({{"p1", "p2"}, {"p3", "p4"}})},
+        {"party_ids", {"party1", "party2", "party3"}},
+        {"avg_mmr", 1520},
+        {"mmr_variance", 45},
+        {"quality_score", 0.87},
+    };
+
+    auto parsed = nlohmann::json::parse(serialize_match_found(match));
+    EXPECT_EQ(parsed, expected);
+    EXPECT_DOUBLE_EQ(parsed["quality_score"].get<double>(), 0.87);
+}
+
+TEST(MatchSerializerTest, EscapesLikeNlohmann) {
+    // Long enough to cross 16-byte chunks with escapes at varied offsets
+    std::string tricky = "plain-ascii-prefix-0123456789\"quoted\"\\back\\slash\n\t\r\b\f";
+    tricky += std::string(1, '\x01');
+    tricky += "ütf8-passthrough-\x1f-end";
+
+    std::string out;
+    append_json_string(out, tricky);
+    EXPECT_EQ(out, nlohmann::json(tricky).dump());
+    EXPECT_EQ(nlohmann::json::parse(out).get<std::string>(), tricky);
+}
+
+TEST(MatchSerializerTest, MockPublishSerializesPayload) {
+    MockNatsClient nats;
+    MatchResult match;
+    match.match_id = "m\"1";
+    match.teams = {{"a"}, {"b"}};
+    match.party_ids = {"a", "b"};
+    match.team_size = 1;
+    match.avg_mmr = 1500;
+    match.mmr_variance = 0;
+    match.quality_score = 1.0;
+
+    nats.publish_match_found(match);
+    auto parsed = nlohmann::json::parse(nats.get_last_payload());
+    EXPECT_EQ(parsed["match_id"], "m\"1");
+    EXPECT_EQ(parsed["teams"].size(), 2u);
+}
+
+TEST(BinaryLoggerTest, WritesFixedRecordsAndFormatsOffline) {
+    auto path = std::filesystem::temp_directory_path() / "matchmaker_binlog_test.mmblog";
+
+    {
+        BinaryLogger::Config config;
+        config.path = path.string();
+        config.ring_capacity = 4;
+        config.mirror_to_spdlog = false;
+        BinaryLogger logger(config);
+
+        EXPECT_TRUE(logger.log(LogEvent::MatchFormed, std::string("m1"), "us-east", "ranked", 1500, 0.875));
+        logger.flush();
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::string blob((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ASSERT_GT(blob.size(), sizeof(BinaryLogRecord));
+    EXPECT_EQ(blob.substr(0, 8), "MMBLOG01");
+
+    BinaryLogRecord record;
+    std::memcpy(&record, blob.data() + blob.size() - sizeof(record), sizeof(record));
+    EXPECT_EQ(record.event, static_cast<uint16_t>(LogEvent::MatchFormed));
+    EXPECT_EQ(record.arg_count, 5);
+    EXPECT_EQ(BinaryLogger::format(record),
+              "Match formed: id=m1, region=us-east, mode=ranked, mmr=1500, quality=0.88");
+
+    std::filesystem::remove(path);
+}
+
+TEST(BinaryLoggerTest, DropsWhenRingIsFull) {
+    BinaryLogger::Config config;
+    config.ring_capacity = 2;
+    config.mirror_to_spdlog = false;
+    BinaryLogger logger(config);
+
+    std::string long_id(300, 'x');
+    size_t accepted = 0;
+    for (int i = 0; i < 1000; ++i) {
+        accepted += logger.log(LogEvent::QueueEvent, long_id, "eu-west", "casual", i) ? 1 : 0;
+    }
+    logger.flush();
+    EXPECT_EQ(accepted + logger.dropped(), 1000u);
+    EXPECT_GT(logger.dropped(), 0u);
+}
+
+namespace {
+
+class CapturingExporter : public SpanExporter {
+public:
+    explicit CapturingExporter(std::vector<Span>& out) : out_(out) {}
+    void export_spans(const std::vector<Span>& spans) override {
+        out_.insert(out_.end(), spans.begin(), spans.end());
+    }
+
+private:
+    std::vector<Span>& out_;
+};
+
+const Span* find_span(const std::vector<Span>& spans, const std::string& name) {
+    auto it = std::find_if(spans.begin(), spans.end(), [&](const Span& s) { return s.name == name; });
+    return it == spans.end() ? nullptr : &*it;
+}
+
+std::string attribute(const Span& span, const std::string& key) {
+    for (const auto& [k, v] : span.attributes) {
+        if (k == key) return v;
+    }
+    for (const auto& [k, v] : span.int_attributes) {
+        if (k == key) return std::to_string(v);
+    }
+    return "";
+}
+
+}  // namespace
+
+TEST(TracingTest, ParsesTraceparent) {
+    auto ctx = TraceContext::from_traceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+    ASSERT_TRUE(ctx.valid());
+    EXPECT_EQ(ctx.trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+    EXPECT_EQ(ctx.parent_span_id, "00f067aa0ba902b7");
+    EXPECT_TRUE(ctx.sampled);
+
+    EXPECT_FALSE(TraceContext::from_traceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00").sampled);
+    EXPECT_FALSE(TraceContext::from_traceparent("00-00000000000000000000000000000000-00f067aa0ba902b7-01").valid());
+    EXPECT_FALSE(TraceContext::from_traceparent("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01").valid());
+    EXPECT_FALSE(TraceContext::from_traceparent("garbage").valid());
+}
+
+TEST(TracingTest, RecordsTimeToMatchSpans) {
+    std::vector<Span> spans;
+    Tracer tracer(std::make_unique<CapturingExporter>(spans));
+    QueueManager qm;
+    qm.set_tracer(&tracer);
+
+    auto a = make_entry("a", "us-east", "ranked", 1, 1500);
+    a.trace = TraceContext::from_traceparent("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01");
+    auto unsampled = make_entry("u", "eu-west", "ranked", 1, 1500);
+    unsampled.trace = TraceContext::from_traceparent("00-5bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00");
+
+    qm.enqueue(a);
+    qm.enqueue(unsampled);
+    EXPECT_EQ(tracer.tracked_parties(), 1u);
+
+    // Alone in the bucket for two ticks
+    qm.tick();
+    qm.tick();
+
+    qm.enqueue(make_entry("b", "us-east", "ranked", 1, 1510));
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    auto now = std::chrono::system_clock::now();
+    tracer.on_published(matches[0], now, now);
+    tracer.flush();
+
+    EXPECT_EQ(tracer.tracked_parties(), 0u);
+    const Span* root = nullptr;
+    for (const auto& span : spans) {
+        if (span.name == "matchmaker.time_to_match" && attribute(span, "party.id") == "a") {
+            root = &span;
+        }
+    }
+    ASSERT_NE(root, nullptr);
+    EXPECT_EQ(root->trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+    EXPECT_EQ(root->parent_span_id, "00f067aa0ba902b7");
+    EXPECT_EQ(attribute(*root, "outcome"), "matched");
+    EXPECT_EQ(attribute(*root, "match.id"), matches[0].match_id);
+
+    const Span* evaluate = find_span(spans, "matchmaker.evaluate");
+    ASSERT_NE(evaluate, nullptr);
+    EXPECT_EQ(evaluate->parent_span_id, root->span_id);
+    EXPECT_EQ(attribute(*evaluate, "skip_reason"), "insufficient_players");
+    EXPECT_EQ(attribute(*evaluate, "evaluations"), "2");
+    EXPECT_NE(find_span(spans, "matchmaker.ingest"), nullptr);
+    EXPECT_NE(find_span(spans, "matchmaker.publish"), nullptr);
+
+    std::string request;
+    OtlpFileExporter::write_request(request, spans, "matchmaker");
+    auto parsed = nlohmann::json::parse(request);
+    EXPECT_EQ(parsed["resourceSpans"][0]["scopeSpans"][0]["spans"].size(), spans.size());
+}
+
+TEST(TracingTest, QueueEventTraceparentParentsTheTimeToMatchSpan) {
+    std::vector<Span> spans;
+    Tracer tracer(std::make_unique<CapturingExporter>(spans));
+    QueueManager qm;
+    qm.set_tracer(&tracer);
+    MockNatsClient nats;
+    nats.subscribe_queue_events("matchmaker.queue.>", [&qm](const QueueEvent& event) { qm.enqueue(event.entry); });
+
+    // Raw events as the API publishes them, one carrying its request's span
+    auto event_json = [](const std::string& party_id, const std::string& traceparent) {
+        std::string timestamp;
+        append_iso8601(timestamp, std::chrono::system_clock::now() - std::chrono::seconds(2));
+        std::string json = R"({"event_type": "queue_enter", "party_id": ")" + party_id +
+            R"(", "mode": "ranked", "team_size": 1, "avg_mmr": 1500, "region": "us-east", )"
+            R"("party_size": 1, "timestamp": ")" + timestamp + "\"";
+        if (!traceparent.empty()) {
+            json += R"(, "traceparent": ")" + traceparent + "\"";
+        }
+        return json + "}";
+    };
+    ASSERT_TRUE(nats.simulate_queue_message("matchmaker.queue.ranked.us-east",
+        event_json("a", "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01")));
+    ASSERT_TRUE(nats.simulate_queue_message("matchmaker.queue.ranked.us-east", event_json("b", "")));
+    EXPECT_FALSE(nats.simulate_queue_message("matchmaker.queue.ranked.us-east", "{}"));
+
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    auto now = std::chrono::system_clock::now();
+    tracer.on_published(matches[0], now, now);
+    tracer.flush();
+
+    const Span* root = nullptr;
+    for (const auto& span : spans) {
+        if (span.name == "matchmaker.time_to_match" && attribute(span, "party.id") == "a") {
+            root = &span;
+        }
+    }
+    ASSERT_NE(root, nullptr);
+    EXPECT_EQ(root->trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+    EXPECT_EQ(root->parent_span_id, "00f067aa0ba902b7");
+
+    // The ingest span starts at the API's timestamp, not at enqueue
+    const Span* ingest = nullptr;
+    for (const auto& span : spans) {
+        if (span.name == "matchmaker.ingest" && span.parent_span_id == root->span_id) {
+            ingest = &span;
+        }
+    }
+    ASSERT_NE(ingest, nullptr);
+    EXPECT_GE(ingest->end_ns - ingest->start_ns, 1'900'000'000);
+
+    qm.set_tracer(nullptr);
+}
+
+TEST(TracingTest, DequeueEndsTraceAndBandSkipsAreReported) {
+    std::vector<Span> spans;
+    Tracer tracer(std::make_unique<CapturingExporter>(spans));
+    QueueManager qm;
+    qm.set_tracer(&tracer);
+
+    qm.enqueue(make_entry("low", "us-east", "ranked", 1, 1000));
+    qm.enqueue(make_entry("high", "us-east", "ranked", 1, 2500));
+    EXPECT_EQ(tracer.tracked_parties(), 2u);
+
+    EXPECT_TRUE(qm.tick().empty());
+    qm.dequeue("low");
+    tracer.flush();
+
+    const Span* evaluate = find_span(spans, "matchmaker.evaluate");
+    ASSERT_NE(evaluate, nullptr);
+    EXPECT_EQ(attribute(*evaluate, "skip_reason"), "band");
+    const Span* root = find_span(spans, "matchmaker.time_to_match");
+    ASSERT_NE(root, nullptr);
+    EXPECT_EQ(attribute(*root, "outcome"), "dequeued");
+    EXPECT_EQ(tracer.tracked_parties(), 1u);
+
+    qm.set_tracer(nullptr);
+}
+
+#if MATCHMAKER_USDT
+TEST(ProbesTest, NotesAreEmittedAndProbesStartDetached) {
+    // Walk our own ELF section headers for the SDT notes bpftrace reads
+    std::ifstream in("/proc/self/exe", std::ios::binary);
+    std::string elf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ASSERT_GT(elf.size(), sizeof(Elf64_Ehdr));
+
+    Elf64_Ehdr header;
+    std::memcpy(&header, elf.data(), sizeof(header));
+    std::vector<Elf64_Shdr> sections(header.e_shnum);
+    std::memcpy(sections.data(), elf.data() + header.e_shoff, header.e_shnum * sizeof(Elf64_Shdr));
+    const char* section_names = elf.data() + sections[header.e_shstrndx].sh_offset;
+
+    std::vector<std::string> probes;
+    for (const auto& section : sections) {
+        if (std::string(section_names + section.sh_name) != ".note.stapsdt") {
+            continue;
+        }
+        size_t pos = section.sh_offset;
+        size_t end = pos + section.sh_size;
+        while (pos + sizeof(Elf64_Nhdr) <= end) {
+            Elf64_Nhdr note;
+            std::memcpy(&note, elf.data() + pos, sizeof(note));
+            size_t desc = pos + sizeof(note) + ((note.n_namesz + 3) & ~3u);
+            // desc: pc, base, semaphore, then provider\0name\0args\0
+            const char* provider = elf.data() + desc + 24;
+            if (std::string(provider) == "matchmaker") {
+                probes.emplace_back(provider + std::strlen(provider) + 1);
+            }
+            pos = desc + ((note.n_descsz + 3) & ~3u);
+        }
+    }
+
+    for (const char* name : {"enqueue", "dequeue", "tick_start", "tick_end", "bucket_processed",
+                             "match_formed", "timeout_evict", "team_formed", "pair_sweep"}) {
+        EXPECT_NE(std::find(probes.begin(), probes.end(), name), probes.end()) << name;
+    }
+    EXPECT_FALSE(MATCHMAKER_PROBE_ENABLED(tick_end));
+}
+#endif
+
+TEST(MemoryAccountingTest, TracksBucketsIndexAndIdsAndReleasesOnRemoval) {
+    QueueManager qm;
+    const std::string long_id = "5e9d1c7a-2b4f-4a8e-9c3d-7f6a5b100000";  // Beyond SSO
+
+    auto empty = qm.get_memory_stats();
+    EXPECT_EQ(empty.id_arena_bytes, 0);
+
+    qm.enqueue(make_entry(long_id, "us-east", "ranked", 5, 1500, 2));
+    qm.enqueue(make_entry("p2", "eu-west", "casual", 1, 1500));
+
+    auto stats = qm.get_memory_stats();
+    EXPECT_GT(stats.party_index_bytes, 0);
+    EXPECT_GT(stats.party_index_allocations, 0);
+    EXPECT_GT(stats.id_arena_bytes, 0);
+    ASSERT_EQ(stats.buckets.size(), 2u);
+    const auto& team_bucket = stats.buckets.at("us-east:ranked:5");
+    EXPECT_EQ(team_bucket.parties, 1u);
+    EXPECT_GE(team_bucket.entry_bytes, static_cast<int64_t>(sizeof(QueueEntry)));
+    EXPECT_GT(team_bucket.id_bytes, 0);
+    EXPECT_GT(team_bucket.graph_bytes, 0);
+    EXPECT_EQ(stats.buckets.at("eu-west:casual:1").graph_bytes, 0);
+    EXPECT_EQ(stats.total(), qm.memory_bytes());
+
+    qm.dequeue(long_id);
+    qm.dequeue("p2");
+    auto after = qm.get_memory_stats();
+    EXPECT_EQ(after.id_arena_bytes, 0);
+    EXPECT_EQ(after.buckets.at("us-east:ranked:5").id_bytes, 0);
+    EXPECT_LT(after.party_index_bytes, stats.party_index_bytes);
+}
+
+TEST(MemoryAccountingTest, BudgetRejectsEnqueues) {
+    QueueConfig config;
+    config.memory_budget_bytes = 64 * 1024;
+    QueueManager qm(config);
+
+    size_t accepted = 0;
+    for (int i = 0; i < 2000; ++i) {
+        accepted += qm.enqueue(make_entry("party-" + std::to_string(i), "us-east", "ranked", 5, 1500 + i)) ? 1 : 0;
+    }
+    auto stats = qm.get_memory_stats();
+    EXPECT_GT(accepted, 0u);
+    EXPECT_LT(accepted, 2000u);
+    EXPECT_EQ(stats.admission_rejections, 2000u - accepted);
+    EXPECT_LE(stats.total(), static_cast<int64_t>(config.memory_budget_bytes));
+    EXPECT_EQ(qm.get_queue_size(), accepted);
+}
+
+TEST(BucketLifecycleTest, AllowListsAndBucketLimitRejectBeforeCreatingBuckets) {
+    QueueConfig config;
+    config.allowed_regions = {"us-east", "eu-west"};
+    config.allowed_modes = {"ranked"};
+    config.max_buckets = 2;
+    QueueManager qm(config);
+
+    EnqueueRejection reason{};
+    EXPECT_FALSE(qm.enqueue(make_entry("p1", "xx-fake", "ranked", 1, 1500), &reason));
+    EXPECT_EQ(reason, EnqueueRejection::Region);
+    EXPECT_FALSE(qm.enqueue(make_entry("p2", "us-east", "arcade", 1, 1500), &reason));
+    EXPECT_EQ(reason, EnqueueRejection::Mode);
+    EXPECT_FALSE(qm.enqueue(make_entry("p3", "us-east", "ranked", 0, 1500), &reason));
+    EXPECT_EQ(reason, EnqueueRejection::TeamSize);
+
+    EXPECT_TRUE(qm.enqueue(make_entry("p4", "us-east", "ranked", 1, 1500)));
+    EXPECT_TRUE(qm.enqueue(make_entry("p5", "eu-west", "ranked", 1, 1500)));
+    EXPECT_FALSE(qm.enqueue(make_entry("p6", "us-east", "ranked", 2, 1500), &reason));
+    EXPECT_EQ(reason, EnqueueRejection::BucketLimit);
+    EXPECT_TRUE(qm.enqueue(make_entry("p7", "us-east", "ranked", 1, 1600)));  // Existing bucket
+
+    auto stats = qm.get_bucket_lifecycle_stats();
+    EXPECT_EQ(stats.live, 2u);
+    EXPECT_EQ(stats.created, 2u);
+    EXPECT_EQ(stats.rejected_region, 1u);
+    EXPECT_EQ(stats.rejected_mode, 1u);
+    EXPECT_EQ(stats.rejected_team_size, 1u);
+    EXPECT_EQ(stats.rejected_bucket_limit, 1u);
+    EXPECT_FALSE(qm.is_queued("p1"));
+    EXPECT_EQ(qm.get_queue_size(), 3u);
+}
+
+TEST(BucketLifecycleTest, IdleBucketsAreEvictedAndStorageRecycled) {
+    QueueConfig config;
+    config.bucket_idle_evict_sec = 0;
+    config.bucket_freelist_size = 1;
+    QueueManager qm(config);
+
+    qm.enqueue(make_entry("p1", "us-east", "ranked", 2, 1500));
+    qm.enqueue(make_entry("p2", "eu-west", "casual", 1, 1500));
+    qm.dequeue("p1");
+    qm.dequeue("p2");
+    int64_t before = qm.memory_bytes();
+
+    qm.tick();
+    auto stats = qm.get_bucket_lifecycle_stats();
+    EXPECT_EQ(stats.live, 0u);
+    EXPECT_EQ(stats.evicted, 2u);
+    EXPECT_EQ(stats.freelist, 1u);      // Second eviction overflowed the freelist
+    EXPECT_TRUE(qm.get_bucket_sizes().empty());
+    EXPECT_EQ(qm.get_memory_stats().total(), qm.memory_bytes());
+    EXPECT_LT(qm.memory_bytes(), before);
+
+    // A new bucket reuses the evicted storage, and repopulated buckets are not evicted
+    qm.enqueue(make_entry("p3", "ap-south", "ranked", 1, 1500));
+    qm.tick();
+    stats = qm.get_bucket_lifecycle_stats();
+    EXPECT_EQ(stats.created, 3u);
+    EXPECT_EQ(stats.recycled, 1u);
+    EXPECT_EQ(stats.freelist, 0u);
+    EXPECT_EQ(stats.live, 1u);
+    EXPECT_TRUE(qm.is_queued("p3"));
+}
+
+TEST(PolicyTest, FirstMatchingRuleWinsAndInheritsDefault) {
+    std::string error;
+    auto policy = PolicySet::parse(R"({
+        "default": {"mmr_band_initial": 150, "min_match_quality": 0.5, "tick_interval_ms": 200},
+        "buckets": [
+            {"region": "eu-west", "mode": "ranked", "team_size": 5, "mmr_band_growth_per_sec": 25},
+            {"region": "eu-west", "min_match_quality": 0.7, "tick_interval_ms": 50}
+        ]
+    })", &error);
+    ASSERT_NE(policy, nullptr) << error;
+
+    const auto& ranked = policy->resolve({"eu-west", "ranked", 5});
+    EXPECT_EQ(ranked.mmr_band_growth_per_sec, 25);
+    EXPECT_EQ(ranked.mmr_band_initial, 150);        // Inherited
+    EXPECT_DOUBLE_EQ(ranked.min_match_quality, 0.5);
+
+    EXPECT_DOUBLE_EQ(policy->resolve({"eu-west", "casual", 1}).min_match_quality, 0.7);
+    EXPECT_EQ(policy->resolve({"us-east", "ranked", 5}).mmr_band_growth_per_sec, 10);
+    EXPECT_EQ(policy->min_tick_interval_ms(), 50);
+}
+
+TEST(PolicyTest, RejectsInvalidPolicy) {
+    std::string error;
+    EXPECT_EQ(PolicySet::parse("not json", &error), nullptr);
+    EXPECT_EQ(PolicySet::parse(R"({"default": {"mmr_band_initial": 600, "mmr_band_max": 500}})", &error), nullptr);
+    EXPECT_NE(error.find("mmr_band_max"), std::string::npos);
+    EXPECT_EQ(PolicySet::parse(R"({"buckets": [{"min_match_quality": 1.5}]})", &error), nullptr);
+    EXPECT_NE(error.find("buckets[0]"), std::string::npos);
+    EXPECT_EQ(PolicySet::parse(R"({"buckets": [{"region": 7}]})", &error), nullptr);
+}
+
+TEST(PolicyTest, SwapTakesEffectAtNextTickAndKeepsQueuedParties) {
+    QueueManager qm;
+    qm.enqueue(make_entry("a", "us-east", "ranked", 1, 1000));
+    qm.enqueue(make_entry("b", "us-east", "ranked", 1, 1400));
+    for (int i = 0; i < 4; ++i) {
+        qm.enqueue(make_entry("t" + std::to_string(i), "us-east", "ranked", 2, i < 2 ? 1000 : 1400));
+    }
+    EXPECT_TRUE(qm.tick().empty());   // 400 MMR apart, band 100
+
+    BucketPolicy wide;
+    wide.mmr_band_initial = 500;
+    wide.min_match_quality = 0.0;
+    qm.set_policy(std::make_unique<PolicySet>(wide));
+    EXPECT_EQ(qm.get_queue_size(), 6u);   // Nothing applied until the tick
+    EXPECT_EQ(qm.policy().default_policy().mmr_band_initial, 100);
+
+    auto matches = qm.tick();
+    EXPECT_EQ(qm.policy().default_policy().mmr_band_initial, 500);
+    ASSERT_EQ(matches.size(), 2u);        // 1v1 and the rebuilt 2v2 graph
+    EXPECT_EQ(qm.get_queue_size(), 0u);
+}
+
+TEST(PolicyTest, BucketTickIntervalThrottlesMatching) {
+    BucketPolicy slow;
+    slow.tick_interval_ms = 60000;
+    QueueManager qm;
+    qm.set_policy(std::make_unique<PolicySet>(BucketPolicy{}, std::vector<PolicySet::Rule>{
+        {"us-east", "", 0, slow}}));
+
+    qm.enqueue(make_entry("a", "us-east", "ranked", 1, 1500));
+    qm.enqueue(make_entry("b", "us-east", "ranked", 1, 1500));
+    qm.enqueue(make_entry("c", "eu-west", "ranked", 1, 1500));
+    qm.enqueue(make_entry("d", "eu-west", "ranked", 1, 1500));
+    EXPECT_EQ(qm.tick().size(), 2u);      // First evaluation of each bucket
+
+    qm.enqueue(make_entry("e", "us-east", "ranked", 1, 1500));
+    qm.enqueue(make_entry("f", "us-east", "ranked", 1, 1500));
+    qm.enqueue(make_entry("g", "eu-west", "ranked", 1, 1500));
+    qm.enqueue(make_entry("h", "eu-west", "ranked", 1, 1500));
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);        // us-east waits for its next slot
+    EXPECT_EQ(matches[0].region, "eu-west");
+    EXPECT_TRUE(qm.is_queued("e"));
+}
+
+TEST(PolicyTest, WatcherReloadsChangedFileAndSkipsInvalidVersions) {
+    auto path = std::filesystem::temp_directory_path() / "matchmaker_policy_test.json";
+    // Each version differs in size, so back-to-back writes within one
+    // timestamp tick are still seen as changes
+    std::ofstream(path) << R"({"default": {"mmr_band_initial": 50}})";
+
+    std::atomic<int> applied{0};
+    std::atomic<int> last_band{0};
+    PolicyWatcher watcher(path.string(), [&](std::unique_ptr<const PolicySet> policy) {
+        last_band = policy->default_policy().mmr_band_initial;
+        applied++;
+    }, std::chrono::milliseconds(5));
+
+    auto wait_for = [](auto done) {
+        for (int i = 0; i < 400 && !done(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return done();
+    };
+
+    std::ofstream(path) << R"({"default": {"mmr_band_initial": 250}})";
+    ASSERT_TRUE(wait_for([&] { return applied.load() == 1; }));
+    EXPECT_EQ(last_band.load(), 250);
+
+    std::ofstream(path) << R"({"default": {"mmr_band_initial": "wide"}})";
+    ASSERT_TRUE(wait_for([&] { return watcher.failures() == 1; }));
+    EXPECT_EQ(applied.load(), 1);
+    std::filesystem::remove(path);
+}
+
+TEST(QueueStoreTest, EntryCodecRoundTrips) {
+    QueueEntry entry = make_entry("party \"x\"\n", "us-east", "ranked", 2, 1543, 2);
+    auto decoded = decode_queue_entry(encode_queue_entry(entry));
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->party_id, entry.party_id);
+    EXPECT_EQ(decoded->region, "us-east");
+    EXPECT_EQ(decoded->team_size, 2);
+    EXPECT_EQ(decoded->party_size, 2);
+    EXPECT_EQ(decoded->avg_mmr, 1543);
+    EXPECT_EQ(decoded->player_ids, entry.player_ids);
+    EXPECT_EQ(std::chrono::duration_cast<std::chrono::microseconds>(decoded->enqueued_at - entry.enqueued_at).count(), 0);
+    EXPECT_FALSE(decode_queue_entry("{\"party_id\": 1}").has_value());
+}
+
+TEST(RedisClientTest, PipelineIsOneRoundTrip) {
+    RespStandIn server;
+    ASSERT_TRUE(server.listening());
+    RedisConnection redis("127.0.0.1", server.port());
+
+    auto replies = redis.pipeline({
+        {"PING"},
+        {"HSET", "h", "a", "1", "b", "2"},
+        {"HGET", "h", "b"},
+        {"HGET", "h", "missing"},
+        {"ZADD", "z", "1500", "p1", "1400", "p2"},
+        {"ZRANGEBYSCORE", "z", "-inf", "+inf"},
+        {"NOPE"},
+    });
+    ASSERT_TRUE(replies.has_value());
+    EXPECT_EQ(redis.round_trips(), 1u);
+    EXPECT_EQ((*replies)[0].str, "PONG");
+    EXPECT_EQ((*replies)[1].integer, 2);
+    EXPECT_EQ((*replies)[2].str, "2");
+    EXPECT_EQ((*replies)[3].type, RedisReply::Type::Nil);
+    ASSERT_EQ((*replies)[5].elements.size(), 2u);
+    EXPECT_EQ((*replies)[5].elements[0].str, "p2");
+    EXPECT_TRUE((*replies)[6].is_error());
+
+    // Atomic batch: the script is loaded on first use in the same round trip
+    EXPECT_EQ(redis.batch({{"SADD", "s", "x"}, {"ZREM", "z", "p1"}}), 2);
+    EXPECT_EQ(redis.batch({{"SADD", "s", "y"}}), 1);
+    EXPECT_EQ(redis.round_trips(), 3u);
+    EXPECT_EQ(server.execute({"ZCARD", "z"}).integer, 1);
+
+    std::string host;
+    int port = 0;
+    EXPECT_TRUE(RedisConnection::parse_url("redis://redis:6380/0", host, port));
+    EXPECT_EQ(host, "redis");
+    EXPECT_EQ(port, 6380);
+    EXPECT_FALSE(RedisConnection::parse_url("http://redis", host, port));
+}
+
+TEST(RedisQueueStoreTest, TickIsOneRoundTripAndQueueSurvivesRestart) {
+    RespStandIn server;
+    ASSERT_TRUE(server.listening());
+    RedisQueueStoreConfig config;
+    config.port = server.port();
+
+    {
+        RedisQueueStore store(config);
+        QueueManager qm;
+        qm.set_store(&store);
+        for (int i = 0; i < 6; ++i) {
+            qm.enqueue(make_entry("s" + std::to_string(i), "us-east", "ranked", 1, i < 4 ? 1500 : 2500 + 500 * i));
+        }
+        qm.enqueue(make_entry("t0", "eu-west", "ranked", 2, 1500, 2));
+        qm.dequeue("s5");
+
+        auto matches = qm.tick();
+        EXPECT_EQ(matches.size(), 2u);
+        EXPECT_EQ(store.round_trips(), 1u);     // 7 adds, 1 dequeue, 4 matched: one batch
+        EXPECT_EQ(qm.pending_store_ops(), 0u);
+
+        qm.tick();
+        EXPECT_EQ(store.round_trips(), 1u);     // Nothing changed: no write
+        EXPECT_EQ(server.execute({"HLEN", store.entries_key()}).integer, 2);
+        EXPECT_EQ(server.execute({"ZCARD", store.bucket_key("us-east:ranked:1")}).integer, 1);
+        EXPECT_EQ(server.execute({"ZSCORE", store.bucket_key("eu-west:ranked:2"), "t0"}).str, "1500");
+    }
+
+    // A new process picks the queue back up
+    RedisQueueStore store(config);
+    QueueManager restarted;
+    restarted.set_store(&store);
+    EXPECT_EQ(restarted.restore_from_store(), 2u);
+    EXPECT_TRUE(restarted.is_queued("s4"));
+    EXPECT_TRUE(restarted.is_queued("t0"));
+    EXPECT_EQ(restarted.pending_store_ops(), 0u);
+}
+
+TEST(RedisQueueStoreTest, FailedWritesAreRetried) {
+    InMemoryQueueStore memory;
+    RedisQueueStoreConfig config;
+    {
+        RespStandIn closed;          // Grab a port, then free it
+        config.port = closed.port();
+    }
+    config.timeout = std::chrono::milliseconds(100);
+    RedisQueueStore unreachable(config);
+
+    QueueManager qm;
+    qm.set_store(&unreachable);
+    qm.enqueue(make_entry("p1", "us-east", "ranked", 1, 1500));
+    qm.tick();
+    EXPECT_EQ(qm.store_write_failures(), 1u);
+    EXPECT_EQ(qm.pending_store_ops(), 1u);
+
+    qm.set_store(&memory);
+    EXPECT_TRUE(qm.flush_store());
+    EXPECT_EQ(memory.size(), 1u);
+}
+
+TEST(JetStreamTest, UnackedMessagesAreRedeliveredToTheDurable) {
+    JetStreamStandIn stream;
+    EXPECT_TRUE(JetStreamStandIn::subject_matches("matchmaker.queue.*", "matchmaker.queue.join"));
+    EXPECT_FALSE(JetStreamStandIn::subject_matches("matchmaker.queue.*", "matchmaker.queue.a.b"));
+    EXPECT_TRUE(JetStreamStandIn::subject_matches("matchmaker.>", "matchmaker.queue.a.b"));
+
+    for (int i = 0; i < 5; ++i) {
+        stream.publish("matchmaker.queue.join", "m" + std::to_string(i));
+    }
+    stream.publish("matchmaker.other", "ignored");
+
+    PullConsumerConfig config;
+    config.ack_wait = std::chrono::milliseconds(20);
+    auto consumer = stream.pull_consumer(config);
+    auto batch = consumer->fetch(3, std::chrono::milliseconds(0));
+    ASSERT_EQ(batch.size(), 3u);
+    EXPECT_EQ(batch[2].stream_sequence, 3u);
+    EXPECT_TRUE(consumer->ack_all(batch[2].stream_sequence));   // One request for the batch
+
+    // The next batch is never acked: the process "crashes"
+    batch = consumer->fetch(10, std::chrono::milliseconds(0));
+    ASSERT_EQ(batch.size(), 2u);                                 // Filter skips "matchmaker.other"
+    consumer.reset();
+    EXPECT_EQ(stream.consumer_info("matchmaker").ack_floor, 3u);
+
+    // A new process binds to the same durable and gets them again after ack_wait
+    auto restarted = stream.pull_consumer(config);
+    EXPECT_TRUE(restarted->fetch(10, std::chrono::milliseconds(0)).empty());
+    batch = restarted->fetch(10, std::chrono::milliseconds(500));
+    ASSERT_EQ(batch.size(), 2u);
+    EXPECT_EQ(batch[0].stream_sequence, 4u);
+    EXPECT_EQ(batch[0].deliveries, 2u);
+    EXPECT_TRUE(restarted->ack_all(batch[1].stream_sequence));
+    EXPECT_EQ(stream.consumer_info("matchmaker").ack_pending, 0u);
+    EXPECT_EQ(stream.stored_messages(), 0u);                    // Work-queue retention
+}
+
+namespace {
+
+class FlakyQueueStore : public InMemoryQueueStore {
+public:
+    bool fail = false;
+    bool apply(const std::vector<StoreOp>& ops) override {
+        return !fail && InMemoryQueueStore::apply(ops);
+    }
+};
+
+} // namespace
+
+TEST(DurableQueueIngestTest, AcksOnlyDurableBatchesAndNeverReappliesAfterRestart) {
+    JetStreamStandIn stream;
+    PullConsumerConfig config;
+    config.ack_wait = std::chrono::milliseconds(20);
+    FlakyQueueStore store;
+
+    stream.publish("matchmaker.queue.ranked.us-east", encode_queue_enter(make_entry("a", "us-east", "ranked", 1, 1500)));
+    stream.publish("matchmaker.queue.ranked.us-east", encode_queue_enter(make_entry("b", "us-east", "ranked", 1, 1500)));
+    stream.publish("matchmaker.queue.ranked.us-east", encode_queue_enter(make_entry("c", "us-east", "ranked", 1, 3000)));
+    stream.publish("matchmaker.queue.ranked.us-east", "not json");
+
+    {
+        auto consumer = stream.pull_consumer(config);
+        QueueManager qm;
+        qm.set_store(&store);
+        DurableQueueIngest ingest(*consumer, qm,
+            [&qm](const QueueEvent& event) { qm.enqueue(event.entry); }, 16);
+        std::vector<std::string> dead_letters;
+        ingest.set_dead_letter([&dead_letters](const JetStreamMessage& message) {
+            dead_letters.push_back(message.data);
+            return true;
+        });
+
+        store.fail = true;
+        EXPECT_EQ(ingest.poll(), 4u);
+        EXPECT_EQ(ingest.stats().malformed, 1u);
+        EXPECT_EQ(dead_letters, std::vector<std::string>{"not json"});
+        EXPECT_EQ(qm.tick().size(), 1u);             // a vs b
+        EXPECT_FALSE(ingest.commit());               // Store write failed: no ack
+        EXPECT_EQ(stream.consumer_info("matchmaker").ack_pending, 4u);
+
+        store.fail = false;
+        qm.tick();
+        uint64_t trips = consumer->round_trips();
+        EXPECT_TRUE(ingest.commit());
+        EXPECT_EQ(consumer->round_trips(), trips + 1);   // One ack for the whole batch
+        EXPECT_EQ(store.load_checkpoint(), 4u);
+
+        // A new event is written but the process dies before acking it
+        stream.publish("matchmaker.queue.ranked.us-east", encode_queue_enter(make_entry("d", "us-east", "ranked", 1, 3000)));
+        EXPECT_EQ(ingest.poll(), 1u);
+        EXPECT_EQ(qm.tick().size(), 1u);             // c vs d, persisted with checkpoint 5
+    }
+
+    // After restart the redelivered event is acked without re-queueing d
+    auto consumer = stream.pull_consumer(config);
+    QueueManager restarted;
+    restarted.set_store(&store);
+    EXPECT_EQ(restarted.restore_from_store(), 0u);
+    EXPECT_EQ(restarted.ingest_checkpoint(), 5u);
+    DurableQueueIngest ingest(*consumer, restarted,
+        [&restarted](const QueueEvent& event) { restarted.enqueue(event.entry); }, 16);
+    EXPECT_EQ(ingest.poll(std::chrono::milliseconds(500)), 1u);
+    EXPECT_EQ(ingest.stats().skipped, 1u);
+    EXPECT_FALSE(restarted.is_queued("d"));
+    EXPECT_TRUE(ingest.commit());
+    EXPECT_EQ(stream.consumer_info("matchmaker").ack_floor, 5u);
+}
+
+TEST(DurableQueueIngestTest, AppliesApiQueueEventsAndHoldsUndecodableOnes) {
+    JetStreamStandIn stream;
+    auto consumer = stream.pull_consumer({});
+    QueueManager qm;
+    DurableQueueIngest ingest(*consumer, qm, [&qm](const QueueEvent& event) {
+        if (event.type == QueueEvent::Type::Leave) {
+            qm.dequeue(event.entry.party_id);
+        } else {
+            qm.enqueue(event.entry);
+        }
+    });
+
+    // As services/api/utils/nats_events.py publishes them
+    const std::string subject = "matchmaker.queue.ranked.us-east";
+    stream.publish(subject, R"({"event_type": "queue_enter", "party_id": "p1", "mode": "ranked",
+        "team_size": 2, "avg_mmr": 1500, "region": "us-east", "party_size": 2,
+        "timestamp": "2026-10-17T12:00:00.250000+00:00",
+        "traceparent": "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"})");
+    stream.publish(subject, R"({"event_type": "queue_enter", "party_id": "p2", "mode": "ranked",
+        "team_size": 2, "avg_mmr": 1510, "region": "us-east", "party_size": 1,
+        "timestamp": "2026-10-17T14:00:00+02:00"})");
+    stream.publish(subject, R"({"event_type": "queue_leave", "party_id": "p2", "mode": "ranked",
+        "region": "us-east", "timestamp": "2026-10-17T12:00:01.000000+00:00"})");
+    stream.publish(subject, R"({"event_type": "queue_enter", "party_id": "p3"})");
+    stream.publish(subject, R"({"event_type": "queue_enter", "party_id": "p4", "mode": "ranked",
+        "team_size": 2, "avg_mmr": 1490, "region": "us-east", "party_size": 1,
+        "timestamp": "2026-10-17T12:00:02Z"})");
+
+    EXPECT_EQ(ingest.poll(), 5u);
+    EXPECT_EQ(ingest.stats().applied, 3u);
+    EXPECT_EQ(ingest.stats().malformed, 1u);
+    EXPECT_TRUE(qm.is_queued("p1"));
+    EXPECT_FALSE(qm.is_queued("p2"));                 // Entered, then left
+    EXPECT_FALSE(qm.is_queued("p4"));                 // Held behind p3
+
+    // With no dead-letter handler the malformed event is never acked past
+    EXPECT_TRUE(ingest.stalled());
+    EXPECT_TRUE(ingest.commit());
+    EXPECT_EQ(ingest.acked_sequence(), 3u);
+    EXPECT_EQ(ingest.poll(), 2u);                     // Retried, nothing fetched
+    EXPECT_EQ(ingest.stats().malformed, 1u);
+    EXPECT_TRUE(ingest.stalled());
+
+    std::vector<uint64_t> dead_letters;
+    ingest.set_dead_letter([&dead_letters](const JetStreamMessage& message) {
+        dead_letters.push_back(message.stream_sequence);
+        return true;
+    });
+    EXPECT_EQ(ingest.poll(), 2u);
+    EXPECT_EQ(dead_letters, std::vector<uint64_t>{4});
+    EXPECT_FALSE(ingest.stalled());
+    EXPECT_TRUE(qm.is_queued("p4"));
+    EXPECT_TRUE(ingest.commit());
+    EXPECT_EQ(stream.consumer_info("matchmaker").ack_floor, 5u);
+}
+
+TEST(QueueEventTest, DecodesApiEnterAndLeaveEvents) {
+    auto enter = decode_queue_event(R"({"event_type": "queue_enter", "party_id": "p1", "mode": "ranked",
+        "team_size": 2, "avg_mmr": 1500, "region": "us-east", "party_size": 2,
+        "timestamp": "2026-10-17T12:00:00.250000+00:00",
+        "traceparent": "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"})");
+    ASSERT_TRUE(enter.has_value());
+    EXPECT_EQ(enter->type, QueueEvent::Type::Enter);
+    EXPECT_EQ(enter->entry.party_size, 2);
+    EXPECT_EQ(enter->entry.party_hash, hash_party_id("p1"));
+    EXPECT_EQ(std::chrono::duration_cast<std::chrono::milliseconds>(
+        enter->entry.enqueued_at.time_since_epoch()).count(), 1792238400250);
+    EXPECT_EQ(enter->entry.trace.trace_id, "4bf92f3577b34da6a3ce929d0e0e4736");
+    EXPECT_EQ(enter->entry.trace.parent_span_id, "00f067aa0ba902b7");
+    EXPECT_TRUE(enter->entry.trace.sampled);
+
+    auto leave = decode_queue_event(R"({"event_type": "queue_leave", "party_id": "p1", "mode": "ranked",
+        "region": "us-east", "timestamp": "2026-10-17T12:00:01+00:00"})");
+    ASSERT_TRUE(leave.has_value());
+    EXPECT_EQ(leave->type, QueueEvent::Type::Leave);
+    EXPECT_EQ(leave->entry.party_id, "p1");
+
+    // Round trip through the encoder, and offsets other than UTC
+    auto again = decode_queue_event(encode_queue_enter(enter->entry));
+    ASSERT_TRUE(again.has_value());
+    EXPECT_EQ(again->entry.enqueued_at, enter->entry.enqueued_at);
+    EXPECT_EQ(again->entry.trace.parent_span_id, "00f067aa0ba902b7");
+    EXPECT_EQ(parse_iso8601("2026-10-17T14:00:00.25+02:00"), enter->entry.enqueued_at);
+
+    EXPECT_FALSE(decode_queue_event(R"({"event_type": "party_updated", "party_id": "p1"})").has_value());
+    EXPECT_FALSE(decode_queue_event(encode_queue_entry(enter->entry)).has_value());   // Store format
+    EXPECT_FALSE(parse_iso8601("2026-02-30T00:00:00Z").has_value());
+    EXPECT_FALSE(parse_iso8601("2026-10-17T12:00:00+0200").has_value());
+}
+
+TEST(BackfillTest, SingleSlotIsFilledInOneTickFromTheNearestMmr) {
+    QueueManager qm;
+    for (int i = 0; i < 200; ++i) {
+        qm.enqueue(make_entry(std::to_string(i), "us-east", "ranked", 1, 1000 + 10 * i));
+    }
+    qm.enqueue(make_entry("near", "us-east", "ranked", 1, 1703));
+    qm.enqueue(make_entry("other-mode", "us-east", "casual", 1, 1700));
+
+    BackfillRequest request;
+    request.match_id = "m1";
+    request.region = "us-east";
+    request.mode = "ranked";
+    request.open_slots = 1;
+    request.target_mmr = 1704;
+    request.deadline = std::chrono::system_clock::now() + std::chrono::seconds(10);
+    ASSERT_TRUE(qm.request_backfill(request));
+    EXPECT_FALSE(qm.request_backfill(request));         // Duplicate match_id
+
+    auto matches = qm.tick();
+    auto results = qm.take_backfill_results();
+    ASSERT_EQ(results.size(), 1u);
+    ASSERT_EQ(results[0].party_ids.size(), 1u);
+    EXPECT_EQ(results[0].party_ids[0], "near");
+    EXPECT_EQ(results[0].players[0], std::vector<std::string>{"near-p0"});
+    EXPECT_EQ(results[0].open_slots, 0);
+    EXPECT_FALSE(qm.is_queued("near"));
+    for (const auto& match : matches) {
+        EXPECT_EQ(std::count(match.party_ids.begin(), match.party_ids.end(), "near"), 0);
+    }
+
+    const auto& stats = qm.get_backfill_stats();
+    EXPECT_EQ(stats.filled, 1u);
+    EXPECT_EQ(stats.pending, 0u);
+    EXPECT_EQ(stats.fill_latency.count, 1u);
+
+    MetricsRegistry metrics;
+    metrics.describe("fill_seconds", MetricsRegistry::Type::Histogram, "Fill latency");
+    metrics.set_histogram("fill_seconds", stats.fill_latency);
+    std::string text = metrics.render();
+    EXPECT_NE(text.find("# TYPE fill_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("fill_seconds_bucket{le=\"+Inf\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("fill_seconds_count 1\n"), std::string::npos);
+}
+
+TEST(BackfillTest, TimedOutPartiesAreNotPlaced) {
+    QueueConfig config;
+    config.max_wait_time_sec = 10;
+    QueueManager qm(config);
+    auto expired = make_entry("expired", "us-east", "ranked", 1, 1500);
+    expired.enqueued_at -= std::chrono::seconds(30);
+    qm.enqueue(expired);
+    qm.enqueue(make_entry("fresh", "us-east", "ranked", 1, 1560));
+
+    BackfillRequest request;
+    request.match_id = "m1";
+    request.region = "us-east";
+    request.mode = "ranked";
+    request.target_mmr = 1500;
+    request.deadline = std::chrono::system_clock::now() + std::chrono::seconds(10);
+    ASSERT_TRUE(qm.request_backfill(request));
+
+    qm.tick();
+    auto results = qm.take_backfill_results();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].party_ids, std::vector<std::string>{"fresh"});
+    EXPECT_FALSE(qm.is_queued("expired"));
+}
+
+TEST(BackfillTest, PartialFillsStayOpenUntilTheDeadline) {
+    QueueManager qm;
+    qm.enqueue(make_entry("duo", "eu-west", "ranked", 3, 1505, 2));
+    qm.enqueue(make_entry("solo", "eu-west", "ranked", 3, 1520));
+    qm.enqueue(make_entry("far", "eu-west", "ranked", 3, 2500));
+
+    BackfillRequest request;
+    request.match_id = "m2";
+    request.region = "eu-west";
+    request.mode = "ranked";
+    request.team_size = 3;
+    request.open_slots = 1;
+    request.target_mmr = 1510;
+    request.deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(50);
+    ASSERT_TRUE(qm.request_backfill(request));
+    request.match_id = "m3";
+    request.open_slots = 2;
+    ASSERT_TRUE(qm.request_backfill(request));
+
+    // m2 skips the nearer duo (too large for one slot) and takes solo; m3 gets the duo
+    qm.tick();
+    auto results = qm.take_backfill_results();
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].match_id, "m2");
+    EXPECT_EQ(results[0].party_ids, std::vector<std::string>{"solo"});
+    EXPECT_EQ(results[1].party_ids, std::vector<std::string>{"duo"});
+    EXPECT_EQ(results[1].players[0].size(), 2u);
+    EXPECT_EQ(qm.get_queue_size(), 1u);
+
+    // Out of band: stays open, then expires
+    request.match_id = "m4";
+    request.open_slots = 1;
+    ASSERT_TRUE(qm.request_backfill(request));
+    qm.tick();
+    EXPECT_TRUE(qm.take_backfill_results().empty());
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    qm.tick();
+    results = qm.take_backfill_results();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_TRUE(results[0].expired);
+    EXPECT_EQ(results[0].open_slots, 1);
+    EXPECT_TRUE(qm.is_queued("far"));
+    EXPECT_EQ(qm.get_backfill_stats().expired, 1u);
+
+    MockNatsClient nats;
+    nats.publish_backfill_result(results[0]);
+    auto payload = nlohmann::json::parse(nats.get_last_backfill_payload());
+    EXPECT_EQ(payload["match_id"], "m4");
+    EXPECT_EQ(payload["expired"], true);
+    EXPECT_EQ(payload["open_slots"], 1);
+}
+
+TEST(PriorityLaneTest, SchedulerSharesAnchorsByWeight) {
+    LaneScheduler lanes({1, 2, 2, 4});
+    std::array<int, kPriorityLaneCount> picks{};
+    PriorityLane lane;
+    uint8_t all = lane_bit(PriorityLane::Normal) | lane_bit(PriorityLane::Requeue) |
+                  lane_bit(PriorityLane::Backfill) | lane_bit(PriorityLane::Vip);
+    for (int i = 0; i < 90; ++i) {
+        ASSERT_TRUE(lanes.pick(all, lane));
+        picks[static_cast<size_t>(lane)]++;
+    }
+    EXPECT_EQ(picks, (std::array<int, kPriorityLaneCount>{10, 20, 20, 40}));
+
+    // Only waiting lanes are picked; an empty mask picks nothing
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(lanes.pick(lane_bit(PriorityLane::Requeue), lane));
+        EXPECT_EQ(lane, PriorityLane::Requeue);
+    }
+    EXPECT_FALSE(lanes.pick(0, lane));
+
+    std::string error;
+    auto policy = PolicySet::parse(R"({"default": {"lane_weights": {"vip": 8}}})", &error);
+    ASSERT_NE(policy, nullptr) << error;
+    EXPECT_EQ(policy->default_policy().lane_weights, (LaneWeights{1, 2, 2, 8}));
+    EXPECT_EQ(PolicySet::parse(R"({"default": {"lane_weights": {"gold": 2}}})"), nullptr);
+    EXPECT_EQ(PolicySet::parse(R"({"default": {"lane_weights": {"vip": 0}}})"), nullptr);
+}
+
+TEST(PriorityLaneTest, VipPartyAnchorsAheadOfOlderNormalParties) {
+    QueueManager qm;
+    auto earlier = std::chrono::system_clock::now() - std::chrono::seconds(10);
+    for (int i = 0; i < 4; ++i) {
+        auto entry = make_entry(std::to_string(i), "us-east", "ranked", 2, 1500);
+        entry.enqueued_at = earlier;
+        qm.enqueue(entry);
+    }
+    auto vip = make_entry("vip", "us-east", "ranked", 2, 1500);
+    vip.lane = PriorityLane::Vip;
+    qm.enqueue(vip);
+
+    // Wait order alone would match the four normal parties
+    auto matches = qm.tick();
+    ASSERT_EQ(matches.size(), 1u);
+    const auto& ids = matches[0].party_ids;
+    EXPECT_NE(std::find(ids.begin(), ids.end(), "vip"), ids.end());
+    EXPECT_EQ(qm.get_queue_size(), 1u);
+    EXPECT_EQ(qm.get_lane_anchor_counts()[static_cast<size_t>(PriorityLane::Vip)], 1u);
+    EXPECT_EQ(qm.get_lane_anchor_counts()[static_cast<size_t>(PriorityLane::Normal)], 0u);
+
+    // The lane survives the queue store codec; normal entries omit it
+    auto decoded = decode_queue_entry(encode_queue_entry(vip));
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->lane, PriorityLane::Vip);
+    EXPECT_EQ(encode_queue_entry(make_entry("n", "us-east", "ranked", 2, 1500)).find("lane"), std::string::npos);
+}
+
+TEST(BulkAssignmentTest, PlacesEveryPartyOnceInFullBalancedLobbies) {
+    // Enough parties for two slices, so the set-aside pass is exercised too
+    std::vector<QueueEntry> pool;
+    std::unordered_map<std::string, int> seen;
+    size_t total_players = 0;
+    for (int i = 0; i < 10000; ++i) {
+        int party_size = i % 7 == 0 ? 2 + i % 4 : 1;
+        pool.push_back(make_entry(std::to_string(i), "eu-west", "cup", 5, 1000 + (i * 37) % 1000, party_size));
+        seen[pool.back().party_id] = 0;
+        total_players += static_cast<size_t>(party_size);
+    }
+    pool.push_back(make_entry("too-big", "eu-west", "cup", 5, 1500, 6));
+    seen["too-big"] = 0;
+
+    BulkAssignmentConfig config;
+    config.threads = 4;
+    config.lobby_id_prefix = "cup";
+    auto result = assign_lobbies(pool, config);
+
+    std::unordered_set<std::string> lobby_ids;
+    for (const auto& lobby : result.lobbies) {
+        EXPECT_TRUE(lobby_ids.insert(lobby.match_id).second);
+        EXPECT_EQ(lobby.mode, "cup");
+        EXPECT_GE(lobby.quality_score, config.min_match_quality);
+        ASSERT_EQ(lobby.teams.size(), 2u);
+        EXPECT_EQ(lobby.teams[0].size(), 5u);
+        EXPECT_EQ(lobby.teams[1].size(), 5u);
+        auto [lo, hi] = std::minmax_element(lobby.party_mmrs.begin(), lobby.party_mmrs.end());
+        EXPECT_LE(*hi - *lo, config.mmr_tolerance);
+        for (const auto& party_id : lobby.party_ids) {
+            seen[party_id]++;
+        }
+    }
+    for (const auto& party_id : result.unassigned) {
+        seen[party_id]++;
+    }
+    for (const auto& [party_id, count] : seen) {
+        EXPECT_EQ(count, 1) << party_id;
+    }
+    EXPECT_NE(std::find(result.unassigned.begin(), result.unassigned.end(), "too-big"), result.unassigned.end());
+    EXPECT_EQ(result.players_assigned, 10 * result.lobbies.size());
+    EXPECT_GT(result.players_assigned, total_players * 98 / 100);
+}
+
+TEST(TenantHostTest, CpuBudgetDefersBucketsInTurnWithoutTouchingOtherTenants) {
+    TenantHost host(2);
+    TenantConfig noisy;
+    noisy.name = "noisy";
+    noisy.cpu_budget = std::chrono::microseconds(1);    // One bucket per tick
+    TenantConfig quiet;
+    quiet.name = "quiet";
+    QueueManager* noisy_queue = host.add_tenant(noisy);
+    QueueManager* quiet_queue = host.add_tenant(quiet);
+    ASSERT_NE(noisy_queue, nullptr);
+    ASSERT_NE(quiet_queue, nullptr);
+    EXPECT_EQ(host.add_tenant(quiet), nullptr);
+    EXPECT_EQ(host.find("quiet"), quiet_queue);
+
+    for (const char* region : {"us-east", "eu-west", "ap-south"}) {
+        noisy_queue->enqueue(make_entry(std::string(region) + "-a", region, "ranked", 1, 1500));
+        noisy_queue->enqueue(make_entry(std::string(region) + "-b", region, "ranked", 1, 1510));
+    }
+    quiet_queue->enqueue(make_entry("q-a", "us-east", "ranked", 1, 1500));
+    quiet_queue->enqueue(make_entry("q-b", "us-east", "ranked", 1, 1510));
+
+    // Each tick the noisy tenant gets through one bucket and resumes with the next
+    std::vector<size_t> noisy_matches;
+    for (int tick = 0; tick < 3; ++tick) {
+        auto results = host.tick();
+        ASSERT_EQ(results.size(), 2u);
+        EXPECT_EQ(results[0].tenant, "noisy");
+        noisy_matches.push_back(results[0].matches.size());
+        if (tick == 0) {
+            EXPECT_EQ(results[1].matches.size(), 1u);
+        }
+    }
+    EXPECT_EQ(noisy_matches, (std::vector<size_t>{1, 1, 1}));
+    EXPECT_EQ(noisy_queue->get_queue_size(), 0u);
+    EXPECT_EQ(quiet_queue->get_queue_size(), 0u);
+
+    const auto& budget = noisy_queue->get_tick_budget_stats();
+    EXPECT_EQ(budget.ticks, 3u);
+    EXPECT_EQ(budget.over_budget_ticks, 3u);         // Emptied buckets stay until idle eviction
+    EXPECT_EQ(budget.deferred_buckets, 6u);
+    EXPECT_EQ(quiet_queue->get_tick_budget_stats().over_budget_ticks, 0u);
+    EXPECT_EQ(host.stats(0).matches, 3u);
+    EXPECT_EQ(host.stats(0).tick_cpu_seconds.count, 3u);
+}
+
+TEST(TenantHostTest, DeferredSweepResumesAtTheSameBucketAfterARehash) {
+    QueueManager qm;
+    qm.set_tick_budget(std::chrono::microseconds(1));     // One bucket per tick
+    for (const char* region : {"us-east", "eu-west", "ap-south"}) {
+        qm.enqueue(make_entry(std::string(region) + "-a", region, "ranked", 1, 1500));
+        qm.enqueue(make_entry(std::string(region) + "-b", region, "ranked", 1, 1510));
+    }
+    ASSERT_EQ(qm.tick().size(), 1u);
+
+    // Lone parties in many new buckets grow and rehash the bucket map
+    for (int i = 0; i < 64; ++i) {
+        qm.enqueue(make_entry("solo-" + std::to_string(i), "region-" + std::to_string(i), "ranked", 1, 1500));
+    }
+    auto now = std::chrono::system_clock::now();
+    EXPECT_EQ(qm.next_wakeup(now), now);                 // Deferred buckets are due
+    EXPECT_EQ(qm.tick().size(), 1u);
+}
+
+TEST(TenantHostTest, TenantsShareOneNatsClientWithoutReplacingSubscriptions) {
+    TenantHost host(2);
+    TenantConfig primary_config;
+    primary_config.name = "default";
+    TenantConfig tenant_config;
+    tenant_config.name = "title-b";
+    auto* primary = host.add_tenant(primary_config);
+    auto* tenant = host.add_tenant(tenant_config);
+    EXPECT_EQ(host.add_tenant(primary_config), nullptr);
+
+    MockNatsClient nats;
+    nats.subscribe_queue_events("matchmaker.queue.>",
+        [primary](const QueueEvent& event) { primary->enqueue(event.entry); });
+    nats.subscribe_queue_events("matchmaker.title-b.queue.>",
+        [tenant](const QueueEvent& event) { tenant->enqueue(event.entry); });
+
+    auto enter = [](const std::string& id, int mmr) {
+        return QueueEvent{QueueEvent::Type::Enter, make_entry(id, "us-east", "ranked", 1, mmr)};
+    };
+    nats.simulate_queue_event("matchmaker.queue.ranked.us-east", enter("a", 1500));
+    nats.simulate_queue_event("matchmaker.queue.ranked.us-east", enter("b", 1510));
+    nats.simulate_queue_event("matchmaker.title-b.queue.ranked.us-east", enter("c", 1500));
+    EXPECT_EQ(primary->get_queue_size(), 2u);
+    EXPECT_EQ(tenant->get_queue_size(), 1u);
+
+    auto results = host.tick();
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].tenant, "default");
+    EXPECT_EQ(results[0].matches.size(), 1u);
+    EXPECT_TRUE(results[1].matches.empty());
+}
+
+TEST(PartyIndexTest, ChurnKeepsRecordsStableAndLookupsExact) {
+    MemoryAccount account;
+    {
+        FlatPartyIndex<int> index(&account);
+        std::vector<std::string> ids;
+        for (int i = 0; i < 2000; ++i) {
+            ids.push_back(std::to_string(i));
+        }
+
+        // Record pointers survive every rehash while the key stays in
+        auto* first = index.try_emplace(ids[0], hash_party_id(ids[0])).first;
+        first->value = 7;
+        for (size_t i = 1; i < ids.size(); ++i) {
+            auto [record, created] = index.try_emplace(ids[i], hash_party_id(ids[i]));
+            ASSERT_TRUE(created);
+            record->value = static_cast<int>(i);
+        }
+        EXPECT_EQ(index.find(std::string_view("0")), first);
+        EXPECT_EQ(&first->key, &index.find(ids[0])->key);
+        EXPECT_FALSE(index.try_emplace(ids[5], hash_party_id(ids[5])).second);
+        EXPECT_EQ(index.size(), 2000u);
+        EXPECT_GE(index.slot_count() * 7, index.size() * 8);
+
+        // Erase every other id; the rest stay reachable without tombstones
+        for (size_t i = 0; i < ids.size(); i += 2) {
+            index.erase(index.find(ids[i]));
+        }
+        EXPECT_EQ(index.size(), 1000u);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            auto* record = index.find(ids[i]);
+            if (i % 2 == 0) {
+                EXPECT_EQ(record, nullptr);
+            } else {
+                ASSERT_NE(record, nullptr);
+                EXPECT_EQ(record->value, static_cast<int>(i));
+            }
+        }
+
+        // Re-inserts reuse freed records instead of growing
+        int64_t bytes = account.bytes;
+        for (size_t i = 0; i < ids.size(); i += 2) {
+            EXPECT_TRUE(index.try_emplace(ids[i], hash_party_id(ids[i])).second);
+        }
+        EXPECT_EQ(account.bytes, bytes);
+        EXPECT_EQ(index.find("missing"), nullptr);
+    }
+    EXPECT_EQ(account.bytes, 0);
+
+    // QueueManager lookups take views of message bytes
+    QueueManager qm;
+    qm.enqueue(make_entry("party-1", "us-east", "ranked", 1, 1500));
+    qm.enqueue(make_entry("party-2", "us-east", "ranked", 1, 1510));
+    std::string wire = "party-1,party-2";
+    EXPECT_TRUE(qm.is_queued(std::string_view(wire).substr(0, 7)));
+    qm.dequeue(std::string_view(wire).substr(8));
+    EXPECT_FALSE(qm.is_queued("party-2"));
+    EXPECT_EQ(qm.get_queue_size(), 1u);
+}
+
+TEST(IdleWakeupTest, NextWakeupTracksDeadlinesAndArrivalsWakeTheLoop) {
+    using namespace std::chrono_literals;
+    QueueManager qm;
+    auto now = std::chrono::system_clock::now();
+    EXPECT_EQ(qm.next_wakeup(now), std::chrono::system_clock::time_point::max());
+
+    // A lone party can only time out; a second one is due at once
+    auto first = make_entry("party-1", "us-east", "ranked", 1, 1500);
+    first.enqueued_at = now - 60s;
+    qm.enqueue(first);
+    EXPECT_EQ(qm.next_wakeup(now), first.enqueued_at + 120s + 1ms);
+    auto second = make_entry("party-2", "us-east", "ranked", 1, 2300);
+    second.enqueued_at = now;
+    qm.enqueue(second);
+    EXPECT_EQ(qm.next_wakeup(now), now);
+
+    // Out of band: nothing changes until party-2's band widens
+    EXPECT_TRUE(qm.tick().empty());
+    EXPECT_EQ(qm.next_wakeup(now), now + 1s);
+
+    // Both bands maxed out: only the timeouts remain
+    auto far = make_entry("party-3", "us-east", "ranked", 1, 2600);
+    far.enqueued_at = now - 40s;
+    qm.dequeue("party-2");
+    qm.enqueue(far);
+    EXPECT_TRUE(qm.tick().empty());
+    EXPECT_EQ(qm.next_wakeup(now), first.enqueued_at + 120s + 1ms);
+
+    BackfillRequest backfill;
+    backfill.match_id = "match-1";
+    backfill.region = "us-east";
+    backfill.mode = "ranked";
+    backfill.deadline = now + 5s;
+    qm.request_backfill(backfill);
+    EXPECT_EQ(qm.next_wakeup(now), now);
+
+    Wakeup wakeup;
+    EXPECT_FALSE(wakeup.wait_for(1ms));
+    wakeup.notify();
+    wakeup.notify();
+    EXPECT_TRUE(wakeup.wait_for(0ms));
+    EXPECT_FALSE(wakeup.wait_for(0ms));
+    auto start = std::chrono::steady_clock::now();
+    std::thread notifier([&wakeup] {
+        std::this_thread::sleep_for(10ms);
+        wakeup.notify();
+    });
+    EXPECT_TRUE(wakeup.wait_for(10s));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+    notifier.join();
+}
+
+TEST(QueuePositionTest, PositionsAndBandDensityWithChangedOnlyUpdates) {
+    using namespace std::chrono_literals;
+    MemoryAccount account;
+    {
+        // Ranks match a sorted vector through random churn
+        OrderStatisticTree<int> tree(&account);
+        std::vector<int64_t> values;
+        std::mt19937 rng(7);
+        for (uint64_t i = 1; i <= 2000; ++i) {
+            if (!values.empty() && rng() % 3 == 0) {
+                size_t victim = rng() % values.size();
+                ASSERT_TRUE(tree.erase({values[victim], static_cast<uint64_t>(values[victim])}));
+                values.erase(values.begin() + static_cast<std::ptrdiff_t>(victim));
+            } else {
+                int64_t value = static_cast<int64_t>(i * 7919 % 5003);
+                tree.insert({value, static_cast<uint64_t>(value)}, 0);
+                values.insert(std::lower_bound(values.begin(), values.end(), value), value);
+            }
+        }
+        ASSERT_EQ(tree.size(), values.size());
+        EXPECT_FALSE(tree.erase({-1, 0}));
+        for (int64_t probe : {0, 100, 2500, 5002}) {
+            auto below = static_cast<size_t>(std::lower_bound(values.begin(), values.end(), probe) - values.begin());
+            EXPECT_EQ(tree.rank({probe, 0}), below);
+        }
+        auto in_range = std::count_if(values.begin(), values.end(), [](int64_t v) { return v >= 1000 && v <= 2000; });
+        EXPECT_EQ(tree.count_between(1000, 2000), static_cast<size_t>(in_range));
+    }
+    EXPECT_EQ(account.bytes, 0);
+
+    QueueConfig config;
+    config.position_update_interval_ms = 1;
+    QueueManager qm(config);
+    auto now = std::chrono::system_clock::now();
+    auto enqueue = [&](const std::string& id, int mmr, std::chrono::seconds waited) {
+        auto entry = make_entry(id, "us-east", "ranked", 5, mmr);
+        entry.enqueued_at = now - waited;
+        qm.enqueue(entry);
+    };
+    enqueue("p1", 1500, 30s);
+    enqueue("p2", 1550, 20s);
+    enqueue("p3", 3000, 10s);
+    enqueue("p4", 1600, 40s);
+
+    auto p1 = qm.get_queue_position("p1");
+    ASSERT_TRUE(p1.has_value());
+    EXPECT_EQ(p1->position, 2u);
+    EXPECT_EQ(p1->queued, 4u);
+    EXPECT_EQ(p1->band, 400);
+    EXPECT_EQ(p1->in_band, 2u);
+    EXPECT_EQ(qm.get_queue_position("p4")->position, 1u);
+    EXPECT_FALSE(qm.get_queue_position("missing").has_value());
+
+    // First update reports everyone, in wait order
+    EXPECT_TRUE(qm.tick().empty());
+    auto updates = qm.take_position_updates();
+    ASSERT_EQ(updates.size(), 1u);
+    ASSERT_EQ(updates[0].positions.size(), 4u);
+    EXPECT_EQ(updates[0].positions[0], std::make_pair(std::string("p4"), 1u));
+    EXPECT_EQ(updates[0].positions[3], std::make_pair(std::string("p3"), 4u));
+
+    // Then only the parties that moved
+    qm.dequeue("p1");
+    std::this_thread::sleep_for(2ms);
+    qm.tick();
+    updates = qm.take_position_updates();
+    ASSERT_EQ(updates.size(), 1u);
+    EXPECT_EQ(serialize_queue_positions(updates[0]),
+              R"({"bucket":"us-east:ranked:5","queued":3,"positions":[["p2",2],["p3",3]]})");
+    std::this_thread::sleep_for(2ms);
+    qm.tick();
+    EXPECT_TRUE(qm.take_position_updates().empty());
+}
+
+TEST(MetricsTest, RendersAndServesPrometheusText) {
+    MetricsRegistry metrics;
+    metrics.describe("matchmaker_memory_bytes", MetricsRegistry::Type::Gauge, "Queue memory");
+    metrics.set("matchmaker_memory_bytes", 1024, {{"component", "ids"}});
+    metrics.set("matchmaker_memory_bytes", 2048, {{"component", "a\"b"}});
+
+    std::string text = metrics.render();
+    EXPECT_NE(text.find("# TYPE matchmaker_memory_bytes gauge\n"), std::string::npos);
+    EXPECT_NE(text.find("matchmaker_memory_bytes{component=\"ids\"} 1024\n"), std::string::npos);
+    EXPECT_NE(text.find("{component=\"a\\\"b\"}"), std::string::npos);
+
+    MetricsServer server(metrics, 0);
+    ASSERT_TRUE(server.listening());
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(server.port()));
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    std::string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    ASSERT_EQ(::send(fd, request.data(), request.size(), 0), static_cast<ssize_t>(request.size()));
+
+    std::string response;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+        response.append(buf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    EXPECT_EQ(response.rfind("HTTP/1.1 200 OK", 0), 0u);
+    EXPECT_NE(response.find("matchmaker_memory_bytes{component=\"ids\"} 1024"), std::string::npos);
+}